@@ -0,0 +1,285 @@
+//! Throughput of each pipeline stage over synthetic and real DWARF corpora.
+//!
+//! Synthetic corpora are generated once per run at the struct counts listed in
+//! `LAYOUT_AUDIT_BENCH_STRUCTS` (comma-separated, default `10000`; the generator handles
+//! 1M and up). Real binaries listed in `LAYOUT_AUDIT_BENCH_CORPUS` (a `PATH`-style list)
+//! are benchmarked alongside them. Track a release with criterion's baselines:
+//!
+//! ```text
+//! cargo bench --bench pipeline -- --save-baseline v0.6.0   # on the release
+//! cargo bench --bench pipeline -- --baseline v0.6.0        # on the change
+//! ```
+
+mod synth;
+
+use criterion::{BatchSize, BenchmarkId, Criterion, Throughput, criterion_group, criterion_main};
+use layout_audit::{
+    BinaryData, DwarfContext, JsonFormatter, OptimizedLayout, SarifFormatter, Snapshot,
+    StructLayout, SuggestJsonFormatter, SuggestTableFormatter, TableFormatter,
+    analyze_false_sharing, analyze_layout, diff_layouts, optimize_layout,
+};
+use std::hint::black_box;
+use std::path::PathBuf;
+use std::sync::OnceLock;
+use synth::SynthConfig;
+
+const CACHE_LINE: u32 = 64;
+const MAX_ALIGN: u64 = 8;
+
+struct Corpus {
+    name: String,
+    path: PathBuf,
+    /// The same corpus after a change, diffed against `path`; real binaries diff
+    /// against themselves.
+    revised: PathBuf,
+}
+
+/// Analyzed layouts of one corpus.
+struct Extracted {
+    layouts: Vec<StructLayout>,
+    revised: Vec<StructLayout>,
+}
+
+impl Extracted {
+    fn elements(&self) -> Throughput {
+        Throughput::Elements(self.layouts.len() as u64)
+    }
+}
+
+fn corpora() -> &'static [(Corpus, Extracted)] {
+    static CORPORA: OnceLock<(tempfile::TempDir, Vec<(Corpus, Extracted)>)> = OnceLock::new();
+    let (_, corpora) = CORPORA.get_or_init(|| {
+        let dir = tempfile::tempdir().expect("tempdir");
+        let mut corpora = Vec::new();
+
+        let sizes = std::env::var("LAYOUT_AUDIT_BENCH_STRUCTS").unwrap_or_else(|_| "10000".into());
+        for size in sizes.split(',').map(str::trim).filter(|s| !s.is_empty()) {
+            let structs: usize = size.replace('_', "").parse().unwrap_or_else(|_| {
+                panic!("LAYOUT_AUDIT_BENCH_STRUCTS: invalid struct count '{size}'")
+            });
+            let config = SynthConfig::new(structs);
+            let path = dir.path().join(format!("synthetic-{structs}"));
+            let revised = dir.path().join(format!("synthetic-{structs}-r1"));
+            synth::write_corpus(&path, &config).expect("write synthetic corpus");
+            synth::write_corpus(&revised, &config.with_revision(1))
+                .expect("write synthetic corpus");
+            corpora.push(Corpus { name: format!("synthetic-{structs}"), path, revised });
+        }
+
+        if let Some(paths) = std::env::var_os("LAYOUT_AUDIT_BENCH_CORPUS") {
+            for path in std::env::split_paths(&paths).filter(|p| !p.as_os_str().is_empty()) {
+                let name = path.file_name().map_or_else(
+                    || path.display().to_string(),
+                    |n| n.to_string_lossy().into_owned(),
+                );
+                corpora.push(Corpus { name, revised: path.clone(), path });
+            }
+        }
+
+        let corpora = corpora
+            .into_iter()
+            .map(|corpus| {
+                let extracted =
+                    Extracted { layouts: extract(&corpus.path), revised: extract(&corpus.revised) };
+                (corpus, extracted)
+            })
+            .collect();
+        (dir, corpora)
+    });
+    corpora
+}
+
+fn extract(path: &std::path::Path) -> Vec<StructLayout> {
+    let binary = BinaryData::load(path)
+        .unwrap_or_else(|e| panic!("Failed to load {}: {}", path.display(), e));
+    let loaded = binary.load_dwarf_for_layouts(0).expect("load DWARF");
+    let mut layouts =
+        DwarfContext::new(&loaded).with_jobs(0).find_structs(None, false).expect("extract");
+    for layout in &mut layouts {
+        analyze_layout(layout, CACHE_LINE);
+    }
+    layouts
+}
+
+fn bench_load(c: &mut Criterion) {
+    let mut group = c.benchmark_group("load");
+    for (corpus, extracted) in corpora() {
+        group.throughput(extracted.elements());
+        group.bench_function(&corpus.name, |b| {
+            b.iter(|| {
+                let binary = BinaryData::load(&corpus.path).expect("load");
+                let loaded = binary.load_dwarf_for_layouts(0).expect("load DWARF");
+                black_box(loaded.address_size);
+            })
+        });
+    }
+    group.finish();
+}
+
+fn bench_extract(c: &mut Criterion) {
+    let mut group = c.benchmark_group("extract");
+    group.sample_size(10);
+    for (corpus, extracted) in corpora() {
+        let binary = BinaryData::load(&corpus.path).expect("load");
+        let loaded = binary.load_dwarf_for_layouts(0).expect("load DWARF");
+        group.throughput(extracted.elements());
+        for (label, jobs) in [("serial", 1), ("parallel", 0)] {
+            group.bench_with_input(BenchmarkId::new(label, &corpus.name), &jobs, |b, &jobs| {
+                b.iter(|| {
+                    let context = DwarfContext::new(&loaded).with_jobs(jobs);
+                    black_box(context.find_structs(None, false).expect("extract"))
+                })
+            });
+        }
+    }
+    group.finish();
+}
+
+fn bench_analyze(c: &mut Criterion) {
+    let mut group = c.benchmark_group("analyze_layout");
+    for (corpus, extracted) in corpora() {
+        group.throughput(extracted.elements());
+        group.bench_function(&corpus.name, |b| {
+            b.iter_batched(
+                || extracted.layouts.clone(),
+                |mut layouts| {
+                    for layout in &mut layouts {
+                        analyze_layout(layout, CACHE_LINE);
+                    }
+                    layouts
+                },
+                BatchSize::LargeInput,
+            )
+        });
+    }
+    group.finish();
+}
+
+fn bench_false_sharing(c: &mut Criterion) {
+    let mut group = c.benchmark_group("analyze_false_sharing");
+    for (corpus, extracted) in corpora() {
+        group.throughput(extracted.elements());
+        group.bench_function(&corpus.name, |b| {
+            b.iter(|| {
+                let analyses =
+                    extracted.layouts.iter().map(|l| analyze_false_sharing(l, CACHE_LINE));
+                black_box(analyses.map(|a| a.pair_count).sum::<u64>())
+            })
+        });
+    }
+    group.finish();
+}
+
+fn bench_optimize(c: &mut Criterion) {
+    let mut group = c.benchmark_group("optimize_layout");
+    for (corpus, extracted) in corpora() {
+        group.throughput(extracted.elements());
+        group.bench_function(&corpus.name, |b| {
+            b.iter(|| {
+                let suggestions: Vec<OptimizedLayout> =
+                    extracted.layouts.iter().map(|l| optimize_layout(l, MAX_ALIGN)).collect();
+                black_box(suggestions)
+            })
+        });
+    }
+    group.finish();
+}
+
+fn bench_diff(c: &mut Criterion) {
+    let mut group = c.benchmark_group("diff");
+    for (corpus, extracted) in corpora() {
+        group.throughput(extracted.elements());
+        group.bench_function(&corpus.name, |b| {
+            b.iter(|| black_box(diff_layouts(&extracted.layouts, &extracted.revised, 64)))
+        });
+    }
+    group.finish();
+}
+
+fn bench_snapshot(c: &mut Criterion) {
+    let mut group = c.benchmark_group("snapshot");
+    for (corpus, extracted) in corpora() {
+        let data = Snapshot::encode(&extracted.layouts).expect("encode snapshot");
+        group.throughput(extracted.elements());
+        group.bench_function(BenchmarkId::new("encode", &corpus.name), |b| {
+            b.iter(|| Snapshot::encode(&extracted.layouts).expect("encode snapshot"))
+        });
+        group.bench_function(BenchmarkId::new("read", &corpus.name), |b| {
+            b.iter(|| Snapshot::parse(&data).expect("parse snapshot").layouts(None, false))
+        });
+    }
+    group.finish();
+}
+
+fn all_cpus() -> usize {
+    layout_audit::dwarf::effective_jobs(0)
+}
+
+fn bench_format(c: &mut Criterion) {
+    let mut group = c.benchmark_group("format");
+    group.sample_size(20);
+    for (corpus, extracted) in corpora() {
+        let layouts = &extracted.layouts;
+        let suggestions: Vec<OptimizedLayout> =
+            layouts.iter().map(|l| optimize_layout(l, MAX_ALIGN)).collect();
+        let diff = diff_layouts(layouts, &extracted.revised, 64);
+        group.throughput(extracted.elements());
+
+        let name = &corpus.name;
+        group.bench_function(BenchmarkId::new("table", name), |b| {
+            b.iter(|| TableFormatter::new(true, CACHE_LINE).format(layouts))
+        });
+        group.bench_function(BenchmarkId::new("table_parallel", name), |b| {
+            let formatter = TableFormatter::new(true, CACHE_LINE).with_jobs(all_cpus());
+            b.iter(|| formatter.write(&mut std::io::sink(), layouts).expect("write"))
+        });
+        group.bench_function(BenchmarkId::new("table_detail_100", name), |b| {
+            let formatter = TableFormatter::new(true, CACHE_LINE).with_detail(100);
+            b.iter(|| formatter.write(&mut std::io::sink(), layouts).expect("write"))
+        });
+        group.bench_function(BenchmarkId::new("json", name), |b| {
+            b.iter(|| JsonFormatter::new(false).format(layouts))
+        });
+        group.bench_function(BenchmarkId::new("ndjson", name), |b| {
+            b.iter(|| {
+                let mut out = Vec::new();
+                for layout in layouts {
+                    JsonFormatter::write_ndjson(&mut out, layout).expect("write");
+                }
+                out
+            })
+        });
+        group.bench_function(BenchmarkId::new("sarif", name), |b| {
+            b.iter(|| SarifFormatter::new().format_inspect(layouts))
+        });
+        group.bench_function(BenchmarkId::new("sarif_parallel", name), |b| {
+            let formatter = SarifFormatter::new().with_jobs(all_cpus());
+            b.iter(|| formatter.write_inspect(&mut std::io::sink(), layouts).expect("write"))
+        });
+        group.bench_function(BenchmarkId::new("sarif_diff", name), |b| {
+            b.iter(|| {
+                SarifFormatter::new().format_diff(&diff, layout_audit::diff::DEFAULT_REGRESSIONS)
+            })
+        });
+        group.bench_function(BenchmarkId::new("suggest_table", name), |b| {
+            b.iter(|| SuggestTableFormatter::new(true).format(&suggestions))
+        });
+        group.bench_function(BenchmarkId::new("suggest_json", name), |b| {
+            b.iter(|| SuggestJsonFormatter::new(false).format(&suggestions))
+        });
+    }
+    group.finish();
+}
+
+criterion_group!(
+    benches,
+    bench_load,
+    bench_extract,
+    bench_analyze,
+    bench_false_sharing,
+    bench_optimize,
+    bench_diff,
+    bench_snapshot,
+    bench_format
+);
+criterion_main!(benches);
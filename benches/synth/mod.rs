@@ -0,0 +1,383 @@
+//! Generator for synthetic DWARF corpora.
+//!
+//! Writes a relocatable ELF object whose `.debug_info` holds `units` compile units of
+//! C++-like struct definitions: a set of "header" structs repeated in every unit (as a
+//! common header is), a chain of nested template instantiations, and records mixing base
+//! types, pointers, atomics and embedded structs with natural alignment padding. Output is
+//! deterministic for a given `SynthConfig`.
+//!
+//! The DWARF is emitted directly with a fixed abbreviation table rather than through a
+//! DWARF writer crate: the schema is small and this keeps the benchmarks' dependencies
+//! down to criterion.
+
+use std::collections::HashMap;
+use std::path::Path;
+
+#[derive(Debug, Clone, Copy)]
+pub struct SynthConfig {
+    /// Struct definitions across all units (approximate: rounded to whole units).
+    pub structs: usize,
+    pub structs_per_unit: usize,
+    /// Nesting depth of the `Tpl<Tpl<...>>` chain emitted in every unit.
+    pub template_depth: usize,
+    /// Structs repeated identically in every unit.
+    pub shared_structs: usize,
+    /// `0` for the baseline; higher revisions add a member to every 50th record, for diffing.
+    pub revision: u32,
+}
+
+impl SynthConfig {
+    pub fn new(structs: usize) -> Self {
+        Self { structs, structs_per_unit: 200, template_depth: 8, shared_structs: 20, revision: 0 }
+    }
+
+    pub fn with_revision(self, revision: u32) -> Self {
+        Self { revision, ..self }
+    }
+
+    fn units(&self) -> usize {
+        self.structs.div_ceil(self.structs_per_unit).max(1)
+    }
+}
+
+/// Write the corpus described by `config` to `path`.
+pub fn write_corpus(path: &Path, config: &SynthConfig) -> std::io::Result<()> {
+    let mut strings = Strings::default();
+    let mut info = Vec::new();
+    for unit in 0..config.units() {
+        write_unit(&mut info, &mut strings, config, unit);
+    }
+    let sections =
+        [(".debug_abbrev", abbreviations()), (".debug_info", info), (".debug_str", strings.data)];
+    std::fs::write(path, elf_object(&sections))
+}
+
+const ABBREV_COMPILE_UNIT: u8 = 1;
+const ABBREV_BASE_TYPE: u8 = 2;
+const ABBREV_POINTER: u8 = 3;
+const ABBREV_ATOMIC: u8 = 4;
+const ABBREV_STRUCT: u8 = 5;
+const ABBREV_MEMBER: u8 = 6;
+
+const DW_TAG_BASE_TYPE: u8 = 0x24;
+const DW_TAG_POINTER_TYPE: u8 = 0x0f;
+const DW_TAG_STRUCTURE_TYPE: u8 = 0x13;
+const DW_TAG_MEMBER: u8 = 0x0d;
+const DW_TAG_COMPILE_UNIT: u8 = 0x11;
+const DW_TAG_ATOMIC_TYPE: u8 = 0x47;
+
+const DW_AT_NAME: u8 = 0x03;
+const DW_AT_BYTE_SIZE: u8 = 0x0b;
+const DW_AT_LANGUAGE: u8 = 0x13;
+const DW_AT_PRODUCER: u8 = 0x25;
+const DW_AT_DATA_MEMBER_LOCATION: u8 = 0x38;
+const DW_AT_ENCODING: u8 = 0x3e;
+const DW_AT_TYPE: u8 = 0x49;
+
+const DW_FORM_DATA1: u8 = 0x0b;
+const DW_FORM_DATA2: u8 = 0x05;
+const DW_FORM_STRP: u8 = 0x0e;
+const DW_FORM_UDATA: u8 = 0x0f;
+const DW_FORM_REF4: u8 = 0x13;
+
+const DW_LANG_C_PLUS_PLUS_14: u16 = 0x21;
+
+/// (name, size, DW_ATE encoding). Alignment equals size.
+const BASE_TYPES: &[(&str, u64, u8)] = &[
+    ("char", 1, 0x06),
+    ("bool", 1, 0x02),
+    ("short", 2, 0x05),
+    ("int", 4, 0x05),
+    ("float", 4, 0x04),
+    ("long", 8, 0x05),
+    ("double", 8, 0x04),
+];
+
+/// (code, tag, has children, (attribute, form) pairs).
+type Abbreviation = (u8, u8, bool, &'static [(u8, u8)]);
+
+fn abbreviations() -> Vec<u8> {
+    let entries: &[Abbreviation] = &[
+        (
+            ABBREV_COMPILE_UNIT,
+            DW_TAG_COMPILE_UNIT,
+            true,
+            &[
+                (DW_AT_PRODUCER, DW_FORM_STRP),
+                (DW_AT_LANGUAGE, DW_FORM_DATA2),
+                (DW_AT_NAME, DW_FORM_STRP),
+            ],
+        ),
+        (
+            ABBREV_BASE_TYPE,
+            DW_TAG_BASE_TYPE,
+            false,
+            &[
+                (DW_AT_NAME, DW_FORM_STRP),
+                (DW_AT_BYTE_SIZE, DW_FORM_DATA1),
+                (DW_AT_ENCODING, DW_FORM_DATA1),
+            ],
+        ),
+        (ABBREV_POINTER, DW_TAG_POINTER_TYPE, false, &[(DW_AT_BYTE_SIZE, DW_FORM_DATA1)]),
+        (ABBREV_ATOMIC, DW_TAG_ATOMIC_TYPE, false, &[(DW_AT_TYPE, DW_FORM_REF4)]),
+        (
+            ABBREV_STRUCT,
+            DW_TAG_STRUCTURE_TYPE,
+            true,
+            &[(DW_AT_NAME, DW_FORM_STRP), (DW_AT_BYTE_SIZE, DW_FORM_UDATA)],
+        ),
+        (
+            ABBREV_MEMBER,
+            DW_TAG_MEMBER,
+            false,
+            &[
+                (DW_AT_NAME, DW_FORM_STRP),
+                (DW_AT_TYPE, DW_FORM_REF4),
+                (DW_AT_DATA_MEMBER_LOCATION, DW_FORM_UDATA),
+            ],
+        ),
+    ];
+
+    let mut out = Vec::new();
+    for &(code, tag, children, attributes) in entries {
+        out.extend([code, tag, children as u8]);
+        for &(name, form) in attributes {
+            out.extend([name, form]);
+        }
+        out.extend([0, 0]);
+    }
+    out.push(0);
+    out
+}
+
+#[derive(Default)]
+struct Strings {
+    data: Vec<u8>,
+    offsets: HashMap<String, u32>,
+}
+
+impl Strings {
+    /// Offset of `s` in `.debug_str`, merged like a linker merges string sections.
+    fn offset(&mut self, s: &str) -> u32 {
+        if let Some(&offset) = self.offsets.get(s) {
+            return offset;
+        }
+        let offset = self.data.len() as u32;
+        self.data.extend_from_slice(s.as_bytes());
+        self.data.push(0);
+        self.offsets.insert(s.to_string(), offset);
+        offset
+    }
+}
+
+/// A type DIE already written to the current unit: its unit offset, size and alignment.
+#[derive(Clone, Copy)]
+struct TypeDie {
+    offset: u32,
+    size: u64,
+    align: u64,
+}
+
+/// xorshift64*, seeded per struct so every unit and revision draws the same sequence for
+/// the same struct.
+struct Rng(u64);
+
+impl Rng {
+    fn new(seed: u64) -> Self {
+        Self(seed.wrapping_mul(0x9E37_79B9_7F4A_7C15) | 1)
+    }
+
+    fn below(&mut self, n: u64) -> u64 {
+        self.0 ^= self.0 >> 12;
+        self.0 ^= self.0 << 25;
+        self.0 ^= self.0 >> 27;
+        self.0.wrapping_mul(0x2545_F491_4F6C_DD1D) % n
+    }
+}
+
+fn write_unit(info: &mut Vec<u8>, strings: &mut Strings, config: &SynthConfig, unit: usize) {
+    // DWARF 4 header; the length is patched once the unit is complete.
+    let start = info.len();
+    info.extend(0u32.to_le_bytes());
+    info.extend(4u16.to_le_bytes());
+    info.extend(0u32.to_le_bytes());
+    info.push(8);
+    let offset = |info: &Vec<u8>| (info.len() - start) as u32;
+
+    info.push(ABBREV_COMPILE_UNIT);
+    info.extend(strings.offset("layout-audit synthetic corpus").to_le_bytes());
+    info.extend(DW_LANG_C_PLUS_PLUS_14.to_le_bytes());
+    info.extend(strings.offset(&format!("unit{unit}.cpp")).to_le_bytes());
+
+    let mut base = Vec::with_capacity(BASE_TYPES.len());
+    for &(name, size, encoding) in BASE_TYPES {
+        base.push(TypeDie { offset: offset(info), size, align: size });
+        info.push(ABBREV_BASE_TYPE);
+        info.extend(strings.offset(name).to_le_bytes());
+        info.extend([size as u8, encoding]);
+    }
+    let pointer = TypeDie { offset: offset(info), size: 8, align: 8 };
+    info.extend([ABBREV_POINTER, 8]);
+    let long = base[5];
+    let atomic = TypeDie { offset: offset(info), ..long };
+    info.push(ABBREV_ATOMIC);
+    info.extend(long.offset.to_le_bytes());
+
+    let mut structs: Vec<TypeDie> = Vec::new();
+    let field = |i: usize| format!("field_{i}");
+
+    // Identical in every unit, like types from a widely included header.
+    for i in 0..config.shared_structs {
+        let mut rng = Rng::new(i as u64);
+        let members: Vec<_> = (0..2 + rng.below(6) as usize)
+            .map(|m| (field(m), base[rng.below(base.len() as u64) as usize]))
+            .collect();
+        structs.push(write_struct(info, strings, start, &format!("common::Header{i}"), &members));
+    }
+
+    // Tpl<Leaf>, Tpl<Tpl<Leaf>>, ...: each level wraps the previous one between a flag
+    // and a counter, and the names grow like real template instantiations.
+    let mut name = format!("app{unit}::Leaf");
+    let mut inner = write_struct(
+        info,
+        strings,
+        start,
+        &name,
+        &[("value".into(), base[3]), ("tag".into(), base[0])],
+    );
+    structs.push(inner);
+    for _ in 0..config.template_depth {
+        name = format!("app{unit}::Tpl<{name}>");
+        let members =
+            [("flag".into(), base[1]), ("inner".into(), inner), ("count".into(), base[5])];
+        inner = write_struct(info, strings, start, &name, &members);
+        structs.push(inner);
+    }
+
+    let records = config.structs_per_unit.saturating_sub(structs.len());
+    for i in 0..records {
+        let mut rng = Rng::new(((unit as u64) << 32) | i as u64);
+        let count = 3 + rng.below(10) as usize;
+        let mut members = Vec::with_capacity(count + 1);
+        for m in 0..count {
+            let ty = match rng.below(24) {
+                0 | 1 => pointer,
+                2 => atomic,
+                3 => structs[rng.below(structs.len() as u64) as usize],
+                _ => base[rng.below(base.len() as u64) as usize],
+            };
+            members.push((field(m), ty));
+        }
+        if config.revision > 0 && i % 50 == 0 {
+            members.push((format!("added_r{}", config.revision), base[0]));
+        }
+        structs.push(write_struct(
+            info,
+            strings,
+            start,
+            &format!("app{unit}::Record{i}"),
+            &members,
+        ));
+    }
+
+    info.push(0);
+    let length = (info.len() - start - 4) as u32;
+    info[start..start + 4].copy_from_slice(&length.to_le_bytes());
+}
+
+/// Write a struct DIE with `members` laid out in order at their natural alignment.
+fn write_struct(
+    info: &mut Vec<u8>,
+    strings: &mut Strings,
+    unit_start: usize,
+    name: &str,
+    members: &[(String, TypeDie)],
+) -> TypeDie {
+    let mut end = 0u64;
+    let mut align = 1;
+    let mut placed = Vec::with_capacity(members.len());
+    for (member, ty) in members {
+        let at = end.next_multiple_of(ty.align);
+        placed.push((member, ty.offset, at));
+        end = at + ty.size;
+        align = align.max(ty.align);
+    }
+    let size = end.next_multiple_of(align).max(1);
+
+    let die = TypeDie { offset: (info.len() - unit_start) as u32, size, align };
+    info.push(ABBREV_STRUCT);
+    info.extend(strings.offset(name).to_le_bytes());
+    write_uleb(info, size);
+    for (member, type_offset, at) in placed {
+        info.push(ABBREV_MEMBER);
+        info.extend(strings.offset(member).to_le_bytes());
+        info.extend(type_offset.to_le_bytes());
+        write_uleb(info, at);
+    }
+    info.push(0);
+    die
+}
+
+fn write_uleb(out: &mut Vec<u8>, mut value: u64) {
+    loop {
+        let byte = (value & 0x7f) as u8;
+        value >>= 7;
+        if value == 0 {
+            out.push(byte);
+            return;
+        }
+        out.push(byte | 0x80);
+    }
+}
+
+/// A little-endian ELF64 relocatable object holding only `sections`. DWARF offsets are
+/// written resolved, so no relocations are needed.
+fn elf_object(sections: &[(&str, Vec<u8>)]) -> Vec<u8> {
+    const EHDR_SIZE: usize = 64;
+    const SHDR_SIZE: usize = 64;
+
+    let mut shstrtab = vec![0u8];
+    let mut names = Vec::new();
+    for (name, _) in sections.iter().map(|(n, d)| (*n, d)).chain([(".shstrtab", &Vec::new())]) {
+        names.push(shstrtab.len() as u32);
+        shstrtab.extend_from_slice(name.as_bytes());
+        shstrtab.push(0);
+    }
+
+    let mut out = vec![0u8; EHDR_SIZE];
+    let mut headers = vec![[0u8; SHDR_SIZE]];
+    let contents =
+        sections.iter().map(|(_, data)| (data.as_slice(), 1u32)).chain([(shstrtab.as_slice(), 3)]);
+    for ((data, kind), name) in contents.zip(&names) {
+        let offset = out.len() as u64;
+        out.extend_from_slice(data);
+        let mut header = [0u8; SHDR_SIZE];
+        header[0..4].copy_from_slice(&name.to_le_bytes());
+        header[4..8].copy_from_slice(&kind.to_le_bytes());
+        header[24..32].copy_from_slice(&offset.to_le_bytes());
+        header[32..40].copy_from_slice(&(data.len() as u64).to_le_bytes());
+        header[48..56].copy_from_slice(&1u64.to_le_bytes());
+        headers.push(header);
+    }
+
+    out.resize(out.len().next_multiple_of(8), 0);
+    let shoff = out.len() as u64;
+    for header in &headers {
+        out.extend_from_slice(header);
+    }
+
+    let ehdr = &mut out[..EHDR_SIZE];
+    ehdr[0..4].copy_from_slice(b"\x7fELF");
+    ehdr[4] = 2; // ELFCLASS64
+    ehdr[5] = 1; // ELFDATA2LSB
+    ehdr[6] = 1; // EV_CURRENT
+    ehdr[16..18].copy_from_slice(&1u16.to_le_bytes()); // ET_REL
+    ehdr[18..20].copy_from_slice(&62u16.to_le_bytes()); // EM_X86_64
+    ehdr[20..24].copy_from_slice(&1u32.to_le_bytes());
+    ehdr[40..48].copy_from_slice(&shoff.to_le_bytes());
+    ehdr[52..54].copy_from_slice(&(EHDR_SIZE as u16).to_le_bytes());
+    ehdr[58..60].copy_from_slice(&(SHDR_SIZE as u16).to_le_bytes());
+    ehdr[60..62].copy_from_slice(&(headers.len() as u16).to_le_bytes());
+    ehdr[62..64].copy_from_slice(&(headers.len() as u16 - 1).to_le_bytes());
+    out
+}
@@ -0,0 +1,126 @@
+use crate::profile::AccessSample;
+use crate::types::{AccessHeat, CacheLineHeat, MemberHeat, StructLayout};
+use std::collections::BTreeMap;
+
+/// Attributes sampled accesses to the members they fall in and sums them per cache line.
+/// A sample inside several members (bitfields, unions) counts for the first one declared.
+///
+/// # Panics
+/// Panics if `cache_line_size` is 0.
+pub fn analyze_access_heat(
+    layout: &StructLayout,
+    samples: &[AccessSample],
+    cache_line_size: u32,
+) -> AccessHeat {
+    assert!(cache_line_size > 0, "cache_line_size must be > 0");
+    let cache_line_size = cache_line_size as u64;
+
+    let total_weight: f64 = samples.iter().map(|s| s.weight).sum();
+    let percent =
+        |weight: f64| if total_weight > 0.0 { weight / total_weight * 100.0 } else { 0.0 };
+
+    let mut member_weights = vec![0.0; layout.members.len()];
+    let mut line_weights: BTreeMap<u64, f64> = BTreeMap::new();
+    let mut unattributed_weight = 0.0;
+
+    for sample in samples {
+        if sample.offset < layout.size {
+            *line_weights.entry(sample.offset / cache_line_size).or_default() += sample.weight;
+        }
+
+        let member = layout.members.iter().position(|m| match (m.offset, m.end_offset()) {
+            (Some(start), Some(end)) => (start..end).contains(&sample.offset),
+            _ => false,
+        });
+        match member {
+            Some(index) => member_weights[index] += sample.weight,
+            None => unattributed_weight += sample.weight,
+        }
+    }
+
+    let mut members: Vec<MemberHeat> = layout
+        .members
+        .iter()
+        .zip(&member_weights)
+        .filter(|(_, weight)| **weight > 0.0)
+        .filter_map(|(m, &weight)| {
+            Some(MemberHeat {
+                name: m.name.to_string(),
+                offset: m.offset?,
+                size: m.size?,
+                weight,
+                percent: percent(weight),
+            })
+        })
+        .collect();
+
+    let cache_lines = line_weights
+        .into_iter()
+        .map(|(cache_line, weight)| {
+            let mut in_line: Vec<&MemberHeat> =
+                members.iter().filter(|m| m.offset / cache_line_size == cache_line).collect();
+            in_line.sort_by_key(|m| m.offset);
+            CacheLineHeat {
+                cache_line,
+                weight,
+                percent: percent(weight),
+                members: in_line.into_iter().map(|m| m.name.clone()).collect(),
+            }
+        })
+        .collect();
+
+    // Hottest first; ties keep declaration order.
+    members.sort_by(|a, b| b.weight.total_cmp(&a.weight));
+
+    AccessHeat { total_weight, unattributed_weight, members, cache_lines }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::types::MemberLayout;
+
+    fn sample(offset: u64, weight: f64) -> AccessSample {
+        AccessSample { offset, weight }
+    }
+
+    fn layout() -> StructLayout {
+        let mut layout = StructLayout::new("Conn".to_string(), 128, Some(8));
+        layout.members = vec![
+            MemberLayout::new("id".to_string(), "long".to_string(), Some(0), Some(8)),
+            MemberLayout::new("flag".to_string(), "char".to_string(), Some(8), Some(1)),
+            MemberLayout::new("buf".to_string(), "char[64]".to_string(), Some(16), Some(64)),
+            MemberLayout::new("state".to_string(), "int".to_string(), Some(96), Some(4)),
+        ];
+        layout
+    }
+
+    #[test]
+    fn samples_map_to_members_and_cache_lines() {
+        let heat = analyze_access_heat(
+            &layout(),
+            &[sample(0, 10.0), sample(4, 10.0), sample(96, 60.0), sample(12, 20.0)],
+            64,
+        );
+
+        assert_eq!(heat.total_weight, 100.0);
+        assert_eq!(heat.unattributed_weight, 20.0, "offset 12 is padding");
+        let names: Vec<_> = heat.members.iter().map(|m| m.name.as_str()).collect();
+        assert_eq!(names, ["state", "id"]);
+        assert_eq!(heat.members[0].percent, 60.0);
+
+        assert_eq!(heat.cache_lines.len(), 2);
+        assert_eq!(heat.cache_lines[0].cache_line, 0);
+        assert_eq!(heat.cache_lines[0].percent, 40.0);
+        assert_eq!(heat.cache_lines[0].members, ["id"]);
+        assert_eq!(heat.cache_lines[1].members, ["state"]);
+    }
+
+    #[test]
+    fn samples_past_the_struct_are_unattributed() {
+        let heat = analyze_access_heat(&layout(), &[sample(4096, 1.0)], 64);
+        assert_eq!(heat.unattributed_weight, 1.0);
+        assert!(heat.members.is_empty());
+        assert!(heat.cache_lines.is_empty());
+    }
+}
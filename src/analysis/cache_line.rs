@@ -0,0 +1,457 @@
+//! Cache-line-aware field reordering.
+//!
+//! Where `optimize_layout` only minimizes padding, this strategy treats the cache line as
+//! a constraint: marked (or profile-hot) field groups stay within one line and atomics
+//! never share a line, and among the orderings that satisfy that it prefers the fewest
+//! cache lines, then the smallest size, then the fewest fields crossing a line boundary.
+
+use super::false_sharing::analyze_false_sharing;
+use super::optimize::{
+    OptimizedLayout, SortableUnit, align_up, heat_weights, optimize_ordered, packed_end,
+    sort_for_padding, split_by_heat,
+};
+use crate::types::{AccessHeat, StructLayout};
+use serde::Serialize;
+use std::collections::{HashMap, HashSet};
+
+/// Structs with at most this many movable items get every ordering tried.
+const EXACT_SEARCH_MAX_ITEMS: usize = 8;
+
+/// Orderings the local search may evaluate for larger structs.
+const MAX_SEARCH_EVALUATIONS: usize = 100_000;
+
+/// How a cache-line-aware suggestion placed fields relative to cache-line boundaries.
+#[derive(Debug, Clone, Serialize, Default)]
+pub struct CacheLinePlan {
+    pub cache_line_size: u64,
+    pub original_cache_lines: u64,
+    pub optimized_cache_lines: u64,
+    /// Field groups placed within a single cache line.
+    #[serde(skip_serializing_if = "Vec::is_empty")]
+    pub kept_together: Vec<Vec<String>>,
+    /// How many of `kept_together` crossed a cache-line boundary in the original layout.
+    pub original_split_groups: usize,
+    /// Groups that cannot fit one line, or that hold two atomics.
+    #[serde(skip_serializing_if = "Vec::is_empty")]
+    pub unsatisfied_groups: Vec<Vec<String>>,
+    /// Atomic members, each on cache lines no other atomic uses.
+    #[serde(skip_serializing_if = "Vec::is_empty")]
+    pub isolated_atomics: Vec<String>,
+    /// False sharing warnings for the original layout. The suggested layout has none.
+    pub original_false_sharing_pairs: usize,
+    /// True when every ordering was tried, false when a bounded local search was used.
+    pub exhaustive: bool,
+}
+
+/// Units placed back to back: a kept-together group, or a single free unit.
+struct Item {
+    units: Vec<SortableUnit>,
+    size: u64,
+    alignment: u64,
+    /// Must not cross a cache-line boundary.
+    keep_in_line: bool,
+    atomic: bool,
+}
+
+/// Ordering preference, compared field by field.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, PartialOrd, Ord)]
+struct Cost {
+    cache_lines: u64,
+    size: u64,
+    /// Free units that would fit in one line but cross a boundary.
+    split_units: usize,
+}
+
+/// Optimize a struct layout with cache-line constraints.
+///
+/// `keep_together` lists field groups to hold within one cache line; with `heat`, the
+/// hottest sampled fields that fit one line form another group. Overlapping groups are
+/// merged. When the struct has two or more atomic members (as `analyze_false_sharing`
+/// detects them), each gets cache lines of its own. Structs with few movable items are
+/// searched exhaustively; larger ones start from the padding-only order and improve it
+/// with a bounded local search.
+pub fn optimize_layout_for_cache_lines(
+    layout: &StructLayout,
+    max_align: u64,
+    cache_line_size: u32,
+    keep_together: &[Vec<String>],
+    heat: Option<&AccessHeat>,
+) -> OptimizedLayout {
+    let cache_line_size = cache_line_size.max(1);
+    let line = cache_line_size as u64;
+
+    let false_sharing = analyze_false_sharing(layout, cache_line_size);
+    let atomics: HashSet<&str> = if false_sharing.atomic_members.len() > 1 {
+        false_sharing.atomic_members.iter().map(|m| m.name.as_str()).collect()
+    } else {
+        HashSet::new()
+    };
+    let weights = heat.map(heat_weights).unwrap_or_default();
+
+    let mut plan = CacheLinePlan {
+        cache_line_size: line,
+        original_cache_lines: layout.size.div_ceil(line),
+        original_false_sharing_pairs: false_sharing.pair_count as usize,
+        ..CacheLinePlan::default()
+    };
+
+    let mut result = optimize_ordered(layout, max_align, |mut units, struct_alignment| {
+        sort_for_padding(&mut units);
+
+        let mut groups = keep_together.to_vec();
+        if heat.is_some() {
+            let (hot, _, _) = split_by_heat(units.clone(), &weights, line);
+            if !hot.is_empty() {
+                groups.push(
+                    hot.iter().flat_map(|u| &u.members).map(|m| m.name.to_string()).collect(),
+                );
+            }
+        }
+
+        let items = build_items(units, &groups, &atomics, line, &mut plan);
+        let (order, exhaustive) = best_order(&items, line, struct_alignment);
+        plan.exhaustive = exhaustive;
+
+        let (starts, _) = place(&items, &order, line);
+        let mut items: Vec<Option<Item>> = items.into_iter().map(Some).collect();
+        let mut placed = Vec::new();
+        for (&index, &start) in order.iter().zip(&starts) {
+            let Some(item) = items[index].take() else { continue };
+            let mut offset = start;
+            for unit in item.units {
+                offset = align_up(offset, unit.alignment);
+                let end = offset.saturating_add(unit.total_size);
+                placed.push((offset, unit));
+                offset = end;
+            }
+        }
+        placed
+    });
+
+    plan.isolated_atomics = false_sharing
+        .atomic_members
+        .iter()
+        .filter(|m| atomics.contains(m.name.as_str()))
+        .map(|m| m.name.clone())
+        .collect();
+    plan.optimized_cache_lines = result.optimized_size.div_ceil(line);
+    result.cache_lines = Some(plan);
+    result
+}
+
+/// Turns `units` (in padding order) into items: one per satisfiable group, in group
+/// order, then one per remaining unit.
+fn build_items(
+    units: Vec<SortableUnit>,
+    groups: &[Vec<String>],
+    atomics: &HashSet<&str>,
+    line: u64,
+    plan: &mut CacheLinePlan,
+) -> Vec<Item> {
+    let is_atomic =
+        |unit: &SortableUnit| unit.members.iter().any(|m| atomics.contains(m.name.as_str()));
+
+    // The group each unit joins. A group naming a unit that is already in another group
+    // absorbs that group.
+    let mut group_of: Vec<Option<usize>> = vec![None; units.len()];
+    for (id, names) in groups.iter().enumerate() {
+        let names: HashSet<&str> = names.iter().map(String::as_str).collect();
+        let matched: Vec<usize> = (0..units.len())
+            .filter(|&u| units[u].members.iter().any(|m| names.contains(m.name.as_str())))
+            .collect();
+        let absorbed: HashSet<usize> = matched.iter().filter_map(|&u| group_of[u]).collect();
+        for slot in group_of.iter_mut() {
+            if slot.is_some_and(|g| absorbed.contains(&g)) {
+                *slot = Some(id);
+            }
+        }
+        for u in matched {
+            group_of[u] = Some(id);
+        }
+    }
+
+    let mut by_group: HashMap<usize, Vec<usize>> = HashMap::new();
+    for (u, group) in group_of.iter().enumerate() {
+        if let Some(group) = group {
+            by_group.entry(*group).or_default().push(u);
+        }
+    }
+
+    let mut units: Vec<Option<SortableUnit>> = units.into_iter().map(Some).collect();
+    let mut items = Vec::new();
+    for id in 0..groups.len() {
+        let Some(indices) = by_group.get(&id) else { continue };
+        let group_units: Vec<&SortableUnit> =
+            indices.iter().filter_map(|&u| units[u].as_ref()).collect();
+        let names: Vec<String> =
+            group_units.iter().flat_map(|u| &u.members).map(|m| m.name.to_string()).collect();
+
+        let owned: Vec<SortableUnit> = group_units.iter().map(|&u| u.clone()).collect();
+        let size = packed_end(&owned);
+        let atomic_count = owned.iter().filter(|u| is_atomic(u)).count();
+        if size > line || atomic_count > 1 {
+            plan.unsatisfied_groups.push(names);
+            continue;
+        }
+
+        if crosses_line_originally(&owned, line) {
+            plan.original_split_groups += 1;
+        }
+        plan.kept_together.push(names);
+        for &u in indices {
+            units[u] = None;
+        }
+        items.push(Item {
+            alignment: owned.iter().map(|u| u.alignment).max().unwrap_or(1),
+            size,
+            keep_in_line: true,
+            atomic: atomic_count == 1,
+            units: owned,
+        });
+    }
+
+    for unit in units.into_iter().flatten() {
+        items.push(Item {
+            size: unit.total_size,
+            alignment: unit.alignment,
+            keep_in_line: false,
+            atomic: is_atomic(&unit),
+            units: vec![unit],
+        });
+    }
+    items
+}
+
+/// True if the members of `units`, at their original offsets, touch more than one line.
+fn crosses_line_originally(units: &[SortableUnit], line: u64) -> bool {
+    let members = || units.iter().flat_map(|u| &u.members);
+    let first = members().map(|m| m.offset / line).min();
+    let last = members().map(|m| m.offset.saturating_add(m.size).saturating_sub(1) / line).max();
+    first != last
+}
+
+fn crosses_line(start: u64, size: u64, line: u64) -> bool {
+    size > 0 && start / line != start.saturating_add(size - 1) / line
+}
+
+/// Start offset of each item in `order` and the end offset of the last one. Items are
+/// packed like `optimize_layout` places units, except that an atomic moves past the
+/// last line holding another atomic and a kept-together group that would cross a line
+/// boundary moves to the next line.
+fn place(items: &[Item], order: &[usize], line: u64) -> (Vec<u64>, u64) {
+    let mut starts = Vec::with_capacity(order.len());
+    let mut offset: u64 = 0;
+    let mut last_atomic_line: Option<u64> = None;
+
+    for &index in order {
+        let item = &items[index];
+        let mut start = align_up(offset, item.alignment);
+        if item.atomic {
+            if let Some(last) = last_atomic_line {
+                if start / line <= last {
+                    start = align_up(last.saturating_add(1).saturating_mul(line), item.alignment);
+                }
+            }
+        }
+        if item.keep_in_line && crosses_line(start, item.size, line) {
+            start = align_up((start / line).saturating_add(1).saturating_mul(line), item.alignment);
+        }
+
+        let end = start.saturating_add(item.size);
+        if item.atomic {
+            last_atomic_line = Some(end.saturating_sub(1) / line);
+        }
+        starts.push(start);
+        offset = end;
+    }
+
+    (starts, offset)
+}
+
+fn cost(items: &[Item], order: &[usize], line: u64, struct_alignment: u64) -> Cost {
+    let (starts, end) = place(items, order, line);
+    let size = align_up(end, struct_alignment);
+    let split_units = order
+        .iter()
+        .zip(&starts)
+        .filter(|&(&index, &start)| {
+            let item = &items[index];
+            !item.keep_in_line && item.size <= line && crosses_line(start, item.size, line)
+        })
+        .count();
+    Cost { cache_lines: size.div_ceil(line), size, split_units }
+}
+
+/// The cheapest order found, and whether every order was tried. Ties keep the earliest
+/// candidate, starting from the padding-only order.
+fn best_order(items: &[Item], line: u64, struct_alignment: u64) -> (Vec<usize>, bool) {
+    let mut order: Vec<usize> = (0..items.len()).collect();
+    order.sort_by(|&a, &b| {
+        items[b].alignment.cmp(&items[a].alignment).then_with(|| items[b].size.cmp(&items[a].size))
+    });
+    let mut best = order.clone();
+    let mut best_cost = cost(items, &order, line, struct_alignment);
+
+    if items.len() <= EXACT_SEARCH_MAX_ITEMS {
+        // Heap's algorithm: every permutation, each one swap away from the previous.
+        let mut counters = vec![0; order.len()];
+        let mut i = 1;
+        while i < order.len() {
+            if counters[i] < i {
+                let j = if i % 2 == 0 { 0 } else { counters[i] };
+                order.swap(j, i);
+                let candidate = cost(items, &order, line, struct_alignment);
+                if candidate < best_cost {
+                    best_cost = candidate;
+                    best.clone_from(&order);
+                }
+                counters[i] += 1;
+                i = 1;
+            } else {
+                counters[i] = 0;
+                i += 1;
+            }
+        }
+        return (best, true);
+    }
+
+    // Pairwise swaps, kept while they help, until a pass finds nothing or the budget ends.
+    let mut evaluations = 0;
+    let mut improved = true;
+    'search: while improved {
+        improved = false;
+        for i in 0..best.len() {
+            for j in (i + 1)..best.len() {
+                if evaluations == MAX_SEARCH_EVALUATIONS {
+                    break 'search;
+                }
+                evaluations += 1;
+                best.swap(i, j);
+                let candidate = cost(items, &best, line, struct_alignment);
+                if candidate < best_cost {
+                    best_cost = candidate;
+                    improved = true;
+                } else {
+                    best.swap(i, j);
+                }
+            }
+        }
+    }
+    (best, false)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::analysis::optimize_layout;
+    use crate::types::MemberLayout;
+
+    fn member(name: &str, type_name: &str, offset: u64, size: u64) -> MemberLayout {
+        MemberLayout::new(name.to_string(), type_name.to_string(), Some(offset), Some(size))
+    }
+
+    fn offset_of(result: &OptimizedLayout, name: &str) -> u64 {
+        result.optimized_members.iter().find(|m| m.name == name).unwrap().offset
+    }
+
+    #[test]
+    fn atomics_are_moved_to_separate_lines() {
+        let mut layout = StructLayout::new("Counters".to_string(), 24, Some(8));
+        layout.members = vec![
+            member("head", "std::atomic<long>", 0, 8),
+            member("tail", "std::atomic<long>", 8, 8),
+            member("id", "long", 16, 8),
+        ];
+
+        let result = optimize_layout_for_cache_lines(&layout, 8, 64, &[], None);
+
+        assert_ne!(offset_of(&result, "head") / 64, offset_of(&result, "tail") / 64);
+        assert_eq!(result.optimized_size, 72);
+        let plan = result.cache_lines.as_ref().unwrap();
+        assert_eq!(plan.isolated_atomics, ["head", "tail"]);
+        assert_eq!(plan.original_false_sharing_pairs, 1);
+        assert_eq!((plan.original_cache_lines, plan.optimized_cache_lines), (1, 2));
+        assert!(plan.exhaustive);
+        assert!(result.is_improvement());
+    }
+
+    #[test]
+    fn marked_group_stays_in_one_line() {
+        // Padding order puts `big` first, which splits `lo`/`hi` across lines 0 and 1.
+        let mut layout = StructLayout::new("Pair".to_string(), 72, Some(8));
+        layout.members = vec![
+            member("big", "char[56]", 0, 56),
+            member("lo", "long", 56, 8),
+            member("hi", "long", 64, 8),
+        ];
+        let padding = optimize_layout(&layout, 8);
+        assert_ne!(offset_of(&padding, "lo") / 64, offset_of(&padding, "hi") / 64);
+
+        let groups = [vec!["lo".to_string(), "hi".to_string()]];
+        let result = optimize_layout_for_cache_lines(&layout, 8, 64, &groups, None);
+
+        assert_eq!(offset_of(&result, "lo") / 64, offset_of(&result, "hi") / 64);
+        assert_eq!(result.optimized_size, 72);
+        let plan = result.cache_lines.unwrap();
+        assert_eq!(plan.kept_together, [["lo", "hi"]]);
+        assert_eq!(plan.original_split_groups, 1);
+    }
+
+    #[test]
+    fn impossible_groups_are_reported() {
+        let mut layout = StructLayout::new("Big".to_string(), 136, Some(8));
+        layout.members = vec![
+            member("a", "char[64]", 0, 64),
+            member("b", "char[64]", 64, 64),
+            member("c", "long", 128, 8),
+        ];
+        let groups = [vec!["a".to_string(), "b".to_string()]];
+
+        let result = optimize_layout_for_cache_lines(&layout, 8, 64, &groups, None);
+
+        let plan = result.cache_lines.unwrap();
+        assert!(plan.kept_together.is_empty());
+        assert_eq!(plan.unsatisfied_groups, [["a", "b"]]);
+        assert_eq!(result.optimized_size, 136);
+    }
+
+    #[test]
+    fn hot_fields_from_profile_form_a_group() {
+        let mut layout = StructLayout::new("Hot".to_string(), 72, Some(8));
+        layout.members = vec![
+            member("big", "char[56]", 0, 56),
+            member("lo", "long", 56, 8),
+            member("hi", "long", 64, 8),
+        ];
+        let samples = [
+            crate::profile::AccessSample { offset: 56, weight: 5.0 },
+            crate::profile::AccessSample { offset: 64, weight: 5.0 },
+        ];
+        let heat = crate::analysis::analyze_access_heat(&layout, &samples, 64);
+
+        let result = optimize_layout_for_cache_lines(&layout, 8, 64, &[], Some(&heat));
+
+        assert_eq!(offset_of(&result, "lo") / 64, offset_of(&result, "hi") / 64);
+        assert_eq!(result.cache_lines.unwrap().kept_together.len(), 1);
+    }
+
+    #[test]
+    fn large_structs_never_do_worse_than_padding_order() {
+        let mut layout = StructLayout::new("Wide".to_string(), 0, Some(8));
+        let sizes = [1, 8, 2, 4, 1, 8, 2, 1, 4, 8, 1, 2, 8, 4, 1, 1];
+        let mut offset = 0;
+        for (i, &size) in sizes.iter().enumerate() {
+            offset = align_up(offset, size);
+            layout.members.push(member(&format!("f{i}"), "int", offset, size));
+            offset += size;
+        }
+        layout.size = align_up(offset, 8);
+
+        let result = optimize_layout_for_cache_lines(&layout, 8, 64, &[], None);
+        let padding = optimize_layout(&layout, 8);
+
+        assert!(!result.cache_lines.as_ref().unwrap().exhaustive);
+        assert_eq!(result.optimized_size, padding.optimized_size);
+        assert_eq!(result.optimized_members.len(), sizes.len());
+    }
+}
@@ -1,7 +1,7 @@
 use crate::types::{
-    AtomicMember, CacheLineSpanningWarning, FalseSharingAnalysis, FalseSharingWarning, StructLayout,
+    AtomicMember, CacheLineSpanningWarning, ContendedCacheLine, FalseSharingAnalysis,
+    FalseSharingWarning, MemberLayout, RoleMember, StructLayout, WriterConflict,
 };
-use std::collections::BTreeMap;
 
 const ATOMIC_PATTERNS: &[&str] = &[
     // Rust std atomics (full paths)
@@ -53,11 +53,29 @@ fn is_atomic_type_by_name(type_name: &str) -> bool {
     ATOMIC_PATTERNS.iter().any(|pattern| type_name.contains(pattern))
 }
 
-/// Analyzes a struct layout for potential false sharing issues.
+/// Analyzes a struct layout for potential false sharing issues, reporting each cache line
+/// shared by two or more atomics once (`contended_lines`) and leaving `warnings` empty.
 ///
 /// # Panics
 /// Panics if `cache_line_size` is 0.
 pub fn analyze_false_sharing(layout: &StructLayout, cache_line_size: u32) -> FalseSharingAnalysis {
+    analyze(layout, cache_line_size, false)
+}
+
+/// Like `analyze_false_sharing`, additionally listing every pair of atomics sharing a
+/// cache line in `warnings`. The number of pairs grows quadratically with the number of
+/// atomics per line.
+///
+/// # Panics
+/// Panics if `cache_line_size` is 0.
+pub fn analyze_false_sharing_pairs(
+    layout: &StructLayout,
+    cache_line_size: u32,
+) -> FalseSharingAnalysis {
+    analyze(layout, cache_line_size, true)
+}
+
+fn analyze(layout: &StructLayout, cache_line_size: u32, pairs: bool) -> FalseSharingAnalysis {
     assert!(cache_line_size > 0, "cache_line_size must be > 0");
     let cache_line_size_u64 = cache_line_size as u64;
 
@@ -81,8 +99,8 @@ pub fn analyze_false_sharing(layout: &StructLayout, cache_line_size: u32) -> Fal
             let spans_cache_lines = end_cache_line > cache_line;
 
             Some(AtomicMember {
-                name: m.name.clone(),
-                type_name: m.type_name.clone(),
+                name: m.name.to_string(),
+                type_name: m.type_name.to_string(),
                 offset,
                 size,
                 cache_line,
@@ -112,57 +130,47 @@ pub fn analyze_false_sharing(layout: &StructLayout, cache_line_size: u32) -> Fal
         .collect();
 
     if atomic_members.len() < 2 {
-        return FalseSharingAnalysis { atomic_members, warnings: Vec::new(), spanning_warnings };
+        return FalseSharingAnalysis {
+            atomic_members,
+            spanning_warnings,
+            ..FalseSharingAnalysis::default()
+        };
     }
 
-    // Group atomics by all cache lines they touch (not just start)
-    // Use BTreeMap for deterministic iteration order (ascending by cache_line)
-    let mut by_cache_line: BTreeMap<u64, Vec<&AtomicMember>> = BTreeMap::new();
-    for member in &atomic_members {
-        for cache_line in member.cache_line..=member.end_cache_line {
-            by_cache_line.entry(cache_line).or_default().push(member);
-        }
-    }
+    // Members are usually declared in offset order, making the stable sort linear.
+    let mut by_offset: Vec<&AtomicMember> = atomic_members.iter().collect();
+    by_offset.sort_by_key(|m| m.offset);
 
+    let mut contended_lines = Vec::new();
     let mut warnings = Vec::new();
-    let mut seen_pairs: std::collections::HashSet<(&str, &str)> = std::collections::HashSet::new();
-
-    for (cache_line, members) in &by_cache_line {
-        if members.len() < 2 {
-            continue;
-        }
-
-        for i in 0..members.len() {
-            for j in (i + 1)..members.len() {
-                let a = members[i];
-                let b = members[j];
-
-                // Ensure consistent ordering and deduplicate
-                let (first, second) = if a.offset <= b.offset { (a, b) } else { (b, a) };
-
-                let pair_key = (first.name.as_str(), second.name.as_str());
-                if seen_pairs.contains(&pair_key) {
-                    continue;
+    let mut pair_count = 0u64;
+    for_each_shared_line(
+        &by_offset,
+        |m| (m.cache_line, m.end_cache_line),
+        |cache_line, active, carried| {
+            let total = active.len() as u64;
+            let carried = carried as u64;
+            let new_pairs = total * (total - 1) / 2 - carried * carried.saturating_sub(1) / 2;
+            pair_count = pair_count.saturating_add(new_pairs);
+            contended_lines.push(ContendedCacheLine {
+                cache_line,
+                members: active.iter().map(|m| m.name.clone()).collect(),
+                new_pairs,
+            });
+
+            if pairs {
+                for (i, &&first) in active.iter().enumerate() {
+                    for &&second in &active[i + 1..] {
+                        // Report each pair on the first line both touch.
+                        if first.cache_line != cache_line && second.cache_line != cache_line {
+                            continue;
+                        }
+                        warnings.push(pair_warning(first, second, cache_line));
+                    }
                 }
-                seen_pairs.insert(pair_key);
-
-                // gap_bytes = second.offset - (first.offset + first.size)
-                // Negative = overlap, Zero = adjacent, Positive = gap
-                let first_end = first.offset.saturating_add(first.size);
-                // Safe conversion: cap values at i64::MAX before cast to avoid sign bit issues
-                let second_offset_i64 = second.offset.min(i64::MAX as u64) as i64;
-                let first_end_i64 = first_end.min(i64::MAX as u64) as i64;
-                let gap_bytes = second_offset_i64.saturating_sub(first_end_i64);
-
-                warnings.push(FalseSharingWarning {
-                    member_a: first.name.clone(),
-                    member_b: second.name.clone(),
-                    cache_line: *cache_line,
-                    gap_bytes,
-                });
             }
-        }
-    }
+        },
+    );
 
     // Sort by (cache_line, member_a, member_b) without cloning strings
     warnings.sort_by(|a, b| {
@@ -172,7 +180,116 @@ pub fn analyze_false_sharing(layout: &StructLayout, cache_line_size: u32) -> Fal
             .then_with(|| a.member_b.cmp(&b.member_b))
     });
 
-    FalseSharingAnalysis { atomic_members, warnings, spanning_warnings }
+    FalseSharingAnalysis {
+        atomic_members,
+        contended_lines,
+        pair_count,
+        warnings,
+        spanning_warnings,
+    }
+}
+
+/// Flags each cache line holding members of more than one writer role, atomic or not.
+/// `role_of` returns the role writing a member (for example `producer`, `consumer` or
+/// `thread-local`); members without one are ignored. Roles are compared by name only.
+///
+/// # Panics
+/// Panics if `cache_line_size` is 0.
+pub fn analyze_writer_roles<'r>(
+    layout: &StructLayout,
+    cache_line_size: u32,
+    mut role_of: impl FnMut(&MemberLayout) -> Option<&'r str>,
+) -> Vec<WriterConflict> {
+    assert!(cache_line_size > 0, "cache_line_size must be > 0");
+    let line = cache_line_size as u64;
+
+    // (first line, last line, member, role)
+    let mut tagged: Vec<(u64, u64, &MemberLayout, &str)> = layout
+        .members
+        .iter()
+        .filter_map(|m| {
+            let role = role_of(m)?;
+            let offset = m.offset?;
+            let last = m.end_offset()?.checked_sub(1).filter(|&last| last >= offset)?;
+            Some((offset / line, last / line, m, role))
+        })
+        .collect();
+    tagged.sort_by_key(|&(_, _, m, _)| m.offset);
+
+    let mut conflicts = Vec::new();
+    for_each_shared_line(
+        &tagged,
+        |&(first, last, _, _)| (first, last),
+        |cache_line, active, _| {
+            let mut roles: Vec<String> = Vec::new();
+            for &&(_, _, _, role) in active {
+                if !roles.iter().any(|r| r == role) {
+                    roles.push(role.to_string());
+                }
+            }
+            if roles.len() < 2 {
+                return;
+            }
+            let members = active
+                .iter()
+                .map(|&&(_, _, m, role)| RoleMember {
+                    name: m.name.to_string(),
+                    role: role.to_string(),
+                })
+                .collect();
+            conflicts.push(WriterConflict { cache_line, roles, members });
+        },
+    );
+    conflicts
+}
+
+/// Sweeps the cache lines in ascending order, calling `on_line(line, active, carried)` for
+/// each line touched by two or more `items`. `lines` gives an item's first and last cache
+/// line, and `items` must be sorted by first line. `active` lists the items touching the
+/// line in input order; its first `carried` also touched the previous line.
+fn for_each_shared_line<T>(
+    items: &[T],
+    lines: impl Fn(&T) -> (u64, u64),
+    mut on_line: impl FnMut(u64, &[&T], usize),
+) {
+    let mut active: Vec<&T> = Vec::new();
+    let mut next = 0;
+    let mut cache_line = 0u64;
+    while next < items.len() || active.len() >= 2 {
+        // A lone item shares no line until the next one starts, however many it spans.
+        cache_line = if active.len() >= 2 { cache_line + 1 } else { lines(&items[next]).0 };
+        active.retain(|item| lines(item).1 >= cache_line);
+        let carried = active.len();
+        while next < items.len() && lines(&items[next]).0 == cache_line {
+            active.push(&items[next]);
+            next += 1;
+        }
+        if active.len() >= 2 {
+            on_line(cache_line, &active, carried);
+        }
+    }
+}
+
+/// `first` must not start after `second`.
+fn pair_warning(
+    first: &AtomicMember,
+    second: &AtomicMember,
+    cache_line: u64,
+) -> FalseSharingWarning {
+    // gap_bytes = second.offset - (first.offset + first.size)
+    // Negative = overlap, Zero = adjacent, Positive = gap
+    let first_end = first.offset.saturating_add(first.size);
+    // Safe conversion: cap values at i64::MAX before cast to avoid sign bit issues
+    let second_offset_i64 = second.offset.min(i64::MAX as u64) as i64;
+    let first_end_i64 = first_end.min(i64::MAX as u64) as i64;
+    let gap_bytes = second_offset_i64.saturating_sub(first_end_i64);
+
+    FalseSharingWarning {
+        member_a: first.name.clone(),
+        member_b: second.name.clone(),
+        cache_line,
+        gap_bytes,
+    }
 }
 
 #[cfg(test)]
@@ -203,7 +320,7 @@ mod tests {
             ),
         ]);
 
-        let analysis = analyze_false_sharing(&layout, 64);
+        let analysis = analyze_false_sharing_pairs(&layout, 64);
 
         assert_eq!(analysis.atomic_members.len(), 2);
         assert_eq!(analysis.warnings.len(), 1);
@@ -230,7 +347,7 @@ mod tests {
             ),
         ]);
 
-        let analysis = analyze_false_sharing(&layout, 64);
+        let analysis = analyze_false_sharing_pairs(&layout, 64);
 
         assert_eq!(analysis.atomic_members.len(), 2);
         assert!(analysis.warnings.is_empty());
@@ -259,7 +376,7 @@ mod tests {
             ),
         ]);
 
-        let analysis = analyze_false_sharing(&layout, 64);
+        let analysis = analyze_false_sharing_pairs(&layout, 64);
 
         assert_eq!(analysis.atomic_members.len(), 3);
         assert_eq!(analysis.warnings.len(), 3); // (a,b), (a,c), (b,c)
@@ -277,7 +394,7 @@ mod tests {
             MemberLayout::new("data".to_string(), "u64".to_string(), Some(8), Some(8)),
         ]);
 
-        let analysis = analyze_false_sharing(&layout, 64);
+        let analysis = analyze_false_sharing_pairs(&layout, 64);
 
         assert_eq!(analysis.atomic_members.len(), 1);
         assert!(analysis.warnings.is_empty());
@@ -290,7 +407,7 @@ mod tests {
             MemberLayout::new("b".to_string(), "std::atomic<int>".to_string(), Some(4), Some(4)),
         ]);
 
-        let analysis = analyze_false_sharing(&layout, 64);
+        let analysis = analyze_false_sharing_pairs(&layout, 64);
 
         assert_eq!(analysis.atomic_members.len(), 2);
         assert_eq!(analysis.warnings.len(), 1);
@@ -303,7 +420,7 @@ mod tests {
             MemberLayout::new("b".to_string(), "_Atomic int".to_string(), Some(4), Some(4)),
         ]);
 
-        let analysis = analyze_false_sharing(&layout, 64);
+        let analysis = analyze_false_sharing_pairs(&layout, 64);
 
         assert_eq!(analysis.atomic_members.len(), 2);
         assert_eq!(analysis.warnings.len(), 1);
@@ -326,7 +443,7 @@ mod tests {
             ),
         ]);
 
-        let analysis = analyze_false_sharing(&layout, 64);
+        let analysis = analyze_false_sharing_pairs(&layout, 64);
 
         assert_eq!(analysis.atomic_members.len(), 2);
         assert_eq!(analysis.warnings.len(), 1);
@@ -351,7 +468,7 @@ mod tests {
             ),
         ]);
 
-        let analysis = analyze_false_sharing(&layout, 64);
+        let analysis = analyze_false_sharing_pairs(&layout, 64);
 
         assert_eq!(analysis.atomic_members.len(), 2);
         assert_eq!(analysis.warnings.len(), 1);
@@ -366,7 +483,7 @@ mod tests {
             Some(8),
         )]);
 
-        let analysis = analyze_false_sharing(&layout, 64);
+        let analysis = analyze_false_sharing_pairs(&layout, 64);
 
         assert_eq!(analysis.atomic_members.len(), 1);
         assert!(analysis.warnings.is_empty());
@@ -390,7 +507,7 @@ mod tests {
             ),
         ]);
 
-        let analysis = analyze_false_sharing(&layout, 64);
+        let analysis = analyze_false_sharing_pairs(&layout, 64);
 
         assert_eq!(analysis.atomic_members.len(), 1);
         assert!(analysis.warnings.is_empty());
@@ -403,7 +520,7 @@ mod tests {
             MemberLayout::new("b".to_string(), "_Atomic(int)".to_string(), Some(4), Some(4)),
         ]);
 
-        let analysis = analyze_false_sharing(&layout, 64);
+        let analysis = analyze_false_sharing_pairs(&layout, 64);
 
         assert_eq!(analysis.atomic_members.len(), 2);
         assert_eq!(analysis.warnings.len(), 1);
@@ -426,7 +543,7 @@ mod tests {
             ),
         ]);
 
-        let analysis = analyze_false_sharing(&layout, 64);
+        let analysis = analyze_false_sharing_pairs(&layout, 64);
 
         assert_eq!(analysis.atomic_members.len(), 2);
         assert_eq!(analysis.warnings.len(), 1);
@@ -444,7 +561,7 @@ mod tests {
             Some(8),
         )]);
 
-        let analysis = analyze_false_sharing(&layout, 64);
+        let analysis = analyze_false_sharing_pairs(&layout, 64);
 
         assert_eq!(analysis.atomic_members.len(), 1);
         assert!(analysis.atomic_members[0].spans_cache_lines);
@@ -466,7 +583,7 @@ mod tests {
             Some(8),
         )]);
 
-        let analysis = analyze_false_sharing(&layout, 64);
+        let analysis = analyze_false_sharing_pairs(&layout, 64);
 
         assert_eq!(analysis.atomic_members.len(), 1);
         assert!(!analysis.atomic_members[0].spans_cache_lines);
@@ -490,7 +607,7 @@ mod tests {
             ),
         ]);
 
-        let analysis = analyze_false_sharing(&layout, 64);
+        let analysis = analyze_false_sharing_pairs(&layout, 64);
 
         assert_eq!(analysis.warnings.len(), 1);
         assert_eq!(analysis.warnings[0].gap_bytes, 8); // Positive gap
@@ -513,7 +630,7 @@ mod tests {
             ),
         ]);
 
-        let analysis = analyze_false_sharing(&layout, 64);
+        let analysis = analyze_false_sharing_pairs(&layout, 64);
 
         assert_eq!(analysis.warnings.len(), 1);
         assert_eq!(analysis.warnings[0].gap_bytes, 0); // Zero = adjacent
@@ -539,7 +656,7 @@ mod tests {
             ),
         ]);
 
-        let analysis = analyze_false_sharing(&layout, 64);
+        let analysis = analyze_false_sharing_pairs(&layout, 64);
 
         assert_eq!(analysis.atomic_members.len(), 2);
         // One warning for the pair on cache line 1
@@ -547,6 +664,34 @@ mod tests {
         assert_eq!(analysis.warnings[0].cache_line, 1);
     }
 
+    #[test]
+    fn test_member_spanning_many_lines_is_not_swept_line_by_line() {
+        // 2^34 cache lines: walking them one at a time would not finish.
+        let huge = 1u64 << 40;
+        let atomic = |name: &str, offset, size| {
+            MemberLayout::new(
+                name.to_string(),
+                "std::sync::atomic::AtomicU64".to_string(),
+                Some(offset),
+                Some(size),
+            )
+        };
+        let layout = make_layout_with_members(vec![
+            atomic("ring", 0, huge),
+            atomic("tail", huge - 8, 8),
+            atomic("after", huge * 2, 8),
+        ]);
+
+        let analysis = analyze_false_sharing_pairs(&layout, 64);
+
+        assert_eq!(analysis.pair_count, 1);
+        assert_eq!(analysis.warnings.len(), 1);
+        assert_eq!(analysis.warnings[0].member_a, "ring");
+        assert_eq!(analysis.warnings[0].member_b, "tail");
+        assert_eq!(analysis.warnings[0].cache_line, (huge - 8) / 64);
+        assert_eq!(analysis.contended_lines.len(), 1);
+    }
+
     // Coverage tests for edge cases and newly fixed paths
 
     #[test]
@@ -557,7 +702,7 @@ mod tests {
             MemberLayout::new("y".to_string(), "u64".to_string(), Some(8), Some(8)),
         ]);
 
-        let analysis = analyze_false_sharing(&layout, 64);
+        let analysis = analyze_false_sharing_pairs(&layout, 64);
 
         assert!(analysis.atomic_members.is_empty());
         assert!(analysis.warnings.is_empty());
@@ -583,7 +728,7 @@ mod tests {
             ),
         ]);
 
-        let analysis = analyze_false_sharing(&layout, 64);
+        let analysis = analyze_false_sharing_pairs(&layout, 64);
 
         // Only the normal atomic should be included; overflow one is skipped
         assert_eq!(analysis.atomic_members.len(), 1);
@@ -595,7 +740,7 @@ mod tests {
     fn test_duplicate_pair_dedupe_deterministic() {
         // Two atomics that both span cache lines 0 and 1
         // The pair should appear only ONCE, and always with the lowest cache_line (0)
-        // This tests both the dedupe logic AND the BTreeMap determinism fix
+        // This tests both the dedupe logic AND the ascending line order of the sweep
         let layout = make_layout_with_members(vec![
             MemberLayout::new(
                 "spanning_a".to_string(),
@@ -611,12 +756,12 @@ mod tests {
             ),
         ]);
 
-        let analysis = analyze_false_sharing(&layout, 64);
+        let analysis = analyze_false_sharing_pairs(&layout, 64);
 
         assert_eq!(analysis.atomic_members.len(), 2);
         // Only ONE warning for this pair (dedupe worked)
         assert_eq!(analysis.warnings.len(), 1);
-        // Should always be cache_line 0 (BTreeMap iteration is deterministic, ascending)
+        // Should always be cache_line 0 (lines are swept in ascending order)
         assert_eq!(analysis.warnings[0].cache_line, 0);
         assert_eq!(analysis.warnings[0].member_a, "spanning_a");
         assert_eq!(analysis.warnings[0].member_b, "spanning_b");
@@ -627,10 +772,120 @@ mod tests {
         // Layout with no members at all
         let layout = make_layout_with_members(vec![]);
 
-        let analysis = analyze_false_sharing(&layout, 64);
+        let analysis = analyze_false_sharing_pairs(&layout, 64);
 
         assert!(analysis.atomic_members.is_empty());
         assert!(analysis.warnings.is_empty());
         assert!(analysis.spanning_warnings.is_empty());
     }
+
+    fn atomic_u64s(count: u64) -> Vec<MemberLayout> {
+        (0..count)
+            .map(|i| {
+                MemberLayout::new(
+                    format!("c{}", i),
+                    "std::atomic<uint64_t>".to_string(),
+                    Some(i * 8),
+                    Some(8),
+                )
+            })
+            .collect()
+    }
+
+    #[test]
+    fn test_contended_line_aggregates_members() {
+        let layout = make_layout_with_members(atomic_u64s(3));
+
+        let analysis = analyze_false_sharing(&layout, 64);
+
+        assert!(analysis.warnings.is_empty());
+        assert_eq!(analysis.pair_count, 3);
+        assert_eq!(
+            analysis.contended_lines,
+            [ContendedCacheLine {
+                cache_line: 0,
+                members: vec!["c0".to_string(), "c1".to_string(), "c2".to_string()],
+                new_pairs: 3,
+            }]
+        );
+    }
+
+    #[test]
+    fn test_many_atomics_one_warning_per_line() {
+        let mut layout = StructLayout::new("Registry".to_string(), 4096, Some(8));
+        layout.members = atomic_u64s(512);
+
+        let analysis = analyze_false_sharing(&layout, 64);
+
+        assert_eq!(analysis.contended_lines.len(), 64);
+        assert!(analysis.contended_lines.iter().all(|l| l.members.len() == 8));
+        assert_eq!(analysis.pair_count, 64 * 28);
+        assert!(analysis.warnings.is_empty());
+        assert_eq!(analyze_false_sharing_pairs(&layout, 64).warnings.len(), 64 * 28);
+    }
+
+    #[test]
+    fn test_spanning_atomic_pairs_counted_once() {
+        // `wide` covers lines 0-2; `a` is on line 0, `b` on line 2, `c` on line 3.
+        let layout = make_layout_with_members(vec![
+            MemberLayout::new("a".to_string(), "_Atomic int".to_string(), Some(0), Some(4)),
+            MemberLayout::new("wide".to_string(), "_Atomic(big)".to_string(), Some(8), Some(128)),
+            MemberLayout::new("b".to_string(), "_Atomic int".to_string(), Some(136), Some(4)),
+            MemberLayout::new("c".to_string(), "_Atomic int".to_string(), Some(192), Some(4)),
+        ]);
+
+        let analysis = analyze_false_sharing(&layout, 64);
+
+        let lines: Vec<(u64, usize, u64)> = analysis
+            .contended_lines
+            .iter()
+            .map(|l| (l.cache_line, l.members.len(), l.new_pairs))
+            .collect();
+        assert_eq!(lines, [(0, 2, 1), (2, 2, 1)]);
+        assert_eq!(analysis.pair_count, 2);
+        assert_eq!(analyze_false_sharing_pairs(&layout, 64).warnings.len(), 2);
+    }
+
+    #[test]
+    fn test_writer_roles_flag_plain_fields() {
+        // Plain (non-atomic) fields: head and tail share line 0, stats sits alone on line 1.
+        let layout = make_layout_with_members(vec![
+            MemberLayout::new("head".to_string(), "u64".to_string(), Some(0), Some(8)),
+            MemberLayout::new("tail".to_string(), "u64".to_string(), Some(8), Some(8)),
+            MemberLayout::new("cap".to_string(), "u64".to_string(), Some(16), Some(8)),
+            MemberLayout::new("stats".to_string(), "u64".to_string(), Some(64), Some(8)),
+        ]);
+        let role_of = |m: &MemberLayout| match m.name.as_str() {
+            "head" => Some("producer"),
+            "tail" => Some("consumer"),
+            "stats" => Some("thread-local"),
+            _ => None,
+        };
+
+        let conflicts = analyze_writer_roles(&layout, 64, role_of);
+
+        assert_eq!(conflicts.len(), 1);
+        assert_eq!(conflicts[0].cache_line, 0);
+        assert_eq!(conflicts[0].roles, ["producer", "consumer"]);
+        let names: Vec<&str> = conflicts[0].members.iter().map(|m| m.name.as_str()).collect();
+        assert_eq!(names, ["head", "tail"]);
+    }
+
+    #[test]
+    fn test_writer_roles_same_role_is_fine() {
+        let layout = make_layout_with_members(vec![
+            MemberLayout::new("a".to_string(), "u64".to_string(), Some(0), Some(8)),
+            MemberLayout::new("b".to_string(), "u64".to_string(), Some(8), Some(8)),
+            // Spans lines 0 and 1; only the second line also holds a consumer field.
+            MemberLayout::new("big".to_string(), "[u8; 64]".to_string(), Some(32), Some(64)),
+            MemberLayout::new("c".to_string(), "u64".to_string(), Some(100), Some(8)),
+        ]);
+        let role_of = |m: &MemberLayout| Some(if m.name == "c" { "consumer" } else { "producer" });
+
+        let conflicts = analyze_writer_roles(&layout, 64, role_of);
+
+        assert_eq!(conflicts.len(), 1);
+        assert_eq!(conflicts[0].cache_line, 1);
+        assert_eq!(conflicts[0].roles, ["producer", "consumer"]);
+    }
 }
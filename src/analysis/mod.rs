@@ -1,7 +1,26 @@
+mod access_heat;
+mod cache_line;
 mod false_sharing;
+mod nested;
 mod optimize;
 mod padding;
+mod split;
+mod target;
 
-pub use false_sharing::analyze_false_sharing;
-pub use optimize::{OptimizedLayout, OptimizedMember, optimize_layout};
-pub use padding::analyze_layout;
+pub use access_heat::analyze_access_heat;
+pub use cache_line::{CacheLinePlan, optimize_layout_for_cache_lines};
+pub use false_sharing::{analyze_false_sharing, analyze_false_sharing_pairs, analyze_writer_roles};
+pub use nested::analyze_nested_padding;
+pub use optimize::{
+    HotFieldPlacement, OptimizedLayout, OptimizedMember, infer_alignment, optimize_layout,
+    optimize_layout_for_access,
+};
+pub use padding::{analyze_layout, cache_lines_touched};
+pub(crate) use split::gcd;
+pub use split::{
+    LoopFootprint, PROFILE_HOT_SHARE, SplitKind, SplitPlan, hot_fields_from_heat,
+    optimize_layout_for_split,
+};
+pub use target::{
+    TargetSuggestion, analyze_layout_for_targets, optimize_for_targets, optimize_layout_for_targets,
+};
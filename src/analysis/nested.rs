@@ -0,0 +1,326 @@
+use crate::types::{NestedPadding, PaddingContributor, StructLayout};
+use std::collections::{BTreeMap, HashMap, HashSet};
+use std::rc::Rc;
+
+/// Flatten embedded structs and arrays of structs into each layout's padding, recording
+/// the result in `metrics.nested`. Layouts must already be analyzed (`analyze_layout`).
+///
+/// A member is followed when its type names another layout in `layouts` whose size matches
+/// (times the element count for arrays); members that overlap others (unions) and bitfields
+/// are kept opaque. Layouts that embed no other layout get no `nested` entry.
+///
+/// # Panics
+/// Panics if `cache_line_size` is 0.
+pub fn analyze_nested_padding(layouts: &mut [StructLayout], cache_line_size: u32) {
+    assert!(cache_line_size > 0, "cache_line_size must be > 0");
+
+    let results: Vec<Option<NestedPadding>> = {
+        let mut flattener = Flattener::new(layouts);
+        (0..layouts.len())
+            .map(|idx| {
+                let flat = flattener.flatten(idx);
+                flat.embeds.then(|| summarize(layouts, idx, &flat, cache_line_size))
+            })
+            .collect()
+    };
+
+    for (layout, nested) in layouts.iter_mut().zip(results) {
+        layout.metrics.nested = nested;
+    }
+}
+
+/// Padding per contributing layout for one instance of a layout.
+#[derive(Default)]
+struct Flat {
+    shares: BTreeMap<usize, Share>,
+    /// At least one member was followed into another layout.
+    embeds: bool,
+    partial: bool,
+}
+
+#[derive(Clone, Default)]
+struct Share {
+    instances: u64,
+    padding_bytes: u64,
+    paths: Vec<String>,
+}
+
+struct Flattener<'a> {
+    layouts: &'a [StructLayout],
+    by_name: HashMap<&'a str, Vec<usize>>,
+    memo: HashMap<usize, Rc<Flat>>,
+    in_progress: HashSet<usize>,
+}
+
+impl<'a> Flattener<'a> {
+    fn new(layouts: &'a [StructLayout]) -> Self {
+        let mut by_name: HashMap<&str, Vec<usize>> = HashMap::new();
+        for (idx, layout) in layouts.iter().enumerate() {
+            by_name.entry(layout.name.as_str()).or_default().push(idx);
+        }
+        Self { layouts, by_name, memo: HashMap::new(), in_progress: HashSet::new() }
+    }
+
+    fn flatten(&mut self, idx: usize) -> Rc<Flat> {
+        if let Some(flat) = self.memo.get(&idx) {
+            return Rc::clone(flat);
+        }
+        // Same-named layouts can make a type appear to contain itself; stop there.
+        if !self.in_progress.insert(idx) {
+            return Rc::new(Flat { partial: true, ..Flat::default() });
+        }
+
+        let layouts = self.layouts;
+        let layout = &layouts[idx];
+        let mut flat = Flat { partial: layout.metrics.partial, ..Flat::default() };
+        flat.shares.insert(
+            idx,
+            Share { instances: 1, padding_bytes: layout.metrics.padding_bytes, paths: Vec::new() },
+        );
+
+        let overlapping = overlapping_members(layout);
+        for (member_idx, member) in layout.members.iter().enumerate() {
+            if member.bit_size.is_some() || overlapping.contains(&member_idx) {
+                continue;
+            }
+            let (Some(size), Some((element, count, is_array))) =
+                (member.size, element_type(&member.type_name))
+            else {
+                continue;
+            };
+            let Some(inner) = self.find_layout(element, size, count) else {
+                continue;
+            };
+
+            let inner_flat = self.flatten(inner);
+            flat.embeds = true;
+            flat.partial |= inner_flat.partial;
+
+            let path =
+                if is_array { format!("{}[]", member.name) } else { member.name.to_string() };
+            for (&contributor, share) in &inner_flat.shares {
+                let entry = flat.shares.entry(contributor).or_default();
+                entry.instances =
+                    entry.instances.saturating_add(share.instances.saturating_mul(count));
+                entry.padding_bytes =
+                    entry.padding_bytes.saturating_add(share.padding_bytes.saturating_mul(count));
+                if share.paths.is_empty() {
+                    entry.paths.push(path.clone());
+                } else {
+                    entry.paths.extend(share.paths.iter().map(|p| format!("{}.{}", path, p)));
+                }
+            }
+        }
+
+        self.in_progress.remove(&idx);
+        let flat = Rc::new(flat);
+        self.memo.insert(idx, Rc::clone(&flat));
+        flat
+    }
+
+    /// The layout named `name` whose size, times `count`, fills a member of `member_size`.
+    fn find_layout(&self, name: &str, member_size: u64, count: u64) -> Option<usize> {
+        self.by_name.get(name)?.iter().copied().find(|&idx| {
+            let size = self.layouts[idx].size;
+            size > 0 && size.checked_mul(count) == Some(member_size)
+        })
+    }
+}
+
+/// Indices of members whose bytes overlap another member's (union members, or layouts
+/// with overlapping members). Padding inside those cannot be attributed to one member.
+fn overlapping_members(layout: &StructLayout) -> HashSet<usize> {
+    let mut spans: Vec<(u64, u64, usize)> = layout
+        .members
+        .iter()
+        .enumerate()
+        .filter_map(|(idx, m)| {
+            let start = m.offset?;
+            let end = m.end_offset()?;
+            (end > start).then_some((start, end, idx))
+        })
+        .collect();
+    spans.sort_unstable();
+
+    let mut overlapping = HashSet::new();
+    let mut reach: Option<(u64, usize)> = None;
+    for &(start, end, idx) in &spans {
+        if let Some((reach_end, reach_idx)) = reach {
+            if start < reach_end {
+                overlapping.insert(idx);
+                overlapping.insert(reach_idx);
+            }
+            if end > reach_end {
+                reach = Some((end, idx));
+            }
+        } else {
+            reach = Some((end, idx));
+        }
+    }
+    overlapping
+}
+
+/// Split a member type name into (element type, element count, is array), looking through
+/// qualifiers and `[T; N]` arrays, nested or not. `None` for arrays of unknown length.
+fn element_type(type_name: &str) -> Option<(&str, u64, bool)> {
+    const QUALIFIERS: [&str; 4] = ["const ", "volatile ", "restrict ", "_Atomic "];
+
+    let mut name = type_name;
+    let mut count: u64 = 1;
+    let mut is_array = false;
+    loop {
+        while let Some(rest) = QUALIFIERS.iter().find_map(|q| name.strip_prefix(q)) {
+            name = rest;
+        }
+        let Some(inner) = name.strip_prefix('[').and_then(|n| n.strip_suffix(']')) else {
+            return Some((name, count, is_array));
+        };
+        let (element, n) = inner.rsplit_once("; ")?;
+        count = count.checked_mul(n.parse().ok()?)?;
+        name = element;
+        is_array = true;
+    }
+}
+
+fn summarize(
+    layouts: &[StructLayout],
+    idx: usize,
+    flat: &Flat,
+    cache_line_size: u32,
+) -> NestedPadding {
+    let layout = &layouts[idx];
+    let padding_bytes =
+        flat.shares.values().fold(0u64, |sum, s| sum.saturating_add(s.padding_bytes));
+    let inner_padding = padding_bytes.saturating_sub(layout.metrics.padding_bytes);
+    let useful_size = layout.metrics.useful_size.saturating_sub(inner_padding);
+
+    let padding_percentage =
+        if layout.size > 0 { (padding_bytes as f64 / layout.size as f64) * 100.0 } else { 0.0 };
+    let cache_bytes = layout.metrics.cache_lines_spanned as u64 * cache_line_size as u64;
+    let cache_line_density =
+        if cache_bytes > 0 { (useful_size as f64 / cache_bytes as f64) * 100.0 } else { 0.0 };
+
+    let mut contributors: Vec<PaddingContributor> = flat
+        .shares
+        .iter()
+        .filter(|(_, share)| share.padding_bytes > 0)
+        .map(|(&contributor, share)| PaddingContributor {
+            type_name: layouts[contributor].name.clone(),
+            instances: share.instances,
+            padding_bytes: share.padding_bytes,
+            percent: share.padding_bytes as f64 / padding_bytes as f64 * 100.0,
+            paths: share.paths.clone(),
+        })
+        .collect();
+    contributors.sort_by(|a, b| {
+        b.padding_bytes.cmp(&a.padding_bytes).then_with(|| a.type_name.cmp(&b.type_name))
+    });
+
+    NestedPadding {
+        useful_size,
+        padding_bytes,
+        padding_percentage,
+        cache_line_density,
+        contributors,
+        partial: flat.partial,
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::analysis::analyze_layout;
+    use crate::types::MemberLayout;
+
+    fn member(name: &str, type_name: &str, offset: u64, size: u64) -> MemberLayout {
+        MemberLayout::new(name.to_string(), type_name.to_string(), Some(offset), Some(size))
+    }
+
+    fn layout(name: &str, size: u64, members: Vec<MemberLayout>) -> StructLayout {
+        let mut layout = StructLayout::new(name.to_string(), size, Some(8));
+        layout.members = members;
+        analyze_layout(&mut layout, 64);
+        layout
+    }
+
+    /// `Leg { u64 price; u16 qty; }` (6 bytes tail padding) and
+    /// `Order { u64 id; Leg legs[16]; }`, which has no padding of its own.
+    fn order_and_leg() -> Vec<StructLayout> {
+        vec![
+            layout("Leg", 16, vec![member("price", "u64", 0, 8), member("qty", "u16", 8, 2)]),
+            layout(
+                "Order",
+                264,
+                vec![member("id", "u64", 0, 8), member("legs", "[Leg; 16]", 8, 256)],
+            ),
+        ]
+    }
+
+    #[test]
+    fn arrays_of_structs_count_element_padding() {
+        let mut layouts = order_and_leg();
+        analyze_nested_padding(&mut layouts, 64);
+
+        assert_eq!(layouts[1].metrics.padding_bytes, 0);
+        let nested = layouts[1].metrics.nested.as_ref().expect("Order embeds Leg");
+        assert_eq!(nested.padding_bytes, 96);
+        assert_eq!(nested.useful_size, 168);
+        assert!((nested.cache_line_density - 168.0 / 320.0 * 100.0).abs() < 1e-9);
+        assert_eq!(nested.contributors.len(), 1);
+        assert_eq!(nested.contributors[0].type_name, "Leg");
+        assert_eq!(nested.contributors[0].instances, 16);
+        assert_eq!(nested.contributors[0].paths, ["legs[]"]);
+        assert!(!nested.partial);
+
+        assert!(layouts[0].metrics.nested.is_none(), "Leg embeds nothing");
+    }
+
+    #[test]
+    fn deep_nesting_attributes_paths_and_outer_padding() {
+        let mut layouts = order_and_leg();
+        // Book { u8 side; <7 pad>; Order best; const [[Order; 2]; 2] depth; }
+        layouts.push(layout(
+            "Book",
+            8 + 264 * 5,
+            vec![
+                member("side", "u8", 0, 1),
+                member("best", "Order", 8, 264),
+                member("depth", "const [[Order; 2]; 2]", 272, 264 * 4),
+            ],
+        ));
+        analyze_nested_padding(&mut layouts, 64);
+
+        let nested = layouts[2].metrics.nested.as_ref().unwrap();
+        assert_eq!(nested.padding_bytes, 7 + 5 * 96);
+        let leg = &nested.contributors[0];
+        assert_eq!((leg.type_name.as_str(), leg.instances), ("Leg", 80));
+        assert_eq!(leg.paths, ["best.legs[]", "depth[].legs[]"]);
+        let own = &nested.contributors[1];
+        assert_eq!((own.type_name.as_str(), own.padding_bytes), ("Book", 7));
+        assert!(own.paths.is_empty());
+    }
+
+    #[test]
+    fn unions_and_mismatched_sizes_stay_opaque() {
+        let mut layouts = order_and_leg();
+        // Two members sharing offset 0 (a union), and a `Leg` whose size disagrees.
+        layouts.push(layout(
+            "Variant",
+            16,
+            vec![member("leg", "Leg", 0, 16), member("raw", "[u8; 16]", 0, 16)],
+        ));
+        layouts.push(layout("Stale", 8, vec![member("leg", "Leg", 0, 8)]));
+        analyze_nested_padding(&mut layouts, 64);
+
+        assert!(layouts[2].metrics.nested.is_none());
+        assert!(layouts[3].metrics.nested.is_none());
+    }
+
+    #[test]
+    fn element_type_parses_qualified_and_nested_arrays() {
+        assert_eq!(element_type("Leg"), Some(("Leg", 1, false)));
+        assert_eq!(element_type("volatile [const Leg; 4]"), Some(("Leg", 4, true)));
+        assert_eq!(element_type("[[Leg; 2]; 3]"), Some(("Leg", 6, true)));
+        assert_eq!(element_type("[Leg; ?]"), None);
+    }
+}
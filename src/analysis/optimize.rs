@@ -1,8 +1,12 @@
 //! Field reordering optimization for struct layouts.
 
-use crate::types::{MemberLayout, StructLayout};
+use super::cache_line::CacheLinePlan;
+use super::split::{SplitKind, SplitPlan};
+use super::target::TargetSuggestion;
+use crate::intern::Name;
+use crate::types::{AccessHeat, MemberLayout, StructLayout};
 use serde::Serialize;
-use std::collections::HashSet;
+use std::collections::{HashMap, HashSet};
 
 /// Result of optimizing a struct layout.
 #[derive(Debug, Clone, Serialize)]
@@ -20,13 +24,56 @@ pub struct OptimizedLayout {
     pub skipped_members: Vec<String>,
     /// True if layout contains bitfields that were kept together.
     pub has_bitfields: bool,
+    /// Set when the ordering was chosen from an access profile.
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub hot_fields: Option<HotFieldPlacement>,
+    /// Set when the ordering was chosen with cache-line constraints.
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub cache_lines: Option<CacheLinePlan>,
+    /// Set when a hot/cold split or struct-of-arrays decomposition was evaluated.
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub split: Option<SplitPlan>,
+    /// What the suggestion for each target profile saves, when several were evaluated;
+    /// this layout is the one that saves the least.
+    #[serde(skip_serializing_if = "Vec::is_empty")]
+    pub targets: Vec<TargetSuggestion>,
+}
+
+/// How much of a struct's sampled access weight lands in its first cache line, counting
+/// members that lie entirely within it. Percentages are of the weight attributed to
+/// members, since samples in padding cannot be moved.
+#[derive(Debug, Clone, Serialize)]
+pub struct HotFieldPlacement {
+    /// Sampled members, hottest first.
+    pub hot_members: Vec<String>,
+    pub original_first_line_percent: f64,
+    pub optimized_first_line_percent: f64,
+}
+
+impl OptimizedLayout {
+    /// True if the suggested order saves bytes, moves hot fields into the first cache line,
+    /// fixes a cache-line problem (more lines than needed, split groups, false sharing), or
+    /// a split of the struct is recommended.
+    pub fn is_improvement(&self) -> bool {
+        self.savings_bytes > 0
+            || self
+                .hot_fields
+                .as_ref()
+                .is_some_and(|h| h.optimized_first_line_percent > h.original_first_line_percent)
+            || self.cache_lines.as_ref().is_some_and(|c| {
+                c.optimized_cache_lines < c.original_cache_lines
+                    || c.original_split_groups > 0
+                    || c.original_false_sharing_pairs > 0
+            })
+            || self.split.as_ref().is_some_and(|s| s.recommendation != SplitKind::None)
+    }
 }
 
 /// Member with computed offset and alignment.
 #[derive(Debug, Clone, Serialize)]
 pub struct OptimizedMember {
-    pub name: String,
-    pub type_name: String,
+    pub name: Name,
+    pub type_name: Name,
     pub offset: u64,
     pub size: u64,
     pub alignment: u64,
@@ -50,7 +97,7 @@ pub fn infer_alignment(size: u64, max_align: u64) -> u64 {
 /// Align value up to alignment boundary.
 /// Returns value unchanged if alignment <= 1.
 /// For values near u64::MAX where alignment would overflow, returns u64::MAX.
-fn align_up(value: u64, alignment: u64) -> u64 {
+pub(super) fn align_up(value: u64, alignment: u64) -> u64 {
     if alignment <= 1 {
         return value;
     }
@@ -66,10 +113,10 @@ fn align_up(value: u64, alignment: u64) -> u64 {
 
 /// A sortable unit for optimization - either a single member or a bitfield group.
 #[derive(Clone)]
-struct SortableUnit {
-    members: Vec<OptimizedMember>,
-    total_size: u64,
-    alignment: u64,
+pub(super) struct SortableUnit {
+    pub(super) members: Vec<OptimizedMember>,
+    pub(super) total_size: u64,
+    pub(super) alignment: u64,
 }
 
 /// Group bitfield members that share storage units.
@@ -118,6 +165,130 @@ fn find_bitfield_groups(members: &[MemberLayout]) -> Vec<Vec<usize>> {
 /// Optimize a struct layout by reordering fields to minimize padding.
 /// Uses greedy bin-packing: sort by alignment desc, then size desc.
 pub fn optimize_layout(layout: &StructLayout, max_align: u64) -> OptimizedLayout {
+    optimize_ordered(layout, max_align, |mut units, _| {
+        sort_for_padding(&mut units);
+        in_sequence(units)
+    })
+}
+
+/// Optimize a struct layout so its most accessed fields share the first cache line.
+///
+/// Sampled fields are taken hottest first and kept in the first line while they still
+/// fit when packed by alignment. If the padding-only order of `optimize_layout` already
+/// places all of them there it is used as is. Otherwise they lead, followed by the
+/// sampled fields that did not fit and then the unsampled ones, each group packed like
+/// `optimize_layout`; padding may then be higher where the groups meet.
+pub fn optimize_layout_for_access(
+    layout: &StructLayout,
+    max_align: u64,
+    cache_line_size: u32,
+    heat: &AccessHeat,
+) -> OptimizedLayout {
+    let line = (cache_line_size as u64).max(1);
+    let weights = heat_weights(heat);
+
+    let mut result = optimize_ordered(layout, max_align, |mut units, _| {
+        sort_for_padding(&mut units);
+        let padding_order = units.clone();
+        let (mut first_line, mut overflow, mut cold) = split_by_heat(units, &weights, line);
+
+        // Grouping costs padding where the groups meet, so prefer the padding-only order
+        // whenever it already keeps every selected field in the first line.
+        let selected: HashSet<&str> =
+            first_line.iter().map(|u| u.members[0].name.as_str()).collect();
+        let mut offset = 0;
+        let padding_order_fits = padding_order.iter().all(|unit| {
+            offset = align_up(offset, unit.alignment).saturating_add(unit.total_size);
+            offset <= line || !selected.contains(unit.members[0].name.as_str())
+        });
+        if padding_order_fits {
+            return in_sequence(padding_order);
+        }
+
+        first_line.append(&mut overflow);
+        first_line.append(&mut cold);
+        in_sequence(first_line)
+    });
+
+    let first_line_percent = |members: &[OptimizedMember]| {
+        let total: f64 = members.iter().filter_map(|m| weights.get(m.name.as_str())).sum();
+        let in_line: f64 = members
+            .iter()
+            .filter(|m| m.offset.saturating_add(m.size) <= line)
+            .filter_map(|m| weights.get(m.name.as_str()))
+            .sum();
+        if total > 0.0 { in_line / total * 100.0 } else { 0.0 }
+    };
+    result.hot_fields = Some(HotFieldPlacement {
+        hot_members: heat.members.iter().map(|m| m.name.clone()).collect(),
+        original_first_line_percent: first_line_percent(&result.original_members),
+        optimized_first_line_percent: first_line_percent(&result.optimized_members),
+    });
+    result
+}
+
+pub(super) fn heat_weights(heat: &AccessHeat) -> HashMap<&str, f64> {
+    heat.members.iter().map(|m| (m.name.as_str(), m.weight)).collect()
+}
+
+/// Splits `units`, in padding order, into the hottest ones that still fit one cache line
+/// when packed together (taken hottest first), the other sampled ones and the unsampled
+/// ones. Each part keeps the padding order.
+pub(super) fn split_by_heat(
+    units: Vec<SortableUnit>,
+    weights: &HashMap<&str, f64>,
+    line: u64,
+) -> (Vec<SortableUnit>, Vec<SortableUnit>, Vec<SortableUnit>) {
+    let unit_weight = |unit: &SortableUnit| -> f64 {
+        unit.members.iter().filter_map(|m| weights.get(m.name.as_str())).sum()
+    };
+    let (mut hot, cold): (Vec<_>, Vec<_>) = units.into_iter().partition(|u| unit_weight(u) > 0.0);
+    // Stable, so equally hot units keep the padding order.
+    hot.sort_by(|a, b| unit_weight(b).total_cmp(&unit_weight(a)));
+
+    let mut first_line: Vec<SortableUnit> = Vec::new();
+    let mut overflow: Vec<SortableUnit> = Vec::new();
+    for unit in hot {
+        let mut candidate = first_line.clone();
+        candidate.push(unit.clone());
+        sort_for_padding(&mut candidate);
+        if packed_end(&candidate) <= line {
+            first_line = candidate;
+        } else {
+            overflow.push(unit);
+        }
+    }
+    sort_for_padding(&mut overflow);
+    (first_line, overflow, cold)
+}
+
+/// Largest alignment first, then largest size.
+pub(super) fn sort_for_padding(units: &mut [SortableUnit]) {
+    units.sort_by(|a, b| {
+        b.alignment.cmp(&a.alignment).then_with(|| b.total_size.cmp(&a.total_size))
+    });
+}
+
+/// End offset of `units` placed in order from offset 0.
+pub(super) fn packed_end(units: &[SortableUnit]) -> u64 {
+    units
+        .iter()
+        .fold(0, |offset, unit| align_up(offset, unit.alignment).saturating_add(unit.total_size))
+}
+
+/// Units in placement order, each starting at the next aligned offset.
+pub(super) fn in_sequence(units: Vec<SortableUnit>) -> Vec<(u64, SortableUnit)> {
+    units.into_iter().map(|unit| (0, unit)).collect()
+}
+
+/// Shared by the optimizers: collects the movable units and lets `order` arrange them,
+/// given the struct alignment. Units are placed in the returned order, each at the next
+/// offset that is aligned for it and no lower than the offset paired with it.
+pub(super) fn optimize_ordered(
+    layout: &StructLayout,
+    max_align: u64,
+    order: impl FnOnce(Vec<SortableUnit>, u64) -> Vec<(u64, SortableUnit)>,
+) -> OptimizedLayout {
     let max_align = max_align.max(1);
     // If struct alignment is known, use it; otherwise infer from member alignments.
     // Exclude ZSTs (size=0) since they don't affect struct alignment.
@@ -143,11 +314,11 @@ pub fn optimize_layout(layout: &StructLayout, max_align: u64) -> OptimizedLayout
 
     for member in &layout.members {
         let Some(size) = member.size else {
-            skipped_members.push(member.name.clone());
+            skipped_members.push(member.name.to_string());
             continue;
         };
         let Some(offset) = member.offset else {
-            skipped_members.push(member.name.clone());
+            skipped_members.push(member.name.to_string());
             continue;
         };
         // Skip zero-size types (ZSTs don't affect layout)
@@ -228,7 +399,7 @@ pub fn optimize_layout(layout: &StructLayout, max_align: u64) -> OptimizedLayout
             .filter(|member| {
                 // Check if already in skipped_members (may have "(zero-size)" suffix)
                 !skipped_names.contains(member.name.as_str())
-                    && !skipped_members.iter().any(|s| s.starts_with(&member.name))
+                    && !skipped_members.iter().any(|s| s.starts_with(member.name.as_str()))
             })
             .map(|member| format!("{} (bitfield, missing info)", member.name))
             .collect()
@@ -250,18 +421,15 @@ pub fn optimize_layout(layout: &StructLayout, max_align: u64) -> OptimizedLayout
         }
     }
 
-    // Sort: largest alignment first, then largest size
-    units.sort_by(|a, b| {
-        b.alignment.cmp(&a.alignment).then_with(|| b.total_size.cmp(&a.total_size))
-    });
+    let units = order(units, struct_alignment);
 
     // Place members greedily
     let mut optimized_members: Vec<OptimizedMember> = Vec::new();
     let mut current_offset: u64 = 0;
 
-    for unit in units {
+    for (min_offset, unit) in units {
         // Align to unit's alignment requirement
-        let aligned_offset = align_up(current_offset, unit.alignment);
+        let aligned_offset = align_up(current_offset.max(min_offset), unit.alignment);
 
         for mut member in unit.members {
             member.offset = aligned_offset;
@@ -295,6 +463,10 @@ pub fn optimize_layout(layout: &StructLayout, max_align: u64) -> OptimizedLayout
         optimized_members,
         skipped_members,
         has_bitfields,
+        hot_fields: None,
+        cache_lines: None,
+        split: None,
+        targets: Vec::new(),
     }
 }
 
@@ -434,4 +606,79 @@ mod tests {
             result.skipped_members
         );
     }
+
+    fn heat_for(layout: &StructLayout, samples: &[(u64, f64)]) -> AccessHeat {
+        let samples: Vec<_> = samples
+            .iter()
+            .map(|&(offset, weight)| crate::profile::AccessSample { offset, weight })
+            .collect();
+        crate::analysis::analyze_access_heat(layout, &samples, 64)
+    }
+
+    #[test]
+    fn test_access_order_moves_hot_fields_into_first_line() {
+        // 64 cold bytes up front push the hot counter into the second cache line.
+        let mut layout = StructLayout::new("Test".to_string(), 80, Some(8));
+        layout.members = vec![
+            MemberLayout::new("cold".to_string(), "char[64]".to_string(), Some(0), Some(64)),
+            MemberLayout::new("hits".to_string(), "long".to_string(), Some(64), Some(8)),
+            MemberLayout::new("misses".to_string(), "long".to_string(), Some(72), Some(8)),
+        ];
+        let heat = heat_for(&layout, &[(64, 90.0), (72, 10.0)]);
+
+        let result = optimize_layout_for_access(&layout, 8, 64, &heat);
+
+        let order: Vec<_> = result.optimized_members.iter().map(|m| m.name.as_str()).collect();
+        assert_eq!(order, ["hits", "misses", "cold"]);
+        assert_eq!(result.optimized_size, 80);
+        let hot = result.hot_fields.as_ref().unwrap();
+        assert_eq!(hot.hot_members, ["hits", "misses"]);
+        assert_eq!(hot.original_first_line_percent, 0.0);
+        assert_eq!(hot.optimized_first_line_percent, 100.0);
+        assert!(result.is_improvement());
+
+        // The padding-only order has nothing to gain here.
+        assert!(!optimize_layout(&layout, 8).is_improvement());
+    }
+
+    #[test]
+    fn test_access_order_keeps_hottest_when_line_overflows() {
+        let mut layout = StructLayout::new("Test".to_string(), 96, Some(8));
+        layout.members = vec![
+            MemberLayout::new("warm".to_string(), "char[48]".to_string(), Some(0), Some(48)),
+            MemberLayout::new("hot".to_string(), "char[40]".to_string(), Some(48), Some(40)),
+            MemberLayout::new("tag".to_string(), "long".to_string(), Some(88), Some(8)),
+        ];
+        let heat = heat_for(&layout, &[(0, 10.0), (48, 80.0), (88, 10.0)]);
+
+        let result = optimize_layout_for_access(&layout, 8, 64, &heat);
+
+        // `hot` and `tag` fit one line together; `warm` no longer does.
+        let first_line: Vec<_> = result
+            .optimized_members
+            .iter()
+            .filter(|m| m.offset + m.size <= 64)
+            .map(|m| m.name.as_str())
+            .collect();
+        assert_eq!(first_line, ["hot", "tag"]);
+        assert_eq!(result.hot_fields.unwrap().optimized_first_line_percent, 90.0);
+    }
+
+    #[test]
+    fn test_access_order_keeps_padding_order_when_hot_fields_fit() {
+        let mut layout = StructLayout::new("Test".to_string(), 16, Some(4));
+        layout.members = vec![
+            MemberLayout::new("a".to_string(), "char".to_string(), Some(0), Some(1)),
+            MemberLayout::new("b".to_string(), "int".to_string(), Some(4), Some(4)),
+            MemberLayout::new("c".to_string(), "char".to_string(), Some(8), Some(1)),
+            MemberLayout::new("d".to_string(), "int".to_string(), Some(12), Some(4)),
+        ];
+        let heat = heat_for(&layout, &[(8, 90.0), (4, 10.0)]);
+
+        let result = optimize_layout_for_access(&layout, 8, 64, &heat);
+
+        assert_eq!(result.optimized_size, optimize_layout(&layout, 8).optimized_size);
+        assert_eq!(result.savings_bytes, 4);
+        assert_eq!(result.hot_fields.unwrap().optimized_first_line_percent, 100.0);
+    }
 }
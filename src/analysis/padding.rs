@@ -1,4 +1,4 @@
-use crate::types::{LayoutMetrics, PaddingHole, StructLayout};
+use crate::types::{LayoutMetrics, MemberLayout, PaddingHole, StructLayout};
 
 /// Analyzes a struct layout for padding holes and cache line metrics.
 ///
@@ -32,7 +32,7 @@ pub fn analyze_layout(layout: &mut StructLayout, cache_line_size: u32) {
         spans.push(Span {
             start: member_offset,
             end: member_offset.saturating_add(member_size),
-            member_name: member.name.clone(),
+            member_name: member.name.to_string(),
         });
     }
 
@@ -61,6 +61,9 @@ pub fn analyze_layout(layout: &mut StructLayout, cache_line_size: u32) {
             padding_holes,
             partial,
             false_sharing: None,
+            access_heat: None,
+            nested: None,
+            targets: Vec::new(),
         };
         return;
     }
@@ -134,9 +137,39 @@ pub fn analyze_layout(layout: &mut StructLayout, cache_line_size: u32) {
         padding_holes,
         partial,
         false_sharing: None,
+        access_heat: None,
+        nested: None,
+        targets: Vec::new(),
     };
 }
 
+/// The cache lines, in order, holding any byte of a member `is_hot` selects. Members
+/// without a known offset or size are skipped.
+///
+/// # Panics
+/// Panics if `cache_line_size` is 0.
+pub fn cache_lines_touched(
+    layout: &StructLayout,
+    cache_line_size: u32,
+    mut is_hot: impl FnMut(&MemberLayout) -> bool,
+) -> Vec<u64> {
+    assert!(cache_line_size > 0, "cache_line_size must be > 0");
+    let line = cache_line_size as u64;
+
+    let mut lines: Vec<u64> = Vec::new();
+    for member in layout.members.iter().filter(|m| is_hot(m)) {
+        let (Some(start), Some(end)) = (member.offset, member.end_offset()) else {
+            continue;
+        };
+        if end > start {
+            lines.extend(start / line..=(end - 1) / line);
+        }
+    }
+    lines.sort_unstable();
+    lines.dedup();
+    lines
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
@@ -299,4 +332,22 @@ mod tests {
         // No padding holes when partial (can't reliably detect them)
         assert!(layout.metrics.padding_holes.is_empty());
     }
+
+    #[test]
+    fn test_cache_lines_touched_by_selected_members() {
+        let layout = make_layout(
+            192,
+            vec![
+                MemberLayout::new("head".to_string(), "u64".to_string(), Some(0), Some(8)),
+                MemberLayout::new("buf".to_string(), "[u8; 120]".to_string(), Some(8), Some(120)),
+                MemberLayout::new("tail".to_string(), "u64".to_string(), Some(184), Some(8)),
+                MemberLayout::new("len".to_string(), "u32".to_string(), None, Some(4)),
+            ],
+        );
+        let touched =
+            |names: &[&str]| cache_lines_touched(&layout, 64, |m| names.contains(&m.name.as_str()));
+        assert_eq!(touched(&["head", "tail"]), [0, 2]);
+        assert_eq!(touched(&["buf", "head"]), [0, 1]);
+        assert!(touched(&["len"]).is_empty());
+    }
 }
@@ -0,0 +1,357 @@
+//! Hot/cold splitting and struct-of-arrays advice.
+//!
+//! Reordering cannot help a loop that reads two fields of a large struct: every element
+//! still drags its whole cache line through the cache. This advisor measures what such a
+//! loop touches when scanning an array of the struct, and compares it against moving the
+//! cold fields into a parallel array (hot/cold split) or giving each hot field its own
+//! array (struct of arrays).
+
+use super::optimize::{
+    OptimizedLayout, OptimizedMember, SortableUnit, align_up, in_sequence, optimize_ordered,
+    sort_for_padding,
+};
+use crate::types::{AccessHeat, StructLayout};
+use serde::Serialize;
+use std::collections::HashSet;
+
+/// Share of a struct's sampled access weight the profile-derived hot set covers.
+pub const PROFILE_HOT_SHARE: f64 = 0.9;
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Serialize)]
+#[serde(rename_all = "snake_case")]
+pub enum SplitKind {
+    /// Neither decomposition touches fewer cache lines than the struct as it is.
+    None,
+    /// Hot fields in one struct, cold fields in a parallel array indexed the same way.
+    HotCold,
+    /// One array per hot field (bitfields sharing storage stay together).
+    StructOfArrays,
+}
+
+/// What a loop reading only the hot fields of `elements` consecutive elements touches.
+#[derive(Debug, Clone, Copy, PartialEq, Serialize)]
+pub struct LoopFootprint {
+    pub cache_lines: u64,
+    /// Cache-line bytes brought in per element.
+    pub bytes_per_element: f64,
+}
+
+#[derive(Debug, Clone, Serialize)]
+pub struct SplitPlan {
+    pub recommendation: SplitKind,
+    pub elements: u64,
+    pub cache_line_size: u64,
+    /// Hot fields packed into their own struct.
+    pub hot_members: Vec<OptimizedMember>,
+    pub hot_size: u64,
+    /// The remaining fields, packed into the cold struct.
+    pub cold_members: Vec<OptimizedMember>,
+    pub cold_size: u64,
+    /// Requested hot fields the struct does not have.
+    #[serde(skip_serializing_if = "Vec::is_empty")]
+    pub unknown_fields: Vec<String>,
+    pub original: LoopFootprint,
+    pub hot_cold: LoopFootprint,
+    pub struct_of_arrays: LoopFootprint,
+}
+
+/// The hottest sampled members that together account for `share` of the sampled weight.
+pub fn hot_fields_from_heat(heat: &AccessHeat, share: f64) -> Vec<String> {
+    let total: f64 = heat.members.iter().map(|m| m.weight).sum();
+    let mut covered = 0.0;
+    let mut fields = Vec::new();
+    // `members` is hottest first.
+    for member in &heat.members {
+        if total <= 0.0 || covered >= total * share {
+            break;
+        }
+        covered += member.weight;
+        fields.push(member.name.clone());
+    }
+    fields
+}
+
+/// Suggest the padding-optimal order from `optimize_layout` together with a split plan
+/// for a loop that reads `hot_fields` of `elements` consecutive array elements.
+///
+/// The recommendation is the decomposition touching the fewest cache lines, preferring the
+/// less invasive hot/cold split on ties, or `SplitKind::None` if neither beats the struct
+/// as laid out now (or every field, or none, is hot).
+pub fn optimize_layout_for_split(
+    layout: &StructLayout,
+    max_align: u64,
+    cache_line_size: u32,
+    hot_fields: &[String],
+    elements: u64,
+) -> OptimizedLayout {
+    let line = (cache_line_size as u64).max(1);
+    let elements = elements.max(1);
+    let wanted: HashSet<&str> = hot_fields.iter().map(String::as_str).collect();
+    let is_hot =
+        |unit: &SortableUnit| unit.members.iter().any(|m| wanted.contains(m.name.as_str()));
+
+    let mut parts: Option<(Vec<SortableUnit>, Vec<SortableUnit>)> = None;
+    let mut result = optimize_ordered(layout, max_align, |mut units, _| {
+        sort_for_padding(&mut units);
+        parts = Some(units.iter().cloned().partition(is_hot));
+        in_sequence(units)
+    });
+    let (hot, cold) = parts.unwrap_or_default();
+
+    let known: HashSet<&str> = result
+        .original_members
+        .iter()
+        .map(|m| m.name.as_str())
+        .chain(result.skipped_members.iter().map(String::as_str))
+        .collect();
+    let unknown_fields: Vec<String> =
+        hot_fields.iter().filter(|f| !known.contains(f.as_str())).cloned().collect();
+
+    let hot_spans: Vec<(u64, u64)> = {
+        let hot_names: HashSet<&str> =
+            hot.iter().flat_map(|u| u.members.iter().map(|m| m.name.as_str())).collect();
+        let mut spans: Vec<(u64, u64)> = result
+            .original_members
+            .iter()
+            .filter(|m| hot_names.contains(m.name.as_str()))
+            .map(|m| (m.offset, m.size))
+            .collect();
+        spans.sort_unstable();
+        spans
+    };
+    let soa_lines = hot.iter().fold(0u64, |sum, unit| {
+        sum.saturating_add(unit.total_size.saturating_mul(elements).div_ceil(line))
+    });
+
+    let (hot_members, hot_size) = pack(hot);
+    let (cold_members, cold_size) = pack(cold);
+    let packed_hot_spans: Vec<(u64, u64)> =
+        hot_members.iter().map(|m| (m.offset, m.size)).collect();
+
+    let footprint = |cache_lines: u64| LoopFootprint {
+        cache_lines,
+        bytes_per_element: cache_lines as f64 * line as f64 / elements as f64,
+    };
+    let original = footprint(lines_touched(layout.size, &hot_spans, elements, line));
+    let hot_cold = footprint(lines_touched(hot_size, &packed_hot_spans, elements, line));
+    let struct_of_arrays = footprint(soa_lines);
+
+    let recommendation = if hot_members.is_empty() || cold_members.is_empty() {
+        SplitKind::None
+    } else if struct_of_arrays.cache_lines < hot_cold.cache_lines
+        && struct_of_arrays.cache_lines < original.cache_lines
+    {
+        SplitKind::StructOfArrays
+    } else if hot_cold.cache_lines < original.cache_lines {
+        SplitKind::HotCold
+    } else {
+        SplitKind::None
+    };
+
+    result.split = Some(SplitPlan {
+        recommendation,
+        elements,
+        cache_line_size: line,
+        hot_members,
+        hot_size,
+        cold_members,
+        cold_size,
+        unknown_fields,
+        original,
+        hot_cold,
+        struct_of_arrays,
+    });
+    result
+}
+
+/// Place `units` (already in padding order) from offset 0; returns the members and the
+/// struct size rounded up to the largest alignment.
+fn pack(units: Vec<SortableUnit>) -> (Vec<OptimizedMember>, u64) {
+    let alignment = units.iter().map(|u| u.alignment).max().unwrap_or(1);
+    let mut members = Vec::new();
+    let mut offset = 0u64;
+    for unit in units {
+        let start = align_up(offset, unit.alignment);
+        for mut member in unit.members {
+            member.offset = start;
+            if member.bit_size.is_some() {
+                member.bit_offset = None;
+            }
+            members.push(member);
+        }
+        offset = start.saturating_add(unit.total_size);
+    }
+    (members, align_up(offset, alignment))
+}
+
+/// Distinct cache lines covered by `spans` (offset, size; sorted, non-overlapping, within
+/// the stride) of `elements` consecutive structs of `stride` bytes, the array starting on a
+/// line boundary.
+fn lines_touched(stride: u64, spans: &[(u64, u64)], elements: u64, line: u64) -> u64 {
+    if stride == 0 || spans.is_empty() {
+        return 0;
+    }
+    // Every `line / gcd(stride, line)` elements the array is back on a line boundary, so
+    // the lines touched repeat; walk one period and the remainder, not every element.
+    let period = line / gcd(stride, line);
+    if elements <= period {
+        return walk_lines(stride, spans, elements, line);
+    }
+    (elements / period)
+        .saturating_mul(walk_lines(stride, spans, period, line))
+        .saturating_add(walk_lines(stride, spans, elements % period, line))
+}
+
+/// `lines_touched` one element at a time.
+fn walk_lines(stride: u64, spans: &[(u64, u64)], elements: u64, line: u64) -> u64 {
+    let mut lines = 0u64;
+    let mut last: Option<u64> = None;
+    for element in 0..elements {
+        let base = element.saturating_mul(stride);
+        for &(offset, size) in spans {
+            if size == 0 {
+                continue;
+            }
+            let start = base.saturating_add(offset);
+            let first = start / line;
+            let end = start.saturating_add(size - 1) / line;
+            let from = match last {
+                Some(last) if last >= first => last + 1,
+                _ => first,
+            };
+            if end >= from {
+                lines += end - from + 1;
+                last = Some(end);
+            }
+        }
+    }
+    lines
+}
+
+pub(crate) fn gcd(mut a: u64, mut b: u64) -> u64 {
+    while b != 0 {
+        (a, b) = (b, a % b);
+    }
+    a
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::types::{MemberHeat, MemberLayout};
+
+    /// 64-byte order with two hot 8-byte fields, one at each end.
+    fn order() -> StructLayout {
+        let mut layout = StructLayout::new("Order".to_string(), 64, Some(8));
+        layout.members = (0..8)
+            .map(|i| {
+                let name = ["price", "a", "b", "c", "d", "e", "f", "qty"][i];
+                MemberLayout::new(name.to_string(), "u64".to_string(), Some(i as u64 * 8), Some(8))
+            })
+            .collect();
+        layout
+    }
+
+    fn hot(fields: &[&str]) -> Vec<String> {
+        fields.iter().map(|f| f.to_string()).collect()
+    }
+
+    #[test]
+    fn hot_cold_split_shrinks_the_hot_loop() {
+        let result = optimize_layout_for_split(&order(), 8, 64, &hot(&["price", "qty"]), 1000);
+        assert!(result.is_improvement());
+        let plan = result.split.expect("split plan");
+
+        assert_eq!(plan.original, LoopFootprint { cache_lines: 1000, bytes_per_element: 64.0 });
+        assert_eq!(plan.hot_size, 16);
+        assert_eq!(plan.cold_size, 48);
+        assert_eq!(plan.hot_cold.cache_lines, 250);
+        assert_eq!(plan.hot_cold.bytes_per_element, 16.0);
+        assert_eq!(plan.struct_of_arrays.cache_lines, 250);
+        // SoA only wins when it beats the split outright.
+        assert_eq!(plan.recommendation, SplitKind::HotCold);
+        let names: Vec<&str> = plan.hot_members.iter().map(|m| m.name.as_str()).collect();
+        assert_eq!(names, ["price", "qty"]);
+    }
+
+    #[test]
+    fn struct_of_arrays_wins_when_hot_fields_pad_each_other() {
+        // { u64 ts; u8 flag; <7 pad>; u64 cold } with ts and flag hot: the split struct
+        // still pads flag to 16 bytes, separate arrays need 9 bytes per element.
+        let mut layout = StructLayout::new("Tick".to_string(), 24, Some(8));
+        layout.members = vec![
+            MemberLayout::new("ts".to_string(), "u64".to_string(), Some(0), Some(8)),
+            MemberLayout::new("flag".to_string(), "u8".to_string(), Some(8), Some(1)),
+            MemberLayout::new("cold".to_string(), "u64".to_string(), Some(16), Some(8)),
+        ];
+        let plan =
+            optimize_layout_for_split(&layout, 8, 64, &hot(&["ts", "flag"]), 64).split.unwrap();
+
+        assert_eq!(plan.hot_cold.cache_lines, 16);
+        assert_eq!(plan.struct_of_arrays.cache_lines, 8 + 1);
+        assert_eq!(plan.recommendation, SplitKind::StructOfArrays);
+    }
+
+    #[test]
+    fn nothing_to_split_when_all_or_no_fields_are_hot() {
+        let all = hot(&["price", "a", "b", "c", "d", "e", "f", "qty"]);
+        let plan = optimize_layout_for_split(&order(), 8, 64, &all, 100).split.unwrap();
+        assert_eq!(plan.recommendation, SplitKind::None);
+
+        let plan = optimize_layout_for_split(&order(), 8, 64, &hot(&["nope"]), 100).split.unwrap();
+        assert_eq!(plan.recommendation, SplitKind::None);
+        assert_eq!(plan.unknown_fields, ["nope"]);
+        assert_eq!(plan.original.cache_lines, 0);
+    }
+
+    #[test]
+    fn lines_touched_counts_shared_lines_once() {
+        // 16-byte stride, 4-byte field at offset 0: four elements per line.
+        assert_eq!(lines_touched(16, &[(0, 4)], 8, 64), 2);
+        // A field straddling a boundary touches both lines.
+        assert_eq!(lines_touched(72, &[(60, 8)], 1, 64), 2);
+        assert_eq!(lines_touched(0, &[(0, 4)], 8, 64), 0);
+    }
+
+    #[test]
+    fn lines_touched_scales_whole_periods() {
+        for stride in [1, 8, 24, 40, 64, 72, 100, 129] {
+            let spans = [vec![(0, 4)], vec![(0, 1), (stride - 1, 1)], vec![(0, stride)]];
+            for spans in spans.into_iter().filter(|s| s.iter().all(|&(o, n)| o + n <= stride)) {
+                for elements in [0, 1, 7, 64, 65, 200, 1000] {
+                    assert_eq!(
+                        lines_touched(stride, &spans, elements, 64),
+                        walk_lines(stride, &spans, elements, 64),
+                        "stride {} spans {:?} elements {}",
+                        stride,
+                        spans,
+                        elements
+                    );
+                }
+            }
+        }
+        // Eight 24-byte elements fill three lines, touching each.
+        assert_eq!(lines_touched(24, &[(0, 8)], 10_000_000_000, 64), 3_750_000_000);
+    }
+
+    #[test]
+    fn profile_hot_set_covers_requested_share() {
+        let heat = AccessHeat {
+            total_weight: 100.0,
+            unattributed_weight: 0.0,
+            members: [("a", 70.0), ("b", 25.0), ("c", 5.0)]
+                .iter()
+                .map(|&(name, weight)| MemberHeat {
+                    name: name.to_string(),
+                    offset: 0,
+                    size: 8,
+                    weight,
+                    percent: weight,
+                })
+                .collect(),
+            cache_lines: Vec::new(),
+        };
+        assert_eq!(hot_fields_from_heat(&heat, 0.9), ["a", "b"]);
+        assert_eq!(hot_fields_from_heat(&heat, 0.5), ["a"]);
+    }
+}
@@ -0,0 +1,182 @@
+//! Evaluating layouts against several target profiles in one pass.
+
+use super::false_sharing::analyze_false_sharing;
+use super::optimize::{OptimizedLayout, optimize_layout};
+use super::padding::analyze_layout;
+use crate::target::TargetProfile;
+use crate::types::{StructLayout, TargetMetrics};
+use serde::Serialize;
+
+/// What the suggestion for one target would save.
+#[derive(Debug, Clone, Serialize, PartialEq, Eq)]
+pub struct TargetSuggestion {
+    pub target: String,
+    pub struct_alignment: u64,
+    pub optimized_size: u64,
+    pub savings_bytes: u64,
+    pub optimized_cache_lines: u64,
+}
+
+/// Analyze `layout` against each of `targets`. `layout.metrics` is left with the metrics
+/// of the worst target (most cache lines spanned, then most false-sharing pairs, then most
+/// members split across lines, then lowest density), and `layout.metrics.targets` lists
+/// every target's figures in the order given.
+///
+/// # Panics
+/// Panics if `targets` is empty.
+pub fn analyze_layout_for_targets(layout: &mut StructLayout, targets: &[TargetProfile]) {
+    assert!(!targets.is_empty(), "at least one target profile is required");
+
+    let mut per_target = Vec::with_capacity(targets.len());
+    let mut worst = None;
+    for target in targets {
+        analyze_layout(layout, target.cache_line);
+        let figures = TargetMetrics {
+            target: target.name.to_string(),
+            cache_line_size: target.cache_line,
+            prefetch_size: target.prefetch_size,
+            cache_lines_spanned: layout.metrics.cache_lines_spanned,
+            prefetch_blocks_spanned: blocks_spanned(layout.size, target.prefetch_size),
+            cache_line_density: layout.metrics.cache_line_density,
+            split_members: split_members(layout, target.cache_line),
+            false_sharing_pairs: analyze_false_sharing(layout, target.interference_size())
+                .pair_count,
+        };
+        let cost = (
+            figures.cache_lines_spanned,
+            figures.false_sharing_pairs,
+            figures.split_members,
+            std::cmp::Reverse(ordered_density(figures.cache_line_density)),
+        );
+        if worst.as_ref().is_none_or(|(worst_cost, _)| cost > *worst_cost) {
+            worst = Some((cost, layout.metrics.clone()));
+        }
+        per_target.push(figures);
+    }
+
+    let (_, mut metrics) = worst.expect("targets is not empty");
+    metrics.targets = per_target;
+    layout.metrics = metrics;
+}
+
+/// Suggest a padding-minimizing order for each target's ABI alignment and return the one
+/// that saves the least, with what every target's suggestion would save in `targets`.
+///
+/// # Panics
+/// Panics if `targets` is empty.
+pub fn optimize_layout_for_targets(
+    layout: &StructLayout,
+    targets: &[TargetProfile],
+) -> OptimizedLayout {
+    optimize_for_targets(targets, |target| optimize_layout(layout, target.max_align))
+}
+
+/// Like `optimize_layout_for_targets`, with `optimize` choosing the order for each target.
+///
+/// # Panics
+/// Panics if `targets` is empty.
+pub fn optimize_for_targets(
+    targets: &[TargetProfile],
+    mut optimize: impl FnMut(&TargetProfile) -> OptimizedLayout,
+) -> OptimizedLayout {
+    assert!(!targets.is_empty(), "at least one target profile is required");
+
+    let mut summaries = Vec::with_capacity(targets.len());
+    let mut worst: Option<OptimizedLayout> = None;
+    for target in targets {
+        let suggestion = optimize(target);
+        summaries.push(TargetSuggestion {
+            target: target.name.to_string(),
+            struct_alignment: suggestion.struct_alignment,
+            optimized_size: suggestion.optimized_size,
+            savings_bytes: suggestion.savings_bytes,
+            optimized_cache_lines: blocks_spanned(suggestion.optimized_size, target.cache_line)
+                as u64,
+        });
+        if worst.as_ref().is_none_or(|w| suggestion.savings_bytes < w.savings_bytes) {
+            worst = Some(suggestion);
+        }
+    }
+
+    let mut worst = worst.expect("targets is not empty");
+    worst.targets = summaries;
+    worst
+}
+
+fn blocks_spanned(size: u64, block: u32) -> u32 {
+    size.div_ceil(block.max(1) as u64).min(u32::MAX as u64) as u32
+}
+
+/// Members whose bytes lie on more than one cache line.
+fn split_members(layout: &StructLayout, cache_line_size: u32) -> u32 {
+    let line = cache_line_size as u64;
+    let split = layout.members.iter().filter(|m| m.crosses_line(line)).count();
+    split.min(u32::MAX as usize) as u32
+}
+
+/// Densities are percentages; compare them at a fixed precision since `f64` is not `Ord`.
+fn ordered_density(density: f64) -> u64 {
+    (density.max(0.0) * 1e6) as u64
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::types::MemberLayout;
+
+    fn profile(
+        name: &'static str,
+        cache_line: u32,
+        prefetch: u32,
+        max_align: u64,
+    ) -> TargetProfile {
+        TargetProfile { name, cache_line, prefetch_size: prefetch, max_align }
+    }
+
+    fn layout() -> StructLayout {
+        let mut layout = StructLayout::new("Counters".to_string(), 128, Some(8));
+        layout.members = vec![
+            MemberLayout::new("head", "std::atomic<long>", Some(0), Some(8)).with_atomic(true),
+            MemberLayout::new("buf", "char[56]", Some(8), Some(56)),
+            MemberLayout::new("tail", "std::atomic<long>", Some(64), Some(8)).with_atomic(true),
+            MemberLayout::new("big", "long double", Some(96), Some(16)),
+            MemberLayout::new("flag", "char", Some(112), Some(1)),
+        ];
+        layout
+    }
+
+    #[test]
+    fn worst_target_wins_and_every_target_is_reported() {
+        let mut layout = layout();
+        let targets = [profile("wide", 128, 128, 16), profile("x86", 64, 128, 16)];
+        analyze_layout_for_targets(&mut layout, &targets);
+
+        // 64-byte lines span more of them, so they are the worst case.
+        assert_eq!(layout.metrics.cache_lines_spanned, 2);
+        let figures: Vec<_> = layout
+            .metrics
+            .targets
+            .iter()
+            .map(|t| (t.target.as_str(), t.cache_lines_spanned, t.false_sharing_pairs))
+            .collect();
+        // The adjacent-line prefetcher puts head and tail in one 128-byte block on both.
+        assert_eq!(figures, [("wide", 1, 1), ("x86", 2, 1)]);
+        assert_eq!(layout.metrics.targets[1].prefetch_blocks_spanned, 1);
+    }
+
+    #[test]
+    fn suggestion_that_saves_least_is_kept() {
+        let mut layout = StructLayout::new("Mixed".to_string(), 32, None);
+        layout.members = vec![
+            MemberLayout::new("a", "char", Some(0), Some(1)),
+            MemberLayout::new("x", "__int128", Some(16), Some(16)),
+        ];
+        let targets = [profile("i386", 64, 64, 4), profile("x86", 64, 128, 16)];
+        let suggestion = optimize_layout_for_targets(&layout, &targets);
+
+        let sizes: Vec<_> =
+            suggestion.targets.iter().map(|t| (t.target.as_str(), t.optimized_size)).collect();
+        assert_eq!(sizes, [("i386", 20), ("x86", 32)]);
+        assert_eq!((suggestion.struct_alignment, suggestion.savings_bytes), (16, 0));
+    }
+}
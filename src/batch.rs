@@ -0,0 +1,111 @@
+use crate::dwarf::{StructFingerprint, struct_fingerprint};
+use crate::types::StructLayout;
+use serde::Serialize;
+use std::collections::HashMap;
+use std::collections::hash_map::Entry;
+
+/// Struct layouts of several binaries, with each distinct layout kept once.
+#[derive(Debug, Clone, Serialize)]
+pub struct BatchReport {
+    /// The analyzed binaries, in input order.
+    pub binaries: Vec<String>,
+    pub structs: Vec<BatchStruct>,
+}
+
+/// One distinct layout and the binaries it was found in.
+#[derive(Debug, Clone, Serialize)]
+pub struct BatchStruct {
+    #[serde(flatten)]
+    pub layout: StructLayout,
+    /// Binaries containing this exact layout, in input order.
+    pub binaries: Vec<String>,
+}
+
+/// Merge per-binary layouts (before analysis). Layouts are identified by the fingerprint
+/// `DwarfContext::find_structs` deduplicates with, so a struct from a shared header is kept
+/// once however many binaries embed it, while a same-named struct that differs (other
+/// members, size or source location) stays a separate entry. Entries keep the order in
+/// which they were first seen.
+pub fn merge_layouts(per_binary: Vec<(String, Vec<StructLayout>)>) -> BatchReport {
+    let mut index: HashMap<StructFingerprint, usize> = HashMap::new();
+    let mut structs: Vec<BatchStruct> = Vec::new();
+    let mut binaries = Vec::with_capacity(per_binary.len());
+
+    for (binary, layouts) in per_binary {
+        for layout in layouts {
+            match index.entry(struct_fingerprint(&layout)) {
+                Entry::Occupied(entry) => {
+                    let seen_in = &mut structs[*entry.get()].binaries;
+                    if seen_in.last() != Some(&binary) {
+                        seen_in.push(binary.clone());
+                    }
+                }
+                Entry::Vacant(entry) => {
+                    entry.insert(structs.len());
+                    structs.push(BatchStruct { layout, binaries: vec![binary.clone()] });
+                }
+            }
+        }
+        binaries.push(binary);
+    }
+
+    BatchReport { binaries, structs }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::types::{MemberLayout, SourceLocation};
+
+    fn layout(name: &str, size: u64, line: u64) -> StructLayout {
+        let mut s = StructLayout::new(name.to_string(), size, Some(8));
+        s.members = vec![MemberLayout::new("a".to_string(), "int".to_string(), Some(0), Some(4))];
+        s.source_location = Some(SourceLocation { file: "types.h".to_string(), line });
+        s
+    }
+
+    #[test]
+    fn shared_layouts_are_merged() {
+        let report = merge_layouts(vec![
+            ("liba.so".to_string(), vec![layout("Order", 8, 3), layout("OnlyA", 8, 9)]),
+            ("libb.so".to_string(), vec![layout("Order", 8, 3)]),
+        ]);
+
+        assert_eq!(report.binaries, ["liba.so", "libb.so"]);
+        assert_eq!(report.structs.len(), 2);
+        assert_eq!(report.structs[0].layout.name, "Order");
+        assert_eq!(report.structs[0].binaries, ["liba.so", "libb.so"]);
+        assert_eq!(report.structs[1].binaries, ["liba.so"]);
+    }
+
+    #[test]
+    fn differing_layouts_stay_separate() {
+        let report = merge_layouts(vec![
+            ("a".to_string(), vec![layout("Order", 8, 3)]),
+            ("b".to_string(), vec![layout("Order", 16, 3)]),
+            ("c".to_string(), vec![layout("Order", 8, 4)]),
+        ]);
+
+        assert_eq!(report.structs.len(), 3);
+        assert!(report.structs.iter().all(|s| s.binaries.len() == 1));
+    }
+
+    #[test]
+    fn duplicates_within_a_binary_list_it_once() {
+        let report = merge_layouts(vec![(
+            "a".to_string(),
+            vec![layout("Order", 8, 3), layout("Order", 8, 3)],
+        )]);
+
+        assert_eq!(report.structs.len(), 1);
+        assert_eq!(report.structs[0].binaries, ["a"]);
+    }
+
+    #[test]
+    fn report_serializes_flat() {
+        let report = merge_layouts(vec![("a".to_string(), vec![layout("Order", 8, 3)])]);
+        let value = serde_json::to_value(&report).unwrap();
+        assert_eq!(value["structs"][0]["name"], "Order");
+        assert_eq!(value["structs"][0]["binaries"][0], "a");
+    }
+}
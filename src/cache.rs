@@ -0,0 +1,659 @@
+//! Persistent on-disk cache of extracted struct layouts.
+//!
+//! Extraction output is stored in a compact binary format keyed by the binary's
+//! identity (ELF build-id, Mach-O UUID, PE PDB signature, or a content hash as
+//! fallback) together with the tool version and the extraction options. Repeat
+//! runs against an unchanged artifact skip DWARF parsing entirely.
+//!
+//! A rebuilt binary gets a new identity, so each binary path also keeps the layouts of its
+//! individual compilation units, keyed by a hash of what extraction reads from each unit
+//! (see `dwarf::unit_hash`). After an edit only the recompiled units are parsed again.
+
+use crate::dwarf::{StructFingerprint, UnitCache, struct_fingerprint};
+use crate::error::Result;
+use crate::hash::{FNV_OFFSET_BASIS, fnv1a, fnv1a_words};
+use crate::intern::Name;
+use crate::loader::BinaryData;
+use crate::types::{MemberLayout, SourceLocation, StructLayout};
+use indexmap::IndexSet;
+use object::Object;
+use std::collections::HashMap;
+use std::fs;
+use std::path::{Path, PathBuf};
+use std::sync::Mutex;
+use std::sync::atomic::{AtomicU64, AtomicUsize, Ordering};
+
+/// File magic for cache entries.
+const MAGIC: &[u8; 8] = b"LAYAUDC\0";
+
+/// Bump whenever the encoding below or the extraction output changes.
+const FORMAT_VERSION: u32 = 3;
+
+const CACHE_EXTENSION: &str = "lacache";
+
+/// Identifies one extraction result: which binary, which tool version, which options.
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct CacheKey {
+    material: Vec<u8>,
+}
+
+impl CacheKey {
+    /// Build the key for extracting `binary` with the given options.
+    pub fn new(binary: &BinaryData, filter: Option<&str>, include_go_runtime: bool) -> Self {
+        let data: &[u8] = &binary.mmap;
+        let mut enc = Encoder::default();
+        enc.str(env!("CARGO_PKG_VERSION"));
+        match binary_identity(data) {
+            Some((kind, id)) => {
+                enc.str(kind);
+                enc.bytes(&id);
+            }
+            None => {
+                enc.str("content");
+                enc.u64(fnv1a_words(data));
+            }
+        }
+        // Stripping keeps the build-id but drops debug info, so the length is
+        // part of the identity as well.
+        enc.u64(data.len() as u64);
+        Self::finish(enc, filter, include_go_runtime)
+    }
+
+    /// Build the key for the per-unit layouts of whatever binary lives at `binary.path`.
+    /// Unlike `new`, this survives rebuilds; the units themselves carry content hashes.
+    pub fn for_units(binary: &BinaryData, filter: Option<&str>, include_go_runtime: bool) -> Self {
+        let path = fs::canonicalize(&binary.path).unwrap_or_else(|_| binary.path.clone());
+        let mut enc = Encoder::default();
+        enc.str(env!("CARGO_PKG_VERSION"));
+        enc.str("units");
+        enc.str(&path.to_string_lossy());
+        Self::finish(enc, filter, include_go_runtime)
+    }
+
+    /// Tell apart layouts extracted with `DwarfContext::with_name_index`, which may leave
+    /// out types the index does not list.
+    pub fn with_name_index(mut self, name_index: bool) -> Self {
+        if name_index {
+            self.material.extend_from_slice(b"name-index");
+        }
+        self
+    }
+
+    fn finish(mut enc: Encoder, filter: Option<&str>, include_go_runtime: bool) -> Self {
+        match filter {
+            Some(f) => {
+                enc.u8(1);
+                enc.str(f);
+            }
+            None => enc.u8(0),
+        }
+        enc.u8(include_go_runtime as u8);
+        Self { material: enc.buf }
+    }
+
+    fn file_name(&self) -> String {
+        format!("{:016x}.{}", fnv1a(FNV_OFFSET_BASIS, &self.material), CACHE_EXTENSION)
+    }
+}
+
+/// Directory-backed layout cache.
+pub struct LayoutCache {
+    dir: PathBuf,
+}
+
+impl LayoutCache {
+    pub fn new(dir: impl Into<PathBuf>) -> Self {
+        Self { dir: dir.into() }
+    }
+
+    pub fn dir(&self) -> &Path {
+        &self.dir
+    }
+
+    /// Look up cached layouts. Missing, stale, or corrupt entries are a miss.
+    pub fn load(&self, key: &CacheKey) -> Option<Vec<StructLayout>> {
+        let data = fs::read(self.dir.join(key.file_name())).ok()?;
+        decode(&data, key).map(|(layouts, _)| layouts)
+    }
+
+    /// Store layouts for `key`.
+    pub fn store(&self, key: &CacheKey, layouts: &[StructLayout]) -> Result<()> {
+        self.write(key, &encode(layouts, &[], key))
+    }
+
+    /// Load the per-unit layouts stored under `key` (from `CacheKey::for_units`). A missing,
+    /// stale, or corrupt entry yields an empty set, so every unit is extracted.
+    pub fn load_units(&self, key: &CacheKey) -> UnitLayouts {
+        let previous = fs::read(self.dir.join(key.file_name()))
+            .ok()
+            .and_then(|data| decode(&data, key))
+            .map(|(layouts, units)| {
+                units
+                    .into_iter()
+                    .map(|(hash, indices)| {
+                        (hash, indices.into_iter().map(|i| layouts[i].clone()).collect())
+                    })
+                    .collect()
+            })
+            .unwrap_or_default();
+        UnitLayouts {
+            state: Mutex::new(UnitState { previous, current: HashMap::new() }),
+            ..Default::default()
+        }
+    }
+
+    /// Store the units used by the last extraction through `units`; units that are no
+    /// longer in the binary are dropped. Layouts shared by several units are stored once.
+    pub fn store_units(&self, key: &CacheKey, units: &UnitLayouts) -> Result<()> {
+        let state = units.state.lock().unwrap_or_else(|e| e.into_inner());
+        let mut hashes: Vec<u64> = state.current.keys().copied().collect();
+        hashes.sort_unstable();
+
+        let mut table: Vec<&StructLayout> = Vec::new();
+        let mut index: HashMap<StructFingerprint, usize> = HashMap::new();
+        let mut entries = Vec::with_capacity(hashes.len());
+        for hash in hashes {
+            let indices = state.current[&hash]
+                .iter()
+                .map(|layout| {
+                    *index.entry(struct_fingerprint(layout)).or_insert_with(|| {
+                        table.push(layout);
+                        table.len() - 1
+                    })
+                })
+                .collect();
+            entries.push((hash, indices));
+        }
+        self.write(key, &encode(table, &entries, key))
+    }
+
+    /// The entry is written to a temporary file and renamed into place so concurrent
+    /// readers never observe a partial entry. Temporary names are unique per write, since
+    /// threads of one process (the sides of `diff`, `batch` workers) may store the same key.
+    fn write(&self, key: &CacheKey, data: &[u8]) -> Result<()> {
+        static WRITES: AtomicU64 = AtomicU64::new(0);
+        fs::create_dir_all(&self.dir)?;
+        let path = self.dir.join(key.file_name());
+        let tmp = self.dir.join(format!(
+            ".{}.{}.{}.tmp",
+            key.file_name(),
+            std::process::id(),
+            WRITES.fetch_add(1, Ordering::Relaxed)
+        ));
+        fs::write(&tmp, data)?;
+        if let Err(e) = fs::rename(&tmp, &path) {
+            let _ = fs::remove_file(&tmp);
+            return Err(e.into());
+        }
+        Ok(())
+    }
+}
+
+/// Layouts of individual compilation units, keyed by `dwarf::unit_hash`. Shared by the
+/// extraction workers: units found here are reused, everything extracted is recorded.
+#[derive(Default)]
+pub struct UnitLayouts {
+    state: Mutex<UnitState>,
+    reused: AtomicUsize,
+}
+
+#[derive(Default)]
+struct UnitState {
+    /// Units loaded from the cache and not yet seen in this run.
+    previous: HashMap<u64, Vec<StructLayout>>,
+    /// Units seen in this run; the set `store_units` writes back.
+    current: HashMap<u64, Vec<StructLayout>>,
+}
+
+impl UnitCache for UnitLayouts {
+    fn get(&self, hash: u64) -> Option<Vec<StructLayout>> {
+        let mut state = self.state.lock().unwrap_or_else(|e| e.into_inner());
+        let layouts = match state.current.get(&hash) {
+            Some(layouts) => layouts.clone(),
+            None => {
+                let layouts = state.previous.remove(&hash)?;
+                state.current.insert(hash, layouts.clone());
+                layouts
+            }
+        };
+        self.reused.fetch_add(1, Ordering::Relaxed);
+        Some(layouts)
+    }
+
+    fn insert(&self, hash: u64, layouts: &[StructLayout]) {
+        let mut state = self.state.lock().unwrap_or_else(|e| e.into_inner());
+        state.current.insert(hash, layouts.to_vec());
+    }
+}
+
+impl UnitLayouts {
+    /// Number of units served from the cache so far.
+    pub fn reused(&self) -> usize {
+        self.reused.load(Ordering::Relaxed)
+    }
+
+    /// Start over for the next extraction, reusing the units seen in this one.
+    pub fn carry_over(self) -> Self {
+        let state = self.state.into_inner().unwrap_or_else(|e| e.into_inner());
+        let state = UnitState { previous: state.current, current: HashMap::new() };
+        Self { state: Mutex::new(state), ..Default::default() }
+    }
+}
+
+/// Stable identity embedded by the linker, if the format carries one.
+fn binary_identity(data: &[u8]) -> Option<(&'static str, Vec<u8>)> {
+    let object = object::File::parse(data).ok()?;
+    if let Ok(Some(id)) = object.build_id() {
+        return Some(("gnu-build-id", id.to_vec()));
+    }
+    if let Ok(Some(uuid)) = object.mach_uuid() {
+        return Some(("macho-uuid", uuid.to_vec()));
+    }
+    if let Ok(Some(pdb)) = object.pdb_info() {
+        let mut id = pdb.guid().to_vec();
+        id.extend_from_slice(&pdb.age().to_le_bytes());
+        return Some(("pe-pdb", id));
+    }
+    None
+}
+
+// Layout:
+//   magic | format version (u32 LE) | key material | string table | structs | units
+//   | checksum (u64 LE)
+// Integers are LEB128, strings are indices into the string table. `units` lists, per unit
+// hash, the indices of the unit's structs; it is empty for whole-binary entries.
+
+fn encode<'l>(
+    layouts: impl IntoIterator<Item = &'l StructLayout, IntoIter: ExactSizeIterator>,
+    units: &[(u64, Vec<usize>)],
+    key: &CacheKey,
+) -> Vec<u8> {
+    fn intern<'a>(strings: &mut IndexSet<&'a str>, enc: &mut Encoder, s: &'a str) {
+        let (idx, _) = strings.insert_full(s);
+        enc.u64(idx as u64);
+    }
+
+    let mut strings: IndexSet<&str> = IndexSet::new();
+    let mut body = Encoder::default();
+
+    let layouts = layouts.into_iter();
+    body.u64(layouts.len() as u64);
+    for layout in layouts {
+        intern(&mut strings, &mut body, &layout.name);
+        body.u64(layout.size);
+        body.opt_u64(layout.alignment);
+        match &layout.source_location {
+            Some(loc) => {
+                body.u8(1);
+                intern(&mut strings, &mut body, &loc.file);
+                body.u64(loc.line);
+            }
+            None => body.u8(0),
+        }
+        body.u64(layout.members.len() as u64);
+        for member in &layout.members {
+            intern(&mut strings, &mut body, &member.name);
+            intern(&mut strings, &mut body, &member.type_name);
+            body.opt_u64(member.offset);
+            body.opt_u64(member.size);
+            body.opt_u64(member.bit_offset);
+            body.opt_u64(member.bit_size);
+            body.u8(member.is_atomic as u8);
+        }
+    }
+    body.u64(units.len() as u64);
+    for (hash, indices) in units {
+        body.buf.extend_from_slice(&hash.to_le_bytes());
+        body.u64(indices.len() as u64);
+        for &index in indices {
+            body.u64(index as u64);
+        }
+    }
+
+    let mut payload = Encoder::default();
+    payload.u64(strings.len() as u64);
+    for s in &strings {
+        payload.str(s);
+    }
+    payload.buf.extend_from_slice(&body.buf);
+
+    let mut out = Encoder::default();
+    out.buf.extend_from_slice(MAGIC);
+    out.buf.extend_from_slice(&FORMAT_VERSION.to_le_bytes());
+    out.bytes(&key.material);
+    out.buf.extend_from_slice(&payload.buf);
+    let checksum = fnv1a(FNV_OFFSET_BASIS, &out.buf);
+    out.buf.extend_from_slice(&checksum.to_le_bytes());
+    out.buf
+}
+
+type UnitTable = Vec<(u64, Vec<usize>)>;
+
+fn decode(data: &[u8], key: &CacheKey) -> Option<(Vec<StructLayout>, UnitTable)> {
+    let (content, checksum) = data.split_at_checked(data.len().checked_sub(8)?)?;
+    if fnv1a(FNV_OFFSET_BASIS, content) != u64::from_le_bytes(checksum.try_into().ok()?) {
+        return None;
+    }
+
+    let mut dec = Decoder { data: content, pos: 0 };
+    if dec.take(MAGIC.len())? != MAGIC {
+        return None;
+    }
+    if u32::from_le_bytes(dec.take(4)?.try_into().ok()?) != FORMAT_VERSION {
+        return None;
+    }
+    // Guards against file-name hash collisions as well as stale entries.
+    if dec.bytes()? != key.material.as_slice() {
+        return None;
+    }
+
+    let string_count = dec.len()?;
+    let mut strings = Vec::with_capacity(string_count);
+    for _ in 0..string_count {
+        strings.push(Name::from(dec.str()?));
+    }
+    let string = |dec: &mut Decoder<'_>| strings.get(usize::try_from(dec.u64()?).ok()?).cloned();
+
+    let struct_count = dec.len()?;
+    let mut layouts = Vec::with_capacity(struct_count);
+    for _ in 0..struct_count {
+        let name = string(&mut dec)?.into();
+        let size = dec.u64()?;
+        let alignment = dec.opt_u64()?;
+        let mut layout = StructLayout::new(name, size, alignment);
+        if dec.flag()? {
+            let file = string(&mut dec)?.into();
+            let line = dec.u64()?;
+            layout.source_location = Some(SourceLocation { file, line });
+        }
+        let member_count = dec.len()?;
+        layout.members.reserve(member_count);
+        for _ in 0..member_count {
+            let name = string(&mut dec)?;
+            let type_name = string(&mut dec)?;
+            let offset = dec.opt_u64()?;
+            let size = dec.opt_u64()?;
+            let mut member = MemberLayout::new(name, type_name, offset, size);
+            member.bit_offset = dec.opt_u64()?;
+            member.bit_size = dec.opt_u64()?;
+            layout.members.push(member.with_atomic(dec.flag()?));
+        }
+        layouts.push(layout);
+    }
+
+    let unit_count = dec.len()?;
+    let mut units = Vec::with_capacity(unit_count);
+    for _ in 0..unit_count {
+        let hash = u64::from_le_bytes(dec.take(8)?.try_into().ok()?);
+        let index_count = dec.len()?;
+        let mut indices = Vec::with_capacity(index_count);
+        for _ in 0..index_count {
+            let index = usize::try_from(dec.u64()?).ok()?;
+            if index >= layouts.len() {
+                return None;
+            }
+            indices.push(index);
+        }
+        units.push((hash, indices));
+    }
+
+    if dec.pos != content.len() {
+        return None;
+    }
+    Some((layouts, units))
+}
+
+#[derive(Default)]
+struct Encoder {
+    buf: Vec<u8>,
+}
+
+impl Encoder {
+    fn u8(&mut self, v: u8) {
+        self.buf.push(v);
+    }
+
+    fn u64(&mut self, mut v: u64) {
+        loop {
+            let byte = (v & 0x7f) as u8;
+            v >>= 7;
+            if v == 0 {
+                self.buf.push(byte);
+                return;
+            }
+            self.buf.push(byte | 0x80);
+        }
+    }
+
+    fn opt_u64(&mut self, v: Option<u64>) {
+        match v {
+            Some(v) => {
+                self.u8(1);
+                self.u64(v);
+            }
+            None => self.u8(0),
+        }
+    }
+
+    fn bytes(&mut self, b: &[u8]) {
+        self.u64(b.len() as u64);
+        self.buf.extend_from_slice(b);
+    }
+
+    fn str(&mut self, s: &str) {
+        self.bytes(s.as_bytes());
+    }
+}
+
+struct Decoder<'a> {
+    data: &'a [u8],
+    pos: usize,
+}
+
+impl<'a> Decoder<'a> {
+    fn take(&mut self, n: usize) -> Option<&'a [u8]> {
+        let end = self.pos.checked_add(n)?;
+        let slice = self.data.get(self.pos..end)?;
+        self.pos = end;
+        Some(slice)
+    }
+
+    fn u8(&mut self) -> Option<u8> {
+        self.take(1).map(|b| b[0])
+    }
+
+    fn flag(&mut self) -> Option<bool> {
+        match self.u8()? {
+            0 => Some(false),
+            1 => Some(true),
+            _ => None,
+        }
+    }
+
+    fn u64(&mut self) -> Option<u64> {
+        let mut result = 0u64;
+        for shift in (0..64).step_by(7) {
+            let byte = self.u8()?;
+            result |= ((byte & 0x7f) as u64).checked_shl(shift)?;
+            if byte & 0x80 == 0 {
+                return Some(result);
+            }
+        }
+        None
+    }
+
+    /// A length or index; bounded by the remaining input so corrupt counts
+    /// cannot trigger huge allocations.
+    fn len(&mut self) -> Option<usize> {
+        let v = usize::try_from(self.u64()?).ok()?;
+        (v <= self.data.len() - self.pos).then_some(v)
+    }
+
+    fn opt_u64(&mut self) -> Option<Option<u64>> {
+        if self.flag()? { self.u64().map(Some) } else { Some(None) }
+    }
+
+    fn bytes(&mut self) -> Option<&'a [u8]> {
+        let n = self.len()?;
+        self.take(n)
+    }
+
+    fn str(&mut self) -> Option<&'a str> {
+        std::str::from_utf8(self.bytes()?).ok()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn sample_layouts() -> Vec<StructLayout> {
+        let mut a = StructLayout::new("Foo".to_string(), 16, Some(8));
+        a.source_location = Some(SourceLocation { file: "foo.c".to_string(), line: 42 });
+        a.members.push(MemberLayout::new("x", "int", Some(0), Some(4)));
+        a.members.push(MemberLayout::new("y", "atomic<u64>", Some(8), Some(8)).with_atomic(true));
+        let mut flags = MemberLayout::new("flags", "int", Some(4), Some(4));
+        flags.bit_offset = Some(3);
+        flags.bit_size = Some(5);
+        a.members.push(flags);
+
+        let mut b = StructLayout::new("Bar".to_string(), 0, None);
+        b.members.push(MemberLayout::new("opaque", "unknown", None, None));
+        vec![a, b]
+    }
+
+    fn key(tag: &str) -> CacheKey {
+        let mut enc = Encoder::default();
+        enc.str(tag);
+        CacheKey { material: enc.buf }
+    }
+
+    fn assert_same(a: &[StructLayout], b: &[StructLayout]) {
+        assert_eq!(serde_json::to_string(a).unwrap(), serde_json::to_string(b).unwrap());
+    }
+
+    #[test]
+    fn roundtrip_preserves_layouts() {
+        let layouts = sample_layouts();
+        let k = key("k");
+        let (decoded, units) = decode(&encode(&layouts, &[], &k), &k).expect("decode");
+        assert_same(&layouts, &decoded);
+        assert!(units.is_empty());
+    }
+
+    #[test]
+    fn strings_are_interned() {
+        let mut layouts = Vec::new();
+        for i in 0..100 {
+            let mut s = StructLayout::new(format!("S{}", i), 8, Some(8));
+            s.members.push(MemberLayout::new("field", "some::long::type::Name", Some(0), Some(8)));
+            layouts.push(s);
+        }
+        let encoded = encode(&layouts, &[], &key("k"));
+        let occurrences = encoded.windows(22).filter(|w| *w == b"some::long::type::Name").count();
+        assert_eq!(occurrences, 1);
+    }
+
+    #[test]
+    fn concurrent_stores_of_one_key_stay_readable() {
+        let dir = tempfile::tempdir().expect("tempdir");
+        let cache = LayoutCache::new(dir.path());
+        let (k, layouts) = (key("k"), sample_layouts());
+        std::thread::scope(|scope| {
+            for _ in 0..4 {
+                scope.spawn(|| {
+                    for _ in 0..25 {
+                        cache.store(&k, &layouts).expect("store");
+                    }
+                });
+            }
+        });
+        assert_same(&layouts, &cache.load(&k).expect("hit"));
+        let leftovers: Vec<_> = fs::read_dir(dir.path()).unwrap().collect();
+        assert_eq!(leftovers.len(), 1, "temporary files left behind");
+    }
+
+    #[test]
+    fn key_mismatch_is_a_miss() {
+        let encoded = encode(&sample_layouts(), &[], &key("a"));
+        assert!(decode(&encoded, &key("b")).is_none());
+    }
+
+    #[test]
+    fn corruption_is_a_miss() {
+        let k = key("k");
+        let encoded = encode(&sample_layouts(), &[], &k);
+        for cut in [0, 1, 8, encoded.len() / 2, encoded.len() - 1] {
+            assert!(decode(&encoded[..cut], &k).is_none());
+        }
+        let mut flipped = encoded.clone();
+        let mid = flipped.len() / 2;
+        flipped[mid] ^= 0xff;
+        assert!(decode(&flipped, &k).is_none());
+    }
+
+    #[test]
+    fn varint_roundtrip_extremes() {
+        let mut enc = Encoder::default();
+        for v in [0, 1, 127, 128, 300, u32::MAX as u64, u64::MAX] {
+            enc.u64(v);
+        }
+        let mut dec = Decoder { data: &enc.buf, pos: 0 };
+        for v in [0, 1, 127, 128, 300, u32::MAX as u64, u64::MAX] {
+            assert_eq!(dec.u64(), Some(v));
+        }
+    }
+
+    #[test]
+    fn store_and_load_through_directory() {
+        let dir = tempfile::tempdir().expect("tempdir");
+        let cache = LayoutCache::new(dir.path().join("nested"));
+        let k = key("k");
+        assert!(cache.load(&k).is_none());
+        cache.store(&k, &sample_layouts()).expect("store");
+        assert_same(&sample_layouts(), &cache.load(&k).expect("hit"));
+    }
+
+    #[test]
+    fn unit_layouts_roundtrip_and_drop_unused_units() {
+        let dir = tempfile::tempdir().expect("tempdir");
+        let cache = LayoutCache::new(dir.path());
+        let k = key("units");
+        let [foo, bar] = <[StructLayout; 2]>::try_from(sample_layouts()).unwrap();
+
+        let units = cache.load_units(&k);
+        assert!(units.get(1).is_none());
+        units.insert(1, std::slice::from_ref(&foo));
+        units.insert(2, &[foo.clone(), bar.clone()]);
+        units.insert(3, &[]);
+        cache.store_units(&k, &units).expect("store");
+        // Foo is shared by two units but stored once.
+        let encoded = fs::read(dir.path().join(k.file_name())).unwrap();
+        assert_eq!(encoded.windows(5).filter(|w| *w == b"foo.c").count(), 1);
+
+        let units = cache.load_units(&k);
+        assert_same(&units.get(2).expect("unit 2"), &[foo.clone(), bar]);
+        assert!(units.get(3).expect("unit 3").is_empty());
+        assert_eq!(units.reused(), 2);
+        cache.store_units(&k, &units).expect("store");
+
+        // Unit 1 was not seen in the second run.
+        let units = cache.load_units(&k);
+        assert!(units.get(1).is_none());
+        assert!(units.get(2).is_some());
+        let units = units.carry_over();
+        assert_eq!(units.reused(), 0);
+        assert!(units.get(2).is_some());
+        assert!(units.get(3).is_none());
+        // A whole-binary key never reads a unit entry.
+        assert!(cache.load(&key("other")).is_none());
+    }
+
+    #[test]
+    fn unit_index_out_of_range_is_a_miss() {
+        let k = key("k");
+        let layouts = sample_layouts();
+        assert!(decode(&encode(&layouts, &[(7, vec![0, 1])], &k), &k).is_some());
+        assert!(decode(&encode(&layouts, &[(7, vec![2])], &k), &k).is_none());
+    }
+}
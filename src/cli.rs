@@ -1,3 +1,4 @@
+use crate::diff::Regression;
 use clap::{Parser, Subcommand, ValueEnum};
 use std::path::PathBuf;
 
@@ -16,6 +17,29 @@ Example:\n  layout-audit inspect ./target/debug/myapp --filter MyStruct"
 pub struct Cli {
     #[command(subcommand)]
     pub command: Commands,
+
+    /// Report wall time and peak memory per pipeline stage, with extraction counters, on
+    /// stderr when the command finishes (`--timings=json` for one JSON document)
+    #[arg(
+        long,
+        global = true,
+        value_enum,
+        value_name = "FORMAT",
+        num_args = 0..=1,
+        require_equals = true,
+        default_missing_value = "table"
+    )]
+    pub timings: Option<TimingsFormat>,
+
+    /// Write the --timings report to FILE instead of stderr (implies --timings)
+    #[arg(long, global = true, value_name = "FILE")]
+    pub timings_file: Option<PathBuf>,
+
+    /// With --filter, trust the binary's .debug_pubtypes index to list every type of the
+    /// units it covers and skip the rest of those units. Faster, but types the index leaves
+    /// out (such as function-local types) are not reported
+    #[arg(long, global = true)]
+    pub name_index: bool,
 }
 
 #[derive(Subcommand)]
@@ -30,7 +54,7 @@ pub enum Commands {
         #[arg(short, long)]
         filter: Option<String>,
 
-        /// Output format (table, json, sarif)
+        /// Output format (table, json, ndjson, sarif)
         #[arg(short, long, value_enum, default_value = "table")]
         output: OutputFormat,
 
@@ -42,6 +66,11 @@ pub enum Commands {
         #[arg(short = 'n', long)]
         top: Option<usize>,
 
+        /// Render member tables for only the first N structs (by sort order), list the rest
+        /// one line each and end with totals over all of them (table output)
+        #[arg(long, value_name = "N")]
+        detail: Option<usize>,
+
         /// Show only structs with at least N bytes of padding
         #[arg(long)]
         min_padding: Option<u64>,
@@ -54,6 +83,12 @@ pub enum Commands {
         #[arg(long, default_value = "64", value_parser = clap::value_parser!(u32).range(1..))]
         cache_line: u32,
 
+        /// Evaluate against these target profiles, comma-separated, and report the worst
+        /// case: x86-64, i386, aarch64, apple-m, graviton, arm, riscv64, ppc64, s390x, or
+        /// auto for the binary's own architecture
+        #[arg(long, value_name = "TARGET", value_delimiter = ',', conflicts_with = "cache_line")]
+        target: Vec<String>,
+
         /// Pretty-print JSON output
         #[arg(long)]
         pretty: bool,
@@ -62,18 +97,46 @@ pub enum Commands {
         #[arg(long)]
         warn_false_sharing: bool,
 
+        /// List every pair of atomics sharing a cache line instead of one warning per line
+        /// (implies --warn-false-sharing)
+        #[arg(long)]
+        false_sharing_pairs: bool,
+
+        /// Access profile to report per-cache-line access heat from: CSV
+        /// `struct,offset,samples` lines or `perf report -s type,typeoff` output
+        #[arg(long, value_name = "FILE")]
+        profile: Option<PathBuf>,
+
+        /// Also report padding with embedded structs and arrays of structs flattened,
+        /// attributed to the inner types responsible
+        #[arg(long)]
+        nested: bool,
+
         /// Include Go runtime internal types (filtered by default)
         #[arg(long)]
         include_go_runtime: bool,
+
+        /// Number of worker threads for DWARF extraction (0 = one per CPU)
+        #[arg(short = 'j', long, default_value = "1")]
+        jobs: usize,
+
+        /// Directory for caching extracted layouts between runs (keyed by build-id)
+        #[arg(long, value_name = "DIR")]
+        cache_dir: Option<PathBuf>,
+
+        /// Also write the extracted layouts (those matching --filter) to FILE as a layout
+        /// snapshot, which `diff` and `check` accept in place of the binary
+        #[arg(long, value_name = "FILE")]
+        write_snapshot: Option<PathBuf>,
     },
 
     /// Compare struct layouts between two binaries
     Diff {
-        /// Path to the old (baseline) binary
+        /// Path to the old (baseline) binary or layout snapshot
         #[arg(value_name = "OLD")]
         old: PathBuf,
 
-        /// Path to the new binary
+        /// Path to the new binary or layout snapshot
         #[arg(value_name = "NEW")]
         new: PathBuf,
 
@@ -89,18 +152,30 @@ pub enum Commands {
         #[arg(long, default_value = "64", value_parser = clap::value_parser!(u32).range(1..))]
         cache_line: u32,
 
-        /// Exit with error code 1 if any regressions found (size or padding increased)
+        /// Exit with error code 1 if any regressions found (see --regression-on)
         #[arg(long)]
         fail_on_regression: bool,
 
+        /// Changes that count as regressions, comma-separated
+        #[arg(long, value_enum, value_delimiter = ',', default_value = "size,padding")]
+        regression_on: Vec<Regression>,
+
         /// Include Go runtime internal types (filtered by default)
         #[arg(long)]
         include_go_runtime: bool,
+
+        /// Number of worker threads for DWARF extraction (0 = one per CPU)
+        #[arg(short = 'j', long, default_value = "1")]
+        jobs: usize,
+
+        /// Directory for caching extracted layouts between runs (keyed by build-id)
+        #[arg(long, value_name = "DIR")]
+        cache_dir: Option<PathBuf>,
     },
 
     /// Check struct layouts against budget constraints
     Check {
-        /// Path to the binary file to analyze
+        /// Path to the binary file or layout snapshot to analyze
         #[arg(value_name = "BINARY")]
         binary: PathBuf,
 
@@ -116,9 +191,23 @@ pub enum Commands {
         #[arg(long, default_value = "64", value_parser = clap::value_parser!(u32).range(1..))]
         cache_line: u32,
 
+        /// Evaluate against these target profiles, comma-separated, and report the worst
+        /// case: x86-64, i386, aarch64, apple-m, graviton, arm, riscv64, ppc64, s390x, or
+        /// auto for the binary's own architecture
+        #[arg(long, value_name = "TARGET", value_delimiter = ',', conflicts_with = "cache_line")]
+        target: Vec<String>,
+
         /// Include Go runtime internal types (filtered by default)
         #[arg(long)]
         include_go_runtime: bool,
+
+        /// Number of worker threads for DWARF extraction (0 = one per CPU)
+        #[arg(short = 'j', long, default_value = "1")]
+        jobs: usize,
+
+        /// Directory for caching extracted layouts between runs (keyed by build-id)
+        #[arg(long, value_name = "DIR")]
+        cache_dir: Option<PathBuf>,
     },
 
     /// Suggest optimal field ordering to minimize padding
@@ -151,10 +240,146 @@ pub enum Commands {
         #[arg(long, default_value = "8", value_parser = clap::value_parser!(u64).range(1..))]
         max_align: u64,
 
+        /// Evaluate against these target profiles, comma-separated, and report the worst
+        /// case: x86-64, i386, aarch64, apple-m, graviton, arm, riscv64, ppc64, s390x, or
+        /// auto for the binary's own architecture
+        #[arg(
+            long,
+            value_name = "TARGET",
+            value_delimiter = ',',
+            conflicts_with_all = ["cache_line", "max_align"]
+        )]
+        target: Vec<String>,
+
         /// Sort suggestions by savings amount (largest first)
         #[arg(long)]
         sort_by_savings: bool,
 
+        /// Reordering strategy
+        #[arg(long, value_enum, default_value = "padding")]
+        strategy: SuggestStrategy,
+
+        /// Fields to keep within one cache line, as STRUCT:FIELD,FIELD,... (repeatable;
+        /// requires --strategy cache-line)
+        #[arg(long, value_name = "STRUCT:FIELDS")]
+        keep_together: Vec<String>,
+
+        /// Fields a hot loop reads, as STRUCT:FIELD,FIELD,... (repeatable; requires
+        /// --strategy split). Without it, split uses the fields --profile finds hottest
+        #[arg(long, value_name = "STRUCT:FIELDS")]
+        hot: Vec<String>,
+
+        /// Array length the split strategy measures a hot loop over
+        #[arg(long, default_value = "1024", value_parser = clap::value_parser!(u64).range(1..))]
+        elements: u64,
+
+        /// Access profile (as for `inspect --profile`); sampled structs get an order that
+        /// packs their hottest fields into the first cache line
+        #[arg(long, value_name = "FILE")]
+        profile: Option<PathBuf>,
+
+        /// Disable colored output
+        #[arg(long)]
+        no_color: bool,
+
+        /// Include Go runtime internal types (filtered by default)
+        #[arg(long)]
+        include_go_runtime: bool,
+
+        /// Number of worker threads for DWARF extraction (0 = one per CPU)
+        #[arg(short = 'j', long, default_value = "1")]
+        jobs: usize,
+
+        /// Directory for caching extracted layouts between runs (keyed by build-id)
+        #[arg(long, value_name = "DIR")]
+        cache_dir: Option<PathBuf>,
+    },
+
+    /// Analyze many binaries at once, merging identical layouts across them
+    Batch {
+        /// Binaries to analyze; a directory contributes every file directly inside it
+        #[arg(value_name = "PATH", required = true)]
+        paths: Vec<PathBuf>,
+
+        /// Filter structs by name (substring match)
+        #[arg(short, long)]
+        filter: Option<String>,
+
+        /// Output format (table, json)
+        #[arg(short, long, value_enum, default_value = "table")]
+        output: OutputFormat,
+
+        /// Sort structs by field
+        #[arg(short, long, value_enum, default_value = "name")]
+        sort_by: SortField,
+
+        /// Show only the top N structs (by sort order)
+        #[arg(short = 'n', long)]
+        top: Option<usize>,
+
+        /// Show only structs with at least N bytes of padding
+        #[arg(long)]
+        min_padding: Option<u64>,
+
+        /// Disable colored output
+        #[arg(long)]
+        no_color: bool,
+
+        /// Cache line size in bytes (must be > 0)
+        #[arg(long, default_value = "64", value_parser = clap::value_parser!(u32).range(1..))]
+        cache_line: u32,
+
+        /// Pretty-print JSON output
+        #[arg(long)]
+        pretty: bool,
+
+        /// Include Go runtime internal types (filtered by default)
+        #[arg(long)]
+        include_go_runtime: bool,
+
+        /// Number of binaries analyzed concurrently (0 = one per CPU)
+        #[arg(short = 'j', long, default_value = "0")]
+        jobs: usize,
+
+        /// Directory for caching extracted layouts between runs (keyed by build-id)
+        #[arg(long, value_name = "DIR")]
+        cache_dir: Option<PathBuf>,
+    },
+
+    /// Rank structs by padding multiplied by live instance counts
+    Footprint {
+        /// Path to the binary file to analyze
+        #[arg(value_name = "BINARY")]
+        binary: PathBuf,
+
+        /// Instance counts, one `name: count` (or `name,count`) line per struct
+        #[arg(long, value_name = "FILE")]
+        instances: PathBuf,
+
+        /// Filter structs by name (substring match)
+        #[arg(short, long)]
+        filter: Option<String>,
+
+        /// Output format (table, json)
+        #[arg(short, long, value_enum, default_value = "table")]
+        output: OutputFormat,
+
+        /// Show only the top N structs (by wasted bytes)
+        #[arg(short = 'n', long)]
+        top: Option<usize>,
+
+        /// Cache line size in bytes (must be > 0)
+        #[arg(long, default_value = "64", value_parser = clap::value_parser!(u32).range(1..))]
+        cache_line: u32,
+
+        /// Maximum alignment to assume for types (typically 8 on 64-bit)
+        #[arg(long, default_value = "8", value_parser = clap::value_parser!(u64).range(1..))]
+        max_align: u64,
+
+        /// Pretty-print JSON output
+        #[arg(long)]
+        pretty: bool,
+
         /// Disable colored output
         #[arg(long)]
         no_color: bool,
@@ -162,6 +387,91 @@ pub enum Commands {
         /// Include Go runtime internal types (filtered by default)
         #[arg(long)]
         include_go_runtime: bool,
+
+        /// Number of worker threads for DWARF extraction (0 = one per CPU)
+        #[arg(short = 'j', long, default_value = "1")]
+        jobs: usize,
+
+        /// Directory for caching extracted layouts between runs (keyed by build-id)
+        #[arg(long, value_name = "DIR")]
+        cache_dir: Option<PathBuf>,
+    },
+
+    /// Rank structs by the functions that take them as parameters, optionally weighted by
+    /// a perf profile of the same binary
+    Hotspots {
+        /// Path to the binary file to analyze
+        #[arg(value_name = "BINARY")]
+        binary: PathBuf,
+
+        /// Function profile: `perf report --stdio --no-children -s sym` output, or
+        /// `symbol,samples` lines
+        #[arg(long, value_name = "FILE")]
+        perf: Option<PathBuf>,
+
+        /// Filter structs by name (substring match)
+        #[arg(short, long)]
+        filter: Option<String>,
+
+        /// Output format (table, json)
+        #[arg(short, long, value_enum, default_value = "table")]
+        output: OutputFormat,
+
+        /// Show only the top N structs (by rank)
+        #[arg(short = 'n', long)]
+        top: Option<usize>,
+
+        /// Cache line size in bytes (must be > 0)
+        #[arg(long, default_value = "64", value_parser = clap::value_parser!(u32).range(1..))]
+        cache_line: u32,
+
+        /// Pretty-print JSON output
+        #[arg(long)]
+        pretty: bool,
+
+        /// Disable colored output
+        #[arg(long)]
+        no_color: bool,
+
+        /// Include Go runtime internal types (filtered by default)
+        #[arg(long)]
+        include_go_runtime: bool,
+
+        /// Number of worker threads for DWARF extraction (0 = one per CPU)
+        #[arg(short = 'j', long, default_value = "1")]
+        jobs: usize,
+    },
+
+    /// Keep a binary's layouts in memory and answer queries over a local TCP socket,
+    /// re-indexing whenever the binary changes
+    Serve {
+        /// Path to the binary file to serve
+        #[arg(value_name = "BINARY")]
+        binary: PathBuf,
+
+        /// Address to listen on; port 0 picks a free port (the bound address is printed)
+        #[arg(long, value_name = "ADDR", default_value = "127.0.0.1:7463")]
+        listen: String,
+
+        /// How often to check the binary for changes, in milliseconds
+        #[arg(long, default_value = "500", value_parser = clap::value_parser!(u64).range(1..))]
+        poll_ms: u64,
+
+        /// Cache line size in bytes (must be > 0)
+        #[arg(long, default_value = "64", value_parser = clap::value_parser!(u32).range(1..))]
+        cache_line: u32,
+
+        /// Include Go runtime internal types (filtered by default)
+        #[arg(long)]
+        include_go_runtime: bool,
+
+        /// Number of worker threads for DWARF extraction (0 = one per CPU)
+        #[arg(short = 'j', long, default_value = "1")]
+        jobs: usize,
+
+        /// Directory for caching extracted layouts between runs (keyed by build-id)
+        #[arg(long, value_name = "DIR")]
+        cache_dir: Option<PathBuf>,
     },
 }
 
@@ -169,9 +479,17 @@ pub enum Commands {
 pub enum OutputFormat {
     Table,
     Json,
+    /// One JSON object per struct per line, streamed as structs are analyzed (inspect only)
+    Ndjson,
     Sarif,
 }
 
+#[derive(Copy, Clone, PartialEq, Eq, ValueEnum)]
+pub enum TimingsFormat {
+    Table,
+    Json,
+}
+
 #[derive(Copy, Clone, PartialEq, Eq, ValueEnum)]
 pub enum SortField {
     /// Sort by struct name (alphabetical)
@@ -183,3 +501,15 @@ pub enum SortField {
     /// Sort by padding percentage (worst efficiency first)
     PaddingPct,
 }
+
+#[derive(Copy, Clone, PartialEq, Eq, ValueEnum)]
+pub enum SuggestStrategy {
+    /// Minimize padding
+    Padding,
+    /// Minimize cache lines: keep marked or profile-hot fields within one line and give
+    /// atomics separate lines (exact search for small structs, bounded heuristic otherwise)
+    CacheLine,
+    /// Propose a hot/cold split or struct-of-arrays for structs with hot fields, sized by
+    /// the cache lines a loop over the hot fields touches
+    Split,
+}
@@ -1,6 +1,9 @@
+use crate::analysis::{analyze_false_sharing_pairs, gcd};
+use crate::dwarf::{fingerprint_hash, same_fingerprint};
 use crate::types::{SourceLocation, StructLayout};
+use clap::ValueEnum;
 use serde::Serialize;
-use std::collections::{BTreeMap, BTreeSet};
+use std::collections::{BTreeMap, BTreeSet, HashMap};
 
 /// Penalty for matching structs with mismatched source locations.
 /// Large enough to dominate all other scoring factors, preventing cross-location matching.
@@ -13,6 +16,29 @@ const SCORE_SIZE_MATCH: i64 = 2; // Size matches
 const SCORE_OFFSET_MATCH: i64 = 1; // Offset matches
 const SCORE_MEMBER_OVERLAP: i64 = 10; // Per overlapping member name
 
+/// Page size assumed for array stride figures.
+pub const PAGE_SIZE: u64 = 4096;
+
+/// A kind of layout change `diff` can fail or flag on.
+#[derive(Copy, Clone, Debug, PartialEq, Eq, ValueEnum)]
+pub enum Regression {
+    /// Struct size increased
+    Size,
+    /// Padding bytes increased
+    Padding,
+    /// Struct spans more cache lines
+    CacheLines,
+    /// A member now straddles a cache line boundary
+    LineSplits,
+    /// A new pair of atomics shares a cache line
+    FalseSharing,
+    /// Elements of an array of the struct each touch more cache lines on average
+    Stride,
+}
+
+/// What `DiffResult::has_regressions` counts as a regression.
+pub const DEFAULT_REGRESSIONS: &[Regression] = &[Regression::Size, Regression::Padding];
+
 #[derive(Debug, Clone, Serialize)]
 pub struct DiffResult {
     pub added: Vec<StructSummary>,
@@ -44,6 +70,136 @@ pub struct StructChange {
     pub source_location: Option<SourceLocation>,
     #[serde(skip_serializing_if = "Option::is_none")]
     pub old_source_location: Option<SourceLocation>,
+    pub impact: PerformanceImpact,
+}
+
+/// How a layout change affects the cache lines that reading the struct costs.
+#[derive(Debug, Clone, Serialize)]
+pub struct PerformanceImpact {
+    pub cache_line_size: u32,
+    pub old_cache_lines: u64,
+    pub new_cache_lines: u64,
+    pub cache_lines_delta: i64,
+    /// Members that straddle a cache line boundary in the new layout but not the old one.
+    #[serde(skip_serializing_if = "Vec::is_empty")]
+    pub newly_split_members: Vec<String>,
+    /// Pairs of atomics that share a cache line in the new layout but not the old one.
+    #[serde(skip_serializing_if = "Vec::is_empty")]
+    pub new_false_sharing_pairs: Vec<AtomicPair>,
+    pub old_stride: ArrayStride,
+    pub new_stride: ArrayStride,
+}
+
+#[derive(Debug, Clone, Serialize, PartialEq, Eq, PartialOrd, Ord)]
+pub struct AtomicPair {
+    pub member_a: String,
+    pub member_b: String,
+}
+
+/// How densely an array of the struct packs into cache lines and pages.
+#[derive(Debug, Clone, Copy, Serialize, PartialEq)]
+pub struct ArrayStride {
+    pub stride_bytes: u64,
+    pub elements_per_cache_line: f64,
+    pub elements_per_page: u64,
+    /// Cache lines one element touches, averaged over the elements of a line-aligned array.
+    pub cache_lines_per_element: f64,
+}
+
+impl ArrayStride {
+    pub fn new(stride: u64, cache_line_size: u32) -> Self {
+        let line = (cache_line_size as u64).max(1);
+        let (elements_per_cache_line, elements_per_page) =
+            if stride > 0 { (line as f64 / stride as f64, PAGE_SIZE / stride) } else { (0.0, 0) };
+        Self {
+            stride_bytes: stride,
+            elements_per_cache_line,
+            elements_per_page,
+            cache_lines_per_element: lines_per_element(stride, line),
+        }
+    }
+}
+
+/// Average lines an element of `stride` bytes touches in an array starting on a line
+/// boundary. Element starts cycle through the multiples of gcd(stride, line) below `line`;
+/// with `stride - 1 = q * line + t`, an element starting at `r` touches `q + 1` lines, plus
+/// one more when `r + t >= line`.
+fn lines_per_element(stride: u64, line: u64) -> f64 {
+    if stride == 0 {
+        return 0.0;
+    }
+    let step = gcd(stride, line);
+    let starts = line / step;
+    let (q, t) = ((stride - 1) / line, (stride - 1) % line);
+    let crossing = starts - (line - t).div_ceil(step);
+    (q + 1) as f64 + crossing as f64 / starts as f64
+}
+
+impl PerformanceImpact {
+    /// The impact of replacing `old` with `new`, on lines of `cache_line_size` bytes.
+    pub fn new(old: &StructLayout, new: &StructLayout, cache_line_size: u32) -> Self {
+        let line = (cache_line_size as u64).max(1);
+        let cache_lines = |s: &StructLayout| s.size.div_ceil(line);
+        let (old_cache_lines, new_cache_lines) = (cache_lines(old), cache_lines(new));
+
+        let old_split: BTreeSet<&str> =
+            old.members.iter().filter(|m| m.crosses_line(line)).map(|m| m.name.as_str()).collect();
+        let newly_split_members = new
+            .members
+            .iter()
+            .filter(|m| m.crosses_line(line) && !old_split.contains(m.name.as_str()))
+            .map(|m| m.name.to_string())
+            .collect();
+
+        let pairs = |s: &StructLayout| -> BTreeSet<AtomicPair> {
+            analyze_false_sharing_pairs(s, cache_line_size.max(1))
+                .warnings
+                .into_iter()
+                .map(|w| {
+                    let (member_a, member_b) = if w.member_a <= w.member_b {
+                        (w.member_a, w.member_b)
+                    } else {
+                        (w.member_b, w.member_a)
+                    };
+                    AtomicPair { member_a, member_b }
+                })
+                .collect()
+        };
+        let old_pairs = pairs(old);
+        let new_false_sharing_pairs =
+            pairs(new).into_iter().filter(|p| !old_pairs.contains(p)).collect();
+
+        Self {
+            cache_line_size,
+            old_cache_lines,
+            new_cache_lines,
+            cache_lines_delta: signed_delta(old_cache_lines, new_cache_lines),
+            newly_split_members,
+            new_false_sharing_pairs,
+            old_stride: ArrayStride::new(old.size, cache_line_size),
+            new_stride: ArrayStride::new(new.size, cache_line_size),
+        }
+    }
+
+    /// Whether each element of an array of the struct touches more cache lines than before.
+    pub fn stride_regressed(&self) -> bool {
+        const EPSILON: f64 = 1e-9;
+        self.new_stride.cache_lines_per_element > self.old_stride.cache_lines_per_element + EPSILON
+    }
+}
+
+impl StructChange {
+    /// Whether the change counts as a regression of `kind`.
+    pub fn regressed(&self, kind: Regression) -> bool {
+        match kind {
+            Regression::Size => self.size_delta > 0,
+            Regression::Padding => self.padding_delta > 0,
+            Regression::CacheLines => self.impact.cache_lines_delta > 0,
+            Regression::LineSplits => !self.impact.newly_split_members.is_empty(),
+            Regression::FalseSharing => !self.impact.new_false_sharing_pairs.is_empty(),
+            Regression::Stride => self.impact.stride_regressed(),
+        }
+    }
 }
 
 #[derive(Debug, Clone, Serialize)]
@@ -67,90 +223,67 @@ impl DiffResult {
         !self.added.is_empty() || !self.removed.is_empty() || !self.changed.is_empty()
     }
 
+    /// Whether any struct grew or gained padding.
     pub fn has_regressions(&self) -> bool {
-        self.changed.iter().any(|c| c.size_delta > 0 || c.padding_delta > 0)
+        self.has_regressions_in(DEFAULT_REGRESSIONS)
+    }
+
+    /// Whether any changed struct regressed in one of `kinds`.
+    pub fn has_regressions_in(&self, kinds: &[Regression]) -> bool {
+        self.changed.iter().any(|c| kinds.iter().any(|&kind| c.regressed(kind)))
     }
 }
 
-pub fn diff_layouts(old: &[StructLayout], new: &[StructLayout]) -> DiffResult {
+/// Same-named layouts from the old and the new binary.
+type OldAndNew<'a> = (Vec<&'a StructLayout>, Vec<&'a StructLayout>);
+
+/// Compare two sets of layouts, estimating the performance impact of each change on
+/// lines of `cache_line_size` bytes.
+pub fn diff_layouts(
+    old: &[StructLayout],
+    new: &[StructLayout],
+    cache_line_size: u32,
+) -> DiffResult {
     let mut added = Vec::new();
     let mut removed = Vec::new();
     let mut changed = Vec::new();
     let mut unchanged_count = 0;
 
-    // Group by display name; allow duplicates and match them deterministically.
-    // IMPORTANT: Use BTreeMap (not HashMap) for deterministic iteration order.
-    // This ensures stable JSON output across runs. See AUDIT_FINDINGS.md Finding #1.
-    let mut old_by_name: BTreeMap<String, Vec<&StructLayout>> = BTreeMap::new();
-    let mut new_by_name: BTreeMap<String, Vec<&StructLayout>> = BTreeMap::new();
-
+    // Group by display name, borrowing the names; duplicates are matched below.
+    let mut by_name: HashMap<&str, OldAndNew<'_>> = HashMap::new();
     for s in old {
-        old_by_name.entry(s.name.clone()).or_default().push(s);
+        by_name.entry(s.name.as_str()).or_default().0.push(s);
     }
     for s in new {
-        new_by_name.entry(s.name.clone()).or_default().push(s);
+        by_name.entry(s.name.as_str()).or_default().1.push(s);
     }
 
-    // Iterate names in a deterministic order using BTreeSet for uniqueness.
-    let all_names: BTreeSet<&str> =
-        old_by_name.keys().chain(new_by_name.keys()).map(String::as_str).collect();
+    // IMPORTANT: Visit names in sorted order so output is stable across runs.
+    // See AUDIT_FINDINGS.md Finding #1.
+    let mut groups: Vec<(&str, OldAndNew<'_>)> = by_name.into_iter().collect();
+    groups.sort_unstable_by(|a, b| a.0.cmp(b.0));
 
-    for name in all_names {
-        let name = name.to_string(); // Convert to owned for lookups and output
-        let old_group = old_by_name.get(&name).map(Vec::as_slice).unwrap_or(&[]);
-        let new_group = new_by_name.get(&name).map(Vec::as_slice).unwrap_or(&[]);
+    for (_, (old_group, new_group)) in groups {
+        // Identical layouts pair up by fingerprint and need no member comparison. For a
+        // name with many instantiations this leaves only the changed ones to be scored.
+        let (unchanged, old_rest, new_rest) = pair_identical(&old_group, &new_group);
+        unchanged_count += unchanged;
 
-        if old_group.is_empty() {
-            for s in new_group {
-                added.push(StructSummary {
-                    name: name.clone(),
-                    size: s.size,
-                    padding_bytes: s.metrics.padding_bytes,
-                    source_location: s.source_location.clone(),
-                });
-            }
-            continue;
-        }
-
-        if new_group.is_empty() {
-            for s in old_group {
-                removed.push(StructSummary {
-                    name: name.clone(),
-                    size: s.size,
-                    padding_bytes: s.metrics.padding_bytes,
-                    source_location: s.source_location.clone(),
-                });
-            }
-            continue;
-        }
-
-        let (pairs, old_unmatched, new_unmatched) = match_structs(old_group, new_group);
+        let (pairs, old_unmatched, new_unmatched) = if old_rest.is_empty() || new_rest.is_empty() {
+            (Vec::new(), old_rest, new_rest)
+        } else {
+            match_structs(&old_rest, &new_rest)
+        };
 
         for (old_s, new_s) in pairs {
-            if let Some(change) = diff_struct(old_s, new_s) {
+            if let Some(change) = diff_struct(old_s, new_s, cache_line_size) {
                 changed.push(change);
             } else {
                 unchanged_count += 1;
             }
         }
-
-        for s in old_unmatched {
-            removed.push(StructSummary {
-                name: name.clone(),
-                size: s.size,
-                padding_bytes: s.metrics.padding_bytes,
-                source_location: s.source_location.clone(),
-            });
-        }
-
-        for s in new_unmatched {
-            added.push(StructSummary {
-                name: name.clone(),
-                size: s.size,
-                padding_bytes: s.metrics.padding_bytes,
-                source_location: s.source_location.clone(),
-            });
-        }
+        removed.extend(old_unmatched.into_iter().map(summary));
+        added.extend(new_unmatched.into_iter().map(summary));
     }
 
     added.sort_by(|a, b| a.name.cmp(&b.name).then_with(|| a.size.cmp(&b.size)));
@@ -165,6 +298,48 @@ pub fn diff_layouts(old: &[StructLayout], new: &[StructLayout]) -> DiffResult {
     DiffResult { added, removed, changed, unchanged_count }
 }
 
+fn summary(s: &StructLayout) -> StructSummary {
+    StructSummary {
+        name: s.name.clone(),
+        size: s.size,
+        padding_bytes: s.metrics.padding_bytes,
+        source_location: s.source_location.clone(),
+    }
+}
+
+/// Pair old and new layouts with equal fingerprints (first unused old one, in input
+/// order). Returns the number of pairs and the unpaired layouts of each side.
+fn pair_identical<'a>(
+    old_group: &[&'a StructLayout],
+    new_group: &[&'a StructLayout],
+) -> (usize, Vec<&'a StructLayout>, Vec<&'a StructLayout>) {
+    let mut old_by_hash: HashMap<u64, Vec<usize>> = HashMap::new();
+    for (i, s) in old_group.iter().enumerate() {
+        old_by_hash.entry(fingerprint_hash(s)).or_default().push(i);
+    }
+
+    let mut old_used = vec![false; old_group.len()];
+    let mut pairs = 0;
+    let mut new_rest = Vec::new();
+    for &s in new_group {
+        let found = old_by_hash.get_mut(&fingerprint_hash(s)).and_then(|candidates| {
+            let pos = candidates.iter().position(|&i| same_fingerprint(old_group[i], s))?;
+            Some(candidates.remove(pos))
+        });
+        match found {
+            Some(i) => {
+                old_used[i] = true;
+                pairs += 1;
+            }
+            None => new_rest.push(s),
+        }
+    }
+
+    let old_rest =
+        old_group.iter().zip(&old_used).filter_map(|(&s, &used)| (!used).then_some(s)).collect();
+    (pairs, old_rest, new_rest)
+}
+
 fn location_key(s: &StructLayout) -> Option<(&str, u64)> {
     s.source_location.as_ref().map(|loc| (loc.file.as_str(), loc.line))
 }
@@ -313,12 +488,18 @@ fn kind_rank(kind: &MemberChangeKind) -> u8 {
     }
 }
 
-fn diff_struct(old: &StructLayout, new: &StructLayout) -> Option<StructChange> {
-    // Use saturating signed subtraction to handle large u64 values safely.
-    let size_delta =
-        (new.size as i128 - old.size as i128).clamp(i64::MIN as i128, i64::MAX as i128) as i64;
-    let padding_delta = (new.metrics.padding_bytes as i128 - old.metrics.padding_bytes as i128)
-        .clamp(i64::MIN as i128, i64::MAX as i128) as i64;
+/// `new - old`, saturated to the `i64` range so large u64 values are handled safely.
+fn signed_delta(old: u64, new: u64) -> i64 {
+    (new as i128 - old as i128).clamp(i64::MIN as i128, i64::MAX as i128) as i64
+}
+
+fn diff_struct(
+    old: &StructLayout,
+    new: &StructLayout,
+    cache_line_size: u32,
+) -> Option<StructChange> {
+    let size_delta = signed_delta(old.size, new.size);
+    let padding_delta = signed_delta(old.metrics.padding_bytes, new.metrics.padding_bytes);
 
     let mut member_changes = Vec::new();
 
@@ -393,6 +574,7 @@ fn diff_struct(old: &StructLayout, new: &StructLayout) -> Option<StructChange> {
         member_changes,
         source_location: new.source_location.clone(),
         old_source_location: old.source_location.clone(),
+        impact: PerformanceImpact::new(old, new, cache_line_size),
     })
 }
 
@@ -444,7 +626,7 @@ mod tests {
         old.metrics.padding_bytes = 0;
         new.metrics.padding_bytes = 4;
 
-        let diff = diff_layouts(&[old], &[new]);
+        let diff = diff_layouts(&[old], &[new], 64);
         assert_eq!(diff.changed.len(), 1);
         let changes = &diff.changed[0].member_changes;
 
@@ -453,11 +635,84 @@ mod tests {
         assert!(kinds.windows(2).all(|w| kind_rank(w[0]) <= kind_rank(w[1])));
     }
 
+    #[test]
+    fn impact_of_growing_past_a_cache_line() {
+        let atomic = |name: &str, offset| {
+            MemberLayout::new(name, "std::atomic<long>", Some(offset), Some(8)).with_atomic(true)
+        };
+        let old = layout(
+            "Order",
+            64,
+            0,
+            vec![
+                atomic("head", 0),
+                MemberLayout::new("price", "double", Some(8), Some(8)),
+                MemberLayout::new("note", "char[40]", Some(16), Some(40)),
+                atomic("tail", 64 - 8),
+            ],
+        );
+        let new = layout(
+            "Order",
+            72,
+            0,
+            vec![
+                atomic("head", 0),
+                atomic("seq", 8),
+                MemberLayout::new("note", "char[44]", Some(16), Some(44)),
+                MemberLayout::new("price", "double", Some(60), Some(8)),
+            ],
+        );
+
+        let diff = diff_layouts(&[old], &[new], 64);
+        let change = &diff.changed[0];
+        let impact = &change.impact;
+        assert_eq!((impact.old_cache_lines, impact.new_cache_lines), (1, 2));
+        assert_eq!(impact.newly_split_members, ["price"]);
+        let pairs: Vec<_> = impact
+            .new_false_sharing_pairs
+            .iter()
+            .map(|p| (p.member_a.as_str(), p.member_b.as_str()))
+            .collect();
+        assert_eq!(pairs, [("head", "seq")]);
+        // Every 72-byte element of an array straddles two lines; 64-byte ones fill one.
+        assert_eq!(impact.old_stride.cache_lines_per_element, 1.0);
+        assert_eq!(impact.new_stride.cache_lines_per_element, 2.0);
+        assert_eq!(
+            (impact.old_stride.elements_per_page, impact.new_stride.elements_per_page),
+            (64, 56)
+        );
+
+        assert!(!diff.has_regressions_in(&[Regression::Padding]));
+        for kind in [
+            Regression::Size,
+            Regression::CacheLines,
+            Regression::LineSplits,
+            Regression::FalseSharing,
+            Regression::Stride,
+        ] {
+            assert!(change.regressed(kind), "{kind:?}");
+        }
+    }
+
+    #[test]
+    fn lines_per_element_matches_a_walk_over_the_array() {
+        for line in [32u64, 64, 128] {
+            for stride in 1..=300 {
+                let elements = line / gcd(stride, line);
+                let touched: u64 = (0..elements)
+                    .map(|i| (i * stride + stride - 1) / line - (i * stride) / line + 1)
+                    .sum();
+                let expected = touched as f64 / elements as f64;
+                assert!((lines_per_element(stride, line) - expected).abs() < 1e-9, "{stride}");
+            }
+        }
+    }
+
     #[test]
     fn diff_added_and_removed() {
         let old = layout("A", 8, 0, Vec::new());
         let new = layout("B", 8, 0, Vec::new());
-        let diff = diff_layouts(&[old], &[new]);
+        let diff = diff_layouts(&[old], &[new], 64);
         assert_eq!(diff.added.len(), 1);
         assert_eq!(diff.removed.len(), 1);
     }
@@ -468,11 +723,43 @@ mod tests {
         let old2 = layout_with_loc("Dup", "b.c", 2);
         let new1 = layout_with_loc("Dup", "b.c", 2);
         let new2 = layout_with_loc("Dup", "a.c", 1);
-        let diff = diff_layouts(&[old1, old2], &[new1, new2]);
+        let diff = diff_layouts(&[old1, old2], &[new1, new2], 64);
         assert_eq!(diff.changed.len(), 0);
         assert_eq!(diff.unchanged_count, 2);
     }
 
+    #[test]
+    fn diff_pairs_identical_instantiations_by_fingerprint() {
+        // Many instantiations sharing one display name, distinguished by member types.
+        let instantiation = |i: usize| {
+            let member_type = format!("T{}", i);
+            layout("Vec", 16, 0, vec![MemberLayout::new("v", member_type, Some(0), Some(8))])
+        };
+        let old: Vec<StructLayout> = (0..200).map(instantiation).collect();
+        let mut new: Vec<StructLayout> = (0..200).rev().map(instantiation).collect();
+        new[10].members[0].offset = Some(8);
+
+        let diff = diff_layouts(&old, &new, 64);
+        assert_eq!(diff.unchanged_count, 199);
+        assert_eq!(diff.changed.len(), 1);
+        assert_eq!(diff.changed[0].member_changes[0].kind, MemberChangeKind::OffsetChanged);
+        assert!(diff.added.is_empty() && diff.removed.is_empty());
+    }
+
+    #[test]
+    fn diff_prefers_identical_layout_over_first_location_match() {
+        // Both old layouts share a location; the second new one is identical to the first
+        // old one and must pair with it, leaving x vs y as the only change.
+        let with = |member: &str| {
+            let mut s = layout_with_loc("Dup", "dup.h", 7);
+            s.members = vec![MemberLayout::new(member, "u32", Some(0), Some(4))];
+            s
+        };
+        let diff = diff_layouts(&[with("x"), with("y")], &[with("y"), with("x")], 64);
+        assert_eq!(diff.unchanged_count, 2);
+        assert!(diff.changed.is_empty());
+    }
+
     #[test]
     fn diff_detects_member_offset_change() {
         let old = layout(
@@ -487,7 +774,7 @@ mod tests {
             0,
             vec![MemberLayout::new("a".to_string(), "u32".to_string(), Some(4), Some(4))],
         );
-        let diff = diff_layouts(&[old], &[new]);
+        let diff = diff_layouts(&[old], &[new], 64);
         assert_eq!(diff.changed.len(), 1);
         assert!(
             diff.changed[0]
@@ -519,7 +806,7 @@ mod tests {
         );
         new.metrics.padding_bytes = 4;
 
-        let diff = diff_layouts(&[old], &[new]);
+        let diff = diff_layouts(&[old], &[new], 64);
         let changes = &diff.changed[0].member_changes;
         let kinds: Vec<_> = changes.iter().map(|c| &c.kind).collect();
         assert!(kinds.contains(&&MemberChangeKind::Added));
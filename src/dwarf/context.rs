@@ -1,11 +1,23 @@
 use crate::error::{Error, Result};
+use crate::hash::FnvHasher;
+use crate::intern::{Interner, Name};
 use crate::loader::{DwarfSlice, LoadedDwarf};
-use crate::types::{MemberLayout, SourceLocation, StructLayout};
-use gimli::{AttributeValue, DebuggingInformationEntry, Dwarf, Unit};
-
-use super::TypeResolver;
+use crate::timings::ExtractStats;
+use crate::types::{FunctionInfo, MemberLayout, SourceLocation, StructLayout, StructParameter};
+use gimli::{
+    AttributeValue, DebugPubTypes, DebuggingInformationEntry, Dwarf, Unit, UnitHeader, UnitOffset,
+    UnitType,
+};
+use std::collections::{HashMap, HashSet};
+use std::hash::Hasher;
+use std::sync::atomic::{AtomicBool, AtomicUsize, Ordering};
+use std::time::{Duration, Instant};
+
+use super::dedup::LayoutSet;
 use super::expr::{evaluate_member_offset, try_simple_offset};
-use super::{debug_info_ref_to_unit_offset, read_u64_from_attr};
+use super::read_u64_from_attr;
+use super::unit_hash::unit_hash;
+use super::{TypeInfo, TypeResolver, TypeTable};
 
 /// Prefixes for Go runtime internal types that should be filtered.
 /// Grouped by category for maintainability.
@@ -114,50 +126,557 @@ pub(crate) fn go_internal_prefixes() -> &'static [&'static str] {
     GO_INTERNAL_PREFIXES
 }
 
+/// Resolve a `--jobs` value to a concrete worker count (0 = one worker per available CPU).
+pub fn effective_jobs(jobs: usize) -> usize {
+    if jobs == 0 {
+        std::thread::available_parallelism().map(|n| n.get()).unwrap_or(1)
+    } else {
+        jobs
+    }
+}
+
+/// How a unit is visited by `find_structs`.
+#[derive(Clone)]
+enum UnitPlan {
+    /// Walk every DIE.
+    Scan,
+    /// The unit is covered by the name index; visit only these DIEs.
+    Candidates(Vec<UnitOffset>),
+    /// A type unit whose signature an earlier unit already defines.
+    Skip,
+}
+
+impl UnitPlan {
+    /// Key a unit's layouts by its content hash and by how it is visited: through the name
+    /// index a unit yields only the candidates' structs.
+    fn unit_key(&self, unit_hash: u64) -> u64 {
+        let mut h = FnvHasher::default();
+        h.write_u64(unit_hash);
+        if let UnitPlan::Candidates(candidates) = self {
+            for offset in candidates {
+                h.write_u64(offset.0 as u64);
+            }
+        }
+        h.finish()
+    }
+}
+
+/// DIEs whose subtrees never hold type definitions of their own. Concrete inlined and
+/// out-of-line instances reference the types of their abstract origin, and the remaining
+/// tags only own enumerators, parameters or subranges.
+fn cannot_define_types(entry: &DebuggingInformationEntry<DwarfSlice<'_>>) -> bool {
+    if !entry.has_children() {
+        return false;
+    }
+    match entry.tag() {
+        gimli::DW_TAG_inlined_subroutine
+        | gimli::DW_TAG_call_site
+        | gimli::DW_TAG_GNU_call_site
+        | gimli::DW_TAG_enumeration_type
+        | gimli::DW_TAG_subroutine_type
+        | gimli::DW_TAG_array_type => true,
+        gimli::DW_TAG_subprogram => {
+            matches!(
+                entry.attr_value(gimli::DW_AT_declaration),
+                Ok(Some(AttributeValue::Flag(true)))
+            ) || matches!(entry.attr_value(gimli::DW_AT_abstract_origin), Ok(Some(_)))
+        }
+        _ => false,
+    }
+}
+
+/// Byte substring search; an empty needle matches everything, like `str::contains`.
+fn memmem(haystack: &[u8], needle: &[u8]) -> bool {
+    needle.is_empty() || haystack.windows(needle.len()).any(|w| w == needle)
+}
+
+/// Layouts of whole units kept across extractions, keyed by a hash of each unit's
+/// contents. Shared by the extraction workers.
+pub trait UnitCache: Sync {
+    /// The layouts earlier recorded under `key`.
+    fn get(&self, key: u64) -> Option<Vec<StructLayout>>;
+
+    /// Record the layouts just extracted from the unit keyed `key`.
+    fn insert(&self, key: u64, layouts: &[StructLayout]);
+}
+
+#[derive(Clone, Copy)]
 pub struct DwarfContext<'a> {
     dwarf: &'a Dwarf<DwarfSlice<'a>>,
+    split_dwarfs: &'a [Dwarf<DwarfSlice<'a>>],
+    debug_pubtypes: &'a DebugPubTypes<DwarfSlice<'a>>,
     address_size: u8,
     endian: gimli::RunTimeEndian,
+    jobs: usize,
+    name_index: bool,
+    units: Option<&'a dyn UnitCache>,
+    stats: Option<&'a ExtractStats>,
 }
 
 impl<'a> DwarfContext<'a> {
     pub fn new(loaded: &'a LoadedDwarf<'a>) -> Self {
-        Self { dwarf: &loaded.dwarf, address_size: loaded.address_size, endian: loaded.endian }
+        Self {
+            dwarf: &loaded.dwarf,
+            split_dwarfs: &loaded.split_dwarfs,
+            debug_pubtypes: &loaded.debug_pubtypes,
+            address_size: loaded.address_size,
+            endian: loaded.endian,
+            jobs: 1,
+            name_index: false,
+            units: None,
+            stats: None,
+        }
+    }
+
+    /// Set the number of worker threads used by `find_structs`.
+    /// `1` (the default) extracts on the calling thread; `0` uses one worker per available CPU.
+    pub fn with_jobs(mut self, jobs: usize) -> Self {
+        self.jobs = jobs;
+        self
+    }
+
+    /// Let filtered `find_structs` runs trust `.debug_pubtypes` to name every type of the
+    /// units it lists, and only visit the DIEs whose indexed names match. Off by default:
+    /// producers leave types out of the index (function-local types always), and those are
+    /// then missing from the results.
+    pub fn with_name_index(mut self, name_index: bool) -> Self {
+        self.name_index = name_index;
+        self
+    }
+
+    /// Reuse the layouts of units whose contents `units` has seen before, and record the
+    /// layouts of every other unit in it. Units with references into other units are
+    /// always extracted.
+    pub fn with_unit_cache(mut self, units: Option<&'a impl UnitCache>) -> Self {
+        self.units = units.map(|units| units as &dyn UnitCache);
+        self
+    }
+
+    /// Count units, DIEs, type lookups and deduplication into `stats`. Type resolution is
+    /// only timed while counting.
+    pub fn with_stats(mut self, stats: Option<&'a ExtractStats>) -> Self {
+        self.stats = stats;
+        self
     }
 
     /// Find all structs in the binary.
     ///
     /// - `filter`: Optional substring filter for struct names
     /// - `include_go_runtime`: If false, Go runtime internal types are filtered out
+    ///
+    /// With more than one job, units are distributed across a worker pool. Results are merged
+    /// back in unit order before deduplication, so output is identical to the single-threaded
+    /// path.
+    ///
+    /// With a filter, `with_name_index(true)` and a `.debug_pubtypes` index, units listed in
+    /// the index only visit the DIEs whose indexed names match, so filtered runs scale with
+    /// the number of matches.
+    ///
+    /// Split units loaded from `.dwo`/`.dwp` files are extracted after the binary's own
+    /// units, and share the worker pool with them.
     pub fn find_structs(
         &self,
         filter: Option<&str>,
         include_go_runtime: bool,
     ) -> Result<Vec<StructLayout>> {
-        let mut structs = Vec::new();
-        let mut units = self.dwarf.units();
+        let sources = self.sources();
+        let headers = Self::unit_headers(&sources)?;
 
-        while let Some(header) =
-            units.next().map_err(|e| Error::Dwarf(format!("Failed to read unit header: {}", e)))?
-        {
-            let unit = self
-                .dwarf
-                .unit(header)
-                .map_err(|e| Error::Dwarf(format!("Failed to parse unit: {}", e)))?;
+        // Type references never cross files, so each file gets its own table.
+        let types: Vec<TypeTable<'a, '_>> = sources
+            .iter()
+            .zip(&headers)
+            .map(|(source, headers)| TypeTable::new(source.dwarf, headers))
+            .collect();
+
+        // The name index only covers the binary's own units.
+        let mut plans = self.plan_units(&headers[0], filter)?;
+        for split_headers in &headers[1..] {
+            plans.extend(std::iter::repeat_n(UnitPlan::Scan, split_headers.len()));
+        }
 
-            self.process_unit(&unit, filter, include_go_runtime, &mut structs)?;
+        // Type units (`-fdebug-types-section`) define one type each, under a signature that
+        // every other unit refers to it by. Objects and `.dwo` files each carry their own
+        // copies, so only the first unit with a signature is extracted.
+        let mut signatures = HashSet::new();
+        for (plan, header) in plans.iter_mut().zip(headers.iter().flatten()) {
+            if let UnitType::Type { type_signature, .. }
+            | UnitType::SplitType { type_signature, .. } = header.type_()
+                && !signatures.insert(type_signature)
+            {
+                *plan = UnitPlan::Skip;
+            }
         }
+        let units: Vec<(usize, UnitHeader<DwarfSlice<'a>>)> = headers
+            .iter()
+            .enumerate()
+            .flat_map(|(source, headers)| headers.iter().map(move |&header| (source, header)))
+            .collect();
 
         // DWARF can contain duplicate identical type entries (e.g., across units or due to
         // language/compiler quirks). Deduplicate exact duplicates to avoid double-counting in
-        // `check` and unstable matching in `diff`.
-        // Use enumerated index as tiebreaker for stable deduplication (Rust's sort_by is unstable).
-        let mut with_fp: Vec<(StructFingerprint, usize, StructLayout)> =
-            structs.into_iter().enumerate().map(|(i, s)| (struct_fingerprint(&s), i, s)).collect();
-        with_fp.sort_by(|a, b| a.0.cmp(&b.0).then_with(|| a.1.cmp(&b.1)));
-        with_fp.dedup_by(|a, b| a.0 == b.0);
+        // `check` and unstable matching in `diff`. Each unit is deduplicated as soon as it is
+        // extracted, so the duplicates are never held together.
+        let workers = effective_jobs(self.jobs).min(units.len());
+        let (set, found, dedup_time) = if workers > 1 {
+            Self::extract_units_parallel(
+                &sources,
+                &units,
+                &plans,
+                filter,
+                include_go_runtime,
+                &types,
+                workers,
+            )?
+        } else {
+            let mut set = LayoutSet::default();
+            let mut names = Interner::default();
+            for (&(source, header), plan) in units.iter().zip(&plans) {
+                let mut structs = Vec::new();
+                sources[source].extract_unit(
+                    header,
+                    plan,
+                    filter,
+                    include_go_runtime,
+                    &types[source],
+                    &mut names,
+                    &mut structs,
+                )?;
+                set.insert(structs);
+            }
+            let (found, dedup_time) = set.counters();
+            (set, found, dedup_time)
+        };
+
+        let sort_start = Instant::now();
+        let structs = set.into_sorted();
+        if let Some(stats) = self.stats {
+            stats.add_dedup(found, structs.len(), dedup_time + sort_start.elapsed());
+        }
+
+        Ok(structs)
+    }
+
+    /// Find every function with code in the binary, with its struct-typed parameters.
+    ///
+    /// Out-of-line definitions of C++ methods and out-of-line copies of inline functions
+    /// take their name, declaration and parameter types from the DIEs that their
+    /// `DW_AT_specification` or `DW_AT_abstract_origin` lead to within the unit. Inlined
+    /// copies (`DW_TAG_inlined_subroutine`) are not functions of their own: profilers
+    /// attribute their samples to the function they were inlined into.
+    ///
+    /// With more than one job, units are distributed across a worker pool. Functions are
+    /// returned in unit order either way.
+    pub fn find_functions(&self) -> Result<Vec<FunctionInfo>> {
+        let sources = self.sources();
+        let headers = Self::unit_headers(&sources)?;
+        let types: Vec<TypeTable<'a, '_>> = sources
+            .iter()
+            .zip(&headers)
+            .map(|(source, headers)| TypeTable::new(source.dwarf, headers))
+            .collect();
+
+        // Type units define types only.
+        let units: Vec<(usize, UnitHeader<DwarfSlice<'a>>)> = headers
+            .iter()
+            .enumerate()
+            .flat_map(|(source, headers)| headers.iter().map(move |&header| (source, header)))
+            .filter(|(_, header)| {
+                !matches!(header.type_(), UnitType::Type { .. } | UnitType::SplitType { .. })
+            })
+            .collect();
+
+        let extract = |&(source, header): &(usize, UnitHeader<DwarfSlice<'a>>),
+                       names: &mut Interner| {
+            let mut functions = Vec::new();
+            sources[source].extract_functions(header, &types[source], names, &mut functions)?;
+            Ok(functions)
+        };
+
+        let workers = effective_jobs(self.jobs).min(units.len());
+        if workers <= 1 {
+            let mut names = Interner::default();
+            let mut functions = Vec::new();
+            for unit in &units {
+                functions.extend(extract(unit, &mut names)?);
+            }
+            return Ok(functions);
+        }
+
+        let next_index = AtomicUsize::new(0);
+        let failed = AtomicBool::new(false);
+        let mut per_unit: Vec<(usize, Result<Vec<FunctionInfo>>)> = std::thread::scope(|scope| {
+            let handles: Vec<_> = (0..workers)
+                .map(|_| {
+                    scope.spawn(|| {
+                        let mut produced = Vec::new();
+                        let mut names = Interner::default();
+                        while !failed.load(Ordering::Relaxed) {
+                            let index = next_index.fetch_add(1, Ordering::Relaxed);
+                            let Some(unit) = units.get(index) else { break };
+                            let result = extract(unit, &mut names);
+                            if result.is_err() {
+                                failed.store(true, Ordering::Relaxed);
+                            }
+                            produced.push((index, result));
+                        }
+                        produced
+                    })
+                })
+                .collect();
+            handles
+                .into_iter()
+                .flat_map(|handle| {
+                    handle.join().unwrap_or_else(|panic| std::panic::resume_unwind(panic))
+                })
+                .collect()
+        });
+
+        // As in `extract_units_parallel`, the lowest-index error is the sequential one.
+        per_unit.sort_unstable_by_key(|(index, _)| *index);
+        let mut functions = Vec::new();
+        for (_, result) in per_unit {
+            functions.extend(result?);
+        }
+        Ok(functions)
+    }
+
+    /// This file's context, followed by one for each split DWARF file.
+    fn sources(&self) -> Vec<DwarfContext<'a>> {
+        std::iter::once(*self)
+            .chain(self.split_dwarfs.iter().map(|dwarf| DwarfContext { dwarf, ..*self }))
+            .collect()
+    }
+
+    /// Each source's `.debug_info` units, then its DWARF 4 type units from `.debug_types`.
+    fn unit_headers(sources: &[DwarfContext<'a>]) -> Result<Vec<Vec<UnitHeader<DwarfSlice<'a>>>>> {
+        let header_err =
+            |e: gimli::Error| Error::Dwarf(format!("Failed to read unit header: {}", e));
+        let mut headers = Vec::with_capacity(sources.len());
+        for source in sources {
+            let mut source_headers = Vec::new();
+            let mut units = source.dwarf.units();
+            while let Some(header) = units.next().map_err(header_err)? {
+                source_headers.push(header);
+            }
+            let mut type_units = source.dwarf.type_units();
+            while let Some(header) = type_units.next().map_err(header_err)? {
+                source_headers.push(header);
+            }
+            headers.push(source_headers);
+        }
+        Ok(headers)
+    }
+
+    /// Decide per unit whether to scan every DIE or only index candidates, which needs a
+    /// filter and `name_index`.
+    fn plan_units(
+        &self,
+        headers: &[UnitHeader<DwarfSlice<'a>>],
+        filter: Option<&str>,
+    ) -> Result<Vec<UnitPlan>> {
+        let Some(filter) = filter.filter(|_| self.name_index) else {
+            return Ok(vec![UnitPlan::Scan; headers.len()]);
+        };
+
+        // Units that appear in the index at all, and the matching candidates within them.
+        let mut indexed: HashMap<usize, Vec<UnitOffset>> = HashMap::new();
+        let mut items = self.debug_pubtypes.items();
+        while let Some(item) =
+            items.next().map_err(|e| Error::Dwarf(format!("Failed to read pubtypes: {}", e)))?
+        {
+            let candidates = indexed.entry(item.unit_header_offset().0).or_default();
+            // Indexed names may be qualified ("ns::Order"); the DIE name is checked again later.
+            if memmem(item.name().slice(), filter.as_bytes()) {
+                candidates.push(item.die_offset());
+            }
+        }
+
+        Ok(headers
+            .iter()
+            .map(|header| {
+                let indexed = header
+                    .offset()
+                    .as_debug_info_offset()
+                    .and_then(|offset| indexed.remove(&offset.0));
+                match indexed {
+                    Some(mut candidates) => {
+                        // DIE order matches the order a full scan would visit them in.
+                        candidates.sort_unstable();
+                        candidates.dedup();
+                        UnitPlan::Candidates(candidates)
+                    }
+                    None => UnitPlan::Scan,
+                }
+            })
+            .collect())
+    }
+
+    #[allow(clippy::too_many_arguments)]
+    fn extract_unit(
+        &self,
+        header: UnitHeader<DwarfSlice<'a>>,
+        plan: &UnitPlan,
+        filter: Option<&str>,
+        include_go_runtime: bool,
+        types: &TypeTable<'a, '_>,
+        names: &mut Interner,
+        structs: &mut Vec<StructLayout>,
+    ) -> Result<()> {
+        if matches!(plan, UnitPlan::Skip) || matches!(plan, UnitPlan::Candidates(c) if c.is_empty())
+        {
+            return Ok(());
+        }
+
+        let unit = self.parse_unit(header)?;
+
+        let cached = match self.units {
+            Some(units) => unit_hash(self.dwarf, &unit)?.map(|hash| (units, plan.unit_key(hash))),
+            None => None,
+        };
+        if let Some((units, key)) = cached
+            && let Some(layouts) = units.get(key)
+        {
+            structs.extend(layouts);
+            if let Some(stats) = self.stats {
+                stats.add_reused_unit();
+            }
+            return Ok(());
+        }
+
+        let start = structs.len();
+        match plan {
+            UnitPlan::Scan => {
+                self.process_unit(&unit, filter, include_go_runtime, types, names, structs)?
+            }
+            UnitPlan::Candidates(candidates) => self.process_candidates(
+                &unit,
+                candidates,
+                filter,
+                include_go_runtime,
+                types,
+                names,
+                structs,
+            )?,
+            UnitPlan::Skip => unreachable!("skipped units return early"),
+        }
+        if let Some((units, key)) = cached {
+            units.insert(key, &structs[start..]);
+        }
+        Ok(())
+    }
+
+    fn parse_unit(&self, header: UnitHeader<DwarfSlice<'a>>) -> Result<Unit<DwarfSlice<'a>>> {
+        let mut unit = self
+            .dwarf
+            .unit(header)
+            .map_err(|e| Error::Dwarf(format!("Failed to parse unit: {}", e)))?;
+
+        // Split units carry no DW_AT_stmt_list; their DW_AT_decl_file indices refer to the
+        // file table at the start of .debug_line.dwo.
+        if unit.line_program.is_none() && self.dwarf.file_type == gimli::DwarfFileType::Dwo {
+            unit.line_program = self
+                .dwarf
+                .debug_line
+                .program(
+                    gimli::DebugLineOffset(0),
+                    unit.header.address_size(),
+                    unit.comp_dir,
+                    unit.name,
+                )
+                .ok();
+        }
+        Ok(unit)
+    }
+
+    /// Extract units on `workers` scoped threads. Each worker claims the next unclaimed unit
+    /// index and builds its own `Unit`/`TypeResolver`, interning names into its own
+    /// `Interner`; only the type tables are shared.
+    /// `units` pairs each header with the index of the source it was read from.
+    ///
+    /// Workers drop the duplicates among their own units as they go, and the survivors are
+    /// deduplicated again in unit order. A layout is only dropped by a worker after an
+    /// earlier copy, so the copy kept overall is the one the sequential path keeps.
+    ///
+    /// Returns the kept layouts with the number found and the time spent deduplicating,
+    /// summed over workers.
+    fn extract_units_parallel(
+        sources: &[DwarfContext<'a>],
+        units: &[(usize, UnitHeader<DwarfSlice<'a>>)],
+        plans: &[UnitPlan],
+        filter: Option<&str>,
+        include_go_runtime: bool,
+        types: &[TypeTable<'a, '_>],
+        workers: usize,
+    ) -> Result<(LayoutSet, usize, Duration)> {
+        let next_index = AtomicUsize::new(0);
+        let failed = AtomicBool::new(false);
+        let mut found = 0;
+        let mut dedup_time = Duration::ZERO;
+
+        let mut per_unit: Vec<(usize, Result<Vec<StructLayout>>)> = std::thread::scope(|scope| {
+            let handles: Vec<_> = (0..workers)
+                .map(|_| {
+                    scope.spawn(|| {
+                        let mut produced = Vec::new();
+                        let mut set = LayoutSet::default();
+                        let mut names = Interner::default();
+                        while !failed.load(Ordering::Relaxed) {
+                            let index = next_index.fetch_add(1, Ordering::Relaxed);
+                            let Some(&(source, header)) = units.get(index) else { break };
+
+                            let mut structs = Vec::new();
+                            let result = sources[source]
+                                .extract_unit(
+                                    header,
+                                    &plans[index],
+                                    filter,
+                                    include_go_runtime,
+                                    &types[source],
+                                    &mut names,
+                                    &mut structs,
+                                )
+                                .map(|()| set.insert(structs));
+                            if result.is_err() {
+                                failed.store(true, Ordering::Relaxed);
+                            }
+                            produced.push((index, result));
+                        }
+                        // `insert` added one chunk per unit that succeeded, in order.
+                        let counters = set.counters();
+                        let mut chunks = set.into_chunks().into_iter();
+                        let produced: Vec<_> = produced
+                            .into_iter()
+                            .map(|(index, result)| {
+                                (index, result.map(|()| chunks.next().unwrap_or_default()))
+                            })
+                            .collect();
+                        (produced, counters)
+                    })
+                })
+                .collect();
+
+            let mut per_unit = Vec::new();
+            for handle in handles {
+                let (produced, (worker_found, worker_time)) =
+                    handle.join().unwrap_or_else(|panic| std::panic::resume_unwind(panic));
+                per_unit.extend(produced);
+                found += worker_found;
+                dedup_time += worker_time;
+            }
+            per_unit
+        });
 
-        Ok(with_fp.into_iter().map(|(_, _, s)| s).collect())
+        // Units are claimed in increasing index order and every claimed unit is finished, so
+        // the lowest-index error is the same one the sequential path would have returned.
+        per_unit.sort_unstable_by_key(|(index, _)| *index);
+
+        let mut set = LayoutSet::default();
+        for (_, result) in per_unit {
+            set.insert(result?);
+        }
+        let (_, merge_time) = set.counters();
+        Ok((set, found, dedup_time + merge_time))
     }
 
     fn process_unit(
@@ -165,21 +684,73 @@ impl<'a> DwarfContext<'a> {
         unit: &Unit<DwarfSlice<'a>>,
         filter: Option<&str>,
         include_go_runtime: bool,
+        types: &TypeTable<'a, '_>,
+        names: &mut Interner,
         structs: &mut Vec<StructLayout>,
     ) -> Result<()> {
-        let mut type_resolver = TypeResolver::new(self.dwarf, unit, self.address_size);
+        let mut type_resolver = TypeResolver::new(self.dwarf, unit, self.address_size)
+            .with_type_table(types)
+            .with_interner(std::mem::take(names));
         let mut entries = unit.entries();
+        let dfs_err = |e: gimli::Error| Error::Dwarf(format!("Failed to read DIE: {}", e));
+
+        let mut more = entries.next_dfs().map_err(dfs_err)?.is_some();
+        while more {
+            let Some(entry) = entries.current() else { break };
+            type_resolver.counters.dies += 1;
+
+            let skip_children = cannot_define_types(entry);
+            if matches!(entry.tag(), gimli::DW_TAG_structure_type | gimli::DW_TAG_class_type) {
+                if let Some(layout) = self.process_struct_entry(
+                    unit,
+                    entry,
+                    filter,
+                    include_go_runtime,
+                    &mut type_resolver,
+                )? {
+                    structs.push(layout);
+                }
+            }
 
-        while let Some((_, entry)) =
-            entries.next_dfs().map_err(|e| Error::Dwarf(format!("Failed to read DIE: {}", e)))?
-        {
+            // `next_sibling` lands on an unvisited sibling, or on the end of the sibling list,
+            // from which `next_dfs` resumes with the parent's next sibling.
+            more = if skip_children && entries.next_sibling().map_err(dfs_err)?.is_some() {
+                true
+            } else {
+                entries.next_dfs().map_err(dfs_err)?.is_some()
+            };
+        }
+
+        self.finish_unit(type_resolver, names);
+        Ok(())
+    }
+
+    /// Visit only the index candidates of a unit instead of walking every DIE.
+    #[allow(clippy::too_many_arguments)]
+    fn process_candidates(
+        &self,
+        unit: &Unit<DwarfSlice<'a>>,
+        candidates: &[UnitOffset],
+        filter: Option<&str>,
+        include_go_runtime: bool,
+        types: &TypeTable<'a, '_>,
+        names: &mut Interner,
+        structs: &mut Vec<StructLayout>,
+    ) -> Result<()> {
+        let mut type_resolver = TypeResolver::new(self.dwarf, unit, self.address_size)
+            .with_type_table(types)
+            .with_interner(std::mem::take(names));
+
+        for &offset in candidates {
+            // A stale or foreign index entry is not worth failing the run over.
+            let Ok(entry) = unit.entry(offset) else { continue };
+            type_resolver.counters.dies += 1;
             if !matches!(entry.tag(), gimli::DW_TAG_structure_type | gimli::DW_TAG_class_type) {
                 continue;
             }
-
             if let Some(layout) = self.process_struct_entry(
                 unit,
-                entry,
+                &entry,
                 filter,
                 include_go_runtime,
                 &mut type_resolver,
@@ -188,6 +759,175 @@ impl<'a> DwarfContext<'a> {
             }
         }
 
+        self.finish_unit(type_resolver, names);
+        Ok(())
+    }
+
+    /// Hand the resolver's interner back for the next unit and record its counters.
+    fn finish_unit(&self, type_resolver: TypeResolver<'a, '_>, names: &mut Interner) {
+        if let Some(stats) = self.stats {
+            stats.add_unit(&type_resolver.counters);
+        }
+        *names = type_resolver.into_interner();
+    }
+
+    fn extract_functions(
+        &self,
+        header: UnitHeader<DwarfSlice<'a>>,
+        types: &TypeTable<'a, '_>,
+        names: &mut Interner,
+        functions: &mut Vec<FunctionInfo>,
+    ) -> Result<()> {
+        let unit = self.parse_unit(header)?;
+        let mut type_resolver = TypeResolver::new(self.dwarf, &unit, self.address_size)
+            .with_type_table(types)
+            .with_interner(std::mem::take(names));
+        let mut entries = unit.entries();
+        let dfs_err = |e: gimli::Error| Error::Dwarf(format!("Failed to read DIE: {}", e));
+
+        let mut more = entries.next_dfs().map_err(dfs_err)?.is_some();
+        while more {
+            let Some(entry) = entries.current() else { break };
+            let is_function = entry.tag() == gimli::DW_TAG_subprogram;
+            if is_function
+                && let Some(function) = self.process_function(&unit, entry, &mut type_resolver)?
+            {
+                functions.push(function);
+            }
+
+            // A function's children are its parameters, locals and inlined copies.
+            more = if is_function && entries.next_sibling().map_err(dfs_err)?.is_some() {
+                true
+            } else {
+                entries.next_dfs().map_err(dfs_err)?.is_some()
+            };
+        }
+
+        *names = type_resolver.into_interner();
+        Ok(())
+    }
+
+    fn process_function(
+        &self,
+        unit: &Unit<DwarfSlice<'a>>,
+        entry: &DebuggingInformationEntry<DwarfSlice<'a>>,
+        type_resolver: &mut TypeResolver<'a, '_>,
+    ) -> Result<Option<FunctionInfo>> {
+        // Declarations and abstract instances of inline functions have no code of their own.
+        let has = |at| matches!(entry.attr_value(at), Ok(Some(_)));
+        if !has(gimli::DW_AT_low_pc) && !has(gimli::DW_AT_ranges) {
+            return Ok(None);
+        }
+
+        // A definition repeats only the declaration attributes that differ, so the file and
+        // line may come from different DIEs.
+        let mut name = None;
+        let mut linkage_name = None;
+        let mut decl_file = None;
+        let mut decl_line = None;
+        self.visit_origins(unit, entry, |die| {
+            if name.is_none() {
+                name = self.get_string_attr_raw(unit, die, gimli::DW_AT_name)?;
+            }
+            if linkage_name.is_none() {
+                linkage_name =
+                    match self.get_string_attr_raw(unit, die, gimli::DW_AT_linkage_name)? {
+                        Some(raw) => Some(raw),
+                        None => {
+                            self.get_string_attr_raw(unit, die, gimli::DW_AT_MIPS_linkage_name)?
+                        }
+                    };
+            }
+            let decl = |at| read_u64_from_attr(die.attr_value(at).ok().flatten());
+            decl_file = decl_file.or_else(|| decl(gimli::DW_AT_decl_file));
+            decl_line = decl_line.or_else(|| decl(gimli::DW_AT_decl_line));
+            Ok(name.is_some()
+                && linkage_name.is_some()
+                && decl_file.is_some()
+                && decl_line.is_some())
+        })?;
+        let Some(name) = name else {
+            return Ok(None);
+        };
+        let source_location = match (decl_file, decl_line) {
+            (Some(file), Some(line)) => Some(self.source_location(unit, file, line)),
+            _ => None,
+        };
+
+        let mut parameters = Vec::new();
+        let mut tree = unit
+            .entries_tree(Some(entry.offset()))
+            .map_err(|e| Error::Dwarf(format!("Failed to create entries tree: {}", e)))?;
+        let root =
+            tree.root().map_err(|e| Error::Dwarf(format!("Failed to get tree root: {}", e)))?;
+        let mut children = root.children();
+        while let Some(child) = children
+            .next()
+            .map_err(|e| Error::Dwarf(format!("Failed to iterate children: {}", e)))?
+        {
+            let param = child.entry();
+            if param.tag() != gimli::DW_TAG_formal_parameter {
+                continue;
+            }
+            let mut param_name = None;
+            let mut struct_type = None;
+            self.visit_origins(unit, param, |die| {
+                if param_name.is_none() {
+                    param_name = self.get_die_name_raw(unit, die)?;
+                }
+                if struct_type.is_none() && matches!(die.attr_value(gimli::DW_AT_type), Ok(Some(_)))
+                {
+                    struct_type = Some(type_resolver.parameter_struct(die)?);
+                }
+                Ok(param_name.is_some() && struct_type.is_some())
+            })?;
+            if let Some(Some((struct_name, passing))) = struct_type {
+                let name = match param_name {
+                    Some(raw) => type_resolver.intern(raw),
+                    None => Name::from("<anonymous>"),
+                };
+                parameters.push(StructParameter { name, struct_name, passing });
+            }
+        }
+
+        Ok(Some(FunctionInfo {
+            name: String::from_utf8_lossy(name).into_owned(),
+            linkage_name: linkage_name.map(|raw| String::from_utf8_lossy(raw).into_owned()),
+            source_location,
+            parameters,
+        }))
+    }
+
+    /// Visit `entry`, then the DIEs its `DW_AT_specification` or `DW_AT_abstract_origin`
+    /// leads to within `unit`, until `visit` returns true. A definition leads to its
+    /// declaration or abstract instance, and that may have a specification of its own.
+    fn visit_origins(
+        &self,
+        unit: &Unit<DwarfSlice<'a>>,
+        entry: &DebuggingInformationEntry<DwarfSlice<'a>>,
+        mut visit: impl FnMut(&DebuggingInformationEntry<DwarfSlice<'a>>) -> Result<bool>,
+    ) -> Result<()> {
+        let origin = |die: &DebuggingInformationEntry<DwarfSlice<'a>>| {
+            [gimli::DW_AT_specification, gimli::DW_AT_abstract_origin].into_iter().find_map(|at| {
+                match die.attr_value(at) {
+                    Ok(Some(AttributeValue::UnitRef(offset))) => Some(offset),
+                    _ => None,
+                }
+            })
+        };
+
+        if visit(entry)? {
+            return Ok(());
+        }
+        let mut next = origin(entry);
+        for _ in 0..4 {
+            let Some(offset) = next else { break };
+            let Ok(die) = unit.entry(offset) else { break };
+            if visit(&die)? {
+                break;
+            }
+            next = origin(&die);
+        }
         Ok(())
     }
 
@@ -200,19 +940,26 @@ impl<'a> DwarfContext<'a> {
         type_resolver: &mut TypeResolver<'a, '_>,
     ) -> Result<Option<StructLayout>> {
         // Use consolidated helper for attribute extraction (see read_u64_from_attr).
-        let Some(size) =
-            read_u64_from_attr(entry.attr_value(gimli::DW_AT_byte_size).ok().flatten())
-        else {
-            return Ok(None); // Forward declaration or no size
+        let size = || read_u64_from_attr(entry.attr_value(gimli::DW_AT_byte_size).ok().flatten());
+
+        // Reject on the borrowed name first so non-matching structs cost no allocation and
+        // no further attribute reads.
+        let raw_name = match self.get_die_name_raw(unit, entry) {
+            Ok(Some(raw)) => raw,
+            Ok(None) => return Ok(None), // Anonymous struct
+            // Declarations were skipped before their name was ever read; keep it that way.
+            Err(_) if size().is_none() => return Ok(None),
+            Err(e) => return Err(e),
         };
-
-        let name = self.get_die_name(unit, entry)?;
-        let name = match name {
-            Some(n) if !n.starts_with("__") => n, // Skip compiler-generated
-            None => return Ok(None),              // Anonymous struct
-            _ => return Ok(None),
+        let name = match std::str::from_utf8(raw_name) {
+            Ok(name) => std::borrow::Cow::Borrowed(name),
+            Err(_) => String::from_utf8_lossy(raw_name),
         };
 
+        if name.starts_with("__") {
+            return Ok(None); // Skip compiler-generated
+        }
+
         // Filter Go runtime internal types unless explicitly included
         if !include_go_runtime && is_go_internal_type(&name) {
             return Ok(None);
@@ -222,6 +969,11 @@ impl<'a> DwarfContext<'a> {
             return Ok(None);
         }
 
+        let Some(size) = size() else {
+            return Ok(None); // Forward declaration or no size
+        };
+        let name = name.into_owned();
+
         let alignment = read_u64_from_attr(entry.attr_value(gimli::DW_AT_alignment).ok().flatten());
 
         let mut layout = StructLayout::new(name, size, alignment);
@@ -251,6 +1003,7 @@ impl<'a> DwarfContext<'a> {
             .map_err(|e| Error::Dwarf(format!("Failed to iterate children: {}", e)))?
         {
             let entry = child.entry();
+            type_resolver.counters.dies += 1;
             match entry.tag() {
                 gimli::DW_TAG_member => {
                     if let Some(member) = self.process_member(unit, entry, type_resolver)? {
@@ -274,26 +1027,27 @@ impl<'a> DwarfContext<'a> {
     /// Returns (type_name, size, is_atomic) or a default for unknown types.
     fn resolve_type_attr(
         &self,
-        unit: &Unit<DwarfSlice<'a>>,
         entry: &DebuggingInformationEntry<DwarfSlice<'a>>,
         type_resolver: &mut TypeResolver<'a, '_>,
-    ) -> Result<(String, Option<u64>, bool)> {
-        match entry.attr_value(gimli::DW_AT_type) {
+    ) -> Result<TypeInfo> {
+        let start = self.stats.map(|_| Instant::now());
+        let info = match entry.attr_value(gimli::DW_AT_type) {
             Ok(Some(AttributeValue::UnitRef(type_offset))) => {
                 type_resolver.resolve_type(type_offset)
             }
             Ok(Some(AttributeValue::DebugInfoRef(debug_info_offset))) => {
-                // Use shared helper for cross-unit reference conversion.
-                if let Some(unit_offset) =
-                    debug_info_ref_to_unit_offset(debug_info_offset, &unit.header)
-                {
-                    type_resolver.resolve_type(unit_offset)
-                } else {
-                    Ok(("unknown".to_string(), None, false))
-                }
+                // May point into another unit (LTO, dwz); the type table resolves those.
+                type_resolver.resolve_debug_info_ref(debug_info_offset)
+            }
+            Ok(Some(AttributeValue::DebugTypesRef(signature))) => {
+                type_resolver.resolve_signature(signature)
             }
-            _ => Ok(("unknown".to_string(), None, false)),
+            _ => Ok((Name::from("unknown"), None, false)),
+        };
+        if let Some(start) = start {
+            type_resolver.counters.type_resolve += start.elapsed();
         }
+        info
     }
 
     fn process_inheritance(
@@ -303,9 +1057,9 @@ impl<'a> DwarfContext<'a> {
         type_resolver: &mut TypeResolver<'a, '_>,
     ) -> Result<Option<MemberLayout>> {
         let offset = self.get_member_offset(unit, entry)?;
-        let (type_name, size, is_atomic) = self.resolve_type_attr(unit, entry, type_resolver)?;
+        let (type_name, size, is_atomic) = self.resolve_type_attr(entry, type_resolver)?;
 
-        let name = format!("<base: {}>", type_name);
+        let name = Name::from(format!("<base: {}>", type_name));
         Ok(Some(MemberLayout::new(name, type_name, offset, size).with_atomic(is_atomic)))
     }
 
@@ -315,8 +1069,11 @@ impl<'a> DwarfContext<'a> {
         entry: &DebuggingInformationEntry<DwarfSlice<'a>>,
         type_resolver: &mut TypeResolver<'a, '_>,
     ) -> Result<Option<MemberLayout>> {
-        let name = self.get_die_name(unit, entry)?.unwrap_or_else(|| "<anonymous>".to_string());
-        let (type_name, size, is_atomic) = self.resolve_type_attr(unit, entry, type_resolver)?;
+        let name = match self.get_die_name_raw(unit, entry)? {
+            Some(raw) => type_resolver.intern(raw),
+            None => Name::from("<anonymous>"),
+        };
+        let (type_name, size, is_atomic) = self.resolve_type_attr(entry, type_resolver)?;
 
         let offset = self.get_member_offset(unit, entry)?;
 
@@ -403,18 +1160,29 @@ impl<'a> DwarfContext<'a> {
         }
     }
 
-    fn get_die_name(
+    /// The `DW_AT_name` of a DIE, borrowed from the string section.
+    fn get_die_name_raw(
         &self,
         unit: &Unit<DwarfSlice<'a>>,
         entry: &DebuggingInformationEntry<DwarfSlice<'a>>,
-    ) -> Result<Option<String>> {
-        match entry.attr_value(gimli::DW_AT_name) {
+    ) -> Result<Option<&'a [u8]>> {
+        self.get_string_attr_raw(unit, entry, gimli::DW_AT_name)
+    }
+
+    /// A string attribute of a DIE, borrowed from the string section.
+    fn get_string_attr_raw(
+        &self,
+        unit: &Unit<DwarfSlice<'a>>,
+        entry: &DebuggingInformationEntry<DwarfSlice<'a>>,
+        at: gimli::DwAt,
+    ) -> Result<Option<&'a [u8]>> {
+        match entry.attr_value(at) {
             Ok(Some(attr)) => {
                 let name = self
                     .dwarf
                     .attr_string(unit, attr)
                     .map_err(|e| Error::Dwarf(format!("Failed to read name: {}", e)))?;
-                Ok(Some(name.to_string_lossy().into_owned()))
+                Ok(Some(name.slice()))
             }
             Ok(None) => Ok(None),
             Err(e) => Err(Error::Dwarf(format!("Failed to read name attribute: {}", e))),
@@ -437,13 +1205,22 @@ impl<'a> DwarfContext<'a> {
             return Ok(None);
         };
 
+        Ok(Some(self.source_location(unit, file_index, line)))
+    }
+
+    fn source_location(
+        &self,
+        unit: &Unit<DwarfSlice<'a>>,
+        file_index: u64,
+        line: u64,
+    ) -> SourceLocation {
         // Try to resolve the file name from the line program header
         let file_name = self.resolve_file_name(unit, file_index).unwrap_or_else(|| {
             // Fall back to file index if resolution fails
             format!("file#{}", file_index)
         });
 
-        Ok(Some(SourceLocation { file: file_name, line }))
+        SourceLocation { file: file_name, line }
     }
 
     /// Resolve a file index to an actual file path using the .debug_line section.
@@ -476,8 +1253,9 @@ impl<'a> DwarfContext<'a> {
     }
 }
 
-#[derive(Clone, Debug, PartialEq, Eq, PartialOrd, Ord)]
-struct StructFingerprint {
+/// Identity of a layout: two structs with equal fingerprints are interchangeable.
+#[derive(Clone, Debug, PartialEq, Eq, PartialOrd, Ord, Hash)]
+pub(crate) struct StructFingerprint {
     name: String,
     size: u64,
     alignment: Option<u64>,
@@ -485,10 +1263,10 @@ struct StructFingerprint {
     members: Vec<MemberFingerprint>,
 }
 
-#[derive(Clone, Debug, PartialEq, Eq, PartialOrd, Ord)]
+#[derive(Clone, Debug, PartialEq, Eq, PartialOrd, Ord, Hash)]
 struct MemberFingerprint {
-    name: String,
-    type_name: String,
+    name: Name,
+    type_name: Name,
     offset: Option<u64>,
     size: Option<u64>,
     bit_offset: Option<u64>,
@@ -496,7 +1274,7 @@ struct MemberFingerprint {
     is_atomic: bool,
 }
 
-fn struct_fingerprint(s: &StructLayout) -> StructFingerprint {
+pub(crate) fn struct_fingerprint(s: &StructLayout) -> StructFingerprint {
     StructFingerprint {
         name: s.name.clone(),
         size: s.size,
@@ -518,10 +1296,90 @@ fn struct_fingerprint(s: &StructLayout) -> StructFingerprint {
     }
 }
 
+/// Hash of the fields making up `struct_fingerprint(s)`, computed without building it:
+/// layouts with equal fingerprints hash equally. Confirm matches with `same_fingerprint`.
+pub(crate) fn fingerprint_hash(s: &StructLayout) -> u64 {
+    use std::hash::{DefaultHasher, Hash, Hasher};
+
+    let mut hasher = DefaultHasher::new();
+    s.name.hash(&mut hasher);
+    s.size.hash(&mut hasher);
+    s.alignment.hash(&mut hasher);
+    s.source_location.as_ref().map(|l| (l.file.as_str(), l.line)).hash(&mut hasher);
+    s.members.len().hash(&mut hasher);
+    for m in &s.members {
+        m.name.hash(&mut hasher);
+        m.type_name.hash(&mut hasher);
+        (m.offset, m.size, m.bit_offset, m.bit_size, m.is_atomic).hash(&mut hasher);
+    }
+    hasher.finish()
+}
+
+/// `struct_fingerprint(a).cmp(&struct_fingerprint(b))`, without building either.
+pub(crate) fn fingerprint_cmp(a: &StructLayout, b: &StructLayout) -> std::cmp::Ordering {
+    fn location(s: &StructLayout) -> Option<(&str, u64)> {
+        s.source_location.as_ref().map(|l| (l.file.as_str(), l.line))
+    }
+    fn member(m: &MemberLayout) -> impl Ord + '_ {
+        (&m.name, &m.type_name, m.offset, m.size, m.bit_offset, m.bit_size, m.is_atomic)
+    }
+    a.name
+        .cmp(&b.name)
+        .then(a.size.cmp(&b.size))
+        .then(a.alignment.cmp(&b.alignment))
+        .then_with(|| location(a).cmp(&location(b)))
+        .then_with(|| a.members.iter().map(member).cmp(b.members.iter().map(member)))
+}
+
+/// `struct_fingerprint(a) == struct_fingerprint(b)`, without building either.
+pub(crate) fn same_fingerprint(a: &StructLayout, b: &StructLayout) -> bool {
+    fn location(s: &StructLayout) -> Option<(&str, u64)> {
+        s.source_location.as_ref().map(|l| (l.file.as_str(), l.line))
+    }
+    a.name == b.name
+        && a.size == b.size
+        && a.alignment == b.alignment
+        && location(a) == location(b)
+        && a.members.len() == b.members.len()
+        && a.members.iter().zip(&b.members).all(|(x, y)| {
+            x.name == y.name
+                && x.type_name == y.type_name
+                && (x.offset, x.size, x.bit_offset, x.bit_size, x.is_atomic)
+                    == (y.offset, y.size, y.bit_offset, y.bit_size, y.is_atomic)
+        })
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
 
+    #[test]
+    fn borrowed_fingerprint_agrees_with_struct_fingerprint() {
+        let mut base = StructLayout::new("Node<int>".to_string(), 16, Some(8));
+        base.members = vec![
+            MemberLayout::new("next".to_string(), "*Node<int>".to_string(), Some(0), Some(8)),
+            MemberLayout::new("value".to_string(), "int".to_string(), Some(8), Some(4)),
+        ];
+        let mut moved = base.clone();
+        moved.source_location = Some(SourceLocation { file: "node.h".to_string(), line: 3 });
+        let mut atomic = base.clone();
+        atomic.members[1].is_atomic = true;
+        let mut renamed = base.clone();
+        renamed.members[1].name = "val".into();
+
+        for other in [&base, &moved, &atomic, &renamed] {
+            let equal = struct_fingerprint(&base) == struct_fingerprint(other);
+            assert_eq!(same_fingerprint(&base, other), equal);
+            let order = struct_fingerprint(&base).cmp(&struct_fingerprint(other));
+            assert_eq!(fingerprint_cmp(&base, other), order);
+            assert_eq!(fingerprint_cmp(other, &base), order.reverse());
+            if equal {
+                assert_eq!(fingerprint_hash(&base), fingerprint_hash(other));
+            }
+        }
+        assert!(!same_fingerprint(&base, &moved));
+    }
+
     #[test]
     fn test_is_go_internal_type() {
         // Runtime packages - should be filtered
@@ -649,4 +1507,17 @@ mod tests {
         // Type with middle dot but also matching prefix
         assert!(is_go_internal_type("runtime\u{00B7}internal"));
     }
+
+    #[test]
+    fn test_memmem_matches_str_contains() {
+        for (haystack, needle) in
+            [("ns::Order", "Order"), ("Order", "Orders"), ("abc", ""), ("", "a"), ("aab", "ab")]
+        {
+            assert_eq!(
+                memmem(haystack.as_bytes(), needle.as_bytes()),
+                haystack.contains(needle),
+                "{haystack:?} / {needle:?}"
+            );
+        }
+    }
 }
@@ -0,0 +1,123 @@
+//! Deduplication of layouts as their units are extracted.
+//!
+//! Every unit that includes a header carries its own copy of the header's structs, so a
+//! C++ binary can produce the same layout dozens of times. Each unit's layouts are checked
+//! against the ones kept so far as soon as the unit is done, keyed by `fingerprint_hash`
+//! and confirmed with `same_fingerprint`, so duplicates are never collected.
+
+use super::context::{fingerprint_cmp, fingerprint_hash, same_fingerprint};
+use crate::types::StructLayout;
+use std::collections::HashMap;
+use std::time::{Duration, Instant};
+
+/// Position of a kept layout: (chunk, index within the chunk).
+type Slot = (u32, u32);
+
+/// Layouts with distinct fingerprints, keeping the first of each in insertion order.
+#[derive(Default)]
+pub(crate) struct LayoutSet {
+    /// Kept layouts, one chunk per `insert` call.
+    chunks: Vec<Vec<StructLayout>>,
+    /// The first kept layout with each hash.
+    first: HashMap<u64, Slot>,
+    /// Further kept layouts whose hash collides with a different one. Hardly ever used.
+    collisions: HashMap<u64, Vec<Slot>>,
+    /// Layouts offered to `insert`, duplicates included.
+    found: usize,
+    elapsed: Duration,
+}
+
+impl LayoutSet {
+    /// Add the layouts not already in the set as a new chunk, which may end up empty.
+    pub(crate) fn insert(&mut self, layouts: Vec<StructLayout>) {
+        let start = Instant::now();
+        self.found += layouts.len();
+        let chunk = self.chunks.len() as u32;
+        let mut kept = Vec::new();
+        for layout in layouts {
+            let hash = fingerprint_hash(&layout);
+            let slot = (chunk, kept.len() as u32);
+            let Some(&existing) = self.first.get(&hash) else {
+                self.first.insert(hash, slot);
+                kept.push(layout);
+                continue;
+            };
+
+            let layout_at = |(c, i): Slot| match self.chunks.get(c as usize) {
+                Some(chunk) => &chunk[i as usize],
+                None => &kept[i as usize],
+            };
+            let collided = self.collisions.get(&hash).map(Vec::as_slice).unwrap_or_default();
+            let duplicate = std::iter::once(&existing)
+                .chain(collided)
+                .any(|&slot| same_fingerprint(layout_at(slot), &layout));
+            if !duplicate {
+                self.collisions.entry(hash).or_default().push(slot);
+                kept.push(layout);
+            }
+        }
+        self.chunks.push(kept);
+        self.elapsed += start.elapsed();
+    }
+
+    /// Layouts offered so far, and the time spent deduplicating them.
+    pub(crate) fn counters(&self) -> (usize, Duration) {
+        (self.found, self.elapsed)
+    }
+
+    /// The kept layouts, one chunk per `insert` call.
+    pub(crate) fn into_chunks(self) -> Vec<Vec<StructLayout>> {
+        self.chunks
+    }
+
+    /// The kept layouts, in fingerprint order.
+    pub(crate) fn into_sorted(self) -> Vec<StructLayout> {
+        let mut layouts: Vec<StructLayout> = self.chunks.into_iter().flatten().collect();
+        // Fingerprints are distinct, so an unstable sort has only one possible result.
+        layouts.sort_unstable_by(fingerprint_cmp);
+        layouts
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::types::MemberLayout;
+
+    fn layout(name: &str, member: &str) -> StructLayout {
+        let mut l = StructLayout::new(name.to_string(), 8, Some(8));
+        l.members =
+            vec![MemberLayout::new(member.to_string(), "long".to_string(), Some(0), Some(8))];
+        l
+    }
+
+    #[test]
+    fn keeps_first_of_each_fingerprint_across_chunks() {
+        let mut set = LayoutSet::default();
+        set.insert(vec![layout("B", "x"), layout("A", "x"), layout("B", "x")]);
+        set.insert(vec![layout("A", "x"), layout("A", "y")]);
+        set.insert(vec![layout("B", "x")]);
+
+        assert_eq!(set.counters().0, 6);
+        let names: Vec<Vec<String>> = set
+            .into_chunks()
+            .iter()
+            .map(|chunk| {
+                chunk.iter().map(|l| format!("{}.{}", l.name, l.members[0].name)).collect()
+            })
+            .collect();
+        assert_eq!(names, [vec!["B.x", "A.x"], vec!["A.y"], vec![]]);
+    }
+
+    #[test]
+    fn sorted_output_matches_fingerprint_order() {
+        let mut set = LayoutSet::default();
+        set.insert(vec![layout("B", "x"), layout("A", "y"), layout("A", "x")]);
+        let names: Vec<_> = set
+            .into_sorted()
+            .into_iter()
+            .map(|l| format!("{}.{}", l.name, l.members[0].name))
+            .collect();
+        assert_eq!(names, ["A.x", "A.y", "B.x"]);
+    }
+}
@@ -1,9 +1,14 @@
 mod context;
+mod dedup;
 mod expr;
 mod types;
+mod unit_hash;
 
-pub use context::{DwarfContext, is_go_internal_type};
-pub use types::TypeResolver;
+pub use context::{DwarfContext, UnitCache, effective_jobs, is_go_internal_type};
+pub(crate) use context::{
+    StructFingerprint, fingerprint_hash, same_fingerprint, struct_fingerprint,
+};
+pub use types::{TypeInfo, TypeResolver, TypeTable};
 
 use crate::loader::DwarfSlice;
 use gimli::{AttributeValue, DebugInfoOffset, UnitHeader, UnitOffset};
@@ -26,8 +31,8 @@ pub(crate) fn read_u64_from_attr(attr: Option<AttributeValue<DwarfSlice<'_>>>) -
 }
 
 /// Convert a DebugInfoRef (section offset) to a UnitOffset (unit-relative offset).
-/// Returns None if the reference is invalid (cross-unit or corrupted DWARF).
-/// Used by both types.rs and context.rs for consistent cross-unit reference handling.
+/// Returns None if the reference precedes the unit (another unit or corrupted DWARF);
+/// callers must still bound the result by the unit length.
 pub(crate) fn debug_info_ref_to_unit_offset<R: gimli::Reader>(
     debug_info_offset: DebugInfoOffset<R::Offset>,
     unit_header: &UnitHeader<R>,
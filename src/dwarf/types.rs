@@ -1,18 +1,117 @@
 use crate::error::{Error, Result};
+use crate::intern::{Interner, Name};
 use crate::loader::DwarfSlice;
-use gimli::{AttributeValue, Dwarf, Unit, UnitOffset};
+use crate::timings::UnitCounters;
+use crate::types::Passing;
+use gimli::{
+    AttributeValue, DebugInfoOffset, DebugTypeSignature, Dwarf, Unit, UnitHeader, UnitOffset,
+    UnitSectionOffset, UnitType,
+};
 use std::collections::HashMap;
+use std::sync::{OnceLock, RwLock};
 
 use super::{debug_info_ref_to_unit_offset, read_u64_from_attr};
 
-/// Result of resolving a type: (type_name, size, is_atomic)
-pub type TypeInfo = (String, Option<u64>, bool);
+/// Result of resolving a type: (type_name, size, is_atomic). Cloning shares the name.
+pub type TypeInfo = (Name, Option<u64>, bool);
+
+/// Binary-wide type table shared by every unit's `TypeResolver`.
+///
+/// Resolves `DW_FORM_ref_addr` references into other units (common with LTO and `dwz`) and
+/// `DW_FORM_ref_sig8` references into type units (`-fdebug-types-section`), and memoizes
+/// resolved types by section offset, so a type DIE referenced from many units is resolved
+/// once per binary. Safe to share across extraction workers.
+pub struct TypeTable<'a, 'd> {
+    dwarf: &'d Dwarf<DwarfSlice<'a>>,
+    /// `.debug_info` units sorted by start offset, then `.debug_types` units.
+    units: Vec<LazyUnit<'a>>,
+    /// How many of `units` are in `.debug_info`.
+    info_units: usize,
+    /// The unit defining each type signature, and the offset of the type in it. A signature
+    /// defined by several units maps to the first.
+    signatures: HashMap<DebugTypeSignature, (usize, UnitOffset)>,
+    resolved: RwLock<HashMap<UnitSectionOffset, TypeInfo>>,
+}
+
+/// A unit header whose `Unit` is parsed on first cross-unit reference.
+struct LazyUnit<'a> {
+    start: usize,
+    header: UnitHeader<DwarfSlice<'a>>,
+    unit: OnceLock<Option<Unit<DwarfSlice<'a>>>>,
+}
+
+impl<'a, 'd> TypeTable<'a, 'd> {
+    /// `headers` holds the file's units from both `.debug_info` and `.debug_types`.
+    pub fn new(dwarf: &'d Dwarf<DwarfSlice<'a>>, headers: &[UnitHeader<DwarfSlice<'a>>]) -> Self {
+        let lazy = |header: UnitHeader<DwarfSlice<'a>>| {
+            let start = match header.offset() {
+                UnitSectionOffset::DebugInfoOffset(offset) => offset.0,
+                UnitSectionOffset::DebugTypesOffset(offset) => offset.0,
+            };
+            LazyUnit { start, header, unit: OnceLock::new() }
+        };
+        let (mut units, type_units): (Vec<_>, Vec<_>) = headers
+            .iter()
+            .map(|&header| lazy(header))
+            .partition(|u| matches!(u.header.offset(), UnitSectionOffset::DebugInfoOffset(_)));
+        units.sort_by_key(|u| u.start);
+        let info_units = units.len();
+        units.extend(type_units);
+
+        let mut signatures = HashMap::new();
+        for (idx, lazy) in units.iter().enumerate() {
+            if let UnitType::Type { type_signature, type_offset }
+            | UnitType::SplitType { type_signature, type_offset } = lazy.header.type_()
+            {
+                signatures.entry(type_signature).or_insert((idx, type_offset));
+            }
+        }
+        Self { dwarf, units, info_units, signatures, resolved: RwLock::new(HashMap::new()) }
+    }
+
+    /// Find the `.debug_info` unit containing `offset`, parsing it if needed.
+    fn locate(&self, offset: DebugInfoOffset) -> Option<(&Unit<DwarfSlice<'a>>, UnitOffset)> {
+        let info_units = &self.units[..self.info_units];
+        let idx = info_units.partition_point(|u| u.start <= offset.0).checked_sub(1)?;
+        let unit_offset = offset.0 - info_units[idx].start;
+        if unit_offset >= info_units[idx].header.length_including_self() {
+            return None;
+        }
+        Some((self.unit(idx)?, UnitOffset(unit_offset)))
+    }
+
+    /// Find the type unit defining `signature` and the offset of its type.
+    fn locate_signature(
+        &self,
+        signature: DebugTypeSignature,
+    ) -> Option<(&Unit<DwarfSlice<'a>>, UnitOffset)> {
+        let &(idx, type_offset) = self.signatures.get(&signature)?;
+        Some((self.unit(idx)?, type_offset))
+    }
+
+    fn unit(&self, idx: usize) -> Option<&Unit<DwarfSlice<'a>>> {
+        let lazy = &self.units[idx];
+        lazy.unit.get_or_init(|| self.dwarf.unit(lazy.header).ok()).as_ref()
+    }
+
+    fn get(&self, offset: UnitSectionOffset) -> Option<TypeInfo> {
+        self.resolved.read().unwrap_or_else(|e| e.into_inner()).get(&offset).cloned()
+    }
+
+    fn insert(&self, offset: UnitSectionOffset, info: &TypeInfo) {
+        self.resolved.write().unwrap_or_else(|e| e.into_inner()).insert(offset, info.clone());
+    }
+}
 
 pub struct TypeResolver<'a, 'b> {
     dwarf: &'b Dwarf<DwarfSlice<'a>>,
     unit: &'b Unit<DwarfSlice<'a>>,
     address_size: u8,
     cache: HashMap<UnitOffset, TypeInfo>,
+    table: Option<&'b TypeTable<'a, 'b>>,
+    names: Interner,
+    /// Lookups and cache hits, plus what the caller counts for `--timings`.
+    pub(crate) counters: UnitCounters,
 }
 
 impl<'a, 'b> TypeResolver<'a, 'b> {
@@ -21,63 +120,222 @@ impl<'a, 'b> TypeResolver<'a, 'b> {
         unit: &'b Unit<DwarfSlice<'a>>,
         address_size: u8,
     ) -> Self {
-        Self { dwarf, unit, address_size, cache: HashMap::new() }
+        Self {
+            dwarf,
+            unit,
+            address_size,
+            cache: HashMap::new(),
+            table: None,
+            names: Interner::default(),
+            counters: UnitCounters::default(),
+        }
+    }
+
+    /// Share resolved types with other units and follow cross-unit references through `table`.
+    /// Without a table, references outside this unit resolve to "unknown".
+    pub fn with_type_table(mut self, table: &'b TypeTable<'a, 'b>) -> Self {
+        self.table = Some(table);
+        self
+    }
+
+    /// Intern names into `names`, so one interner can serve every unit a worker extracts.
+    pub(crate) fn with_interner(mut self, names: Interner) -> Self {
+        self.names = names;
+        self
+    }
+
+    pub(crate) fn into_interner(self) -> Interner {
+        self.names
+    }
+
+    /// The shared `Name` for a string read from `.debug_str` (or inline).
+    pub(crate) fn intern(&mut self, raw: &[u8]) -> Name {
+        match std::str::from_utf8(raw) {
+            Ok(name) => self.names.intern(name),
+            Err(_) => self.names.intern(&String::from_utf8_lossy(raw)),
+        }
     }
 
     pub fn resolve_type(&mut self, offset: UnitOffset) -> Result<TypeInfo> {
+        self.counters.type_lookups += 1;
         if let Some(cached) = self.cache.get(&offset) {
+            self.counters.type_cache_hits += 1;
             return Ok(cached.clone());
         }
 
-        let result = self.resolve_type_inner(offset, 0, false)?;
+        let result = self.resolve_root(self.unit, offset)?;
         self.cache.insert(offset, result.clone());
         Ok(result)
     }
 
+    /// Resolve a `DW_FORM_ref_addr` type reference, which may point into another unit.
+    pub fn resolve_debug_info_ref(&mut self, offset: DebugInfoOffset) -> Result<TypeInfo> {
+        match self.locate(self.unit, offset) {
+            Some((unit, unit_offset)) if std::ptr::eq(unit, self.unit) => {
+                self.resolve_type(unit_offset)
+            }
+            Some((unit, unit_offset)) => {
+                self.counters.type_lookups += 1;
+                self.resolve_root(unit, unit_offset)
+            }
+            None => Ok((Name::from("unknown"), None, false)),
+        }
+    }
+
+    /// Resolve a `DW_FORM_ref_sig8` type reference to the type unit defining the signature.
+    pub fn resolve_signature(&mut self, signature: DebugTypeSignature) -> Result<TypeInfo> {
+        match self.table.and_then(|table| table.locate_signature(signature)) {
+            Some((unit, type_offset)) if std::ptr::eq(unit, self.unit) => {
+                self.resolve_type(type_offset)
+            }
+            Some((unit, type_offset)) => {
+                self.counters.type_lookups += 1;
+                self.resolve_root(unit, type_offset)
+            }
+            None => Ok((Name::from("unknown"), None, false)),
+        }
+    }
+
+    /// The struct or class that the `DW_AT_type` of a parameter `entry` of this unit refers
+    /// to, seen through qualifiers, typedefs and one pointer or reference, with how it is
+    /// passed. `None` for any other type, for anonymous structs and for pointers to pointers.
+    pub(crate) fn parameter_struct(
+        &mut self,
+        entry: &gimli::DebuggingInformationEntry<DwarfSlice<'a>>,
+    ) -> Result<Option<(Name, Passing)>> {
+        let Some(mut target) = self.get_type_ref(self.unit, entry)? else {
+            return Ok(None);
+        };
+        let mut passing = Passing::Value;
+        for _ in 0..=20 {
+            let (unit, offset) = target;
+            let entry = unit
+                .entry(offset)
+                .map_err(|e| Error::Dwarf(format!("Failed to get type entry: {}", e)))?;
+            if let Ok(Some(AttributeValue::DebugTypesRef(signature))) =
+                entry.attr_value(gimli::DW_AT_signature)
+                && let Some(located) =
+                    self.table.and_then(|table| table.locate_signature(signature))
+            {
+                target = located;
+                continue;
+            }
+
+            match entry.tag() {
+                gimli::DW_TAG_structure_type | gimli::DW_TAG_class_type => {
+                    return Ok(self.get_type_name(unit, &entry)?.map(|name| (name, passing)));
+                }
+                gimli::DW_TAG_pointer_type if passing == Passing::Value => {
+                    passing = Passing::Pointer;
+                }
+                gimli::DW_TAG_reference_type | gimli::DW_TAG_rvalue_reference_type
+                    if passing == Passing::Value =>
+                {
+                    passing = Passing::Reference;
+                }
+                gimli::DW_TAG_const_type
+                | gimli::DW_TAG_volatile_type
+                | gimli::DW_TAG_restrict_type
+                | gimli::DW_TAG_atomic_type
+                | gimli::DW_TAG_typedef => {}
+                _ => return Ok(None),
+            }
+            let Some(next) = self.get_type_ref(unit, &entry)? else {
+                return Ok(None);
+            };
+            target = next;
+        }
+        Ok(None)
+    }
+
+    /// Top-level resolution, memoized binary-wide when a type table is attached.
+    fn resolve_root(
+        &mut self,
+        unit: &'b Unit<DwarfSlice<'a>>,
+        offset: UnitOffset,
+    ) -> Result<TypeInfo> {
+        let key = offset.to_unit_section_offset(unit);
+        if let Some(cached) = self.table.and_then(|table| table.get(key)) {
+            self.counters.type_cache_hits += 1;
+            return Ok(cached);
+        }
+
+        let result = self.resolve_type_inner(unit, offset, 0, false)?;
+        if let Some(table) = self.table {
+            table.insert(key, &result);
+        }
+        Ok(result)
+    }
+
+    /// Map a `.debug_info` offset to (unit, unit offset), preferring the unit being resolved.
+    fn locate(
+        &self,
+        unit: &'b Unit<DwarfSlice<'a>>,
+        offset: DebugInfoOffset,
+    ) -> Option<(&'b Unit<DwarfSlice<'a>>, UnitOffset)> {
+        if let Some(unit_offset) = debug_info_ref_to_unit_offset(offset, &unit.header) {
+            if unit_offset.0 < unit.header.length_including_self() {
+                return Some((unit, unit_offset));
+            }
+        }
+        self.table?.locate(offset)
+    }
+
     fn resolve_type_inner(
         &mut self,
+        unit: &'b Unit<DwarfSlice<'a>>,
         offset: UnitOffset,
         depth: usize,
         is_atomic: bool,
     ) -> Result<TypeInfo> {
         if depth > 20 {
-            return Ok(("...".to_string(), None, is_atomic));
+            return Ok((Name::from("..."), None, is_atomic));
         }
 
-        let entry = self
-            .unit
+        let entry = unit
             .entry(offset)
             .map_err(|e| Error::Dwarf(format!("Failed to get type entry: {}", e)))?;
 
+        // A skeleton (`DW_AT_signature`) stands in for a type defined in a type unit.
+        if let Ok(Some(AttributeValue::DebugTypesRef(signature))) =
+            entry.attr_value(gimli::DW_AT_signature)
+            && let Some((type_unit, type_offset)) =
+                self.table.and_then(|table| table.locate_signature(signature))
+        {
+            return self.resolve_type_inner(type_unit, type_offset, depth + 1, is_atomic);
+        }
+
         let tag = entry.tag();
 
         match tag {
             gimli::DW_TAG_base_type => {
-                let name = self.get_type_name(&entry)?.unwrap_or_else(|| "?".to_string());
+                let name = self.get_type_name(unit, &entry)?.unwrap_or_else(|| Name::from("?"));
                 let size = self.get_byte_size(&entry)?;
                 Ok((name, size, is_atomic))
             }
 
             gimli::DW_TAG_pointer_type => {
-                let pointee = if let Some(type_offset) = self.get_type_ref(&entry)? {
-                    let (pointee_name, _, _) =
-                        self.resolve_type_inner(type_offset, depth + 1, false)?;
-                    pointee_name
-                } else {
-                    "void".to_string()
-                };
-                Ok((format!("*{}", pointee), Some(self.address_size as u64), is_atomic))
+                let pointee =
+                    if let Some((type_unit, type_offset)) = self.get_type_ref(unit, &entry)? {
+                        let (pointee_name, _, _) =
+                            self.resolve_type_inner(type_unit, type_offset, depth + 1, false)?;
+                        pointee_name
+                    } else {
+                        Name::from("void")
+                    };
+                Ok((format!("*{}", pointee).into(), Some(self.address_size as u64), is_atomic))
             }
 
             gimli::DW_TAG_reference_type => {
-                let referee = if let Some(type_offset) = self.get_type_ref(&entry)? {
-                    let (referee_name, _, _) =
-                        self.resolve_type_inner(type_offset, depth + 1, false)?;
-                    referee_name
-                } else {
-                    "void".to_string()
-                };
-                Ok((format!("&{}", referee), Some(self.address_size as u64), is_atomic))
+                let referee =
+                    if let Some((type_unit, type_offset)) = self.get_type_ref(unit, &entry)? {
+                        let (referee_name, _, _) =
+                            self.resolve_type_inner(type_unit, type_offset, depth + 1, false)?;
+                        referee_name
+                    } else {
+                        Name::from("void")
+                    };
+                Ok((format!("&{}", referee).into(), Some(self.address_size as u64), is_atomic))
             }
 
             gimli::DW_TAG_const_type
@@ -89,50 +347,51 @@ impl<'a, 'b> TypeResolver<'a, 'b> {
                     gimli::DW_TAG_volatile_type => "volatile ",
                     _ => "restrict ", // DW_TAG_restrict_type
                 };
-                if let Some(type_offset) = self.get_type_ref(&entry)? {
+                if let Some((type_unit, type_offset)) = self.get_type_ref(unit, &entry)? {
                     let (inner_name, size, inner_atomic) =
-                        self.resolve_type_inner(type_offset, depth + 1, is_atomic)?;
-                    Ok((format!("{}{}", prefix, inner_name), size, inner_atomic))
+                        self.resolve_type_inner(type_unit, type_offset, depth + 1, is_atomic)?;
+                    Ok((format!("{}{}", prefix, inner_name).into(), size, inner_atomic))
                 } else {
-                    Ok((format!("{}void", prefix), None, is_atomic))
+                    Ok((format!("{}void", prefix).into(), None, is_atomic))
                 }
             }
 
             gimli::DW_TAG_atomic_type => {
                 // Mark as atomic and propagate through the type chain
-                if let Some(type_offset) = self.get_type_ref(&entry)? {
+                if let Some((type_unit, type_offset)) = self.get_type_ref(unit, &entry)? {
                     let (inner_name, size, _) =
-                        self.resolve_type_inner(type_offset, depth + 1, true)?;
-                    Ok((format!("_Atomic {}", inner_name), size, true))
+                        self.resolve_type_inner(type_unit, type_offset, depth + 1, true)?;
+                    Ok((format!("_Atomic {}", inner_name).into(), size, true))
                 } else {
-                    Ok(("_Atomic void".to_string(), None, true))
+                    Ok((Name::from("_Atomic void"), None, true))
                 }
             }
 
             gimli::DW_TAG_typedef => {
-                let name = self.get_type_name(&entry)?;
-                if let Some(type_offset) = self.get_type_ref(&entry)? {
+                let name = self.get_type_name(unit, &entry)?;
+                if let Some((type_unit, type_offset)) = self.get_type_ref(unit, &entry)? {
                     let (_, size, inner_atomic) =
-                        self.resolve_type_inner(type_offset, depth + 1, is_atomic)?;
+                        self.resolve_type_inner(type_unit, type_offset, depth + 1, is_atomic)?;
                     // Propagate atomic flag through typedefs
                     Ok((
-                        name.unwrap_or_else(|| "typedef".to_string()),
+                        name.unwrap_or_else(|| Name::from("typedef")),
                         size,
                         inner_atomic || is_atomic,
                     ))
                 } else {
-                    Ok((name.unwrap_or_else(|| "typedef".to_string()), None, is_atomic))
+                    Ok((name.unwrap_or_else(|| Name::from("typedef")), None, is_atomic))
                 }
             }
 
             gimli::DW_TAG_array_type => {
-                let element_type = if let Some(type_offset) = self.get_type_ref(&entry)? {
-                    self.resolve_type_inner(type_offset, depth + 1, is_atomic)?
-                } else {
-                    ("?".to_string(), None, is_atomic)
-                };
-
-                let count = self.get_array_count(&entry)?;
+                let element_type =
+                    if let Some((type_unit, type_offset)) = self.get_type_ref(unit, &entry)? {
+                        self.resolve_type_inner(type_unit, type_offset, depth + 1, is_atomic)?
+                    } else {
+                        (Name::from("?"), None, is_atomic)
+                    };
+
+                let count = self.get_array_count(unit, &entry)?;
                 let size = match (element_type.1, count) {
                     // Use checked_mul to prevent overflow for very large arrays.
                     // Fall back to DW_AT_byte_size if multiplication overflows.
@@ -143,27 +402,30 @@ impl<'a, 'b> TypeResolver<'a, 'b> {
                 };
 
                 let count_str = count.map(|c| c.to_string()).unwrap_or_else(|| "?".to_string());
-                Ok((format!("[{}; {}]", element_type.0, count_str), size, element_type.2))
+                Ok((format!("[{}; {}]", element_type.0, count_str).into(), size, element_type.2))
             }
 
             gimli::DW_TAG_structure_type | gimli::DW_TAG_class_type | gimli::DW_TAG_union_type => {
-                let name = self.get_type_name(&entry)?.unwrap_or_else(|| "<anonymous>".to_string());
+                let name =
+                    self.get_type_name(unit, &entry)?.unwrap_or_else(|| Name::from("<anonymous>"));
                 let size = self.get_byte_size(&entry)?;
                 Ok((name, size, is_atomic))
             }
 
             gimli::DW_TAG_enumeration_type => {
-                let name = self.get_type_name(&entry)?.unwrap_or_else(|| "enum".to_string());
+                let name = self.get_type_name(unit, &entry)?.unwrap_or_else(|| Name::from("enum"));
                 let size = self.get_byte_size(&entry)?;
                 Ok((name, size, is_atomic))
             }
 
             gimli::DW_TAG_subroutine_type => {
-                Ok(("fn(...)".to_string(), Some(self.address_size as u64), is_atomic))
+                Ok((Name::from("fn(...)"), Some(self.address_size as u64), is_atomic))
             }
 
             _ => {
-                let name = self.get_type_name(&entry)?.unwrap_or_else(|| format!("?<{:?}>", tag));
+                let name = self
+                    .get_type_name(unit, &entry)?
+                    .unwrap_or_else(|| format!("?<{:?}>", tag).into());
                 let size = self.get_byte_size(&entry)?;
                 Ok((name, size, is_atomic))
             }
@@ -171,16 +433,17 @@ impl<'a, 'b> TypeResolver<'a, 'b> {
     }
 
     fn get_type_name(
-        &self,
+        &mut self,
+        unit: &Unit<DwarfSlice<'a>>,
         entry: &gimli::DebuggingInformationEntry<DwarfSlice<'a>>,
-    ) -> Result<Option<String>> {
+    ) -> Result<Option<Name>> {
         match entry.attr_value(gimli::DW_AT_name) {
             Ok(Some(attr)) => {
                 let name = self
                     .dwarf
-                    .attr_string(self.unit, attr)
+                    .attr_string(unit, attr)
                     .map_err(|e| Error::Dwarf(format!("Failed to read type name: {}", e)))?;
-                Ok(Some(name.to_string_lossy().into_owned()))
+                Ok(Some(self.intern(name.slice())))
             }
             Ok(None) => Ok(None),
             Err(e) => Err(Error::Dwarf(format!("Failed to read name attr: {}", e))),
@@ -197,13 +460,16 @@ impl<'a, 'b> TypeResolver<'a, 'b> {
 
     fn get_type_ref(
         &self,
+        unit: &'b Unit<DwarfSlice<'a>>,
         entry: &gimli::DebuggingInformationEntry<DwarfSlice<'a>>,
-    ) -> Result<Option<UnitOffset>> {
+    ) -> Result<Option<(&'b Unit<DwarfSlice<'a>>, UnitOffset)>> {
         match entry.attr_value(gimli::DW_AT_type) {
-            Ok(Some(AttributeValue::UnitRef(offset))) => Ok(Some(offset)),
+            Ok(Some(AttributeValue::UnitRef(offset))) => Ok(Some((unit, offset))),
             Ok(Some(AttributeValue::DebugInfoRef(debug_info_offset))) => {
-                // Use shared helper for cross-unit reference conversion.
-                Ok(debug_info_ref_to_unit_offset(debug_info_offset, &self.unit.header))
+                Ok(self.locate(unit, debug_info_offset))
+            }
+            Ok(Some(AttributeValue::DebugTypesRef(signature))) => {
+                Ok(self.table.and_then(|table| table.locate_signature(signature)))
             }
             _ => Ok(None),
         }
@@ -211,36 +477,48 @@ impl<'a, 'b> TypeResolver<'a, 'b> {
 
     fn get_array_count(
         &self,
+        unit: &Unit<DwarfSlice<'a>>,
         entry: &gimli::DebuggingInformationEntry<DwarfSlice<'a>>,
     ) -> Result<Option<u64>> {
-        let mut tree = self
-            .unit
+        let mut tree = unit
             .entries_tree(Some(entry.offset()))
             .map_err(|e| Error::Dwarf(format!("Failed to create tree: {}", e)))?;
 
         let root = tree.root().map_err(|e| Error::Dwarf(format!("Failed to get root: {}", e)))?;
 
+        // A multi-dimensional C array is one array type with a subrange per dimension;
+        // its element count is the product of the dimensions.
+        let mut total: Option<u64> = None;
         let mut children = root.children();
         while let Some(child) =
             children.next().map_err(|e| Error::Dwarf(format!("Failed to iterate: {}", e)))?
         {
             let child_entry = child.entry();
-            if child_entry.tag() == gimli::DW_TAG_subrange_type {
-                // Try DW_AT_count first (can be various data encodings)
-                if let Some(count) = self.extract_count_attr(child_entry, gimli::DW_AT_count)? {
-                    return Ok(Some(count));
-                }
-                // Fall back to DW_AT_upper_bound (0-indexed, so add 1).
-                // Use checked_add to handle corrupted DWARF with upper == u64::MAX.
-                if let Some(upper) =
-                    self.extract_count_attr(child_entry, gimli::DW_AT_upper_bound)?
-                {
-                    return Ok(upper.checked_add(1));
-                }
+            if child_entry.tag() != gimli::DW_TAG_subrange_type {
+                continue;
             }
+            // Try DW_AT_count first (can be various data encodings), then fall back to
+            // DW_AT_upper_bound (0-indexed, so add 1). Use checked_add to handle corrupted
+            // DWARF with upper == u64::MAX.
+            let count = match self.extract_count_attr(child_entry, gimli::DW_AT_count)? {
+                Some(count) => Some(count),
+                None => self
+                    .extract_count_attr(child_entry, gimli::DW_AT_upper_bound)?
+                    .and_then(|upper| upper.checked_add(1)),
+            };
+            let Some(count) = count else {
+                return Ok(None);
+            };
+            total = match total {
+                Some(total) => match total.checked_mul(count) {
+                    Some(product) => Some(product),
+                    None => return Ok(None),
+                },
+                None => Some(count),
+            };
         }
 
-        Ok(None)
+        Ok(total)
     }
 
     fn extract_count_attr(
@@ -280,6 +558,107 @@ mod tests {
         None
     }
 
+    /// Two DWARF 4 units sharing one abbreviation table: unit A defines `int`, unit B holds a
+    /// typedef and a pointer that reach it through `DW_FORM_ref_addr`.
+    const CROSS_UNIT_ABBREV: &[u8] = &[
+        1, 0x11, 1, 0, 0, // compile_unit, children
+        2, 0x24, 0, 0x03, 0x08, 0x0b, 0x0b, 0, 0, // base_type: name(string), byte_size(data1)
+        3, 0x16, 0, 0x03, 0x08, 0x49, 0x10, 0, 0, // typedef: name(string), type(ref_addr)
+        4, 0x0f, 0, 0x49, 0x10, 0, 0, // pointer_type: type(ref_addr)
+        0,
+    ];
+    const CROSS_UNIT_INFO: &[u8] = &[
+        // Unit A @ 0x00
+        15, 0, 0, 0, 4, 0, 0, 0, 0, 0, 8, // header
+        1, // compile_unit @ 0x0b
+        2, b'i', b'n', b't', 0, 4, // base_type "int" @ 0x0c
+        0, // end of children
+        // Unit B @ 0x13
+        25, 0, 0, 0, 4, 0, 0, 0, 0, 0, 8, // header
+        1, // compile_unit @ 0x1e
+        3, b'm', b'y', b'i', b'n', b't', 0, 0x0c, 0, 0, 0, // typedef "myint" @ 0x1f
+        4, 0x0c, 0, 0, 0, // pointer_type @ 0x2a
+        0, // end of children
+    ];
+
+    fn cross_unit_dwarf() -> Dwarf<DwarfSlice<'static>> {
+        Dwarf::load(|id| {
+            let data = match id {
+                gimli::SectionId::DebugInfo => CROSS_UNIT_INFO,
+                gimli::SectionId::DebugAbbrev => CROSS_UNIT_ABBREV,
+                _ => &[],
+            };
+            Ok::<_, gimli::Error>(DwarfSlice::new(data, gimli::RunTimeEndian::Little))
+        })
+        .expect("load synthetic DWARF")
+    }
+
+    fn unit_headers(dwarf: &Dwarf<DwarfSlice<'static>>) -> Vec<UnitHeader<DwarfSlice<'static>>> {
+        let mut headers = Vec::new();
+        let mut units = dwarf.units();
+        while let Some(header) = units.next().expect("unit header") {
+            headers.push(header);
+        }
+        headers
+    }
+
+    #[test]
+    fn cross_unit_refs_resolve_through_type_table() {
+        let dwarf = cross_unit_dwarf();
+        let headers = unit_headers(&dwarf);
+        assert_eq!(headers.len(), 2);
+        let unit_b = dwarf.unit(headers[1]).expect("unit B");
+        let table = TypeTable::new(&dwarf, &headers);
+
+        let mut resolver = TypeResolver::new(&dwarf, &unit_b, 8).with_type_table(&table);
+        assert_eq!(
+            resolver.resolve_type(UnitOffset(0x0c)).unwrap(),
+            (Name::from("myint"), Some(4), false)
+        );
+        assert_eq!(
+            resolver.resolve_type(UnitOffset(0x17)).unwrap(),
+            (Name::from("*int"), Some(8), false)
+        );
+        assert_eq!(
+            resolver.resolve_debug_info_ref(DebugInfoOffset(0x0c)).unwrap(),
+            (Name::from("int"), Some(4), false)
+        );
+
+        // Roots are memoized binary-wide by .debug_info offset.
+        let int = UnitSectionOffset::from(DebugInfoOffset(0x0c));
+        assert_eq!(table.get(int), Some((Name::from("int"), Some(4), false)));
+        assert!(table.get(DebugInfoOffset(0x1f).into()).is_some());
+    }
+
+    #[test]
+    fn cross_unit_refs_without_table_are_unknown() {
+        let dwarf = cross_unit_dwarf();
+        let headers = unit_headers(&dwarf);
+        let unit_b = dwarf.unit(headers[1]).expect("unit B");
+
+        let mut resolver = TypeResolver::new(&dwarf, &unit_b, 8);
+        assert_eq!(
+            resolver.resolve_type(UnitOffset(0x0c)).unwrap(),
+            (Name::from("myint"), None, false)
+        );
+        assert_eq!(
+            resolver.resolve_debug_info_ref(DebugInfoOffset(0x0c)).unwrap(),
+            (Name::from("unknown"), None, false)
+        );
+        // Refs inside the current unit still resolve.
+        assert_eq!(resolver.resolve_debug_info_ref(DebugInfoOffset(0x1f)).unwrap().0, "myint");
+    }
+
+    #[test]
+    fn type_table_rejects_offsets_outside_units() {
+        let dwarf = cross_unit_dwarf();
+        let headers = unit_headers(&dwarf);
+        let table = TypeTable::new(&dwarf, &headers);
+        assert!(table.locate(DebugInfoOffset(0x1000)).is_none());
+        let (_, offset) = table.locate(DebugInfoOffset(0x1f)).expect("inside unit B");
+        assert_eq!(offset, UnitOffset(0x0c));
+    }
+
     fn find_type_offset(unit: &Unit<DwarfSlice<'_>>, tag: DwTag) -> Option<UnitOffset> {
         let mut entries = unit.entries();
         while let Some((_, entry)) = entries.next_dfs().ok().flatten() {
@@ -0,0 +1,184 @@
+//! Content hash of a compilation unit, used to reuse its layouts across rebuilds.
+//!
+//! Raw `.debug_info` bytes are a poor key: relinking after any edit moves code, which
+//! rewrites the addresses in every unit, and string merging shifts `.debug_str` offsets.
+//! Instead the hash covers the DIE tree shape, the attributes layout extraction reads
+//! (with strings resolved to their contents), and the unit's file table. Addresses,
+//! locations and ranges are left out.
+
+use crate::error::{Error, Result};
+use crate::hash::FnvHasher;
+use crate::loader::DwarfSlice;
+use gimli::{AttributeValue, Dwarf, Unit};
+use std::hash::Hasher;
+
+/// Attributes whose values can affect the layouts extracted from a unit. Keep in sync
+/// with what `context.rs` and `types.rs` read.
+const HASHED_ATTRIBUTES: &[gimli::DwAt] = &[
+    gimli::DW_AT_name,
+    gimli::DW_AT_type,
+    gimli::DW_AT_byte_size,
+    gimli::DW_AT_bit_size,
+    gimli::DW_AT_bit_offset,
+    gimli::DW_AT_data_bit_offset,
+    gimli::DW_AT_data_member_location,
+    gimli::DW_AT_alignment,
+    gimli::DW_AT_declaration,
+    // Skeleton declarations name their type-unit definition by signature.
+    gimli::DW_AT_signature,
+    gimli::DW_AT_decl_file,
+    gimli::DW_AT_decl_line,
+    gimli::DW_AT_count,
+    gimli::DW_AT_upper_bound,
+];
+
+/// Hash everything extraction reads from `unit`, or `None` if the unit refers to DIEs in
+/// other units: its layouts then depend on more than its own contents.
+pub(crate) fn unit_hash(
+    dwarf: &Dwarf<DwarfSlice<'_>>,
+    unit: &Unit<DwarfSlice<'_>>,
+) -> Result<Option<u64>> {
+    let mut h = FnvHasher::default();
+    h.write_u16(unit.header.version());
+    h.write_u8(unit.header.address_size());
+    h.write_u8(unit.header.format().word_size());
+    h.write_u8((dwarf.file_type == gimli::DwarfFileType::Dwo) as u8);
+    hash_bytes(&mut h, unit.comp_dir.map(|dir| dir.slice()));
+
+    if let Some(program) = &unit.line_program {
+        let header = program.header();
+        for dir in header.include_directories() {
+            hash_string(&mut h, dwarf, unit, *dir);
+        }
+        for file in header.file_names() {
+            hash_string(&mut h, dwarf, unit, file.path_name());
+            h.write_u64(file.directory_index());
+        }
+    }
+
+    let dwarf_err = |e: gimli::Error| Error::Dwarf(format!("Failed to hash unit: {}", e));
+    let mut entries = unit.entries_raw(None).map_err(dwarf_err)?;
+    while !entries.is_empty() {
+        h.write_i64(entries.next_depth() as i64);
+        let Some(abbrev) = entries.read_abbreviation().map_err(dwarf_err)? else {
+            h.write_u8(0);
+            continue;
+        };
+        h.write_u16(abbrev.tag().0);
+        h.write_u8(abbrev.has_children() as u8);
+        for &spec in abbrev.attributes() {
+            let attr = entries.read_attribute(spec).map_err(dwarf_err)?;
+            // Only whether a subprogram has an origin matters (see `cannot_define_types`),
+            // and LTO points it into other units.
+            if attr.name() == gimli::DW_AT_abstract_origin {
+                h.write_u16(attr.name().0);
+                continue;
+            }
+            if !HASHED_ATTRIBUTES.contains(&attr.name()) {
+                continue;
+            }
+            h.write_u16(attr.name().0);
+            match attr.value() {
+                AttributeValue::DebugInfoRef(_) | AttributeValue::DebugInfoRefSup(_) => {
+                    return Ok(None);
+                }
+                AttributeValue::UnitRef(offset) => {
+                    h.write_u8(1);
+                    h.write_u64(offset.0 as u64);
+                }
+                // A type signature is a hash of the type unit's contents, so it changes
+                // whenever the referenced type does.
+                AttributeValue::DebugTypesRef(signature) => {
+                    h.write_u8(8);
+                    h.write_u64(signature.0);
+                }
+                AttributeValue::Flag(flag) => h.write_u8(6 + flag as u8),
+                AttributeValue::Exprloc(expr) => hash_bytes(&mut h, Some(expr.0.slice())),
+                AttributeValue::Block(block) => hash_bytes(&mut h, Some(block.slice())),
+                value => match value.udata_value() {
+                    Some(v) => {
+                        h.write_u8(2);
+                        h.write_u64(v);
+                    }
+                    None => match value.sdata_value() {
+                        Some(v) => {
+                            h.write_u8(3);
+                            h.write_i64(v);
+                        }
+                        None => hash_string(&mut h, dwarf, unit, value),
+                    },
+                },
+            }
+        }
+    }
+
+    Ok(Some(h.finish()))
+}
+
+/// Hash the contents of a string attribute rather than its offset, which shifts with
+/// every change to the string section.
+fn hash_string(
+    h: &mut FnvHasher,
+    dwarf: &Dwarf<DwarfSlice<'_>>,
+    unit: &Unit<DwarfSlice<'_>>,
+    value: AttributeValue<DwarfSlice<'_>>,
+) {
+    hash_bytes(h, dwarf.attr_string(unit, value).ok().map(|s| s.slice()));
+}
+
+fn hash_bytes(h: &mut FnvHasher, bytes: Option<&[u8]>) {
+    match bytes {
+        Some(bytes) => {
+            h.write_u8(4);
+            h.write_u64(bytes.len() as u64);
+            h.write(bytes);
+        }
+        None => h.write_u8(5),
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    const SKELETON_ABBREV: &[u8] = &[
+        1, 0x11, 1, 0, 0, // compile_unit, children
+        // structure_type: DW_AT_declaration flag_present, DW_AT_signature ref_sig8
+        2, 0x13, 0, 0x3c, 0x19, 0x69, 0x20, 0, 0, //
+        0,
+    ];
+
+    /// Three DWARF 4 units, each a skeleton declaration of one type-unit type. Only the
+    /// signatures differ: 1, 2, then 1 again.
+    const SKELETON_INFO: &[u8] = &[
+        18, 0, 0, 0, 4, 0, 0, 0, 0, 0, 8, // header
+        1, 2, 1, 0, 0, 0, 0, 0, 0, 0, 0, // compile_unit, skeleton with signature 1
+        18, 0, 0, 0, 4, 0, 0, 0, 0, 0, 8, //
+        1, 2, 2, 0, 0, 0, 0, 0, 0, 0, 0, // signature 2
+        18, 0, 0, 0, 4, 0, 0, 0, 0, 0, 8, //
+        1, 2, 1, 0, 0, 0, 0, 0, 0, 0, 0, // signature 1
+    ];
+
+    #[test]
+    fn skeleton_signatures_are_hashed() {
+        let dwarf = Dwarf::load(|id| {
+            let data = match id {
+                gimli::SectionId::DebugInfo => SKELETON_INFO,
+                gimli::SectionId::DebugAbbrev => SKELETON_ABBREV,
+                _ => &[],
+            };
+            Ok::<_, gimli::Error>(DwarfSlice::new(data, gimli::RunTimeEndian::Little))
+        })
+        .expect("load synthetic DWARF");
+
+        let mut hashes = Vec::new();
+        let mut units = dwarf.units();
+        while let Some(header) = units.next().expect("unit header") {
+            let unit = dwarf.unit(header).expect("unit");
+            hashes.push(unit_hash(&dwarf, &unit).expect("hash").expect("self-contained unit"));
+        }
+        assert_eq!(hashes.len(), 3);
+        assert_ne!(hashes[0], hashes[1]);
+        assert_eq!(hashes[0], hashes[2]);
+    }
+}
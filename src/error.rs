@@ -16,6 +16,21 @@ pub enum Error {
 
     #[error("DWARF parsing error: {0}")]
     Dwarf(String),
+
+    #[error("Invalid access profile: {0}")]
+    Profile(String),
+
+    #[error("Invalid function profile: {0}")]
+    FunctionProfile(String),
+
+    #[error("Invalid instance counts: {0}")]
+    Instances(String),
+
+    #[error("Invalid layout snapshot: {0}")]
+    Snapshot(String),
+
+    #[error("Invalid target: {0}")]
+    Target(String),
 }
 
 pub type Result<T> = std::result::Result<T, Error>;
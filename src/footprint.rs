@@ -0,0 +1,207 @@
+//! Whole-program padding cost: per-instance padding weighted by how many instances exist.
+//!
+//! Instance counts are read from a text file with one `name: count` (or `name,count`)
+//! line per struct; `#` starts a comment and digits may be grouped with `_`. Heap
+//! profiles record allocation sites and sizes rather than types, so they have to be
+//! resolved to struct names (for example by aggregating a heaptrack or jemalloc profile
+//! per allocating constructor) before they can be used here.
+
+use crate::analysis::optimize_layout;
+use crate::error::{Error, Result};
+use crate::types::StructLayout;
+use serde::Serialize;
+use std::collections::{HashMap, HashSet};
+use std::path::Path;
+
+/// Live instance count per struct name.
+#[derive(Debug, Clone, Default)]
+pub struct InstanceCounts {
+    counts: HashMap<String, u64>,
+    /// Names in file order, for reporting the ones the binary does not define.
+    order: Vec<String>,
+}
+
+impl InstanceCounts {
+    pub fn load(path: &Path) -> Result<Self> {
+        let text = std::fs::read_to_string(path)?;
+        Self::parse(&text)
+    }
+
+    pub fn parse(text: &str) -> Result<Self> {
+        let mut counts = Self::default();
+
+        for (index, line) in text.lines().enumerate() {
+            let line = line.split('#').next().unwrap_or("").trim();
+            if line.is_empty() {
+                continue;
+            }
+
+            let parsed = line
+                .rfind([':', ','])
+                .map(|at| (line[..at].trim(), line[at + 1..].trim()))
+                .filter(|(name, _)| !name.is_empty())
+                .and_then(|(name, count)| {
+                    Some((name, count.replace('_', "").parse::<u64>().ok()?))
+                });
+            let Some((name, count)) = parsed else {
+                return Err(Error::Instances(format!(
+                    "line {}: expected `name: count`, got `{}`",
+                    index + 1,
+                    line
+                )));
+            };
+
+            match counts.counts.get_mut(name) {
+                Some(total) => *total = total.saturating_add(count),
+                None => {
+                    counts.counts.insert(name.to_string(), count);
+                    counts.order.push(name.to_string());
+                }
+            }
+        }
+
+        if counts.counts.is_empty() {
+            return Err(Error::Instances("no instance counts found".to_string()));
+        }
+        Ok(counts)
+    }
+
+    pub fn get(&self, name: &str) -> Option<u64> {
+        self.counts.get(name).copied()
+    }
+}
+
+/// One struct's padding cost across all of its instances. Byte totals saturate.
+#[derive(Debug, Clone, Serialize)]
+pub struct FootprintEntry {
+    pub name: String,
+    pub size: u64,
+    pub padding_bytes: u64,
+    pub instances: u64,
+    /// `size × instances`.
+    pub total_bytes: u64,
+    /// `padding_bytes × instances`.
+    pub wasted_bytes: u64,
+    /// Size after the reordering `optimize_layout` suggests.
+    pub optimized_size: u64,
+    /// `(size - optimized_size) × instances`.
+    pub projected_savings_bytes: u64,
+}
+
+#[derive(Debug, Clone, Serialize)]
+pub struct FootprintReport {
+    /// Counted structs, most wasted bytes first.
+    pub entries: Vec<FootprintEntry>,
+    pub total_wasted_bytes: u64,
+    pub total_projected_savings_bytes: u64,
+    /// Names in the counts file that match no struct in the binary.
+    #[serde(skip_serializing_if = "Vec::is_empty")]
+    pub unmatched: Vec<String>,
+}
+
+/// Join analyzed layouts with instance counts. Every layout with a count gets an entry;
+/// a name defined more than once (distinct layouts) is counted for each definition.
+pub fn build_footprint(
+    layouts: &[StructLayout],
+    counts: &InstanceCounts,
+    max_align: u64,
+) -> FootprintReport {
+    let mut matched: HashSet<&str> = HashSet::new();
+    let mut entries: Vec<FootprintEntry> = layouts
+        .iter()
+        .filter_map(|layout| {
+            let instances = counts.get(&layout.name)?;
+            matched.insert(layout.name.as_str());
+            let optimized_size = optimize_layout(layout, max_align).optimized_size;
+            let savings = layout.size.saturating_sub(optimized_size);
+            Some(FootprintEntry {
+                name: layout.name.clone(),
+                size: layout.size,
+                padding_bytes: layout.metrics.padding_bytes,
+                instances,
+                total_bytes: layout.size.saturating_mul(instances),
+                wasted_bytes: layout.metrics.padding_bytes.saturating_mul(instances),
+                optimized_size,
+                projected_savings_bytes: savings.saturating_mul(instances),
+            })
+        })
+        .collect();
+
+    entries.sort_by(|a, b| b.wasted_bytes.cmp(&a.wasted_bytes).then_with(|| a.name.cmp(&b.name)));
+
+    FootprintReport {
+        total_wasted_bytes: entries.iter().fold(0, |sum, e| sum.saturating_add(e.wasted_bytes)),
+        total_projected_savings_bytes: entries
+            .iter()
+            .fold(0, |sum, e| sum.saturating_add(e.projected_savings_bytes)),
+        unmatched: counts
+            .order
+            .iter()
+            .filter(|name| !matched.contains(name.as_str()))
+            .cloned()
+            .collect(),
+        entries,
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::analysis::analyze_layout;
+    use crate::types::MemberLayout;
+
+    fn padded(name: &str) -> StructLayout {
+        // { char a; int b; char c; } = 12 bytes, 6 padding; reorders to 8.
+        let mut layout = StructLayout::new(name.to_string(), 12, Some(4));
+        layout.members = vec![
+            MemberLayout::new("a".to_string(), "char".to_string(), Some(0), Some(1)),
+            MemberLayout::new("b".to_string(), "int".to_string(), Some(4), Some(4)),
+            MemberLayout::new("c".to_string(), "char".to_string(), Some(8), Some(1)),
+        ];
+        analyze_layout(&mut layout, 64);
+        layout
+    }
+
+    #[test]
+    fn parses_both_separators_and_sums_repeats() {
+        let counts =
+            InstanceCounts::parse("# live objects\nOrder: 50_000_000\nQuote,12\nOrder: 1 # more\n")
+                .unwrap();
+        assert_eq!(counts.get("Order"), Some(50_000_001));
+        assert_eq!(counts.get("Quote"), Some(12));
+        assert_eq!(counts.get("Other"), None);
+    }
+
+    #[test]
+    fn names_may_contain_colons() {
+        let counts = InstanceCounts::parse("ns::Order: 3\n").unwrap();
+        assert_eq!(counts.get("ns::Order"), Some(3));
+    }
+
+    #[test]
+    fn rejects_bad_lines_and_empty_files() {
+        let err = InstanceCounts::parse("Order: 1\nQuote: many\n").unwrap_err();
+        assert!(err.to_string().contains("line 2"), "{err}");
+        assert!(InstanceCounts::parse("# nothing\n").is_err());
+        assert!(InstanceCounts::parse(": 4\n").is_err());
+    }
+
+    #[test]
+    fn ranks_by_total_waste_and_projects_savings() {
+        let layouts = [padded("Singleton"), padded("Order")];
+        let counts = InstanceCounts::parse("Singleton: 1\nOrder: 1000\nMissing: 5\n").unwrap();
+
+        let report = build_footprint(&layouts, &counts, 8);
+
+        assert_eq!(report.entries.len(), 2);
+        let order = &report.entries[0];
+        assert_eq!(order.name, "Order");
+        assert_eq!(order.wasted_bytes, 6000);
+        assert_eq!(order.total_bytes, 12_000);
+        assert_eq!(order.optimized_size, 8);
+        assert_eq!(order.projected_savings_bytes, 4000);
+        assert_eq!(report.total_wasted_bytes, 6006);
+        assert_eq!(report.total_projected_savings_bytes, 4004);
+        assert_eq!(report.unmatched, ["Missing"]);
+    }
+}
@@ -0,0 +1,59 @@
+//! FNV-1a, for hashes that are persisted (cache keys, unit hashes, snapshot checksums) and
+//! so must not change between runs or Rust versions.
+
+use std::hash::Hasher;
+
+pub(crate) const FNV_OFFSET_BASIS: u64 = 0xcbf2_9ce4_8422_2325;
+const FNV_PRIME: u64 = 0x0000_0100_0000_01b3;
+
+/// FNV-1a as a `Hasher`.
+#[derive(Clone, Copy)]
+pub(crate) struct FnvHasher(u64);
+
+impl Default for FnvHasher {
+    fn default() -> Self {
+        Self(FNV_OFFSET_BASIS)
+    }
+}
+
+impl Hasher for FnvHasher {
+    fn write(&mut self, bytes: &[u8]) {
+        self.0 = fnv1a(self.0, bytes);
+    }
+
+    fn finish(&self) -> u64 {
+        self.0
+    }
+}
+
+pub(crate) fn fnv1a(mut hash: u64, bytes: &[u8]) -> u64 {
+    for &b in bytes {
+        hash ^= b as u64;
+        hash = hash.wrapping_mul(FNV_PRIME);
+    }
+    hash
+}
+
+/// FNV-1a over 8-byte words. Only used as a content fingerprint, so trading the
+/// per-byte avalanche for throughput on large binaries is fine.
+pub(crate) fn fnv1a_words(data: &[u8]) -> u64 {
+    let mut chunks = data.chunks_exact(8);
+    let mut hash = FNV_OFFSET_BASIS;
+    for chunk in &mut chunks {
+        let word = u64::from_le_bytes(chunk.try_into().expect("chunk of 8 bytes"));
+        hash ^= word;
+        hash = hash.wrapping_mul(FNV_PRIME);
+    }
+    fnv1a(hash, chunks.remainder())
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn word_hash_covers_tail_bytes() {
+        assert_ne!(fnv1a_words(b"0123456789"), fnv1a_words(b"0123456788"));
+        assert_ne!(fnv1a_words(b""), fnv1a_words(b"\0"));
+    }
+}
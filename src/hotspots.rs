@@ -0,0 +1,408 @@
+//! Structs that matter: ranking structs by the functions that take them as parameters.
+//!
+//! Padding says how much a layout could shrink, not whether anything hot touches it. The
+//! functions whose parameters are a struct, or a pointer or reference to one, are where
+//! its layout is paid for. Without a profile each struct is ranked by how many functions
+//! take it; with one, by the share of samples spent in those functions.
+//!
+//! Function profiles are read from a text file in either of two formats, which may not be
+//! mixed:
+//!
+//! - The symbol report printed by `perf report --stdio --no-children -s sym`, i.e. lines
+//!   like `45.23%  [.] process_order`. With `--children` the last overhead column (self)
+//!   is used. Kernel and other foreign symbols count toward the total but match nothing.
+//! - CSV lines `symbol,samples`, e.g. `process_order,1520`. An optional header line is
+//!   skipped, and weights are taken as shares of their sum.
+//!
+//! Symbols match a function by linkage name or by name, ignoring an argument list and
+//! GCC clone suffixes such as `.isra.0` or `.cold`. perf demangles C++ and Rust symbols
+//! into qualified names that debug info does not spell out; `perf report --no-demangle`
+//! leaves them matching linkage names.
+
+use crate::error::{Error, Result};
+use crate::types::{FunctionInfo, Passing, SourceLocation, StructLayout};
+use serde::Serialize;
+use std::collections::HashMap;
+use std::collections::hash_map::Entry;
+use std::path::Path;
+
+/// Suffixes GCC appends to the symbols of specialized or split copies of a function.
+const CLONE_SUFFIXES: &[&str] = &[".isra.", ".constprop.", ".part.", ".cold", ".lto_priv."];
+
+/// Share of profile samples per symbol, in percent.
+#[derive(Debug, Clone, Default)]
+pub struct FunctionProfile {
+    symbols: HashMap<String, f64>,
+}
+
+impl FunctionProfile {
+    pub fn load(path: &Path) -> Result<Self> {
+        let text = std::fs::read_to_string(path)?;
+        Self::parse(&text)
+    }
+
+    pub fn parse(text: &str) -> Result<Self> {
+        let mut perf = Vec::new();
+        let mut csv = Vec::new();
+
+        for (index, line) in text.lines().enumerate() {
+            let line = line.trim();
+            if line.is_empty() || line.starts_with('#') {
+                continue;
+            }
+
+            if let Some(sample) = parse_perf_line(line) {
+                perf.push(sample);
+            } else if line.contains(',') {
+                match parse_csv_line(line) {
+                    Some(sample) => csv.push(sample),
+                    // Tolerate one header line before the data.
+                    None if perf.is_empty() && csv.is_empty() => {}
+                    None => {
+                        return Err(Error::FunctionProfile(format!(
+                            "line {}: expected `symbol,samples`, got `{}`",
+                            index + 1,
+                            line
+                        )));
+                    }
+                }
+            }
+        }
+
+        if !perf.is_empty() && !csv.is_empty() {
+            return Err(Error::FunctionProfile(
+                "mixes perf overhead percentages with sample counts".to_string(),
+            ));
+        }
+        // perf overheads are already shares of every sample; counts become shares of their sum.
+        let scale = if csv.is_empty() {
+            1.0
+        } else {
+            let total: f64 = csv.iter().map(|(_, weight)| weight).sum();
+            if total > 0.0 { 100.0 / total } else { 0.0 }
+        };
+
+        let mut symbols: HashMap<String, f64> = HashMap::new();
+        for (symbol, weight) in perf.into_iter().chain(csv) {
+            *symbols.entry(base_symbol(symbol).to_string()).or_default() += weight * scale;
+        }
+        if symbols.is_empty() {
+            return Err(Error::FunctionProfile("no samples found".to_string()));
+        }
+        Ok(Self { symbols })
+    }
+
+    /// Percent of samples spent in `function`, or `None` if no symbol matches it.
+    pub fn weight(&self, function: &FunctionInfo) -> Option<f64> {
+        function
+            .linkage_name
+            .as_deref()
+            .and_then(|linkage| self.symbols.get(linkage))
+            .or_else(|| self.symbols.get(&function.name))
+            .copied()
+    }
+}
+
+/// `<overhead>% [...] [.] <symbol>`: one or more overhead columns, optional command and
+/// object columns, then the symbol after its `[.]` or `[k]` marker.
+fn parse_perf_line(line: &str) -> Option<(&str, f64)> {
+    let mut weight = None;
+    let mut rest = line;
+    while let Some((column, tail)) = rest.split_once(char::is_whitespace) {
+        let Some(value) = column.strip_suffix('%') else { break };
+        weight = Some(parse_weight(value)?);
+        rest = tail.trim_start();
+    }
+    let weight = weight?;
+
+    let at = rest.find("] ")?;
+    if at < 2 || !rest[..at].ends_with(['.', 'k', 'g', 'u', 'H']) || !rest[..at - 1].ends_with('[')
+    {
+        return None;
+    }
+    let symbol = rest[at + 2..].trim();
+    (!symbol.is_empty()).then_some((symbol, weight))
+}
+
+/// `symbol,weight`. The symbol is everything before the last comma, so argument lists
+/// like `scale(int, int)` survive.
+fn parse_csv_line(line: &str) -> Option<(&str, f64)> {
+    let (symbol, weight) = line.rsplit_once(',')?;
+    let weight = parse_weight(weight.trim())?;
+    let symbol = symbol.trim();
+    (!symbol.is_empty()).then_some((symbol, weight))
+}
+
+fn parse_weight(s: &str) -> Option<f64> {
+    let weight: f64 = s.parse().ok()?;
+    (weight.is_finite() && weight >= 0.0).then_some(weight)
+}
+
+/// `symbol` without an argument list or clone suffix: `route_cost.isra.0` and
+/// `route_cost(Route const*)` are both `route_cost`. Go's `main.(*Order).fill` keeps its
+/// receiver.
+fn base_symbol(symbol: &str) -> &str {
+    let symbol = match symbol.find('(') {
+        Some(at) if at > 0 && !symbol[..at].ends_with('.') => &symbol[..at],
+        _ => symbol,
+    };
+    CLONE_SUFFIXES
+        .iter()
+        .filter_map(|suffix| symbol.find(suffix))
+        .filter(|&at| at > 0)
+        .min()
+        .map_or(symbol, |at| &symbol[..at])
+}
+
+/// One function taking a struct.
+#[derive(Debug, Clone, Serialize)]
+pub struct FunctionUse {
+    pub function: String,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub linkage_name: Option<String>,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub source_location: Option<SourceLocation>,
+    /// The first parameter of the struct's type.
+    pub parameter: String,
+    pub passing: Passing,
+    /// Percent of profile samples spent in the function; `None` without a profile or
+    /// when no profiled symbol matches it.
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub weight_percent: Option<f64>,
+}
+
+/// One struct and the functions that take it.
+#[derive(Debug, Clone, Serialize)]
+pub struct HotspotEntry {
+    pub name: String,
+    pub size: u64,
+    pub padding_bytes: u64,
+    pub cache_lines: u32,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub source_location: Option<SourceLocation>,
+    /// Percent of profile samples spent in `functions`; `None` without a profile.
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub weight_percent: Option<f64>,
+    /// Functions taking the struct, hottest first, then by name.
+    pub functions: Vec<FunctionUse>,
+}
+
+#[derive(Debug, Clone, Serialize)]
+pub struct HotspotReport {
+    /// Structs taken by at least one function, most important first.
+    pub entries: Vec<HotspotEntry>,
+    /// Functions with code in the binary.
+    pub functions: usize,
+    /// Functions taking at least one listed struct.
+    pub functions_with_structs: usize,
+    /// Percent of profile samples in functions of the binary, and in those taking a
+    /// listed struct; `None` without a profile.
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub profiled_percent: Option<f64>,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub struct_profiled_percent: Option<f64>,
+}
+
+/// Join analyzed layouts with the functions taking them. Structs no function takes are
+/// left out. With a profile, structs are ranked by the samples spent in their functions,
+/// otherwise by how many functions take them; ties go to the struct with more padding.
+/// A name defined more than once (distinct layouts) gets an entry for each definition.
+pub fn build_hotspots(
+    layouts: &[StructLayout],
+    functions: &[FunctionInfo],
+    profile: Option<&FunctionProfile>,
+) -> HotspotReport {
+    let weights: Vec<Option<f64>> = functions
+        .iter()
+        .map(|function| profile.and_then(|profile| profile.weight(function)))
+        .collect();
+
+    // Each function once per struct it takes, under its first parameter of that type.
+    let mut uses: HashMap<&str, Vec<usize>> = HashMap::new();
+    let mut first_parameter: HashMap<(usize, &str), usize> = HashMap::new();
+    for (index, function) in functions.iter().enumerate() {
+        for (param, parameter) in function.parameters.iter().enumerate() {
+            let key = (index, parameter.struct_name.as_str());
+            if let Entry::Vacant(first) = first_parameter.entry(key) {
+                first.insert(param);
+                uses.entry(parameter.struct_name.as_str()).or_default().push(index);
+            }
+        }
+    }
+
+    let mut taking = vec![false; functions.len()];
+    let mut entries: Vec<HotspotEntry> = layouts
+        .iter()
+        .filter_map(|layout| {
+            let indices = uses.get(layout.name.as_str())?;
+            let mut users: Vec<FunctionUse> = indices
+                .iter()
+                .map(|&index| {
+                    taking[index] = true;
+                    let function = &functions[index];
+                    let parameter =
+                        &function.parameters[first_parameter[&(index, layout.name.as_str())]];
+                    FunctionUse {
+                        function: function.name.clone(),
+                        linkage_name: function.linkage_name.clone(),
+                        source_location: function.source_location.clone(),
+                        parameter: parameter.name.to_string(),
+                        passing: parameter.passing,
+                        weight_percent: weights[index],
+                    }
+                })
+                .collect();
+            users.sort_by(|a, b| {
+                b.weight_percent
+                    .unwrap_or(0.0)
+                    .total_cmp(&a.weight_percent.unwrap_or(0.0))
+                    .then_with(|| a.function.cmp(&b.function))
+            });
+            Some(HotspotEntry {
+                name: layout.name.clone(),
+                size: layout.size,
+                padding_bytes: layout.metrics.padding_bytes,
+                cache_lines: layout.metrics.cache_lines_spanned,
+                source_location: layout.source_location.clone(),
+                weight_percent: profile
+                    .map(|_| users.iter().filter_map(|u| u.weight_percent).fold(0.0, |a, b| a + b)),
+                functions: users,
+            })
+        })
+        .collect();
+
+    entries.sort_by(|a, b| {
+        b.weight_percent
+            .unwrap_or(0.0)
+            .total_cmp(&a.weight_percent.unwrap_or(0.0))
+            .then_with(|| b.functions.len().cmp(&a.functions.len()))
+            .then_with(|| b.padding_bytes.cmp(&a.padding_bytes))
+            .then_with(|| a.name.cmp(&b.name))
+    });
+
+    let share = |keep: &dyn Fn(usize) -> bool| -> f64 {
+        // `f64::sum` of nothing is -0.0, which prints as a negative share.
+        weights
+            .iter()
+            .enumerate()
+            .filter(|&(i, _)| keep(i))
+            .filter_map(|(_, w)| *w)
+            .fold(0.0, |a, b| a + b)
+    };
+    HotspotReport {
+        functions: functions.len(),
+        functions_with_structs: taking.iter().filter(|&&t| t).count(),
+        profiled_percent: profile.map(|_| share(&|_| true)),
+        struct_profiled_percent: profile.map(|_| share(&|i| taking[i])),
+        entries,
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::analysis::analyze_layout;
+    use crate::types::{MemberLayout, StructParameter};
+
+    fn layout(name: &str, padded: bool) -> StructLayout {
+        let mut layout = StructLayout::new(name.to_string(), 8, Some(4));
+        layout.members = vec![
+            MemberLayout::new("a", "char", Some(0), Some(1)),
+            MemberLayout::new("b", "int", Some(4), Some(if padded { 1 } else { 4 })),
+        ];
+        analyze_layout(&mut layout, 64);
+        layout
+    }
+
+    fn function(name: &str, params: &[(&str, &str, Passing)]) -> FunctionInfo {
+        FunctionInfo {
+            name: name.to_string(),
+            linkage_name: None,
+            source_location: None,
+            parameters: params
+                .iter()
+                .map(|&(name, struct_name, passing)| StructParameter {
+                    name: name.into(),
+                    struct_name: struct_name.into(),
+                    passing,
+                })
+                .collect(),
+        }
+    }
+
+    #[test]
+    fn parses_perf_symbol_reports() {
+        let report = "\
+# Overhead  Command  Shared Object      Symbol
+# ........  .......  .................  ......
+#
+    45.50%  app      app                [.] route_cost
+    10.00%  app      app                [.] route_cost.isra.0
+     3.00%  app      [kernel.kallsyms]  [k] clear_page_erms
+     1.25%  app      app                [.] _ZN6Widget6updateEv
+";
+        let profile = FunctionProfile::parse(report).unwrap();
+        assert_eq!(profile.weight(&function("route_cost", &[])), Some(55.5));
+        assert_eq!(base_symbol("main.(*Order).fill"), "main.(*Order).fill");
+        assert_eq!(profile.weight(&function("other", &[])), None);
+
+        let mut method = function("update", &[]);
+        method.linkage_name = Some("_ZN6Widget6updateEv".to_string());
+        assert_eq!(profile.weight(&method), Some(1.25));
+
+        // With --children, the self column is used.
+        let children = FunctionProfile::parse("  60.00%  20.00%  app  app  [.] main\n").unwrap();
+        assert_eq!(children.weight(&function("main", &[])), Some(20.0));
+    }
+
+    #[test]
+    fn csv_counts_become_shares() {
+        let profile =
+            FunctionProfile::parse("symbol,samples\nscale(int, int),30\nmain,10\n").unwrap();
+        assert_eq!(profile.weight(&function("scale", &[])), Some(75.0));
+        assert_eq!(profile.weight(&function("main", &[])), Some(25.0));
+    }
+
+    #[test]
+    fn rejects_bad_and_mixed_profiles() {
+        let err = FunctionProfile::parse("main,10\nscale,many\n").unwrap_err();
+        assert!(err.to_string().contains("line 2"), "{err}");
+        assert!(FunctionProfile::parse("# nothing\n").is_err());
+        assert!(FunctionProfile::parse("main,10\n  5.00%  [.] scale\n").is_err());
+        assert!(FunctionProfile::parse("main,-1\n").is_err());
+    }
+
+    #[test]
+    fn ranks_by_profile_weight_then_function_count() {
+        let layouts = [layout("Quote", true), layout("Order", false), layout("Unused", true)];
+        let functions = [
+            function("fill", &[("order", "Order", Passing::Pointer)]),
+            function("reprice", &[("quote", "Quote", Passing::Reference)]),
+            function("log_quote", &[("quote", "Quote", Passing::Pointer)]),
+            function("compare", &[("a", "Quote", Passing::Value), ("b", "Quote", Passing::Value)]),
+            function("main", &[]),
+        ];
+
+        // Without a profile Quote is taken by more functions.
+        let report = build_hotspots(&layouts, &functions, None);
+        let names: Vec<_> = report.entries.iter().map(|e| e.name.as_str()).collect();
+        assert_eq!(names, ["Quote", "Order"]);
+        assert_eq!((report.functions, report.functions_with_structs), (5, 4));
+        assert_eq!(report.profiled_percent, None);
+        let quote = &report.entries[0];
+        let users: Vec<_> =
+            quote.functions.iter().map(|u| (u.function.as_str(), u.parameter.as_str())).collect();
+        assert_eq!(users, [("compare", "a"), ("log_quote", "quote"), ("reprice", "quote")]);
+        assert_eq!(report.entries[1].padding_bytes, 3);
+
+        // The profile puts Order's one function ahead of all of Quote's.
+        let profile = FunctionProfile::parse("fill,70\nlog_quote,10\nmain,20\n").unwrap();
+        let report = build_hotspots(&layouts, &functions, Some(&profile));
+        let ranked: Vec<_> =
+            report.entries.iter().map(|e| (e.name.as_str(), e.weight_percent)).collect();
+        assert_eq!(ranked, [("Order", Some(70.0)), ("Quote", Some(10.0))]);
+        assert_eq!(report.entries[1].functions[0].function, "log_quote");
+        assert_eq!(report.profiled_percent, Some(100.0));
+        assert_eq!(report.struct_profiled_percent, Some(80.0));
+    }
+}
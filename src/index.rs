@@ -0,0 +1,160 @@
+//! In-memory index of extracted layouts, for answering many queries against one binary
+//! (see the `serve` command).
+
+use crate::types::StructLayout;
+use serde::Deserialize;
+use std::collections::HashMap;
+
+/// Which layouts a query selects. Unset fields match every layout.
+#[derive(Debug, Clone, Default, Deserialize)]
+#[serde(default)]
+pub struct LayoutQuery {
+    /// Exact struct name.
+    pub name: Option<String>,
+    /// Substring of the struct name, like `--filter`.
+    pub filter: Option<String>,
+    /// Declaring source file: the full path as recorded in DWARF, or its trailing
+    /// components (`order.h`, `include/order.h`).
+    pub file: Option<String>,
+    pub min_size: Option<u64>,
+    pub max_size: Option<u64>,
+}
+
+/// Layouts indexed by name, declaring file and size.
+pub struct LayoutIndex {
+    layouts: Vec<StructLayout>,
+    by_name: HashMap<String, Vec<usize>>,
+    by_file: HashMap<String, Vec<usize>>,
+    /// (size, index), sorted.
+    by_size: Vec<(u64, usize)>,
+}
+
+impl LayoutIndex {
+    pub fn new(layouts: Vec<StructLayout>) -> Self {
+        let mut by_name: HashMap<String, Vec<usize>> = HashMap::new();
+        let mut by_file: HashMap<String, Vec<usize>> = HashMap::new();
+        let mut by_size = Vec::with_capacity(layouts.len());
+        for (i, layout) in layouts.iter().enumerate() {
+            by_name.entry(layout.name.clone()).or_default().push(i);
+            if let Some(loc) = &layout.source_location {
+                by_file.entry(loc.file.clone()).or_default().push(i);
+            }
+            by_size.push((layout.size, i));
+        }
+        by_size.sort_unstable();
+        Self { layouts, by_name, by_file, by_size }
+    }
+
+    pub fn layouts(&self) -> &[StructLayout] {
+        &self.layouts
+    }
+
+    pub fn len(&self) -> usize {
+        self.layouts.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.layouts.is_empty()
+    }
+
+    /// The layouts matching every condition of `query`, in extraction order.
+    pub fn query(&self, query: &LayoutQuery) -> Vec<&StructLayout> {
+        // Start from the most selective index, then check the remaining conditions.
+        let mut candidates: Vec<usize> = if let Some(name) = &query.name {
+            self.by_name.get(name).cloned().unwrap_or_default()
+        } else if let Some(file) = &query.file {
+            self.by_file
+                .iter()
+                .filter(|(path, _)| file_matches(path, file))
+                .flat_map(|(_, indices)| indices.iter().copied())
+                .collect()
+        } else if query.min_size.is_some() || query.max_size.is_some() {
+            let min = query.min_size.unwrap_or(0);
+            let start = self.by_size.partition_point(|&(size, _)| size < min);
+            let end = match query.max_size {
+                Some(max) => self.by_size.partition_point(|&(size, _)| size <= max),
+                None => self.by_size.len(),
+            };
+            self.by_size.get(start..end).unwrap_or_default().iter().map(|&(_, i)| i).collect()
+        } else {
+            (0..self.layouts.len()).collect()
+        };
+        candidates.sort_unstable();
+
+        candidates
+            .into_iter()
+            .map(|i| &self.layouts[i])
+            .filter(|l| query.name.as_ref().is_none_or(|name| &l.name == name))
+            .filter(|l| query.filter.as_ref().is_none_or(|f| l.name.contains(f.as_str())))
+            .filter(|l| {
+                query.file.as_ref().is_none_or(|file| {
+                    l.source_location.as_ref().is_some_and(|loc| file_matches(&loc.file, file))
+                })
+            })
+            .filter(|l| query.min_size.is_none_or(|min| l.size >= min))
+            .filter(|l| query.max_size.is_none_or(|max| l.size <= max))
+            .collect()
+    }
+}
+
+fn file_matches(path: &str, file: &str) -> bool {
+    path == file
+        || path.strip_suffix(file).is_some_and(|rest| rest.ends_with('/') || rest.ends_with('\\'))
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::types::SourceLocation;
+
+    fn index() -> LayoutIndex {
+        let layout = |name: &str, size: u64, file: Option<&str>| {
+            let mut l = StructLayout::new(name.to_string(), size, Some(8));
+            l.source_location = file.map(|f| SourceLocation { file: f.to_string(), line: 1 });
+            l
+        };
+        LayoutIndex::new(vec![
+            layout("Order", 64, Some("/src/include/order.h")),
+            layout("OrderBook", 4096, Some("/src/book.h")),
+            layout("Tick", 24, Some("/src/reorder.h")),
+            layout("Anon", 8, None),
+        ])
+    }
+
+    fn names(layouts: Vec<&StructLayout>) -> Vec<&str> {
+        layouts.into_iter().map(|l| l.name.as_str()).collect()
+    }
+
+    #[test]
+    fn query_by_name_filter_and_size() {
+        let index = index();
+        let q = |query: LayoutQuery| names(index.query(&query));
+
+        assert_eq!(q(LayoutQuery::default()), ["Order", "OrderBook", "Tick", "Anon"]);
+        assert_eq!(q(LayoutQuery { name: Some("Order".into()), ..Default::default() }), ["Order"]);
+        assert_eq!(
+            q(LayoutQuery { filter: Some("Order".into()), ..Default::default() }),
+            ["Order", "OrderBook"]
+        );
+        assert_eq!(
+            q(LayoutQuery { min_size: Some(24), max_size: Some(64), ..Default::default() }),
+            ["Order", "Tick"]
+        );
+        assert_eq!(
+            q(LayoutQuery { name: Some("Order".into()), max_size: Some(32), ..Default::default() }),
+            [] as [&str; 0]
+        );
+    }
+
+    #[test]
+    fn query_by_file_matches_whole_trailing_components() {
+        let index = index();
+        let q = |file: &str| {
+            names(index.query(&LayoutQuery { file: Some(file.into()), ..Default::default() }))
+        };
+        assert_eq!(q("order.h"), ["Order"]);
+        assert_eq!(q("include/order.h"), ["Order"]);
+        assert_eq!(q("/src/book.h"), ["OrderBook"]);
+        assert!(q("der.h").is_empty());
+    }
+}
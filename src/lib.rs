@@ -1,25 +1,55 @@
 pub mod analysis;
+pub mod batch;
+pub mod cache;
 pub mod cli;
 pub mod diff;
 pub mod dwarf;
 pub mod error;
+pub mod footprint;
+mod hash;
+pub mod hotspots;
+pub mod index;
+pub mod intern;
 pub mod loader;
 pub mod output;
+pub mod profile;
+pub mod snapshot;
+pub mod target;
+pub mod timings;
 pub mod types;
 
 pub use analysis::{
-    OptimizedLayout, OptimizedMember, analyze_false_sharing, analyze_layout, optimize_layout,
+    CacheLinePlan, HotFieldPlacement, LoopFootprint, OptimizedLayout, OptimizedMember,
+    PROFILE_HOT_SHARE, SplitKind, SplitPlan, TargetSuggestion, analyze_access_heat,
+    analyze_false_sharing, analyze_false_sharing_pairs, analyze_layout, analyze_layout_for_targets,
+    analyze_nested_padding, analyze_writer_roles, cache_lines_touched, hot_fields_from_heat,
+    optimize_for_targets, optimize_layout, optimize_layout_for_access,
+    optimize_layout_for_cache_lines, optimize_layout_for_split, optimize_layout_for_targets,
 };
-pub use cli::{Cli, Commands, OutputFormat, SortField};
-pub use diff::{DiffResult, diff_layouts};
-pub use dwarf::DwarfContext;
+pub use batch::{BatchReport, BatchStruct, merge_layouts};
+pub use cache::{CacheKey, LayoutCache, UnitLayouts};
+pub use cli::{Cli, Commands, OutputFormat, SortField, SuggestStrategy, TimingsFormat};
+pub use diff::{ArrayStride, DiffResult, PerformanceImpact, Regression, diff_layouts};
+pub use dwarf::{DwarfContext, UnitCache};
 pub use error::{Error, Result};
+pub use footprint::{FootprintEntry, FootprintReport, InstanceCounts, build_footprint};
+pub use hotspots::{FunctionProfile, FunctionUse, HotspotEntry, HotspotReport, build_hotspots};
+pub use index::{LayoutIndex, LayoutQuery};
+pub use intern::Name;
 pub use loader::{BinaryData, LoadedDwarf};
 pub use output::{
-    CheckViolation, CheckViolationKind, JsonFormatter, SarifFormatter, SuggestJsonFormatter,
-    SuggestTableFormatter, TableFormatter,
+    CheckViolation, CheckViolationKind, FootprintJsonFormatter, FootprintTableFormatter,
+    HotspotsJsonFormatter, HotspotsTableFormatter, JsonFormatter, SarifFormatter,
+    SuggestJsonFormatter, SuggestTableFormatter, TableFormatter, TimingsJsonFormatter,
+    TimingsTableFormatter,
 };
+pub use profile::{AccessProfile, AccessSample};
+pub use snapshot::{Snapshot, SnapshotMember, SnapshotStruct};
+pub use target::{TARGET_PROFILES, TargetProfile, widest_interference};
+pub use timings::{ExtractCounters, ExtractStats, StageTiming, Timings, TimingsReport};
 pub use types::{
-    AtomicMember, CacheLineSpanningWarning, FalseSharingAnalysis, FalseSharingWarning,
-    LayoutMetrics, MemberLayout, PaddingHole, SourceLocation, StructLayout,
+    AccessHeat, AtomicMember, CacheLineHeat, CacheLineSpanningWarning, ContendedCacheLine,
+    FalseSharingAnalysis, FalseSharingWarning, FunctionInfo, LayoutMetrics, MemberHeat,
+    MemberLayout, NestedPadding, PaddingContributor, PaddingHole, Passing, RoleMember,
+    SourceLocation, StructLayout, StructParameter, TargetMetrics, WriterConflict,
 };
@@ -1,15 +1,20 @@
 use crate::error::{Error, Result};
-use gimli::{Dwarf, EndianSlice, RunTimeEndian, SectionId};
+use gimli::{
+    DebugPubTypes, Dwarf, DwarfPackage, DwoId, EndianSlice, RunTimeEndian, Section, SectionId,
+    UnitType,
+};
 use memmap2::Mmap;
-use object::{Object, ObjectSection};
-use std::borrow::Cow;
+use object::{CompressedData, CompressionFormat, Object, ObjectSection};
 use std::collections::HashMap;
 use std::fs::File;
-use std::path::Path;
+use std::path::{Path, PathBuf};
 use std::pin::Pin;
+use std::sync::atomic::{AtomicUsize, Ordering};
 
 pub struct BinaryData {
     pub mmap: Mmap,
+    /// Where the binary was loaded from; split DWARF files are looked up relative to it.
+    pub path: PathBuf,
 }
 
 pub type DwarfSlice<'a> = EndianSlice<'a, RunTimeEndian>;
@@ -34,33 +39,73 @@ impl DecompressedSections {
     fn get(&self, name: &str) -> Option<&[u8]> {
         self.sections.get(name).map(|v| v.as_slice())
     }
+
+    fn total_bytes(&self) -> u64 {
+        self.sections.values().map(|v| v.len() as u64).sum()
+    }
+}
+
+/// A mapped `.dwo` or `.dwp` file backing some of `LoadedDwarf::split_dwarfs`.
+struct SplitFile {
+    _mmap: Mmap,
+    decompressed_sections: Pin<Box<DecompressedSections>>,
 }
 
 pub struct LoadedDwarf<'a> {
     pub dwarf: Dwarf<DwarfSlice<'a>>,
+    /// Name index of public types; empty when the binary has no `.debug_pubtypes`.
+    pub debug_pubtypes: DebugPubTypes<DwarfSlice<'a>>,
+    /// Split units (`-gsplit-dwarf`) referenced by skeleton units of `dwarf`, one `Dwarf`
+    /// per `.dwo` file or `.dwp` contribution, in skeleton unit order.
+    pub split_dwarfs: Vec<Dwarf<DwarfSlice<'a>>>,
+    /// `.dwo` files named by skeleton units that could not be found or parsed.
+    pub missing_split_units: Vec<PathBuf>,
     pub address_size: u8,
     pub endian: RunTimeEndian,
+    /// Total size of the sections that had to be decompressed, split files included.
+    pub decompressed_bytes: u64,
     /// Pinned storage for decompressed sections. The Dwarf object holds slices
     /// pointing into this data, so it must remain at a stable address.
     /// Named with underscore prefix to indicate intentional non-use (kept for lifetime).
     _decompressed_sections: Pin<Box<DecompressedSections>>,
+    /// Mappings `split_dwarfs` borrow from. Declared after them so they are dropped last.
+    _split_files: Vec<SplitFile>,
 }
 
-/// Standard DWARF section names that we need to load.
-const DEBUG_SECTIONS: &[&str] = &[
-    "abbrev",
-    "addr",
-    "aranges",
-    "info",
-    "line",
-    "line_str",
-    "loc",
-    "loclists",
-    "ranges",
-    "rnglists",
-    "str",
-    "str_offsets",
-    "types",
+/// Standard DWARF sections that `load_dwarf` prepares.
+const DEBUG_SECTIONS: &[SectionId] = &[
+    SectionId::DebugAbbrev,
+    SectionId::DebugAddr,
+    SectionId::DebugAranges,
+    SectionId::DebugInfo,
+    SectionId::DebugLine,
+    SectionId::DebugLineStr,
+    SectionId::DebugLoc,
+    SectionId::DebugLocLists,
+    SectionId::DebugPubTypes,
+    SectionId::DebugRanges,
+    SectionId::DebugRngLists,
+    SectionId::DebugStr,
+    SectionId::DebugStrOffsets,
+    SectionId::DebugTypes,
+    // Only present in `.dwp` packages.
+    SectionId::DebugCuIndex,
+    SectionId::DebugTuIndex,
+];
+
+/// The subset of `DEBUG_SECTIONS` read by struct layout extraction (`DwarfContext`).
+/// Address, range and location lists are never consulted for type layouts.
+const LAYOUT_SECTIONS: &[SectionId] = &[
+    SectionId::DebugAbbrev,
+    SectionId::DebugInfo,
+    SectionId::DebugLine,
+    SectionId::DebugLineStr,
+    SectionId::DebugPubTypes,
+    SectionId::DebugStr,
+    SectionId::DebugStrOffsets,
+    SectionId::DebugTypes,
+    SectionId::DebugCuIndex,
+    SectionId::DebugTuIndex,
 ];
 
 impl BinaryData {
@@ -69,10 +114,23 @@ impl BinaryData {
         // SAFETY: The file is opened read-only and we keep the mmap alive
         // for the lifetime of BinaryData.
         let mmap = unsafe { Mmap::map(&file)? };
-        Ok(Self { mmap })
+        Ok(Self { mmap, path: path.to_path_buf() })
     }
 
+    /// Load every standard DWARF section, decompressing on one thread per CPU.
     pub fn load_dwarf(&self) -> Result<LoadedDwarf<'_>> {
+        self.load_dwarf_sections(DEBUG_SECTIONS, 0)
+    }
+
+    /// Load only the sections struct layout extraction reads. Compressed sections outside
+    /// that set are never decompressed and appear empty; uncompressed ones are still
+    /// borrowed from the mapping since that is free. Sections are decompressed and `.dwo`
+    /// files loaded on up to `jobs` threads (0 = one per CPU).
+    pub fn load_dwarf_for_layouts(&self, jobs: usize) -> Result<LoadedDwarf<'_>> {
+        self.load_dwarf_sections(LAYOUT_SECTIONS, jobs)
+    }
+
+    fn load_dwarf_sections(&self, sections: &[SectionId], jobs: usize) -> Result<LoadedDwarf<'_>> {
         let object = object::File::parse(&*self.mmap)?;
 
         if !matches!(
@@ -86,73 +144,338 @@ impl BinaryData {
             if object.is_little_endian() { RunTimeEndian::Little } else { RunTimeEndian::Big };
 
         // Create pinned storage for decompressed sections
-        let mut decompressed_sections = DecompressedSections::new();
-
-        // Pre-decompress any compressed sections and store them
-        for &base_name in DEBUG_SECTIONS {
-            let debug_name = format!(".debug_{}", base_name);
-            let zdebug_name = format!(".zdebug_{}", base_name);
-
-            // Try .debug_* first, then .zdebug_*
-            for name in [&debug_name, &zdebug_name] {
-                if let Some(section) = object.section_by_name(name) {
-                    if let Ok(Cow::Owned(vec)) = section.uncompressed_data() {
-                        // Leak the string to get a 'static lifetime - this is fine since
-                        // these are a fixed set of section names used for the program lifetime
-                        let static_name: &'static str = match name.as_str() {
-                            n if n == debug_name => leak_section_name(&debug_name),
-                            _ => leak_section_name(&zdebug_name),
-                        };
-                        decompressed_sections.insert(static_name, vec);
-                    }
-                }
-            }
-        }
+        let decompressed_sections = decompress_sections(&object, sections, false, jobs);
 
         // Create a raw pointer to the pinned storage for use in the closure.
         // SAFETY: The Pin<Box<DecompressedSections>> ensures the data won't move.
         // We only read from it in the closure, and the LoadedDwarf keeps it alive.
         let decompressed_ptr = &*decompressed_sections as *const DecompressedSections;
-
         let load_section = |id: SectionId| -> std::result::Result<DwarfSlice<'_>, gimli::Error> {
-            let section_name = id.name();
-            let zdebug_name = section_name.replace(".debug_", ".zdebug_");
-
-            let try_load = |name: &str| -> Option<&[u8]> {
-                // SAFETY: decompressed_ptr points to pinned data that outlives this closure
-                let decompressed = unsafe { &*decompressed_ptr };
-                if let Some(slice) = decompressed.get(name) {
-                    return Some(slice);
-                }
-
-                // Fall back to borrowing directly from mmap for uncompressed sections
-                object.section_by_name(name).and_then(|s| s.uncompressed_data().ok()).and_then(
-                    |data| match data {
-                        Cow::Borrowed(b) => Some(b),
-                        Cow::Owned(_) => None,
-                    },
-                )
-            };
-
-            let slice = try_load(section_name).or_else(|| try_load(&zdebug_name)).unwrap_or(&[]);
-
-            Ok(EndianSlice::new(slice, endian))
+            Ok(section_data(&object, decompressed_ptr, id, false, endian))
         };
 
         let dwarf = Dwarf::load(load_section).map_err(|e| Error::Dwarf(e.to_string()))?;
+        let debug_pubtypes =
+            DebugPubTypes::load(load_section).map_err(|e| Error::Dwarf(e.to_string()))?;
 
         let mut units = dwarf.units();
         if units.next().map_err(|e| Error::Dwarf(e.to_string()))?.is_none() {
             return Err(Error::NoDebugInfo);
         }
 
+        // GNU split DWARF 4 skeletons are plain compile units, but they always come with a
+        // .debug_addr section; without one only DWARF 5 skeleton headers need a look.
+        let gnu_split = object.section_by_name(".debug_addr").is_some();
+        let skeletons = skeleton_units(&dwarf, gnu_split)?;
+        let split = if skeletons.is_empty() {
+            SplitDwarf::default()
+        } else {
+            self.load_split_dwarf(&dwarf, skeletons, sections, endian, jobs)?
+        };
+
+        let decompressed_bytes = decompressed_sections.total_bytes()
+            + split.files.iter().map(|f| f.decompressed_sections.total_bytes()).sum::<u64>();
         Ok(LoadedDwarf {
             dwarf,
+            debug_pubtypes,
+            split_dwarfs: split.dwarfs,
+            missing_split_units: split.missing,
             address_size: if object.is_64() { 8 } else { 4 },
             endian,
+            decompressed_bytes,
             _decompressed_sections: decompressed_sections,
+            _split_files: split.files,
         })
     }
+
+    /// Find the split unit of every skeleton: in `<binary>.dwp` when that package exists and
+    /// lists the unit, otherwise in the `.dwo` file the skeleton names. `.dwo` files are
+    /// mapped and parsed on a pool of `jobs` worker threads.
+    fn load_split_dwarf<'a>(
+        &self,
+        parent: &Dwarf<DwarfSlice<'a>>,
+        skeletons: Vec<Skeleton>,
+        sections: &[SectionId],
+        endian: RunTimeEndian,
+        jobs: usize,
+    ) -> Result<SplitDwarf<'a>> {
+        let mut split = SplitDwarf::default();
+        let mut dwo_files = Vec::new();
+
+        let mut dwp_path = self.path.clone().into_os_string();
+        dwp_path.push(".dwp");
+        let dwp_path = PathBuf::from(dwp_path);
+        if dwp_path.is_file() {
+            let (file, object) = map_split_file(&dwp_path).map_err(|e| {
+                Error::Dwarf(format!("Failed to load {}: {}", dwp_path.display(), e))
+            })?;
+            let decompressed = decompress_sections(&object, sections, true, jobs);
+            let decompressed_ptr = &*decompressed as *const DecompressedSections;
+            let dwp = DwarfPackage::load(
+                |id| -> std::result::Result<DwarfSlice<'a>, gimli::Error> {
+                    Ok(section_data(&object, decompressed_ptr, id, true, endian))
+                },
+                EndianSlice::new(&[], endian),
+            )
+            .map_err(|e| Error::Dwarf(format!("Failed to read {}: {}", dwp_path.display(), e)))?;
+
+            for skeleton in skeletons {
+                match dwp.find_cu(skeleton.dwo_id, parent) {
+                    Ok(Some(dwarf)) => split.dwarfs.push(dwarf),
+                    _ => dwo_files.push(skeleton.path),
+                }
+            }
+            split.files.push(SplitFile { _mmap: file, decompressed_sections: decompressed });
+        } else {
+            dwo_files.extend(skeletons.into_iter().map(|skeleton| skeleton.path));
+        }
+
+        // Build trees are often moved after linking; fall back to a `.dwo` next to the binary.
+        for path in &mut dwo_files {
+            if !path.is_file() {
+                let beside = self.path.parent().zip(path.file_name()).map(|(dir, n)| dir.join(n));
+                if let Some(beside) = beside.filter(|p| p.is_file()) {
+                    *path = beside;
+                }
+            }
+        }
+
+        let workers = crate::dwarf::effective_jobs(jobs).min(dwo_files.len()).max(1);
+        let chunk_size = dwo_files.len().div_ceil(workers).max(1);
+        let loaded: Vec<_> = std::thread::scope(|scope| {
+            let handles: Vec<_> = dwo_files
+                .chunks(chunk_size)
+                .map(|chunk| {
+                    scope.spawn(move || {
+                        chunk
+                            .iter()
+                            .map(|path| load_dwo(path, parent, sections, endian))
+                            .collect::<Vec<_>>()
+                    })
+                })
+                .collect();
+            handles
+                .into_iter()
+                .flat_map(|handle| {
+                    handle.join().unwrap_or_else(|panic| std::panic::resume_unwind(panic))
+                })
+                .collect()
+        });
+
+        for (path, result) in dwo_files.into_iter().zip(loaded) {
+            match result {
+                Some((file, dwarf)) => {
+                    split.dwarfs.push(dwarf);
+                    split.files.push(file);
+                }
+                None => split.missing.push(path),
+            }
+        }
+
+        Ok(split)
+    }
+}
+
+/// What a skeleton unit says about its split unit.
+struct Skeleton {
+    dwo_id: DwoId,
+    /// The `.dwo` file, resolved against the compilation directory.
+    path: PathBuf,
+}
+
+#[derive(Default)]
+struct SplitDwarf<'a> {
+    dwarfs: Vec<Dwarf<DwarfSlice<'a>>>,
+    files: Vec<SplitFile>,
+    missing: Vec<PathBuf>,
+}
+
+/// Collect the skeleton units of `dwarf`. DWARF 5 marks them in the unit header; GNU split
+/// DWARF 4 skeletons are only recognizable by their `DW_AT_GNU_dwo_id`, so their root DIE
+/// is parsed when `gnu_split` is set.
+fn skeleton_units(dwarf: &Dwarf<DwarfSlice<'_>>, gnu_split: bool) -> Result<Vec<Skeleton>> {
+    let mut skeletons = Vec::new();
+    let mut units = dwarf.units();
+    while let Some(header) =
+        units.next().map_err(|e| Error::Dwarf(format!("Failed to read unit header: {}", e)))?
+    {
+        let candidate = match header.type_() {
+            UnitType::Skeleton(_) => true,
+            UnitType::Compilation => gnu_split && header.version() < 5,
+            _ => false,
+        };
+        if !candidate {
+            continue;
+        }
+
+        let unit =
+            dwarf.unit(header).map_err(|e| Error::Dwarf(format!("Failed to parse unit: {}", e)))?;
+        let Some(dwo_id) = unit.dwo_id else { continue };
+        let dwo_name = match unit.dwo_name() {
+            Ok(Some(attr)) => dwarf
+                .attr_string(&unit, attr)
+                .map_err(|e| Error::Dwarf(format!("Failed to read dwo name: {}", e)))?,
+            _ => continue,
+        };
+
+        let dwo_name = PathBuf::from(&*dwo_name.to_string_lossy());
+        let path = match &unit.comp_dir {
+            Some(comp_dir) => PathBuf::from(&*comp_dir.to_string_lossy()).join(dwo_name),
+            None => dwo_name,
+        };
+        skeletons.push(Skeleton { dwo_id, path });
+    }
+    Ok(skeletons)
+}
+
+/// Map and parse one `.dwo` file. Returns `None` when it is missing or unreadable, which
+/// the caller reports instead of failing the whole binary.
+fn load_dwo<'a>(
+    path: &Path,
+    parent: &Dwarf<DwarfSlice<'a>>,
+    sections: &[SectionId],
+    endian: RunTimeEndian,
+) -> Option<(SplitFile, Dwarf<DwarfSlice<'a>>)> {
+    let (file, object) = map_split_file(path).ok()?;
+    // Already on one of the pool's workers.
+    let decompressed = decompress_sections(&object, sections, true, 1);
+    let decompressed_ptr = &*decompressed as *const DecompressedSections;
+
+    let mut dwarf = Dwarf::load(|id| -> std::result::Result<DwarfSlice<'a>, gimli::Error> {
+        Ok(section_data(&object, decompressed_ptr, id, true, endian))
+    })
+    .ok()?;
+    dwarf.make_dwo(parent);
+
+    Some((SplitFile { _mmap: file, decompressed_sections: decompressed }, dwarf))
+}
+
+/// Map a split DWARF file and parse it with the lifetime of the `LoadedDwarf` it will be
+/// stored in.
+fn map_split_file<'a>(path: &Path) -> Result<(Mmap, object::File<'a>)> {
+    let file = File::open(path)?;
+    // SAFETY: The file is opened read-only.
+    let mmap = unsafe { Mmap::map(&file)? };
+    // SAFETY: The mapping is moved into a `SplitFile` owned by the `LoadedDwarf` that holds
+    // every slice borrowed from it, and its address does not change when the `Mmap` moves.
+    let data: &'a [u8] = unsafe { std::slice::from_raw_parts(mmap.as_ptr(), mmap.len()) };
+    let object = object::File::parse(data)?;
+    Ok((mmap, object))
+}
+
+/// The section name for `id` in a regular object (`split == false`) or `.dwo`/`.dwp` file.
+fn section_name(id: SectionId, split: bool) -> Option<&'static str> {
+    if split { id.dwo_name() } else { Some(id.name()) }
+}
+
+/// Pre-decompress the compressed sections among `sections` on up to `jobs` threads.
+fn decompress_sections(
+    object: &object::File<'_>,
+    sections: &[SectionId],
+    split: bool,
+    jobs: usize,
+) -> Pin<Box<DecompressedSections>> {
+    let mut decompressed_sections = DecompressedSections::new();
+
+    // Find the compressed sections first; reading the compression header is cheap.
+    let mut compressed: Vec<(&'static str, CompressedData<'_>)> = Vec::new();
+    for &id in sections {
+        let Some(debug_name) = section_name(id, split) else { continue };
+        let zdebug_name = debug_name.replace(".debug_", ".zdebug_");
+
+        // Try .debug_* first, then .zdebug_*
+        for name in [debug_name, &zdebug_name] {
+            if let Some(section) = object.section_by_name(name) {
+                if let Ok(data) = section.compressed_data() {
+                    if data.format != CompressionFormat::None {
+                        // Leak the string to get a 'static lifetime - this is fine since
+                        // these are a fixed set of section names used for the program lifetime
+                        compressed.push((leak_section_name(name), data));
+                    }
+                }
+            }
+        }
+    }
+
+    // Decompress concurrently: .debug_info, .debug_str and .debug_line dominate and are
+    // independent. Failures leave the section empty.
+    for (name, data) in decompress_all(compressed, jobs) {
+        decompressed_sections.insert(name, data);
+    }
+    decompressed_sections
+}
+
+/// Return section `id` of `object`, preferring its decompressed copy.
+fn section_data<'a>(
+    object: &object::File<'a>,
+    decompressed_ptr: *const DecompressedSections,
+    id: SectionId,
+    split: bool,
+    endian: RunTimeEndian,
+) -> DwarfSlice<'a> {
+    let Some(section_name) = section_name(id, split) else {
+        return EndianSlice::new(&[], endian);
+    };
+    let zdebug_name = section_name.replace(".debug_", ".zdebug_");
+
+    let try_load = |name: &str| -> Option<&'a [u8]> {
+        // SAFETY: decompressed_ptr points to pinned data that the caller keeps alive for 'a
+        let decompressed = unsafe { &*decompressed_ptr };
+        if let Some(slice) = decompressed.get(name) {
+            return Some(slice);
+        }
+
+        // Fall back to borrowing directly from mmap for uncompressed sections.
+        // Compressed sections that were not selected are left empty rather than
+        // decompressed here.
+        object
+            .section_by_name(name)
+            .and_then(|s| s.compressed_data().ok())
+            .filter(|data| data.format == CompressionFormat::None)
+            .map(|data| data.data)
+    };
+
+    let slice = try_load(section_name).or_else(|| try_load(&zdebug_name)).unwrap_or(&[]);
+    EndianSlice::new(slice, endian)
+}
+
+/// Decompress `compressed` on up to `jobs` threads (0 = one per CPU), dropping sections
+/// that fail to decompress.
+fn decompress_all(
+    compressed: Vec<(&'static str, CompressedData<'_>)>,
+    jobs: usize,
+) -> Vec<(&'static str, Vec<u8>)> {
+    let decompress = |(name, data): &(&'static str, CompressedData<'_>)| {
+        data.decompress().ok().map(|bytes| (*name, bytes.into_owned()))
+    };
+
+    let workers = crate::dwarf::effective_jobs(jobs).min(compressed.len());
+    if workers <= 1 {
+        return compressed.iter().filter_map(decompress).collect();
+    }
+
+    // Sections differ widely in size, so workers take the next one as they finish.
+    let next_index = AtomicUsize::new(0);
+    std::thread::scope(|scope| {
+        let handles: Vec<_> = (0..workers)
+            .map(|_| {
+                scope.spawn(|| {
+                    let mut done = Vec::new();
+                    while let Some(job) = compressed.get(next_index.fetch_add(1, Ordering::Relaxed))
+                    {
+                        done.extend(decompress(job));
+                    }
+                    done
+                })
+            })
+            .collect();
+        handles
+            .into_iter()
+            .flat_map(|handle| {
+                handle.join().unwrap_or_else(|panic| std::panic::resume_unwind(panic))
+            })
+            .collect()
+    })
 }
 
 /// Leak a section name string to get a 'static lifetime.
@@ -174,3 +497,27 @@ fn leak_section_name(name: &str) -> &'static str {
     guard.insert(name.to_string(), leaked);
     leaked
 }
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn decompress_all_returns_every_section_for_any_job_count() {
+        let data: Vec<Vec<u8>> = (0..5u8).map(|i| vec![i; 16 * (i as usize + 1)]).collect();
+        let names = [".debug_info", ".debug_str", ".debug_line", ".debug_abbrev", ".debug_ranges"];
+        for jobs in [1, 2, 8] {
+            let compressed = names
+                .iter()
+                .zip(&data)
+                .map(|(&name, bytes)| (name, CompressedData::none(bytes)))
+                .collect();
+            let mut done = decompress_all(compressed, jobs);
+            done.sort_unstable();
+            let mut expected: Vec<_> =
+                names.iter().zip(&data).map(|(&name, bytes)| (name, bytes.clone())).collect();
+            expected.sort_unstable();
+            assert_eq!(done, expected, "jobs = {}", jobs);
+        }
+    }
+}
@@ -1,11 +1,26 @@
 use anyhow::{Context, Result, bail};
-use clap::Parser;
+use clap::{Parser, ValueEnum};
 use layout_audit::{
-    BinaryData, CheckViolation, CheckViolationKind, Cli, Commands, DwarfContext, JsonFormatter,
-    OutputFormat, SarifFormatter, SortField, SuggestJsonFormatter, SuggestTableFormatter,
-    TableFormatter, analyze_false_sharing, analyze_layout, diff_layouts, optimize_layout,
+    AccessProfile, BatchStruct, BinaryData, CacheKey, CheckViolation, CheckViolationKind, Cli,
+    Commands, DwarfContext, ExtractStats, FootprintJsonFormatter, FootprintTableFormatter,
+    FunctionProfile, HotspotsJsonFormatter, HotspotsTableFormatter, InstanceCounts, JsonFormatter,
+    LayoutCache, LoadedDwarf, OptimizedLayout, OutputFormat, PROFILE_HOT_SHARE, Regression,
+    SarifFormatter, Snapshot, SortField, StructLayout, SuggestJsonFormatter, SuggestStrategy,
+    SuggestTableFormatter, TableFormatter, TargetProfile, Timings, TimingsFormat,
+    TimingsJsonFormatter, TimingsTableFormatter, UnitLayouts, analyze_access_heat,
+    analyze_false_sharing, analyze_false_sharing_pairs, analyze_layout, analyze_layout_for_targets,
+    analyze_nested_padding, analyze_writer_roles, build_footprint, build_hotspots,
+    cache_lines_touched, diff_layouts, hot_fields_from_heat, merge_layouts, optimize_for_targets,
+    optimize_layout, optimize_layout_for_access, optimize_layout_for_cache_lines,
+    optimize_layout_for_split, widest_interference,
 };
-use std::path::Path;
+use std::io::Write;
+use std::path::{Path, PathBuf};
+use std::sync::OnceLock;
+use std::sync::atomic::{AtomicBool, AtomicUsize, Ordering};
+use std::time::Duration;
+
+mod serve;
 
 /// Configuration for the inspect command
 struct InspectConfig<'a> {
@@ -14,12 +29,104 @@ struct InspectConfig<'a> {
     output_format: OutputFormat,
     sort_by: SortField,
     top: Option<usize>,
+    /// Member tables for only this many structs, in table output.
+    detail: Option<usize>,
     min_padding: Option<u64>,
     no_color: bool,
     cache_line_size: u32,
     pretty: bool,
     warn_false_sharing: bool,
+    false_sharing_pairs: bool,
+    profile: Option<&'a AccessProfile>,
+    nested: bool,
+    include_go_runtime: bool,
+    jobs: usize,
+    cache_dir: Option<&'a Path>,
+    write_snapshot: Option<&'a Path>,
+    /// `--target` profiles; `cache_line_size` is then the smallest of their lines.
+    targets: &'a [TargetProfile],
+}
+
+/// Configuration for the batch command
+struct BatchConfig<'a> {
+    paths: &'a [PathBuf],
+    filter: Option<&'a str>,
+    output_format: OutputFormat,
+    sort_by: SortField,
+    top: Option<usize>,
+    min_padding: Option<u64>,
+    no_color: bool,
+    cache_line_size: u32,
+    pretty: bool,
     include_go_runtime: bool,
+    jobs: usize,
+    cache_dir: Option<&'a Path>,
+}
+
+/// Configuration for the suggest command
+struct SuggestConfig<'a> {
+    binary_path: &'a Path,
+    filter: Option<&'a str>,
+    output_format: OutputFormat,
+    min_savings: Option<u64>,
+    cache_line_size: u32,
+    pretty: bool,
+    max_align: u64,
+    sort_by_savings: bool,
+    strategy: SuggestStrategy,
+    /// `--keep-together` groups per struct name.
+    keep_together: &'a [(String, Vec<String>)],
+    /// `--hot` fields per struct name.
+    hot: &'a [(String, Vec<String>)],
+    elements: u64,
+    profile: Option<&'a AccessProfile>,
+    no_color: bool,
+    include_go_runtime: bool,
+    jobs: usize,
+    cache_dir: Option<&'a Path>,
+    /// `--target` profiles; `cache_line_size` is then the smallest of their lines.
+    targets: &'a [TargetProfile],
+}
+
+/// Configuration for the serve command
+struct ServeConfig<'a> {
+    binary_path: &'a Path,
+    listen: &'a str,
+    poll_interval: Duration,
+    cache_line_size: u32,
+    include_go_runtime: bool,
+    jobs: usize,
+    cache_dir: Option<&'a Path>,
+}
+
+/// Configuration for the footprint command
+struct FootprintConfig<'a> {
+    binary_path: &'a Path,
+    instances: &'a InstanceCounts,
+    filter: Option<&'a str>,
+    output_format: OutputFormat,
+    top: Option<usize>,
+    cache_line_size: u32,
+    max_align: u64,
+    pretty: bool,
+    no_color: bool,
+    include_go_runtime: bool,
+    jobs: usize,
+    cache_dir: Option<&'a Path>,
+}
+
+/// Configuration for the hotspots command
+struct HotspotsConfig<'a> {
+    binary_path: &'a Path,
+    profile: Option<&'a FunctionProfile>,
+    filter: Option<&'a str>,
+    output_format: OutputFormat,
+    top: Option<usize>,
+    cache_line_size: u32,
+    pretty: bool,
+    no_color: bool,
+    include_go_runtime: bool,
+    jobs: usize,
 }
 
 fn run_cli(cli: Cli) -> Result<()> {
@@ -30,25 +137,43 @@ fn run_cli(cli: Cli) -> Result<()> {
             output,
             sort_by,
             top,
+            detail,
             min_padding,
             no_color,
             cache_line,
+            target,
             pretty,
             warn_false_sharing,
+            false_sharing_pairs,
+            profile,
+            nested,
             include_go_runtime,
+            jobs,
+            cache_dir,
+            write_snapshot,
         } => {
+            let profile = profile.as_deref().map(load_profile).transpose()?;
+            let targets = resolve_targets(&target, &binary)?;
             let config = InspectConfig {
                 binary_path: &binary,
                 filter: filter.as_deref(),
                 output_format: output,
                 sort_by,
                 top,
+                detail,
                 min_padding,
                 no_color,
-                cache_line_size: cache_line,
+                cache_line_size: single_line_size(&targets, cache_line),
                 pretty,
-                warn_false_sharing,
+                warn_false_sharing: warn_false_sharing || false_sharing_pairs,
+                false_sharing_pairs,
+                profile: profile.as_ref(),
+                nested,
                 include_go_runtime,
+                jobs,
+                cache_dir: cache_dir.as_deref(),
+                write_snapshot: write_snapshot.as_deref(),
+                targets: &targets,
             };
             run_inspect(&config)?;
         }
@@ -59,7 +184,10 @@ fn run_cli(cli: Cli) -> Result<()> {
             output,
             cache_line,
             fail_on_regression,
+            regression_on,
             include_go_runtime,
+            jobs,
+            cache_dir,
         } => {
             let has_regression = run_diff(
                 &old,
@@ -68,14 +196,37 @@ fn run_cli(cli: Cli) -> Result<()> {
                 output,
                 cache_line,
                 fail_on_regression,
+                &regression_on,
                 include_go_runtime,
+                jobs,
+                cache_dir.as_deref(),
             )?;
             if fail_on_regression && has_regression {
+                report_timings()?;
                 std::process::exit(1);
             }
         }
-        Commands::Check { binary, config, output, cache_line, include_go_runtime } => {
-            run_check(&binary, &config, output, cache_line, include_go_runtime)?;
+        Commands::Check {
+            binary,
+            config,
+            output,
+            cache_line,
+            target,
+            include_go_runtime,
+            jobs,
+            cache_dir,
+        } => {
+            let targets = resolve_targets(&target, &binary)?;
+            run_check(
+                &binary,
+                &config,
+                output,
+                single_line_size(&targets, cache_line),
+                &targets,
+                include_go_runtime,
+                jobs,
+                cache_dir.as_deref(),
+            )?;
         }
         Commands::Suggest {
             binary,
@@ -85,22 +236,163 @@ fn run_cli(cli: Cli) -> Result<()> {
             cache_line,
             pretty,
             max_align,
+            target,
             sort_by_savings,
+            strategy,
+            keep_together,
+            hot,
+            elements,
+            profile,
             no_color,
             include_go_runtime,
+            jobs,
+            cache_dir,
         } => {
-            run_suggest(
-                &binary,
-                filter.as_deref(),
-                output,
+            let keep_together = parse_field_groups(
+                &keep_together,
+                "keep-together",
+                SuggestStrategy::CacheLine,
+                strategy,
+            )?;
+            let hot = parse_field_groups(&hot, "hot", SuggestStrategy::Split, strategy)?;
+            let profile = profile.as_deref().map(load_profile).transpose()?;
+            let targets = resolve_targets(&target, &binary)?;
+            run_suggest(&SuggestConfig {
+                binary_path: &binary,
+                filter: filter.as_deref(),
+                output_format: output,
                 min_savings,
-                cache_line,
+                cache_line_size: single_line_size(&targets, cache_line),
                 pretty,
                 max_align,
                 sort_by_savings,
+                strategy,
+                keep_together: &keep_together,
+                hot: &hot,
+                elements,
+                profile: profile.as_ref(),
                 no_color,
                 include_go_runtime,
-            )?;
+                jobs,
+                cache_dir: cache_dir.as_deref(),
+                targets: &targets,
+            })?;
+        }
+        Commands::Batch {
+            paths,
+            filter,
+            output,
+            sort_by,
+            top,
+            min_padding,
+            no_color,
+            cache_line,
+            pretty,
+            include_go_runtime,
+            jobs,
+            cache_dir,
+        } => {
+            let config = BatchConfig {
+                paths: &paths,
+                filter: filter.as_deref(),
+                output_format: output,
+                sort_by,
+                top,
+                min_padding,
+                no_color,
+                cache_line_size: cache_line,
+                pretty,
+                include_go_runtime,
+                jobs,
+                cache_dir: cache_dir.as_deref(),
+            };
+            run_batch(&config)?;
+        }
+        Commands::Footprint {
+            binary,
+            instances,
+            filter,
+            output,
+            top,
+            cache_line,
+            max_align,
+            pretty,
+            no_color,
+            include_go_runtime,
+            jobs,
+            cache_dir,
+        } => {
+            let counts = InstanceCounts::load(&instances).with_context(|| {
+                format!("Failed to load instance counts: {}", instances.display())
+            })?;
+            let config = FootprintConfig {
+                binary_path: &binary,
+                instances: &counts,
+                filter: filter.as_deref(),
+                output_format: output,
+                top,
+                cache_line_size: cache_line,
+                max_align,
+                pretty,
+                no_color,
+                include_go_runtime,
+                jobs,
+                cache_dir: cache_dir.as_deref(),
+            };
+            run_footprint(&config)?;
+        }
+        Commands::Hotspots {
+            binary,
+            perf,
+            filter,
+            output,
+            top,
+            cache_line,
+            pretty,
+            no_color,
+            include_go_runtime,
+            jobs,
+        } => {
+            let profile = perf
+                .map(|path| {
+                    FunctionProfile::load(&path).with_context(|| {
+                        format!("Failed to load function profile: {}", path.display())
+                    })
+                })
+                .transpose()?;
+            let config = HotspotsConfig {
+                binary_path: &binary,
+                profile: profile.as_ref(),
+                filter: filter.as_deref(),
+                output_format: output,
+                top,
+                cache_line_size: cache_line,
+                pretty,
+                no_color,
+                include_go_runtime,
+                jobs,
+            };
+            run_hotspots(&config)?;
+        }
+        Commands::Serve {
+            binary,
+            listen,
+            poll_ms,
+            cache_line,
+            include_go_runtime,
+            jobs,
+            cache_dir,
+        } => {
+            let config = ServeConfig {
+                binary_path: &binary,
+                listen: &listen,
+                poll_interval: Duration::from_millis(poll_ms),
+                cache_line_size: cache_line,
+                include_go_runtime,
+                jobs,
+                cache_dir: cache_dir.as_deref(),
+            };
+            serve::run_serve(&config)?;
         }
     }
 
@@ -109,20 +401,283 @@ fn run_cli(cli: Cli) -> Result<()> {
 
 fn main() -> Result<()> {
     let cli = Cli::parse();
-    run_cli(cli)
+    if cli.timings.is_some() || cli.timings_file.is_some() {
+        let format = cli.timings.unwrap_or(TimingsFormat::Table);
+        let _ = TIMINGS.set((Timings::new(), format, cli.timings_file.clone()));
+    }
+    NAME_INDEX.store(cli.name_index, Ordering::Relaxed);
+    let result = run_cli(cli);
+    report_timings()?;
+    result
+}
+
+/// Set by `--timings`: the run's stage timings, how to report them and where.
+static TIMINGS: OnceLock<(Timings, TimingsFormat, Option<PathBuf>)> = OnceLock::new();
+
+/// Run `f` as pipeline stage `name` when `--timings` is on. Stages may overlap on other
+/// threads; a stage nested in another on the same thread is counted in both.
+fn timed<T>(name: &'static str, f: impl FnOnce() -> T) -> T {
+    match TIMINGS.get() {
+        Some((timings, _, _)) => timings.stage(name, f),
+        None => f(),
+    }
+}
+
+/// Set by `--name-index`; passed to `DwarfContext::with_name_index`.
+static NAME_INDEX: AtomicBool = AtomicBool::new(false);
+
+fn name_index() -> bool {
+    NAME_INDEX.load(Ordering::Relaxed)
+}
+
+/// Extraction counters to pass to `DwarfContext::with_stats`.
+fn extract_stats() -> Option<&'static ExtractStats> {
+    TIMINGS.get().map(|(timings, _, _)| timings.extract_stats())
+}
+
+/// Print the `--timings` report to stderr, or write it to `--timings-file`.
+fn report_timings() -> Result<()> {
+    let Some((timings, format, path)) = TIMINGS.get() else {
+        return Ok(());
+    };
+    let report = timings.report();
+    let output = match format {
+        TimingsFormat::Table => TimingsTableFormatter::new().format(&report),
+        TimingsFormat::Json => TimingsJsonFormatter::new(false).format(&report),
+    };
+    match path {
+        Some(path) => std::fs::write(path, output + "\n")
+            .with_context(|| format!("Failed to write timings to {}", path.display())),
+        None => {
+            eprintln!("{}", output);
+            Ok(())
+        }
+    }
+}
+
+/// Parse repeatable `STRUCT:FIELD,FIELD` specs given with `--<flag>`, which only `required`
+/// uses.
+fn parse_field_groups(
+    specs: &[String],
+    flag: &str,
+    required: SuggestStrategy,
+    strategy: SuggestStrategy,
+) -> Result<Vec<(String, Vec<String>)>> {
+    if !specs.is_empty() && strategy != required {
+        let name = required.to_possible_value().map(|v| v.get_name().to_string());
+        bail!("--{} requires --strategy {}", flag, name.unwrap_or_default());
+    }
+    specs
+        .iter()
+        .map(|spec| {
+            let Some((name, fields)) = spec.rsplit_once(':') else {
+                bail!("Invalid --{} '{}': expected STRUCT:FIELD,FIELD", flag, spec);
+            };
+            let fields: Vec<String> = fields
+                .split(',')
+                .map(str::trim)
+                .filter(|f| !f.is_empty())
+                .map(String::from)
+                .collect();
+            if name.is_empty() || fields.is_empty() {
+                bail!("Invalid --{} '{}': expected STRUCT:FIELD,FIELD", flag, spec);
+            }
+            Ok((name.to_string(), fields))
+        })
+        .collect()
+}
+
+/// Resolve `--target` names. The binary is only mapped when `auto` asks for its
+/// architecture.
+fn resolve_targets(names: &[String], binary: &Path) -> Result<Vec<TargetProfile>> {
+    if !names.iter().any(|name| name.eq_ignore_ascii_case("auto")) {
+        return Ok(TargetProfile::resolve(names, &[])?);
+    }
+    let data = BinaryData::load(binary)
+        .with_context(|| format!("Failed to load binary: {}", binary.display()))?;
+    TargetProfile::resolve(names, &data.mmap)
+        .with_context(|| format!("Failed to pick a target for {}", binary.display()))
+}
+
+/// The line size to use where only one applies: with targets, the smallest of their lines,
+/// which is the one that splits a layout into the most lines.
+fn single_line_size(targets: &[TargetProfile], cache_line_size: u32) -> u32 {
+    targets.iter().map(|t| t.cache_line).min().unwrap_or(cache_line_size)
+}
+
+/// `analyze_layout`, or `analyze_layout_for_targets` when targets were given.
+fn analyze_for_targets(layout: &mut StructLayout, cache_line_size: u32, targets: &[TargetProfile]) {
+    if targets.is_empty() {
+        analyze_layout(layout, cache_line_size);
+    } else {
+        analyze_layout_for_targets(layout, targets);
+    }
+}
+
+/// The distance within which atomics and writers interfere: the widest of the targets',
+/// or one cache line.
+fn sharing_distance(targets: &[TargetProfile], cache_line_size: u32) -> u32 {
+    widest_interference(targets).map_or(cache_line_size, |t| t.interference_size())
+}
+
+fn load_profile(path: &Path) -> Result<AccessProfile> {
+    AccessProfile::load(path)
+        .with_context(|| format!("Failed to load access profile: {}", path.display()))
+}
+
+/// Extract struct layouts via `extract`, going through the on-disk layout cache when
+/// `cache_dir` is set. On a miss, `extract` is handed the binary's per-unit layouts to pass
+/// to `DwarfContext::with_unit_cache`. Cache write failures are reported but never fail
+/// the run.
+fn cached_layouts(
+    binary: &BinaryData,
+    cache_dir: Option<&Path>,
+    filter: Option<&str>,
+    include_go_runtime: bool,
+    extract: impl FnOnce(Option<&UnitLayouts>) -> Result<Vec<StructLayout>>,
+) -> Result<Vec<StructLayout>> {
+    LayoutLookup::new(binary, cache_dir, filter, include_go_runtime)?.resolve(extract)
+}
+
+/// The result of looking a binary up in the layout cache, kept apart from the extraction
+/// so callers can tell beforehand whether DWARF will have to be parsed. A layout snapshot
+/// given in place of the binary is always a hit.
+enum LayoutLookup {
+    Hit(Vec<StructLayout>),
+    /// Not cached. Holds where to store the extracted layouts when caching is enabled,
+    /// along with the key of the per-unit entry.
+    Miss(Option<(LayoutCache, CacheKey, CacheKey)>),
+}
+
+impl LayoutLookup {
+    fn new(
+        binary: &BinaryData,
+        cache_dir: Option<&Path>,
+        filter: Option<&str>,
+        include_go_runtime: bool,
+    ) -> Result<Self> {
+        if Snapshot::is_snapshot(&binary.mmap) {
+            let layouts = timed("snapshot", || {
+                let snapshot = Snapshot::parse(&binary.mmap)?;
+                Ok::<_, layout_audit::Error>(snapshot.layouts(filter, include_go_runtime))
+            })
+            .with_context(|| format!("Failed to read snapshot: {}", binary.path.display()))?;
+            return Ok(Self::Hit(layouts));
+        }
+
+        let Some(dir) = cache_dir else {
+            return Ok(Self::Miss(None));
+        };
+
+        let cache = LayoutCache::new(dir);
+        let key = CacheKey::new(binary, filter, include_go_runtime)
+            .with_name_index(name_index() && filter.is_some());
+        Ok(match timed("cache", || cache.load(&key)) {
+            Some(layouts) => Self::Hit(layouts),
+            None => {
+                let units_key = CacheKey::for_units(binary, filter, include_go_runtime);
+                Self::Miss(Some((cache, key, units_key)))
+            }
+        })
+    }
+
+    fn is_hit(&self) -> bool {
+        matches!(self, Self::Hit(_))
+    }
+
+    fn resolve(
+        self,
+        extract: impl FnOnce(Option<&UnitLayouts>) -> Result<Vec<StructLayout>>,
+    ) -> Result<Vec<StructLayout>> {
+        let (cache, key, units_key) = match self {
+            Self::Hit(layouts) => return Ok(layouts),
+            Self::Miss(None) => return extract(None),
+            Self::Miss(Some(slot)) => slot,
+        };
+
+        let units = timed("cache", || cache.load_units(&units_key));
+        let layouts = extract(Some(&units))?;
+        let stored = timed("cache", || {
+            cache.store(&key, &layouts).and_then(|()| cache.store_units(&units_key, &units))
+        });
+        if let Err(e) = stored {
+            eprintln!("Warning: Failed to write layout cache to {}: {}", cache.dir().display(), e);
+        }
+        Ok(layouts)
+    }
+}
+
+/// Load the DWARF that layout extraction reads, warning about split units whose `.dwo`
+/// file could not be found.
+fn load_layout_dwarf<'a>(
+    binary: &'a BinaryData,
+    jobs: usize,
+    context: &'static str,
+) -> Result<LoadedDwarf<'a>> {
+    let loaded = timed_load_dwarf(binary, jobs).context(context)?;
+    warn_missing_split_units(&loaded);
+    Ok(loaded)
+}
+
+/// `load_dwarf_for_layouts` as the `load_dwarf` stage, counting decompressed sections.
+fn timed_load_dwarf(binary: &BinaryData, jobs: usize) -> layout_audit::Result<LoadedDwarf<'_>> {
+    let loaded = timed("load_dwarf", || binary.load_dwarf_for_layouts(jobs))?;
+    if let Some((timings, _, _)) = TIMINGS.get() {
+        timings.add_decompressed(loaded.decompressed_bytes);
+    }
+    Ok(loaded)
+}
+
+fn warn_missing_split_units(loaded: &LoadedDwarf<'_>) {
+    for path in &loaded.missing_split_units {
+        eprintln!("Warning: Split DWARF file not found: {}", path.display());
+    }
 }
 
 fn run_inspect(config: &InspectConfig<'_>) -> Result<()> {
-    let binary = BinaryData::load(config.binary_path)
+    let binary = timed("mmap", || BinaryData::load(config.binary_path))
         .with_context(|| format!("Failed to load binary: {}", config.binary_path.display()))?;
 
-    let loaded = binary.load_dwarf().context("Failed to load DWARF debug info")?;
-
-    let dwarf = DwarfContext::new(&loaded);
+    // Flattening needs the embedded types too, so nested mode filters after extraction.
+    let extract_filter = if config.nested { None } else { config.filter };
+    let mut layouts = cached_layouts(
+        &binary,
+        config.cache_dir,
+        extract_filter,
+        config.include_go_runtime,
+        |units| {
+            let loaded =
+                load_layout_dwarf(&binary, config.jobs, "Failed to load DWARF debug info")?;
+            let dwarf = DwarfContext::new(&loaded)
+                .with_jobs(config.jobs)
+                .with_unit_cache(units)
+                .with_name_index(name_index())
+                .with_stats(extract_stats());
+            timed("extract", || dwarf.find_structs(extract_filter, config.include_go_runtime))
+                .context("Failed to parse struct layouts")
+        },
+    )?;
+
+    if config.nested {
+        timed("analyze", || {
+            for layout in &mut layouts {
+                analyze_for_targets(layout, config.cache_line_size, config.targets);
+            }
+            analyze_nested_padding(&mut layouts, config.cache_line_size);
+        });
+        if let Some(f) = config.filter {
+            layouts.retain(|l| l.name.contains(f));
+        }
+    }
 
-    let mut layouts = dwarf
-        .find_structs(config.filter, config.include_go_runtime)
-        .context("Failed to parse struct layouts")?;
+    if let Some(path) = config.write_snapshot {
+        timed("output", || {
+            let snapshot = Snapshot::encode(&layouts)?;
+            std::fs::write(path, snapshot)?;
+            Ok::<_, anyhow::Error>(())
+        })
+        .with_context(|| format!("Failed to write snapshot: {}", path.display()))?;
+    }
 
     if layouts.is_empty() {
         if let Some(f) = config.filter {
@@ -133,14 +688,17 @@ fn run_inspect(config: &InspectConfig<'_>) -> Result<()> {
         return Ok(());
     }
 
-    for layout in &mut layouts {
-        analyze_layout(layout, config.cache_line_size);
-        if config.warn_false_sharing {
-            let fs_analysis = analyze_false_sharing(layout, config.cache_line_size);
-            layout.metrics.false_sharing = Some(fs_analysis);
-        }
+    if config.output_format == OutputFormat::Ndjson {
+        // Streaming analyzes each struct as it is written, so all of it counts as output.
+        return timed("output", || stream_ndjson(config, layouts));
     }
 
+    timed("analyze", || {
+        for layout in &mut layouts {
+            analyze_for_inspect(layout, config);
+        }
+    });
+
     if let Some(min) = config.min_padding {
         layouts.retain(|l| l.metrics.padding_bytes >= min);
     }
@@ -150,13 +708,75 @@ fn run_inspect(config: &InspectConfig<'_>) -> Result<()> {
         return Ok(());
     }
 
-    match config.sort_by {
-        SortField::Name => layouts.sort_by(|a, b| a.name.cmp(&b.name)),
-        SortField::Size => layouts.sort_by(|a, b| b.size.cmp(&a.size)),
+    sort_layouts(&mut layouts, config.sort_by);
+
+    if let Some(n) = config.top {
+        layouts.truncate(n);
+    }
+
+    let jobs = layout_audit::dwarf::effective_jobs(config.jobs);
+    timed("output", || {
+        write_stdout(|out| {
+            match config.output_format {
+                OutputFormat::Table => {
+                    let mut formatter =
+                        TableFormatter::new(config.no_color, config.cache_line_size)
+                            .with_jobs(jobs);
+                    if let Some(n) = config.detail {
+                        formatter = formatter.with_detail(n);
+                    }
+                    formatter.write(&mut *out, &layouts)?;
+                }
+                OutputFormat::Json => {
+                    JsonFormatter::new(config.pretty).write(&mut *out, &layouts)?
+                }
+                OutputFormat::Sarif => {
+                    SarifFormatter::new().with_jobs(jobs).write_inspect(&mut *out, &layouts)?
+                }
+                OutputFormat::Ndjson => unreachable!("handled by stream_ndjson"),
+            }
+            out.write_all(b"\n")
+        })
+    })
+}
+
+fn analyze_for_inspect(layout: &mut StructLayout, config: &InspectConfig<'_>) {
+    // Nested mode analyzed every layout up front, before flattening them.
+    if !config.nested {
+        analyze_for_targets(layout, config.cache_line_size, config.targets);
+    }
+    if config.warn_false_sharing {
+        let distance = sharing_distance(config.targets, config.cache_line_size);
+        let fs_analysis = if config.false_sharing_pairs {
+            analyze_false_sharing_pairs(layout, distance)
+        } else {
+            analyze_false_sharing(layout, distance)
+        };
+        layout.metrics.false_sharing = Some(fs_analysis);
+    }
+    if let Some(samples) = config.profile.and_then(|p| p.samples(&layout.name)) {
+        let heat = analyze_access_heat(layout, samples, config.cache_line_size);
+        layout.metrics.access_heat = Some(heat);
+    }
+}
+
+fn sort_layouts(layouts: &mut [StructLayout], sort_by: SortField) {
+    sort_by_layout(layouts, sort_by, |layout| layout);
+}
+
+/// Sort items that wrap a `StructLayout` by one of its fields.
+fn sort_by_layout<T>(items: &mut [T], sort_by: SortField, layout: impl Fn(&T) -> &StructLayout) {
+    let layout = &layout;
+    let by = |f: fn(&StructLayout, &StructLayout) -> std::cmp::Ordering| {
+        move |a: &T, b: &T| f(layout(a), layout(b))
+    };
+    match sort_by {
+        SortField::Name => items.sort_by(by(|a, b| a.name.cmp(&b.name))),
+        SortField::Size => items.sort_by(by(|a, b| b.size.cmp(&a.size))),
         SortField::Padding => {
-            layouts.sort_by(|a, b| b.metrics.padding_bytes.cmp(&a.metrics.padding_bytes))
+            items.sort_by(by(|a, b| b.metrics.padding_bytes.cmp(&a.metrics.padding_bytes)))
         }
-        SortField::PaddingPct => layouts.sort_by(|a, b| {
+        SortField::PaddingPct => items.sort_by(by(|a, b| {
             match (a.metrics.padding_percentage.is_nan(), b.metrics.padding_percentage.is_nan()) {
                 (true, true) => std::cmp::Ordering::Equal,
                 (true, false) => std::cmp::Ordering::Greater,
@@ -167,33 +787,244 @@ fn run_inspect(config: &InspectConfig<'_>) -> Result<()> {
                     .partial_cmp(&a.metrics.padding_percentage)
                     .unwrap_or(std::cmp::Ordering::Equal),
             }
-        }),
+        })),
+    }
+}
+
+/// Write to a buffered, locked stdout. A closed pipe (e.g. `| head`) ends output quietly.
+fn write_stdout(write: impl FnOnce(&mut dyn Write) -> std::io::Result<()>) -> Result<()> {
+    let stdout = std::io::stdout();
+    let mut out = std::io::BufWriter::new(stdout.lock());
+    match write(&mut out).and_then(|()| out.flush()) {
+        Err(e) if e.kind() == std::io::ErrorKind::BrokenPipe => Ok(()),
+        result => result.context("Failed to write output"),
+    }
+}
+
+/// NDJSON inspect output: each struct is analyzed, written and dropped in turn, so neither
+/// the analyzed set nor the serialized document is ever held in full. Sorting by anything
+/// but name needs every struct's metrics first, so those orders analyze up front.
+fn stream_ndjson(config: &InspectConfig<'_>, mut layouts: Vec<StructLayout>) -> Result<()> {
+    let min_padding = config.min_padding.unwrap_or(0);
+    let limit = config.top.unwrap_or(usize::MAX);
+    let mut written = 0;
+
+    write_stdout(|out| {
+        if config.sort_by == SortField::Name {
+            sort_layouts(&mut layouts, SortField::Name);
+            for mut layout in layouts {
+                if written == limit {
+                    break;
+                }
+                analyze_for_inspect(&mut layout, config);
+                if layout.metrics.padding_bytes < min_padding {
+                    continue;
+                }
+                JsonFormatter::write_ndjson(out, &layout)?;
+                written += 1;
+            }
+        } else {
+            for layout in &mut layouts {
+                analyze_for_inspect(layout, config);
+            }
+            layouts.retain(|l| l.metrics.padding_bytes >= min_padding);
+            sort_layouts(&mut layouts, config.sort_by);
+            for layout in layouts.into_iter().take(limit) {
+                JsonFormatter::write_ndjson(out, &layout)?;
+                written += 1;
+            }
+        }
+        Ok(())
+    })?;
+
+    if written == 0 && limit > 0 {
+        eprintln!("No structs match the filter criteria");
+    }
+    Ok(())
+}
+
+/// NDJSON streams one struct per line, which only fits `inspect` output.
+fn reject_ndjson(output_format: OutputFormat, command: &str) -> Result<()> {
+    if output_format == OutputFormat::Ndjson {
+        bail!("NDJSON output is only supported by inspect; use -o json for {}", command);
+    }
+    Ok(())
+}
+
+fn run_batch(config: &BatchConfig<'_>) -> Result<()> {
+    if !matches!(config.output_format, OutputFormat::Table | OutputFormat::Json) {
+        bail!("batch supports table and json output");
+    }
+
+    let inputs = batch_inputs(config.paths)?;
+    if inputs.is_empty() {
+        bail!("No binaries found in the given paths");
+    }
+
+    let mut report = merge_layouts(extract_batch(&inputs, config)?);
+
+    // Each distinct layout is analyzed once, however many binaries share it.
+    timed("analyze", || {
+        for entry in &mut report.structs {
+            analyze_layout(&mut entry.layout, config.cache_line_size);
+        }
+    });
+
+    if let Some(min) = config.min_padding {
+        report.structs.retain(|s| s.layout.metrics.padding_bytes >= min);
     }
 
+    if report.structs.is_empty() {
+        eprintln!("No structs match the filter criteria");
+        return Ok(());
+    }
+
+    sort_by_layout(&mut report.structs, config.sort_by, |s: &BatchStruct| &s.layout);
+
     if let Some(n) = config.top {
-        layouts.truncate(n);
+        report.structs.truncate(n);
     }
 
-    let output_str = match config.output_format {
+    timed("output", || match config.output_format {
         OutputFormat::Table => {
             let formatter = TableFormatter::new(config.no_color, config.cache_line_size);
-            formatter.format(&layouts)
+            write_stdout(|out| writeln!(out, "{}", formatter.format_batch(&report.structs)))
         }
         OutputFormat::Json => {
             let formatter = JsonFormatter::new(config.pretty);
-            formatter.format(&layouts)
+            write_stdout(|out| {
+                formatter.write_batch(&mut *out, &report)?;
+                out.write_all(b"\n")
+            })
         }
-        OutputFormat::Sarif => {
-            let formatter = SarifFormatter::new();
-            formatter.format_inspect(&layouts)
+        OutputFormat::Ndjson | OutputFormat::Sarif => unreachable!("rejected above"),
+    })
+}
+
+/// A binary named on the command line, or a file found in a directory named there.
+struct BatchInput {
+    path: PathBuf,
+    /// Files found in a directory that turn out not to be binaries with debug info are
+    /// skipped instead of failing the run.
+    from_directory: bool,
+}
+
+/// Expand directories to the non-empty files directly inside them, sorted by name.
+fn batch_inputs(paths: &[PathBuf]) -> Result<Vec<BatchInput>> {
+    let mut inputs = Vec::new();
+    for path in paths {
+        if !path.is_dir() {
+            inputs.push(BatchInput { path: path.clone(), from_directory: false });
+            continue;
         }
-    };
 
-    println!("{}", output_str);
+        let read_dir = std::fs::read_dir(path)
+            .with_context(|| format!("Failed to read directory: {}", path.display()))?;
+        let mut files = Vec::new();
+        for entry in read_dir {
+            let entry =
+                entry.with_context(|| format!("Failed to read directory: {}", path.display()))?;
+            let is_candidate = entry.metadata().is_ok_and(|m| m.is_file() && m.len() > 0);
+            if is_candidate {
+                files.push(entry.path());
+            }
+        }
+        files.sort();
+        inputs.extend(files.into_iter().map(|path| BatchInput { path, from_directory: true }));
+    }
+    Ok(inputs)
+}
 
-    Ok(())
+/// Extract every input on a pool of `jobs` worker threads, one binary at a time per worker,
+/// and return the layouts in input order.
+fn extract_batch(
+    inputs: &[BatchInput],
+    config: &BatchConfig<'_>,
+) -> Result<Vec<(String, Vec<StructLayout>)>> {
+    let workers = layout_audit::dwarf::effective_jobs(config.jobs).min(inputs.len()).max(1);
+    let next_index = AtomicUsize::new(0);
+
+    let mut results: Vec<(usize, Result<Option<Vec<StructLayout>>>)> =
+        std::thread::scope(|scope| {
+            let handles: Vec<_> = (0..workers)
+                .map(|_| {
+                    scope.spawn(|| {
+                        let mut produced = Vec::new();
+                        loop {
+                            let index = next_index.fetch_add(1, Ordering::Relaxed);
+                            let Some(input) = inputs.get(index) else { break };
+                            produced.push((index, extract_batch_input(input, config)));
+                        }
+                        produced
+                    })
+                })
+                .collect();
+
+            handles
+                .into_iter()
+                .flat_map(|handle| {
+                    handle.join().unwrap_or_else(|panic| std::panic::resume_unwind(panic))
+                })
+                .collect()
+        });
+    results.sort_unstable_by_key(|(index, _)| *index);
+
+    let mut per_binary = Vec::with_capacity(results.len());
+    for (index, result) in results {
+        if let Some(layouts) = result? {
+            per_binary.push((inputs[index].path.display().to_string(), layouts));
+        }
+    }
+    Ok(per_binary)
+}
+
+/// Extract one batch input, or `None` for a directory entry that is not a binary with
+/// debug info. Binaries are the unit of parallelism, so each is extracted on one thread.
+fn extract_batch_input(
+    input: &BatchInput,
+    config: &BatchConfig<'_>,
+) -> Result<Option<Vec<StructLayout>>> {
+    let path = &input.path;
+    let binary = timed("mmap", || BinaryData::load(path))
+        .with_context(|| format!("Failed to load binary: {}", path.display()))?;
+
+    let mut not_a_binary = false;
+    let result = cached_layouts(
+        &binary,
+        config.cache_dir,
+        config.filter,
+        config.include_go_runtime,
+        |units| {
+            let loaded = match timed_load_dwarf(&binary, 1) {
+                Err(
+                    e @ (layout_audit::Error::UnsupportedFormat
+                    | layout_audit::Error::ObjectParse(_)
+                    | layout_audit::Error::NoDebugInfo),
+                ) if input.from_directory => {
+                    not_a_binary = true;
+                    return Err(e.into());
+                }
+                loaded => loaded.with_context(|| {
+                    format!("Failed to load DWARF debug info: {}", path.display())
+                })?,
+            };
+            warn_missing_split_units(&loaded);
+            let dwarf = DwarfContext::new(&loaded)
+                .with_unit_cache(units)
+                .with_name_index(name_index())
+                .with_stats(extract_stats());
+            timed("extract", || dwarf.find_structs(config.filter, config.include_go_runtime))
+                .with_context(|| format!("Failed to parse struct layouts: {}", path.display()))
+        },
+    );
+
+    match result {
+        Err(_) if not_a_binary => Ok(None),
+        result => result.map(Some),
+    }
 }
 
+#[allow(clippy::too_many_arguments)]
 fn run_diff(
     old_path: &Path,
     new_path: &Path,
@@ -201,45 +1032,86 @@ fn run_diff(
     output_format: OutputFormat,
     cache_line_size: u32,
     fail_on_regression: bool,
+    regressions: &[Regression],
     include_go_runtime: bool,
+    jobs: usize,
+    cache_dir: Option<&Path>,
 ) -> Result<bool> {
-    let old_binary = BinaryData::load(old_path)
+    reject_ndjson(output_format, "diff")?;
+
+    let old_binary = timed("mmap", || BinaryData::load(old_path))
         .with_context(|| format!("Failed to load old binary: {}", old_path.display()))?;
-    let new_binary = BinaryData::load(new_path)
+    let new_binary = timed("mmap", || BinaryData::load(new_path))
         .with_context(|| format!("Failed to load new binary: {}", new_path.display()))?;
 
-    let old_loaded = old_binary.load_dwarf().context("Failed to load DWARF from old binary")?;
-    let new_loaded = new_binary.load_dwarf().context("Failed to load DWARF from new binary")?;
-
-    let old_dwarf = DwarfContext::new(&old_loaded);
-    let new_dwarf = DwarfContext::new(&new_loaded);
-
-    let mut old_layouts = old_dwarf.find_structs(filter, include_go_runtime)?;
-    let mut new_layouts = new_dwarf.find_structs(filter, include_go_runtime)?;
+    let old_lookup = LayoutLookup::new(&old_binary, cache_dir, filter, include_go_runtime)?;
+    let new_lookup = LayoutLookup::new(&new_binary, cache_dir, filter, include_go_runtime)?;
+
+    // The two sides are independent, so when both have to be parsed the old side runs on
+    // its own thread, whatever `--jobs` says, and they share the worker budget instead of
+    // each taking all of it.
+    let workers = layout_audit::dwarf::effective_jobs(jobs);
+    let both_parsed = !old_lookup.is_hit() && !new_lookup.is_hit();
+    let side_jobs = if both_parsed { workers.div_ceil(2) } else { workers };
+
+    let extract_side = |binary: &BinaryData, lookup: LayoutLookup, context: &'static str| {
+        let mut layouts = lookup.resolve(|units| {
+            let loaded = load_layout_dwarf(binary, side_jobs, context)?;
+            let dwarf = DwarfContext::new(&loaded)
+                .with_jobs(side_jobs)
+                .with_unit_cache(units)
+                .with_name_index(name_index())
+                .with_stats(extract_stats());
+            Ok(timed("extract", || dwarf.find_structs(filter, include_go_runtime))?)
+        })?;
+        timed("analyze", || {
+            for layout in &mut layouts {
+                analyze_layout(layout, cache_line_size);
+            }
+        });
+        Ok::<_, anyhow::Error>(layouts)
+    };
 
-    for layout in &mut old_layouts {
-        analyze_layout(layout, cache_line_size);
-    }
-    for layout in &mut new_layouts {
-        analyze_layout(layout, cache_line_size);
-    }
+    let (old_layouts, new_layouts) = if both_parsed {
+        std::thread::scope(|scope| {
+            let old_side = scope.spawn(|| {
+                extract_side(&old_binary, old_lookup, "Failed to load DWARF from old binary")
+            });
+            let new_layouts =
+                extract_side(&new_binary, new_lookup, "Failed to load DWARF from new binary");
+            let old_layouts =
+                old_side.join().unwrap_or_else(|panic| std::panic::resume_unwind(panic));
+            (old_layouts, new_layouts)
+        })
+    } else {
+        (
+            extract_side(&old_binary, old_lookup, "Failed to load DWARF from old binary"),
+            extract_side(&new_binary, new_lookup, "Failed to load DWARF from new binary"),
+        )
+    };
+    let (old_layouts, new_layouts) = (old_layouts?, new_layouts?);
 
-    let diff = diff_layouts(&old_layouts, &new_layouts);
+    let diff = timed("diff", || diff_layouts(&old_layouts, &new_layouts, cache_line_size));
 
-    match output_format {
-        OutputFormat::Json => {
-            println!("{}", serde_json::to_string_pretty(&diff)?);
-        }
-        OutputFormat::Table => {
-            print_diff_table(&diff);
-        }
-        OutputFormat::Sarif => {
-            let formatter = SarifFormatter::new();
-            println!("{}", formatter.format_diff(&diff, fail_on_regression));
+    timed("output", || {
+        match output_format {
+            OutputFormat::Json => {
+                println!("{}", serde_json::to_string_pretty(&diff)?);
+            }
+            OutputFormat::Table => {
+                print_diff_table(&diff);
+            }
+            OutputFormat::Sarif => {
+                let formatter = SarifFormatter::new();
+                let error_on = if fail_on_regression { regressions } else { &[] };
+                println!("{}", formatter.format_diff(&diff, error_on));
+            }
+            OutputFormat::Ndjson => unreachable!("rejected by reject_ndjson"),
         }
-    }
+        Ok::<_, anyhow::Error>(())
+    })?;
 
-    Ok(diff.has_regressions())
+    Ok(diff.has_regressions_in(regressions))
 }
 
 fn print_diff_table(diff: &layout_audit::DiffResult) {
@@ -291,6 +1163,35 @@ fn print_diff_table(diff: &layout_audit::DiffResult) {
                 pad_indicator
             );
 
+            let impact = &c.impact;
+            if impact.cache_lines_delta != 0 || impact.old_stride != impact.new_stride {
+                println!(
+                    "      cache lines: {} -> {}, lines per array element: {:.2} -> {:.2}, \
+                     elements per page: {} -> {}",
+                    impact.old_cache_lines,
+                    impact.new_cache_lines,
+                    impact.old_stride.cache_lines_per_element,
+                    impact.new_stride.cache_lines_per_element,
+                    impact.old_stride.elements_per_page,
+                    impact.new_stride.elements_per_page
+                );
+            }
+            if !impact.newly_split_members.is_empty() {
+                println!(
+                    "      {} now split across cache lines: {}",
+                    "!".red(),
+                    impact.newly_split_members.join(", ")
+                );
+            }
+            if !impact.new_false_sharing_pairs.is_empty() {
+                let pairs: Vec<String> = impact
+                    .new_false_sharing_pairs
+                    .iter()
+                    .map(|p| format!("{}/{}", p.member_a, p.member_b))
+                    .collect();
+                println!("      {} new false sharing: {}", "!".red(), pairs.join(", "));
+            }
+
             for mc in &c.member_changes {
                 let prefix = match mc.kind {
                     layout_audit::diff::MemberChangeKind::Added => "+".green(),
@@ -312,28 +1213,20 @@ fn print_diff_table(diff: &layout_audit::DiffResult) {
     );
 }
 
+#[allow(clippy::too_many_arguments)]
 fn run_check(
     binary_path: &Path,
     config_path: &Path,
     output_format: OutputFormat,
     cache_line_size: u32,
+    targets: &[TargetProfile],
     include_go_runtime: bool,
+    jobs: usize,
+    cache_dir: Option<&Path>,
 ) -> Result<()> {
-    if !config_path.exists() {
-        bail!(
-            "Config file not found: {}\n\nCreate a .layout-audit.yaml with budget constraints:\n\n\
-            budgets:\n  MyStruct:\n    max_size: 64\n    max_padding: 8\n    max_padding_percent: 10.0\n\n\
-            Glob patterns are supported:\n  \"*Padding\":\n    max_padding_percent: 15.0",
-            config_path.display()
-        );
-    }
-
-    let config_str = std::fs::read_to_string(config_path)
-        .with_context(|| format!("Failed to read config: {}", config_path.display()))?;
-
-    let config: Config = serde_yaml::from_str(&config_str)
-        .with_context(|| format!("Failed to parse config: {}", config_path.display()))?;
+    reject_ndjson(output_format, "check")?;
 
+    let config = read_config(config_path)?;
     if config.budgets.is_empty() {
         eprintln!("Warning: No budget constraints defined in config file");
         return Ok(());
@@ -342,17 +1235,97 @@ fn run_check(
     // Compile patterns (validates and separates exact matches from globs)
     let compiled = config.compile()?;
 
-    let binary = BinaryData::load(binary_path)
+    let binary = timed("mmap", || BinaryData::load(binary_path))
         .with_context(|| format!("Failed to load binary: {}", binary_path.display()))?;
 
-    let loaded = binary.load_dwarf().context("Failed to load DWARF debug info")?;
-    let dwarf = DwarfContext::new(&loaded);
+    let mut layouts = cached_layouts(&binary, cache_dir, None, include_go_runtime, |units| {
+        let loaded = load_layout_dwarf(&binary, jobs, "Failed to load DWARF debug info")?;
+        let dwarf = DwarfContext::new(&loaded)
+            .with_jobs(jobs)
+            .with_unit_cache(units)
+            .with_name_index(name_index())
+            .with_stats(extract_stats());
+        Ok(timed("extract", || dwarf.find_structs(None, include_go_runtime))?)
+    })?;
+    let violations = timed("analyze", || {
+        for layout in &mut layouts {
+            analyze_for_targets(layout, cache_line_size, targets);
+        }
+        check_violations(
+            &compiled,
+            &layouts,
+            single_line_size(targets, cache_line_size),
+            sharing_distance(targets, cache_line_size),
+        )
+    });
 
-    let mut layouts = dwarf.find_structs(None, include_go_runtime)?;
-    for layout in &mut layouts {
-        analyze_layout(layout, cache_line_size);
+    timed("output", || match output_format {
+        OutputFormat::Table => {
+            if violations.is_empty() {
+                println!("All structs within budget constraints");
+                Ok(())
+            } else {
+                use colored::Colorize;
+                eprintln!("{}", "Budget violations:".red().bold());
+                for v in &violations {
+                    eprintln!("  {}", v.message);
+                }
+                bail!("Budget check failed: {} violation(s)", violations.len());
+            }
+        }
+        OutputFormat::Json => {
+            let output = CheckJsonOutput {
+                version: env!("CARGO_PKG_VERSION"),
+                violations: &violations,
+                summary: CheckSummary { total_violations: violations.len() },
+            };
+            println!("{}", serde_json::to_string_pretty(&output)?);
+            if violations.is_empty() {
+                Ok(())
+            } else {
+                bail!("Budget check failed: {} violation(s)", violations.len());
+            }
+        }
+        OutputFormat::Sarif => {
+            let formatter = SarifFormatter::new();
+            println!("{}", formatter.format_check(&violations));
+            if violations.is_empty() {
+                Ok(())
+            } else {
+                bail!("Budget check failed: {} violation(s)", violations.len());
+            }
+        }
+        OutputFormat::Ndjson => unreachable!("rejected by reject_ndjson"),
+    })
+}
+
+/// Read and parse a budget config file.
+fn read_config(config_path: &Path) -> Result<Config> {
+    if !config_path.exists() {
+        bail!(
+            "Config file not found: {}\n\nCreate a .layout-audit.yaml with budget constraints:\n\n\
+            budgets:\n  MyStruct:\n    max_size: 64\n    max_padding: 8\n    max_padding_percent: 10.0\n\n\
+            Glob patterns are supported:\n  \"*Padding\":\n    max_padding_percent: 15.0",
+            config_path.display()
+        );
     }
 
+    let config_str = std::fs::read_to_string(config_path)
+        .with_context(|| format!("Failed to read config: {}", config_path.display()))?;
+
+    serde_yaml::from_str(&config_str)
+        .with_context(|| format!("Failed to parse config: {}", config_path.display()))
+}
+
+/// Check analyzed `layouts` against `compiled` budgets, warning on stderr about budgets
+/// that match nothing. Hot fields are placed on lines of `cache_line_size` bytes; atomics
+/// and writers conflict within `sharing_distance` bytes.
+fn check_violations(
+    compiled: &CompiledBudgets,
+    layouts: &[StructLayout],
+    cache_line_size: u32,
+    sharing_distance: u32,
+) -> Vec<CheckViolation> {
     let layout_names: std::collections::HashSet<&str> =
         layouts.iter().map(|l| l.name.as_str()).collect();
 
@@ -368,7 +1341,7 @@ fn run_check(
 
     let mut violations: Vec<CheckViolation> = Vec::new();
 
-    for layout in &layouts {
+    for layout in layouts {
         if let Some((budget, pattern_idx)) = compiled.find_budget(&layout.name) {
             // Mark glob pattern as matched
             if let Some(idx) = pattern_idx {
@@ -399,36 +1372,103 @@ fn run_check(
                     struct_name: layout.name.clone(),
                     kind: CheckViolationKind::MaxPaddingBytes,
                     message: format!(
-                        "{}: padding {} exceeds budget {} (+{} bytes)",
-                        layout.name,
-                        layout.metrics.padding_bytes,
-                        max_padding,
-                        layout.metrics.padding_bytes - max_padding
+                        "{}: padding {} exceeds budget {} (+{} bytes)",
+                        layout.name,
+                        layout.metrics.padding_bytes,
+                        max_padding,
+                        layout.metrics.padding_bytes - max_padding
+                    ),
+                    source_location: source_location.clone(),
+                });
+            }
+            if let Some(max_pct) = budget.max_padding_percent {
+                const EPSILON: f64 = 1e-6;
+                if layout.metrics.padding_percentage > max_pct + EPSILON {
+                    violations.push(CheckViolation {
+                        struct_name: layout.name.clone(),
+                        kind: CheckViolationKind::MaxPaddingPercent,
+                        message: format!(
+                            "{}: padding {:.1}% exceeds budget {:.1}% (+{:.1} percentage points)",
+                            layout.name,
+                            layout.metrics.padding_percentage,
+                            max_pct,
+                            layout.metrics.padding_percentage - max_pct
+                        ),
+                        source_location: source_location.clone(),
+                    });
+                }
+            }
+            if let Some(max_lines) = budget.max_cache_lines
+                && layout.metrics.cache_lines_spanned > max_lines
+            {
+                violations.push(CheckViolation {
+                    struct_name: layout.name.clone(),
+                    kind: CheckViolationKind::MaxCacheLines,
+                    message: format!(
+                        "{}: spans {} cache lines, budget {}",
+                        layout.name, layout.metrics.cache_lines_spanned, max_lines
                     ),
                     source_location: source_location.clone(),
                 });
             }
-            if let Some(max_pct) = budget.max_padding_percent {
+            if let Some(min_density) = budget.min_cache_line_density {
                 const EPSILON: f64 = 1e-6;
-                if layout.metrics.padding_percentage > max_pct + EPSILON {
+                if layout.metrics.cache_line_density + EPSILON < min_density {
                     violations.push(CheckViolation {
                         struct_name: layout.name.clone(),
-                        kind: CheckViolationKind::MaxPaddingPercent,
+                        kind: CheckViolationKind::MinCacheLineDensity,
                         message: format!(
-                            "{}: padding {:.1}% exceeds budget {:.1}% (+{:.1} percentage points)",
+                            "{}: cache line density {:.1}% is below budget {:.1}% (-{:.1} percentage points)",
                             layout.name,
-                            layout.metrics.padding_percentage,
-                            max_pct,
-                            layout.metrics.padding_percentage - max_pct
+                            layout.metrics.cache_line_density,
+                            min_density,
+                            min_density - layout.metrics.cache_line_density
+                        ),
+                        source_location: source_location.clone(),
+                    });
+                }
+            }
+            if !budget.hot_globs.is_empty() {
+                if pattern_idx.is_none() {
+                    for (field, glob) in budget.hot_fields.iter().zip(&budget.hot_globs) {
+                        if !layout.members.iter().any(|m| glob.is_match(m.name.as_str())) {
+                            eprintln!(
+                                "Warning: Hot field '{}' did not match any field of '{}'",
+                                field, layout.name
+                            );
+                        }
+                    }
+                }
+                let max_hot_lines = budget.max_hot_lines.unwrap_or(1);
+                let lines =
+                    cache_lines_touched(layout, cache_line_size, |m| budget.is_hot(&m.name));
+                if lines.len() as u64 > max_hot_lines {
+                    let hot: Vec<&str> = layout
+                        .members
+                        .iter()
+                        .filter(|m| budget.is_hot(&m.name))
+                        .map(|m| m.name.as_str())
+                        .collect();
+                    let lines: Vec<String> = lines.iter().map(u64::to_string).collect();
+                    violations.push(CheckViolation {
+                        struct_name: layout.name.clone(),
+                        kind: CheckViolationKind::MaxHotLines,
+                        message: format!(
+                            "{}: hot fields {} touch {} cache lines ({}), budget {}",
+                            layout.name,
+                            hot.join(", "),
+                            lines.len(),
+                            lines.join(", "),
+                            max_hot_lines
                         ),
                         source_location: source_location.clone(),
                     });
                 }
             }
             if let Some(max_fs) = budget.max_false_sharing_warnings {
-                let fs = analyze_false_sharing(layout, cache_line_size);
-                // Clamp to u32::MAX to prevent truncation on 64-bit platforms
-                let warning_count = fs.warnings.len().min(u32::MAX as usize) as u32;
+                let fs = analyze_false_sharing(layout, sharing_distance);
+                // Budgets count distinct pairs. Clamp to u32::MAX to prevent truncation.
+                let warning_count = fs.pair_count.min(u32::MAX as u64) as u32;
                 if warning_count > max_fs {
                     violations.push(CheckViolation {
                         struct_name: layout.name.clone(),
@@ -441,6 +1481,40 @@ fn run_check(
                     });
                 }
             }
+            if !budget.writer_globs.is_empty() {
+                // Field patterns under a struct glob are expected to miss in some structs.
+                if pattern_idx.is_none() {
+                    for (field, glob) in budget.writers.keys().zip(&budget.writer_globs) {
+                        if !layout.members.iter().any(|m| glob.0.is_match(m.name.as_str())) {
+                            eprintln!(
+                                "Warning: Writer pattern '{}' did not match any field of '{}'",
+                                field, layout.name
+                            );
+                        }
+                    }
+                }
+                let conflicts =
+                    analyze_writer_roles(layout, sharing_distance, |m| budget.writer_role(&m.name));
+                for conflict in conflicts {
+                    let members: Vec<String> = conflict
+                        .members
+                        .iter()
+                        .map(|m| format!("{} ({})", m.name, m.role))
+                        .collect();
+                    violations.push(CheckViolation {
+                        struct_name: layout.name.clone(),
+                        kind: CheckViolationKind::SharedWriterCacheLine,
+                        message: format!(
+                            "{}: cache line {} is written by {}: {}",
+                            layout.name,
+                            conflict.cache_line,
+                            conflict.roles.join(" and "),
+                            members.join(", ")
+                        ),
+                        source_location: source_location.clone(),
+                    });
+                }
+            }
         }
     }
 
@@ -454,43 +1528,7 @@ fn run_check(
         }
     }
 
-    match output_format {
-        OutputFormat::Table => {
-            if violations.is_empty() {
-                println!("All structs within budget constraints");
-                Ok(())
-            } else {
-                use colored::Colorize;
-                eprintln!("{}", "Budget violations:".red().bold());
-                for v in &violations {
-                    eprintln!("  {}", v.message);
-                }
-                bail!("Budget check failed: {} violation(s)", violations.len());
-            }
-        }
-        OutputFormat::Json => {
-            let output = CheckJsonOutput {
-                version: env!("CARGO_PKG_VERSION"),
-                violations: &violations,
-                summary: CheckSummary { total_violations: violations.len() },
-            };
-            println!("{}", serde_json::to_string_pretty(&output)?);
-            if violations.is_empty() {
-                Ok(())
-            } else {
-                bail!("Budget check failed: {} violation(s)", violations.len());
-            }
-        }
-        OutputFormat::Sarif => {
-            let formatter = SarifFormatter::new();
-            println!("{}", formatter.format_check(&violations));
-            if violations.is_empty() {
-                Ok(())
-            } else {
-                bail!("Budget check failed: {} violation(s)", violations.len());
-            }
-        }
-    }
+    violations
 }
 
 #[derive(serde::Serialize)]
@@ -517,6 +1555,22 @@ struct Budget {
     max_padding: Option<u64>,
     max_padding_percent: Option<f64>,
     max_false_sharing_warnings: Option<u32>,
+    max_cache_lines: Option<u32>,
+    min_cache_line_density: Option<f64>,
+    /// Field names or glob patterns read on the hot path.
+    #[serde(default)]
+    hot_fields: Vec<String>,
+    /// Cache lines the `hot_fields` may touch; 1 if not given.
+    max_hot_lines: Option<u64>,
+    /// Field name or glob pattern -> role of the thread writing it; the first match wins.
+    #[serde(default)]
+    writers: indexmap::IndexMap<String, String>,
+    /// `writers`, compiled by `Config::compile`.
+    #[serde(skip)]
+    writer_globs: Vec<(globset::GlobMatcher, String)>,
+    /// `hot_fields`, compiled by `Config::compile`.
+    #[serde(skip)]
+    hot_globs: Vec<globset::GlobMatcher>,
 }
 
 impl Budget {
@@ -545,8 +1599,64 @@ impl Budget {
         {
             bail!("Invalid budget for '{}': max_size must be greater than 0", name);
         }
+        if self.max_cache_lines == Some(0) {
+            bail!("Invalid budget for '{}': max_cache_lines must be greater than 0", name);
+        }
+        if let Some(min_density) = self.min_cache_line_density
+            && !(0.0..=100.0).contains(&min_density)
+        {
+            bail!(
+                "Invalid budget for '{}': min_cache_line_density must be between 0 and 100 (got {})",
+                name,
+                min_density
+            );
+        }
+        if let Some(max_hot_lines) = self.max_hot_lines {
+            if self.hot_fields.is_empty() {
+                bail!("Invalid budget for '{}': max_hot_lines needs hot_fields", name);
+            }
+            if max_hot_lines == 0 {
+                bail!("Invalid budget for '{}': max_hot_lines must be greater than 0", name);
+            }
+        }
+        if self.hot_fields.iter().any(String::is_empty) {
+            bail!("Invalid budget for '{}': hot_fields entries cannot be empty", name);
+        }
+        for (field, role) in &self.writers {
+            if field.is_empty() || role.trim().is_empty() {
+                bail!(
+                    "Invalid budget for '{}': writers entries need a field pattern and a role",
+                    name
+                );
+            }
+        }
+        Ok(())
+    }
+
+    fn compile_writers(&mut self) -> Result<()> {
+        self.writer_globs = self
+            .writers
+            .iter()
+            .map(|(field, role)| Ok((compile_glob(field)?, role.clone())))
+            .collect::<Result<_>>()?;
+        Ok(())
+    }
+
+    fn compile_hot_fields(&mut self) -> Result<()> {
+        self.hot_globs =
+            self.hot_fields.iter().map(|field| compile_glob(field)).collect::<Result<_>>()?;
         Ok(())
     }
+
+    /// Whether a struct field matches one of the `hot_fields` patterns.
+    fn is_hot(&self, field: &str) -> bool {
+        self.hot_globs.iter().any(|glob| glob.is_match(field))
+    }
+
+    /// The writer role of a struct field, from the first matching `writers` pattern.
+    fn writer_role(&self, field: &str) -> Option<&str> {
+        self.writer_globs.iter().find(|(glob, _)| glob.is_match(field)).map(|(_, r)| r.as_str())
+    }
 }
 
 /// Check if a pattern string contains glob metacharacters
@@ -568,12 +1678,18 @@ struct CompiledPattern {
     original_pattern: String,
 }
 
+fn compile_glob(pattern: &str) -> Result<globset::GlobMatcher> {
+    Ok(globset::GlobBuilder::new(pattern)
+        .literal_separator(false) // * matches ::
+        .build()
+        .with_context(|| format!("Invalid glob pattern: '{}'", pattern))?
+        .compile_matcher())
+}
+
 impl Config {
     /// Compile budget patterns for efficient matching.
     /// Separates exact matches from glob patterns.
     fn compile(&self) -> Result<CompiledBudgets> {
-        use globset::GlobBuilder;
-
         let mut exact = std::collections::HashMap::new();
         let mut patterns = Vec::new();
 
@@ -583,21 +1699,20 @@ impl Config {
             }
 
             budget.validate(name)?;
+            let mut budget = budget.clone();
+            budget.compile_writers().with_context(|| format!("Invalid writers for '{}'", name))?;
+            budget
+                .compile_hot_fields()
+                .with_context(|| format!("Invalid hot_fields for '{}'", name))?;
 
             if is_glob_pattern(name) {
-                let glob = GlobBuilder::new(name)
-                    .literal_separator(false) // * matches ::
-                    .build()
-                    .with_context(|| format!("Invalid glob pattern: '{}'", name))?
-                    .compile_matcher();
-
                 patterns.push(CompiledPattern {
-                    glob,
-                    budget: budget.clone(),
+                    glob: compile_glob(name)?,
+                    budget,
                     original_pattern: name.clone(),
                 });
             } else {
-                exact.insert(name.clone(), budget.clone());
+                exact.insert(name.clone(), budget);
             }
         }
 
@@ -623,30 +1738,32 @@ impl CompiledBudgets {
     }
 }
 
-#[allow(clippy::too_many_arguments)]
-fn run_suggest(
-    binary_path: &Path,
-    filter: Option<&str>,
-    output_format: OutputFormat,
-    min_savings: Option<u64>,
-    cache_line_size: u32,
-    pretty: bool,
-    max_align: u64,
-    sort_by_savings: bool,
-    no_color: bool,
-    include_go_runtime: bool,
-) -> Result<()> {
-    let binary = BinaryData::load(binary_path)
-        .with_context(|| format!("Failed to load binary: {}", binary_path.display()))?;
+fn run_suggest(config: &SuggestConfig<'_>) -> Result<()> {
+    reject_ndjson(config.output_format, "suggest")?;
 
-    let loaded = binary.load_dwarf().context("Failed to load DWARF debug info")?;
-    let dwarf = DwarfContext::new(&loaded);
+    let binary = timed("mmap", || BinaryData::load(config.binary_path))
+        .with_context(|| format!("Failed to load binary: {}", config.binary_path.display()))?;
 
-    let mut layouts =
-        dwarf.find_structs(filter, include_go_runtime).context("Failed to parse struct layouts")?;
+    let mut layouts = cached_layouts(
+        &binary,
+        config.cache_dir,
+        config.filter,
+        config.include_go_runtime,
+        |units| {
+            let loaded =
+                load_layout_dwarf(&binary, config.jobs, "Failed to load DWARF debug info")?;
+            let dwarf = DwarfContext::new(&loaded)
+                .with_jobs(config.jobs)
+                .with_unit_cache(units)
+                .with_name_index(name_index())
+                .with_stats(extract_stats());
+            timed("extract", || dwarf.find_structs(config.filter, config.include_go_runtime))
+                .context("Failed to parse struct layouts")
+        },
+    )?;
 
     if layouts.is_empty() {
-        if let Some(f) = filter {
+        if let Some(f) = config.filter {
             eprintln!("No structs found matching filter: {}", f);
         } else {
             eprintln!("No structs found in binary");
@@ -655,18 +1772,18 @@ fn run_suggest(
     }
 
     // Analyze layouts first (needed for metrics)
-    for layout in &mut layouts {
-        analyze_layout(layout, cache_line_size);
-    }
+    timed("analyze", || {
+        for layout in &mut layouts {
+            analyze_for_targets(layout, config.cache_line_size, config.targets);
+        }
+    });
 
-    // Optimize each layout and keep source locations aligned
-    let mut suggestions_with_locations: Vec<_> = layouts
-        .iter()
-        .map(|l| (optimize_layout(l, max_align), l.source_location.clone()))
-        .collect();
+    let mut suggestions_with_locations: Vec<_> = timed("optimize", || {
+        layouts.iter().map(|l| (suggest_layout(l, config), l.source_location.clone())).collect()
+    });
 
     // Filter by minimum savings
-    if let Some(min) = min_savings {
+    if let Some(min) = config.min_savings {
         suggestions_with_locations.retain(|(s, _)| s.savings_bytes >= min);
     }
 
@@ -676,30 +1793,205 @@ fn run_suggest(
     }
 
     // Sort by savings if requested
-    if sort_by_savings {
+    if config.sort_by_savings {
         suggestions_with_locations.sort_by(|(a, _), (b, _)| b.savings_bytes.cmp(&a.savings_bytes));
     }
 
     let (suggestions, locations): (Vec<_>, Vec<_>) = suggestions_with_locations.into_iter().unzip();
 
-    let output_str = match output_format {
-        OutputFormat::Table => {
-            let formatter = SuggestTableFormatter::new(no_color);
-            formatter.format(&suggestions)
+    timed("output", || {
+        let output_str = match config.output_format {
+            OutputFormat::Table => {
+                let formatter = SuggestTableFormatter::new(config.no_color);
+                formatter.format(&suggestions)
+            }
+            OutputFormat::Json => {
+                let formatter = SuggestJsonFormatter::new(config.pretty);
+                formatter.format(&suggestions)
+            }
+            OutputFormat::Sarif => {
+                let formatter = SarifFormatter::new();
+                formatter.format_suggest(&suggestions, &locations)
+            }
+            OutputFormat::Ndjson => unreachable!("rejected by reject_ndjson"),
+        };
+
+        println!("{}", output_str);
+    });
+
+    Ok(())
+}
+
+/// Suggest a layout for `l`, analyzed, with the configured strategy. Structs in the access
+/// profile are ordered for hot-field locality rather than padding alone. With targets, the
+/// suggestion for each target's line size and alignment is made and the worst one kept.
+fn suggest_layout(l: &StructLayout, config: &SuggestConfig<'_>) -> OptimizedLayout {
+    if config.targets.is_empty() {
+        suggest_layout_for(l, config, config.cache_line_size, config.max_align)
+    } else {
+        optimize_for_targets(config.targets, |target| {
+            suggest_layout_for(l, config, target.cache_line, target.max_align)
+        })
+    }
+}
+
+fn suggest_layout_for(
+    l: &StructLayout,
+    config: &SuggestConfig<'_>,
+    cache_line_size: u32,
+    max_align: u64,
+) -> OptimizedLayout {
+    let fields_for = |groups: &[(String, Vec<String>)], name: &str| -> Vec<Vec<String>> {
+        groups.iter().filter(|(n, _)| n == name).map(|(_, fields)| fields.clone()).collect()
+    };
+
+    let heat = config
+        .profile
+        .and_then(|p| p.samples(&l.name))
+        .map(|samples| analyze_access_heat(l, samples, cache_line_size));
+    match (config.strategy, heat) {
+        (SuggestStrategy::CacheLine, heat) => optimize_layout_for_cache_lines(
+            l,
+            max_align,
+            cache_line_size,
+            &fields_for(config.keep_together, &l.name),
+            heat.as_ref(),
+        ),
+        (SuggestStrategy::Split, heat) => {
+            // Explicit --hot fields win over the profile's hottest ones.
+            let mut hot: Vec<String> =
+                fields_for(config.hot, &l.name).into_iter().flatten().collect();
+            if hot.is_empty() {
+                if let Some(heat) = &heat {
+                    hot = hot_fields_from_heat(heat, PROFILE_HOT_SHARE);
+                }
+            }
+            if hot.is_empty() {
+                optimize_layout(l, max_align)
+            } else {
+                optimize_layout_for_split(l, max_align, cache_line_size, &hot, config.elements)
+            }
         }
-        OutputFormat::Json => {
-            let formatter = SuggestJsonFormatter::new(pretty);
-            formatter.format(&suggestions)
+        (SuggestStrategy::Padding, Some(heat)) => {
+            optimize_layout_for_access(l, max_align, cache_line_size, &heat)
         }
-        OutputFormat::Sarif => {
-            let formatter = SarifFormatter::new();
-            formatter.format_suggest(&suggestions, &locations)
+        (SuggestStrategy::Padding, None) => optimize_layout(l, max_align),
+    }
+}
+
+fn run_footprint(config: &FootprintConfig<'_>) -> Result<()> {
+    if !matches!(config.output_format, OutputFormat::Table | OutputFormat::Json) {
+        bail!("footprint supports table and json output");
+    }
+
+    let binary = timed("mmap", || BinaryData::load(config.binary_path))
+        .with_context(|| format!("Failed to load binary: {}", config.binary_path.display()))?;
+
+    let mut layouts = cached_layouts(
+        &binary,
+        config.cache_dir,
+        config.filter,
+        config.include_go_runtime,
+        |units| {
+            let loaded =
+                load_layout_dwarf(&binary, config.jobs, "Failed to load DWARF debug info")?;
+            let dwarf = DwarfContext::new(&loaded)
+                .with_jobs(config.jobs)
+                .with_unit_cache(units)
+                .with_name_index(name_index())
+                .with_stats(extract_stats());
+            timed("extract", || dwarf.find_structs(config.filter, config.include_go_runtime))
+                .context("Failed to parse struct layouts")
+        },
+    )?;
+
+    // Only counted structs contribute, so leave the rest unanalyzed.
+    layouts.retain(|l| config.instances.get(&l.name).is_some());
+    let mut report = timed("analyze", || {
+        for layout in &mut layouts {
+            analyze_layout(layout, config.cache_line_size);
         }
-    };
+        build_footprint(&layouts, config.instances, config.max_align)
+    });
+    // With a filter, names it excludes are expected to be missing.
+    if config.filter.is_none() && !report.unmatched.is_empty() {
+        eprintln!(
+            "Warning: {} counted struct(s) not found in binary: {}",
+            report.unmatched.len(),
+            report.unmatched.join(", ")
+        );
+    }
+
+    if report.entries.is_empty() {
+        eprintln!("No counted structs found in binary");
+        return Ok(());
+    }
+
+    // Totals stay those of every counted struct; --top only shortens the listing.
+    if let Some(n) = config.top {
+        report.entries.truncate(n);
+    }
 
-    println!("{}", output_str);
+    timed("output", || {
+        let output_str = match config.output_format {
+            OutputFormat::Table => FootprintTableFormatter::new(config.no_color).format(&report),
+            OutputFormat::Json => FootprintJsonFormatter::new(config.pretty).format(&report),
+            OutputFormat::Ndjson | OutputFormat::Sarif => unreachable!("rejected above"),
+        };
+        write_stdout(|out| writeln!(out, "{}", output_str))
+    })
+}
 
-    Ok(())
+fn run_hotspots(config: &HotspotsConfig<'_>) -> Result<()> {
+    if !matches!(config.output_format, OutputFormat::Table | OutputFormat::Json) {
+        bail!("hotspots supports table and json output");
+    }
+
+    let binary = timed("mmap", || BinaryData::load(config.binary_path))
+        .with_context(|| format!("Failed to load binary: {}", config.binary_path.display()))?;
+    let loaded = load_layout_dwarf(&binary, config.jobs, "Failed to load DWARF debug info")?;
+    let dwarf = DwarfContext::new(&loaded)
+        .with_jobs(config.jobs)
+        .with_name_index(name_index())
+        .with_stats(extract_stats());
+
+    let mut layouts =
+        timed("extract", || dwarf.find_structs(config.filter, config.include_go_runtime))
+            .context("Failed to parse struct layouts")?;
+    let functions =
+        timed("functions", || dwarf.find_functions()).context("Failed to parse functions")?;
+
+    let mut report = timed("analyze", || {
+        for layout in &mut layouts {
+            analyze_layout(layout, config.cache_line_size);
+        }
+        build_hotspots(&layouts, &functions, config.profile)
+    });
+    if report.profiled_percent == Some(0.0) {
+        eprintln!(
+            "Warning: no profiled symbol matches a function in the binary; profile the same \
+             binary, and use `perf report --no-demangle` for C++ and Rust"
+        );
+    }
+
+    if report.entries.is_empty() {
+        eprintln!("No structs are taken as parameters by functions in binary");
+        return Ok(());
+    }
+
+    // Totals stay those of every struct; --top only shortens the listing.
+    if let Some(n) = config.top {
+        report.entries.truncate(n);
+    }
+
+    timed("output", || {
+        let output_str = match config.output_format {
+            OutputFormat::Table => HotspotsTableFormatter::new(config.no_color).format(&report),
+            OutputFormat::Json => HotspotsJsonFormatter::new(config.pretty).format(&report),
+            OutputFormat::Ndjson | OutputFormat::Sarif => unreachable!("rejected above"),
+        };
+        write_stdout(|out| writeln!(out, "{}", output_str))
+    })
 }
 
 #[cfg(test)]
@@ -707,66 +1999,234 @@ mod tests {
     use super::*;
     use std::path::{Path, PathBuf};
 
-    fn find_fixture_path(name: &str) -> Option<PathBuf> {
+    pub(crate) fn find_fixture_path(name: &str) -> Option<PathBuf> {
         let base = Path::new("tests/fixtures/bin");
         let dsym_path = base.join(format!("{}.dSYM/Contents/Resources/DWARF/{}", name, name));
         if dsym_path.exists() {
             return Some(dsym_path);
         }
 
-        let exe_path = base.join(format!("{}.exe", name));
-        if exe_path.exists() {
-            return Some(exe_path);
-        }
+        let exe_path = base.join(format!("{}.exe", name));
+        if exe_path.exists() {
+            return Some(exe_path);
+        }
+
+        let direct_path = base.join(name);
+        if direct_path.exists() {
+            return Some(direct_path);
+        }
+
+        None
+    }
+
+    fn create_temp_config(content: &str) -> PathBuf {
+        use std::sync::atomic::{AtomicU64, Ordering};
+        static COUNTER: AtomicU64 = AtomicU64::new(0);
+        let temp_dir = std::env::temp_dir();
+        let unique_id = COUNTER.fetch_add(1, Ordering::SeqCst);
+        let config_path = temp_dir.join(format!(
+            "layout-audit-main-test-{}-{}.yaml",
+            std::process::id(),
+            unique_id
+        ));
+        std::fs::write(&config_path, content).expect("Failed to write temp config");
+        config_path
+    }
+
+    #[test]
+    fn run_inspect_outputs() {
+        let path = match find_fixture_path("test_simple") {
+            Some(p) => p,
+            None => return,
+        };
+
+        let base = InspectConfig {
+            binary_path: &path,
+            filter: Some("Padding"),
+            output_format: OutputFormat::Table,
+            sort_by: SortField::Name,
+            top: Some(1),
+            min_padding: None,
+            no_color: true,
+            cache_line_size: 64,
+            pretty: true,
+            warn_false_sharing: true,
+            false_sharing_pairs: false,
+            profile: None,
+            nested: false,
+            include_go_runtime: false,
+            jobs: 1,
+            cache_dir: None,
+            targets: &[],
+            write_snapshot: None,
+            detail: None,
+        };
+
+        run_inspect(&base).expect("inspect table");
+        let json_cfg = InspectConfig { output_format: OutputFormat::Json, ..base };
+        run_inspect(&json_cfg).expect("inspect json");
+        let sarif_cfg = InspectConfig { output_format: OutputFormat::Sarif, ..base };
+        run_inspect(&sarif_cfg).expect("inspect sarif");
+        let ndjson_cfg = InspectConfig { output_format: OutputFormat::Ndjson, ..base };
+        run_inspect(&ndjson_cfg).expect("inspect ndjson");
+        let ndjson_sorted = InspectConfig {
+            output_format: OutputFormat::Ndjson,
+            sort_by: SortField::Padding,
+            ..base
+        };
+        run_inspect(&ndjson_sorted).expect("inspect ndjson sorted");
+    }
+
+    #[test]
+    fn ndjson_rejected_outside_inspect() {
+        let path = Path::new("does-not-matter");
+        let err = run_diff(
+            path,
+            path,
+            None,
+            OutputFormat::Ndjson,
+            64,
+            false,
+            layout_audit::diff::DEFAULT_REGRESSIONS,
+            false,
+            1,
+            None,
+        )
+        .expect_err("diff ndjson");
+        assert!(err.to_string().contains("only supported by inspect"));
+        assert!(
+            run_check(path, path, OutputFormat::Ndjson, 64, &[], false, 1, None).is_err(),
+            "check ndjson"
+        );
+    }
+
+    #[test]
+    fn run_batch_outputs() {
+        let (Some(simple), Some(modified)) =
+            (find_fixture_path("test_simple"), find_fixture_path("test_modified"))
+        else {
+            return;
+        };
+
+        let paths = [simple, modified];
+        let base = BatchConfig {
+            paths: &paths,
+            filter: Some("Padding"),
+            output_format: OutputFormat::Table,
+            sort_by: SortField::Padding,
+            top: Some(3),
+            min_padding: Some(1),
+            no_color: true,
+            cache_line_size: 64,
+            pretty: true,
+            include_go_runtime: false,
+            jobs: 2,
+            cache_dir: None,
+        };
+
+        run_batch(&base).expect("batch table");
+        let json_cfg = BatchConfig { output_format: OutputFormat::Json, ..base };
+        run_batch(&json_cfg).expect("batch json");
+        let sarif_cfg = BatchConfig { output_format: OutputFormat::Sarif, ..base };
+        assert!(run_batch(&sarif_cfg).is_err(), "batch sarif");
+    }
+
+    #[test]
+    fn batch_skips_non_binaries_only_inside_directories() {
+        let Some(simple) = find_fixture_path("test_simple") else { return };
 
-        let direct_path = base.join(name);
-        if direct_path.exists() {
-            return Some(direct_path);
-        }
+        let dir = tempfile::tempdir().expect("tempdir");
+        std::fs::copy(&simple, dir.path().join("app")).expect("copy fixture");
+        std::fs::write(dir.path().join("notes.txt"), "not a binary").expect("write");
+        std::fs::write(dir.path().join("empty"), "").expect("write");
 
-        None
-    }
+        let paths = [dir.path().to_path_buf()];
+        let inputs = batch_inputs(&paths).expect("inputs");
+        let names: Vec<_> = inputs.iter().map(|i| i.path.file_name().unwrap()).collect();
+        assert_eq!(names, ["app", "notes.txt"]);
 
-    fn create_temp_config(content: &str) -> PathBuf {
-        use std::sync::atomic::{AtomicU64, Ordering};
-        static COUNTER: AtomicU64 = AtomicU64::new(0);
-        let temp_dir = std::env::temp_dir();
-        let unique_id = COUNTER.fetch_add(1, Ordering::SeqCst);
-        let config_path = temp_dir.join(format!(
-            "layout-audit-main-test-{}-{}.yaml",
-            std::process::id(),
-            unique_id
-        ));
-        std::fs::write(&config_path, content).expect("Failed to write temp config");
-        config_path
+        let config = BatchConfig {
+            paths: &paths,
+            filter: None,
+            output_format: OutputFormat::Json,
+            sort_by: SortField::Name,
+            top: None,
+            min_padding: None,
+            no_color: true,
+            cache_line_size: 64,
+            pretty: false,
+            include_go_runtime: false,
+            jobs: 0,
+            cache_dir: None,
+        };
+        let per_binary = extract_batch(&inputs, &config).expect("extract");
+        assert_eq!(per_binary.len(), 1);
+        assert!(per_binary[0].0.ends_with("app"));
+
+        let explicit = BatchInput { path: dir.path().join("notes.txt"), from_directory: false };
+        assert!(extract_batch_input(&explicit, &config).is_err());
     }
 
     #[test]
-    fn run_inspect_outputs() {
-        let path = match find_fixture_path("test_simple") {
-            Some(p) => p,
-            None => return,
+    fn run_footprint_outputs() {
+        let Some(binary) = find_fixture_path("test_simple") else {
+            return;
         };
 
-        let base = InspectConfig {
-            binary_path: &path,
-            filter: Some("Padding"),
+        let counts = InstanceCounts::parse("InternalPadding: 1000\nNoPadding: 5\nMissing: 1\n")
+            .expect("counts");
+        let base = FootprintConfig {
+            binary_path: &binary,
+            instances: &counts,
+            filter: None,
             output_format: OutputFormat::Table,
-            sort_by: SortField::Name,
             top: Some(1),
-            min_padding: None,
+            cache_line_size: 64,
+            max_align: 8,
+            pretty: true,
             no_color: true,
+            include_go_runtime: false,
+            jobs: 1,
+            cache_dir: None,
+        };
+
+        run_footprint(&base).expect("footprint table");
+        let json_cfg = FootprintConfig { output_format: OutputFormat::Json, ..base };
+        run_footprint(&json_cfg).expect("footprint json");
+        let sarif_cfg = FootprintConfig { output_format: OutputFormat::Sarif, ..base };
+        assert!(run_footprint(&sarif_cfg).is_err(), "footprint sarif");
+        let unmatched = InstanceCounts::parse("Missing: 1\n").expect("counts");
+        run_footprint(&FootprintConfig { instances: &unmatched, ..base }).expect("no matches");
+    }
+
+    #[test]
+    fn run_hotspots_outputs() {
+        let Some(binary) = find_fixture_path("test_simple") else {
+            return;
+        };
+
+        let profile = FunctionProfile::parse("route_length,60\nmain,40\n").expect("profile");
+        let base = HotspotsConfig {
+            binary_path: &binary,
+            profile: None,
+            filter: None,
+            output_format: OutputFormat::Table,
+            top: Some(2),
             cache_line_size: 64,
             pretty: true,
-            warn_false_sharing: true,
+            no_color: true,
             include_go_runtime: false,
+            jobs: 1,
         };
 
-        run_inspect(&base).expect("inspect table");
-        let json_cfg = InspectConfig { output_format: OutputFormat::Json, ..base };
-        run_inspect(&json_cfg).expect("inspect json");
-        let sarif_cfg = InspectConfig { output_format: OutputFormat::Sarif, ..base };
-        run_inspect(&sarif_cfg).expect("inspect sarif");
+        run_hotspots(&base).expect("hotspots table");
+        let profiled = HotspotsConfig { profile: Some(&profile), jobs: 2, ..base };
+        run_hotspots(&profiled).expect("profiled hotspots");
+        let json_cfg = HotspotsConfig { output_format: OutputFormat::Json, ..profiled };
+        run_hotspots(&json_cfg).expect("hotspots json");
+        let sarif_cfg = HotspotsConfig { output_format: OutputFormat::Sarif, ..base };
+        assert!(run_hotspots(&sarif_cfg).is_err(), "hotspots sarif");
+        run_hotspots(&HotspotsConfig { filter: Some("NoSuchStruct"), ..base }).expect("no structs");
     }
 
     #[test]
@@ -776,9 +2236,177 @@ mod tests {
             None => return,
         };
 
-        run_diff(&path, &path, None, OutputFormat::Table, 64, false, false).expect("diff table");
-        run_diff(&path, &path, None, OutputFormat::Json, 64, false, false).expect("diff json");
-        run_diff(&path, &path, None, OutputFormat::Sarif, 64, false, false).expect("diff sarif");
+        run_diff(
+            &path,
+            &path,
+            None,
+            OutputFormat::Table,
+            64,
+            false,
+            layout_audit::diff::DEFAULT_REGRESSIONS,
+            false,
+            1,
+            None,
+        )
+        .expect("diff table");
+        run_diff(
+            &path,
+            &path,
+            None,
+            OutputFormat::Json,
+            64,
+            false,
+            layout_audit::diff::DEFAULT_REGRESSIONS,
+            false,
+            1,
+            None,
+        )
+        .expect("diff json");
+        run_diff(
+            &path,
+            &path,
+            None,
+            OutputFormat::Sarif,
+            64,
+            false,
+            layout_audit::diff::DEFAULT_REGRESSIONS,
+            false,
+            1,
+            None,
+        )
+        .expect("diff sarif");
+    }
+
+    #[test]
+    fn run_diff_extracts_sides_concurrently_and_cached() {
+        let (Some(old), Some(new)) =
+            (find_fixture_path("test_simple"), find_fixture_path("test_modified"))
+        else {
+            return;
+        };
+        let cache_dir = tempfile::tempdir().expect("tempdir");
+
+        // Cold cache: both sides parsed at once; warm: both served from the cache;
+        // mixed: only the new side parsed.
+        let cold = run_diff(
+            &old,
+            &new,
+            None,
+            OutputFormat::Json,
+            64,
+            true,
+            layout_audit::diff::DEFAULT_REGRESSIONS,
+            false,
+            4,
+            None,
+        )
+        .expect("diff without cache");
+        // The default `-j 1` still extracts both sides at once, one thread each.
+        let single = run_diff(
+            &old,
+            &new,
+            None,
+            OutputFormat::Json,
+            64,
+            true,
+            layout_audit::diff::DEFAULT_REGRESSIONS,
+            false,
+            1,
+            None,
+        )
+        .expect("diff with one job");
+        assert_eq!(cold, single);
+        for _ in 0..2 {
+            let cached = run_diff(
+                &old,
+                &new,
+                None,
+                OutputFormat::Json,
+                64,
+                true,
+                layout_audit::diff::DEFAULT_REGRESSIONS,
+                false,
+                4,
+                Some(cache_dir.path()),
+            )
+            .expect("diff with cache");
+            assert_eq!(cold, cached);
+        }
+
+        let other_dir = tempfile::tempdir().expect("tempdir");
+        run_diff(
+            &old,
+            &old,
+            None,
+            OutputFormat::Json,
+            64,
+            true,
+            layout_audit::diff::DEFAULT_REGRESSIONS,
+            false,
+            0,
+            Some(other_dir.path()),
+        )
+        .expect("warm old side");
+        let mixed = run_diff(
+            &old,
+            &new,
+            None,
+            OutputFormat::Json,
+            64,
+            true,
+            layout_audit::diff::DEFAULT_REGRESSIONS,
+            false,
+            0,
+            Some(other_dir.path()),
+        )
+        .expect("diff with cached old side");
+        assert_eq!(cold, mixed);
+    }
+
+    #[test]
+    fn unit_cache_reuses_units_across_rebuilds() {
+        let (Some(simple), Some(modified)) =
+            (find_fixture_path("test_simple"), find_fixture_path("test_modified"))
+        else {
+            return;
+        };
+        let dir = tempfile::tempdir().expect("tempdir");
+        let app = dir.path().join("app");
+        let cache_dir = dir.path().join("cache");
+
+        // Returns the layouts as JSON and how many units were served from the cache.
+        let extract = |cache_dir: Option<&Path>| {
+            let binary = BinaryData::load(&app).expect("load");
+            let mut reused = 0;
+            let layouts = cached_layouts(&binary, cache_dir, None, false, |units| {
+                let loaded = binary.load_dwarf_for_layouts(2)?;
+                let layouts = DwarfContext::new(&loaded)
+                    .with_jobs(2)
+                    .with_unit_cache(units)
+                    .find_structs(None, false)?;
+                reused = units.map_or(0, UnitLayouts::reused);
+                Ok(layouts)
+            })
+            .expect("extract");
+            (serde_json::to_string(&layouts).unwrap(), reused)
+        };
+
+        std::fs::copy(&simple, &app).unwrap();
+        let (first, reused) = extract(Some(&cache_dir));
+        assert_eq!(reused, 0);
+
+        // A different length is a different binary identity, but the units are unchanged.
+        let mut bytes = std::fs::read(&app).unwrap();
+        bytes.extend_from_slice(&[0; 16]);
+        std::fs::write(&app, bytes).unwrap();
+        let (second, reused) = extract(Some(&cache_dir));
+        assert!(reused > 0);
+        assert_eq!(first, second);
+
+        std::fs::copy(&modified, &app).unwrap();
+        let (rebuilt, _) = extract(Some(&cache_dir));
+        assert_eq!(rebuilt, extract(None).0);
+        assert_ne!(rebuilt, first);
     }
 
     #[test]
@@ -798,9 +2426,11 @@ budgets:
 "#,
         );
 
-        run_check(&path, &config, OutputFormat::Table, 64, false).expect("check table");
-        run_check(&path, &config, OutputFormat::Json, 64, false).expect("check json");
-        run_check(&path, &config, OutputFormat::Sarif, 64, false).expect("check sarif");
+        run_check(&path, &config, OutputFormat::Table, 64, &[], false, 1, None)
+            .expect("check table");
+        run_check(&path, &config, OutputFormat::Json, 64, &[], false, 1, None).expect("check json");
+        run_check(&path, &config, OutputFormat::Sarif, 64, &[], false, 1, None)
+            .expect("check sarif");
 
         std::fs::remove_file(&config).ok();
     }
@@ -820,7 +2450,7 @@ budgets:
 "#,
         );
 
-        let result = run_check(&path, &config, OutputFormat::Table, 64, false);
+        let result = run_check(&path, &config, OutputFormat::Table, 64, &[], false, 1, None);
         std::fs::remove_file(&config).ok();
         assert!(result.is_err());
     }
@@ -840,7 +2470,7 @@ budgets:
 "#,
         );
 
-        let result = run_check(&path, &config, OutputFormat::Json, 64, false);
+        let result = run_check(&path, &config, OutputFormat::Json, 64, &[], false, 1, None);
         std::fs::remove_file(&config).ok();
         assert!(result.is_err());
     }
@@ -860,7 +2490,7 @@ budgets:
 "#,
         );
 
-        let result = run_check(&path, &config, OutputFormat::Sarif, 64, false);
+        let result = run_check(&path, &config, OutputFormat::Sarif, 64, &[], false, 1, None);
         std::fs::remove_file(&config).ok();
         assert!(result.is_err());
     }
@@ -891,7 +2521,7 @@ budgets:
         let layout = &mut layouts[0];
         analyze_layout(layout, 64);
         let fs = analyze_false_sharing(layout, 64);
-        if fs.warnings.is_empty() {
+        if fs.pair_count == 0 {
             return;
         }
 
@@ -903,7 +2533,7 @@ budgets:
 "#,
         );
 
-        let result = run_check(&path, &config, OutputFormat::Table, 64, false);
+        let result = run_check(&path, &config, OutputFormat::Table, 64, &[], false, 1, None);
         std::fs::remove_file(&config).ok();
         assert!(result.is_err());
     }
@@ -915,14 +2545,249 @@ budgets:
             None => return,
         };
 
-        run_suggest(&path, None, OutputFormat::Table, Some(1), 64, true, 8, false, true, false)
-            .expect("suggest table");
+        run_suggest(&SuggestConfig {
+            binary_path: &path,
+            filter: None,
+            output_format: OutputFormat::Table,
+            min_savings: Some(1),
+            cache_line_size: 64,
+            pretty: true,
+            max_align: 8,
+            sort_by_savings: false,
+            strategy: SuggestStrategy::Padding,
+            keep_together: &[],
+            hot: &[],
+            elements: 1024,
+            profile: None,
+            no_color: true,
+            include_go_runtime: false,
+            jobs: 1,
+            cache_dir: None,
+            targets: &[],
+        })
+        .expect("suggest table");
+
+        run_suggest(&SuggestConfig {
+            binary_path: &path,
+            filter: None,
+            output_format: OutputFormat::Json,
+            min_savings: Some(1),
+            cache_line_size: 64,
+            pretty: true,
+            max_align: 8,
+            sort_by_savings: false,
+            strategy: SuggestStrategy::Padding,
+            keep_together: &[],
+            hot: &[],
+            elements: 1024,
+            profile: None,
+            no_color: true,
+            include_go_runtime: false,
+            jobs: 1,
+            cache_dir: None,
+            targets: &[],
+        })
+        .expect("suggest json");
+
+        run_suggest(&SuggestConfig {
+            binary_path: &path,
+            filter: None,
+            output_format: OutputFormat::Sarif,
+            min_savings: Some(1),
+            cache_line_size: 64,
+            pretty: true,
+            max_align: 8,
+            sort_by_savings: false,
+            strategy: SuggestStrategy::Padding,
+            keep_together: &[],
+            hot: &[],
+            elements: 1024,
+            profile: None,
+            no_color: true,
+            include_go_runtime: false,
+            jobs: 1,
+            cache_dir: None,
+            targets: &[],
+        })
+        .expect("suggest sarif");
+    }
+
+    #[test]
+    fn inspect_and_suggest_with_access_profile() {
+        let path = match find_fixture_path("test_simple") {
+            Some(p) => p,
+            None => return,
+        };
+        let profile =
+            AccessProfile::parse("InternalPadding,8,90\nInternalPadding,4,10\n").expect("profile");
+
+        let cfg = InspectConfig {
+            binary_path: &path,
+            filter: Some("InternalPadding"),
+            output_format: OutputFormat::Table,
+            sort_by: SortField::Name,
+            top: None,
+            min_padding: None,
+            no_color: true,
+            cache_line_size: 64,
+            pretty: false,
+            warn_false_sharing: false,
+            false_sharing_pairs: false,
+            profile: Some(&profile),
+            nested: false,
+            include_go_runtime: false,
+            jobs: 1,
+            cache_dir: None,
+            targets: &[],
+            write_snapshot: None,
+            detail: None,
+        };
+        run_inspect(&cfg).expect("inspect with profile");
+
+        let mut layout = StructLayout::new("InternalPadding".to_string(), 8, Some(4));
+        layout.members = vec![layout_audit::MemberLayout::new("b", "int", Some(4), Some(4))];
+        analyze_for_inspect(&mut layout, &cfg);
+        let heat = layout.metrics.access_heat.expect("sampled struct gets heat");
+        assert_eq!(heat.members[0].name, "b");
+
+        run_suggest(&SuggestConfig {
+            binary_path: &path,
+            filter: Some("InternalPadding"),
+            output_format: OutputFormat::Json,
+            min_savings: None,
+            cache_line_size: 64,
+            pretty: false,
+            max_align: 8,
+            sort_by_savings: false,
+            strategy: SuggestStrategy::Padding,
+            keep_together: &[],
+            hot: &[],
+            elements: 1024,
+            profile: Some(&profile),
+            no_color: true,
+            include_go_runtime: false,
+            jobs: 1,
+            cache_dir: None,
+            targets: &[],
+        })
+        .expect("suggest with profile");
+
+        assert!(load_profile(Path::new("does/not/exist.csv")).is_err());
+    }
+
+    #[test]
+    fn suggest_cache_line_strategy() {
+        let path = match find_fixture_path("test_simple") {
+            Some(p) => p,
+            None => return,
+        };
+
+        let keep_together = parse_field_groups(
+            &["InternalPadding:a, c".to_string()],
+            "keep-together",
+            SuggestStrategy::CacheLine,
+            SuggestStrategy::CacheLine,
+        )
+        .expect("valid spec");
+        assert_eq!(
+            keep_together,
+            [("InternalPadding".to_string(), vec!["a".to_string(), "c".to_string()])]
+        );
+        assert!(
+            parse_field_groups(
+                &["NoFields:".to_string()],
+                "keep-together",
+                SuggestStrategy::CacheLine,
+                SuggestStrategy::CacheLine
+            )
+            .is_err()
+        );
+        assert!(
+            parse_field_groups(
+                &["Plain".to_string()],
+                "keep-together",
+                SuggestStrategy::CacheLine,
+                SuggestStrategy::CacheLine
+            )
+            .is_err()
+        );
+        assert!(
+            parse_field_groups(
+                &["A:b".to_string()],
+                "keep-together",
+                SuggestStrategy::CacheLine,
+                SuggestStrategy::Padding
+            )
+            .is_err(),
+            "groups need the cache-line strategy"
+        );
+
+        for output in [OutputFormat::Table, OutputFormat::Json] {
+            run_suggest(&SuggestConfig {
+                binary_path: &path,
+                filter: None,
+                output_format: output,
+                min_savings: None,
+                cache_line_size: 64,
+                pretty: false,
+                max_align: 8,
+                sort_by_savings: true,
+                strategy: SuggestStrategy::CacheLine,
+                keep_together: &keep_together,
+                hot: &[],
+                elements: 1024,
+                profile: None,
+                no_color: true,
+                include_go_runtime: false,
+                jobs: 1,
+                cache_dir: None,
+                targets: &[],
+            })
+            .expect("suggest cache-line");
+        }
+    }
 
-        run_suggest(&path, None, OutputFormat::Json, Some(1), 64, true, 8, false, true, false)
-            .expect("suggest json");
+    #[test]
+    fn suggest_split_strategy() {
+        let path = match find_fixture_path("test_simple") {
+            Some(p) => p,
+            None => return,
+        };
 
-        run_suggest(&path, None, OutputFormat::Sarif, Some(1), 64, true, 8, false, true, false)
-            .expect("suggest sarif");
+        let err = parse_field_groups(
+            &["A:b".to_string()],
+            "hot",
+            SuggestStrategy::Split,
+            SuggestStrategy::Padding,
+        )
+        .unwrap_err();
+        assert_eq!(err.to_string(), "--hot requires --strategy split");
+
+        let hot = [("WithPointer".to_string(), vec!["value".to_string()])];
+        let profile = AccessProfile::parse("InternalPadding,0,5\n").expect("profile");
+        for output in [OutputFormat::Table, OutputFormat::Json, OutputFormat::Sarif] {
+            run_suggest(&SuggestConfig {
+                binary_path: &path,
+                filter: None,
+                output_format: output,
+                min_savings: None,
+                cache_line_size: 64,
+                pretty: false,
+                max_align: 8,
+                sort_by_savings: false,
+                strategy: SuggestStrategy::Split,
+                keep_together: &[],
+                hot: &hot,
+                elements: 256,
+                profile: Some(&profile),
+                no_color: true,
+                include_go_runtime: false,
+                jobs: 1,
+                cache_dir: None,
+                targets: &[],
+            })
+            .expect("suggest split");
+        }
     }
 
     #[test]
@@ -943,7 +2808,15 @@ budgets:
             cache_line_size: 64,
             pretty: false,
             warn_false_sharing: false,
+            false_sharing_pairs: false,
+            profile: None,
+            nested: false,
             include_go_runtime: false,
+            jobs: 1,
+            cache_dir: None,
+            targets: &[],
+            write_snapshot: None,
+            detail: None,
         };
 
         run_inspect(&cfg).expect("inspect no matches");
@@ -967,7 +2840,15 @@ budgets:
             cache_line_size: 64,
             pretty: false,
             warn_false_sharing: false,
+            false_sharing_pairs: false,
+            profile: None,
+            nested: false,
             include_go_runtime: false,
+            jobs: 1,
+            cache_dir: None,
+            targets: &[],
+            write_snapshot: None,
+            detail: None,
         };
 
         run_inspect(&cfg).expect("inspect min padding");
@@ -984,8 +2865,19 @@ budgets:
             None => return,
         };
 
-        run_diff(&old_path, &new_path, None, OutputFormat::Table, 64, false, false)
-            .expect("diff table changes");
+        run_diff(
+            &old_path,
+            &new_path,
+            None,
+            OutputFormat::Table,
+            64,
+            false,
+            layout_audit::diff::DEFAULT_REGRESSIONS,
+            false,
+            1,
+            None,
+        )
+        .expect("diff table changes");
     }
 
     #[test]
@@ -996,7 +2888,7 @@ budgets:
         };
 
         let missing = Path::new("tests/fixtures/does-not-exist.yaml");
-        let result = run_check(&path, missing, OutputFormat::Table, 64, false);
+        let result = run_check(&path, missing, OutputFormat::Table, 64, &[], false, 1, None);
         assert!(result.is_err());
     }
 
@@ -1010,6 +2902,13 @@ budgets:
                     max_padding: None,
                     max_padding_percent: None,
                     max_false_sharing_warnings: None,
+                    max_cache_lines: None,
+                    min_cache_line_density: None,
+                    hot_fields: Vec::new(),
+                    max_hot_lines: None,
+                    writers: Default::default(),
+                    writer_globs: Vec::new(),
+                    hot_globs: Vec::new(),
                 },
             )]
             .into_iter()
@@ -1026,6 +2925,13 @@ budgets:
                     max_padding: None,
                     max_padding_percent: None,
                     max_false_sharing_warnings: None,
+                    max_cache_lines: None,
+                    min_cache_line_density: None,
+                    hot_fields: Vec::new(),
+                    max_hot_lines: None,
+                    writers: Default::default(),
+                    writer_globs: Vec::new(),
+                    hot_globs: Vec::new(),
                 },
             )]
             .into_iter()
@@ -1035,6 +2941,62 @@ budgets:
         assert!(cfg.compile().is_err());
     }
 
+    #[test]
+    fn budget_writer_roles_first_match_wins() {
+        let cfg: Config = serde_yaml::from_str(
+            "budgets:\n  Ring:\n    writers:\n      head: producer\n      \"{head,tail}\": consumer\n",
+        )
+        .unwrap();
+        let compiled = cfg.compile().unwrap();
+        let (budget, _) = compiled.find_budget("Ring").unwrap();
+        assert_eq!(budget.writer_role("head"), Some("producer"));
+        assert_eq!(budget.writer_role("tail"), Some("consumer"));
+
+        let cfg: Config =
+            serde_yaml::from_str("budgets:\n  Ring:\n    writers:\n      head: \"\"\n").unwrap();
+        assert!(cfg.compile().is_err());
+    }
+
+    #[test]
+    fn hot_path_budgets() {
+        let cfg: Config = serde_yaml::from_str(
+            "budgets:\n  Order:\n    max_cache_lines: 1\n    min_cache_line_density: 90.0\n    \
+             hot_fields: [price, \"qty*\"]\n",
+        )
+        .unwrap();
+        let compiled = cfg.compile().unwrap();
+        let mut layout = StructLayout::new("Order".to_string(), 128, Some(8));
+        layout.members = vec![
+            layout_audit::MemberLayout::new("price", "double", Some(0), Some(8)),
+            layout_audit::MemberLayout::new("note", "char[56]", Some(8), Some(56)),
+            layout_audit::MemberLayout::new("qty", "long", Some(64), Some(8)),
+        ];
+        analyze_layout(&mut layout, 64);
+
+        let violations = check_violations(&compiled, std::slice::from_ref(&layout), 64, 64);
+        let kinds: Vec<String> =
+            violations.iter().map(|v| serde_json::to_string(&v.kind).unwrap()).collect();
+        assert_eq!(
+            kinds,
+            ["\"max_cache_lines\"", "\"min_cache_line_density\"", "\"max_hot_lines\""]
+        );
+        assert!(violations[2].message.contains("hot fields price, qty touch 2 cache lines (0, 1)"));
+        // Both hot fields fit one 128-byte line.
+        let violations = check_violations(&compiled, std::slice::from_ref(&layout), 128, 128);
+        assert!(violations.iter().all(|v| !matches!(v.kind, CheckViolationKind::MaxHotLines)));
+
+        for invalid in [
+            "max_hot_lines: 1",
+            "hot_fields: [a]\n    max_hot_lines: 0",
+            "min_cache_line_density: 120.0",
+            "max_cache_lines: 0",
+        ] {
+            let cfg: Config =
+                serde_yaml::from_str(&format!("budgets:\n  Order:\n    {}\n", invalid)).unwrap();
+            assert!(cfg.compile().is_err(), "{invalid}");
+        }
+    }
+
     #[test]
     fn budget_validate_rejects_invalid_percent() {
         let budget = Budget {
@@ -1042,6 +3004,13 @@ budgets:
             max_padding: None,
             max_padding_percent: Some(200.0),
             max_false_sharing_warnings: None,
+            max_cache_lines: None,
+            min_cache_line_density: None,
+            hot_fields: Vec::new(),
+            max_hot_lines: None,
+            writers: Default::default(),
+            writer_globs: Vec::new(),
+            hot_globs: Vec::new(),
         };
         assert!(budget.validate("X").is_err());
     }
@@ -1063,7 +3032,8 @@ budgets:
 "#,
         );
 
-        run_check(&path, &config, OutputFormat::Table, 64, false).expect("check warnings");
+        run_check(&path, &config, OutputFormat::Table, 64, &[], false, 1, None)
+            .expect("check warnings");
         std::fs::remove_file(&config).ok();
     }
 
@@ -1075,7 +3045,8 @@ budgets:
         };
 
         let config = create_temp_config("budgets: {}");
-        run_check(&path, &config, OutputFormat::Table, 64, false).expect("check empty budgets");
+        run_check(&path, &config, OutputFormat::Table, 64, &[], false, 1, None)
+            .expect("check empty budgets");
         std::fs::remove_file(&config).ok();
     }
 
@@ -1086,8 +3057,27 @@ budgets:
             None => return,
         };
 
-        run_suggest(&path, None, OutputFormat::Table, None, 64, true, 8, true, true, false)
-            .expect("suggest sorted");
+        run_suggest(&SuggestConfig {
+            binary_path: &path,
+            filter: None,
+            output_format: OutputFormat::Table,
+            min_savings: None,
+            cache_line_size: 64,
+            pretty: true,
+            max_align: 8,
+            sort_by_savings: true,
+            strategy: SuggestStrategy::Padding,
+            keep_together: &[],
+            hot: &[],
+            elements: 1024,
+            profile: None,
+            no_color: true,
+            include_go_runtime: false,
+            jobs: 1,
+            cache_dir: None,
+            targets: &[],
+        })
+        .expect("suggest sorted");
     }
 
     #[test]
@@ -1097,18 +3087,26 @@ budgets:
             None => return,
         };
 
-        run_suggest(
-            &path,
-            None,
-            OutputFormat::Table,
-            Some(10_000),
-            64,
-            true,
-            8,
-            false,
-            true,
-            false,
-        )
+        run_suggest(&SuggestConfig {
+            binary_path: &path,
+            filter: None,
+            output_format: OutputFormat::Table,
+            min_savings: Some(10_000),
+            cache_line_size: 64,
+            pretty: true,
+            max_align: 8,
+            sort_by_savings: false,
+            strategy: SuggestStrategy::Padding,
+            keep_together: &[],
+            hot: &[],
+            elements: 1024,
+            profile: None,
+            no_color: true,
+            include_go_runtime: false,
+            jobs: 1,
+            cache_dir: None,
+            targets: &[],
+        })
         .expect("suggest no savings");
     }
 
@@ -1130,7 +3128,15 @@ budgets:
             cache_line_size: 64,
             pretty: false,
             warn_false_sharing: false,
+            false_sharing_pairs: false,
+            profile: None,
+            nested: false,
             include_go_runtime: false,
+            jobs: 1,
+            cache_dir: None,
+            targets: &[],
+            write_snapshot: None,
+            detail: None,
         };
         run_inspect(&cfg).expect("inspect size sort");
 
@@ -1152,6 +3158,13 @@ budgets:
                         max_padding: None,
                         max_padding_percent: None,
                         max_false_sharing_warnings: None,
+                        max_cache_lines: None,
+                        min_cache_line_density: None,
+                        hot_fields: Vec::new(),
+                        max_hot_lines: None,
+                        writers: Default::default(),
+                        writer_globs: Vec::new(),
+                        hot_globs: Vec::new(),
                     },
                 ),
                 (
@@ -1161,6 +3174,13 @@ budgets:
                         max_padding: None,
                         max_padding_percent: None,
                         max_false_sharing_warnings: None,
+                        max_cache_lines: None,
+                        min_cache_line_density: None,
+                        hot_fields: Vec::new(),
+                        max_hot_lines: None,
+                        writers: Default::default(),
+                        writer_globs: Vec::new(),
+                        hot_globs: Vec::new(),
                     },
                 ),
             ]
@@ -1194,8 +3214,19 @@ budgets:
                 cache_line: 64,
                 pretty: false,
                 warn_false_sharing: false,
+                false_sharing_pairs: false,
+                profile: None,
+                nested: false,
                 include_go_runtime: false,
+                jobs: 1,
+                cache_dir: None,
+                target: Vec::new(),
+                write_snapshot: None,
+                detail: None,
             },
+            timings: None,
+            timings_file: None,
+            name_index: false,
         };
         run_cli(inspect).expect("cli inspect");
 
@@ -1207,8 +3238,14 @@ budgets:
                 output: OutputFormat::Json,
                 cache_line: 64,
                 fail_on_regression: false,
+                regression_on: layout_audit::diff::DEFAULT_REGRESSIONS.to_vec(),
                 include_go_runtime: false,
+                jobs: 1,
+                cache_dir: None,
             },
+            timings: None,
+            timings_file: None,
+            name_index: false,
         };
         run_cli(diff).expect("cli diff");
 
@@ -1220,7 +3257,13 @@ budgets:
                 output: OutputFormat::Table,
                 cache_line: 64,
                 include_go_runtime: false,
+                jobs: 1,
+                cache_dir: None,
+                target: Vec::new(),
             },
+            timings: None,
+            timings_file: None,
+            name_index: false,
         };
         run_cli(check).expect("cli check");
         std::fs::remove_file(&config).ok();
@@ -1235,9 +3278,20 @@ budgets:
                 pretty: false,
                 max_align: 8,
                 sort_by_savings: false,
+                strategy: SuggestStrategy::Padding,
+                keep_together: Vec::new(),
+                hot: Vec::new(),
+                elements: 1024,
+                profile: None,
                 no_color: true,
                 include_go_runtime: false,
+                jobs: 1,
+                cache_dir: None,
+                target: Vec::new(),
             },
+            timings: None,
+            timings_file: None,
+            name_index: false,
         };
         run_cli(suggest).expect("cli suggest");
     }
@@ -0,0 +1,178 @@
+//! Output formatters for footprint command.
+
+use crate::footprint::{FootprintEntry, FootprintReport};
+use colored::Colorize;
+use comfy_table::{Cell, CellAlignment, Color, Table, presets::UTF8_FULL_CONDENSED};
+use serde::Serialize;
+
+pub struct FootprintTableFormatter {
+    no_color: bool,
+}
+
+impl FootprintTableFormatter {
+    pub fn new(no_color: bool) -> Self {
+        Self { no_color }
+    }
+
+    pub fn format(&self, report: &FootprintReport) -> String {
+        let mut table = Table::new();
+        table.load_preset(UTF8_FULL_CONDENSED);
+        table.set_header(vec![
+            "Struct",
+            "Size",
+            "Padding",
+            "Instances",
+            "Total",
+            "Wasted",
+            "Optimized",
+            "Projected savings",
+        ]);
+
+        for e in &report.entries {
+            let savings = Cell::new(format_bytes(e.projected_savings_bytes));
+            let savings = if self.no_color || e.projected_savings_bytes == 0 {
+                savings
+            } else {
+                savings.fg(Color::Green)
+            };
+            table.add_row(vec![
+                Cell::new(&e.name),
+                Cell::new(e.size).set_alignment(CellAlignment::Right),
+                Cell::new(e.padding_bytes).set_alignment(CellAlignment::Right),
+                Cell::new(e.instances).set_alignment(CellAlignment::Right),
+                Cell::new(format_bytes(e.total_bytes)).set_alignment(CellAlignment::Right),
+                Cell::new(format_bytes(e.wasted_bytes)).set_alignment(CellAlignment::Right),
+                Cell::new(e.optimized_size).set_alignment(CellAlignment::Right),
+                savings.set_alignment(CellAlignment::Right),
+            ]);
+        }
+
+        let summary = format!(
+            "Padding across counted instances: {}; reordering would save {}",
+            format_bytes(report.total_wasted_bytes),
+            format_bytes(report.total_projected_savings_bytes)
+        );
+
+        let mut output = table.to_string();
+        output.push_str("\n\n");
+        if self.no_color {
+            output.push_str(&summary);
+        } else {
+            output.push_str(&summary.bold().to_string());
+        }
+        output
+    }
+}
+
+/// Bytes in binary units, exact below 1 KiB.
+pub(super) fn format_bytes(bytes: u64) -> String {
+    const UNITS: [&str; 4] = ["KiB", "MiB", "GiB", "TiB"];
+    if bytes < 1024 {
+        return format!("{} B", bytes);
+    }
+    let mut value = bytes as f64 / 1024.0;
+    let mut unit = 0;
+    while value >= 1024.0 && unit + 1 < UNITS.len() {
+        value /= 1024.0;
+        unit += 1;
+    }
+    format!("{:.1} {}", value, UNITS[unit])
+}
+
+#[derive(Serialize)]
+struct FootprintJsonOutput<'a> {
+    version: &'static str,
+    structs: &'a [FootprintEntry],
+    summary: FootprintSummary<'a>,
+}
+
+#[derive(Serialize)]
+struct FootprintSummary<'a> {
+    total_wasted_bytes: u64,
+    total_projected_savings_bytes: u64,
+    #[serde(skip_serializing_if = "<[String]>::is_empty")]
+    unmatched: &'a [String],
+}
+
+pub struct FootprintJsonFormatter {
+    pretty: bool,
+}
+
+impl FootprintJsonFormatter {
+    pub fn new(pretty: bool) -> Self {
+        Self { pretty }
+    }
+
+    pub fn format(&self, report: &FootprintReport) -> String {
+        let output = FootprintJsonOutput {
+            version: env!("CARGO_PKG_VERSION"),
+            structs: &report.entries,
+            summary: FootprintSummary {
+                total_wasted_bytes: report.total_wasted_bytes,
+                total_projected_savings_bytes: report.total_projected_savings_bytes,
+                unmatched: &report.unmatched,
+            },
+        };
+
+        if self.pretty {
+            serde_json::to_string_pretty(&output)
+                .unwrap_or_else(|e| format!("{{\"error\": \"{}\"}}", e))
+        } else {
+            serde_json::to_string(&output).unwrap_or_else(|e| format!("{{\"error\": \"{}\"}}", e))
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn report() -> FootprintReport {
+        FootprintReport {
+            entries: vec![FootprintEntry {
+                name: "Order".to_string(),
+                size: 24,
+                padding_bytes: 8,
+                instances: 1_000_000,
+                total_bytes: 24_000_000,
+                wasted_bytes: 8_000_000,
+                optimized_size: 16,
+                projected_savings_bytes: 8_000_000,
+            }],
+            total_wasted_bytes: 8_000_000,
+            total_projected_savings_bytes: 8_000_000,
+            unmatched: vec!["Gone".to_string()],
+        }
+    }
+
+    #[test]
+    fn format_bytes_uses_binary_units() {
+        assert_eq!(format_bytes(0), "0 B");
+        assert_eq!(format_bytes(1023), "1023 B");
+        assert_eq!(format_bytes(1536), "1.5 KiB");
+        assert_eq!(format_bytes(8_000_000), "7.6 MiB");
+        assert_eq!(format_bytes(u64::MAX), "16777216.0 TiB");
+    }
+
+    #[test]
+    fn footprint_table_lists_entries_and_totals() {
+        let out = FootprintTableFormatter::new(true).format(&report());
+        assert!(out.contains("Order"));
+        assert!(out.contains("1000000"));
+        assert!(out.contains("22.9 MiB"));
+        assert!(
+            out.contains(
+                "Padding across counted instances: 7.6 MiB; reordering would save 7.6 MiB"
+            )
+        );
+    }
+
+    #[test]
+    fn footprint_json_has_summary() {
+        let out = FootprintJsonFormatter::new(false).format(&report());
+        let parsed: serde_json::Value = serde_json::from_str(&out).expect("valid JSON");
+        assert_eq!(parsed["structs"][0]["wasted_bytes"], 8_000_000);
+        assert_eq!(parsed["summary"]["total_projected_savings_bytes"], 8_000_000);
+        assert_eq!(parsed["summary"]["unmatched"][0], "Gone");
+    }
+}
@@ -0,0 +1,194 @@
+//! Output formatters for hotspots command.
+
+use crate::hotspots::{HotspotEntry, HotspotReport};
+use colored::Colorize;
+use comfy_table::{Cell, CellAlignment, Color, Table, presets::UTF8_FULL_CONDENSED};
+use serde::Serialize;
+
+/// Functions named per struct in the table; JSON lists them all.
+const TABLE_FUNCTIONS: usize = 3;
+
+pub struct HotspotsTableFormatter {
+    no_color: bool,
+}
+
+impl HotspotsTableFormatter {
+    pub fn new(no_color: bool) -> Self {
+        Self { no_color }
+    }
+
+    pub fn format(&self, report: &HotspotReport) -> String {
+        let profiled = report.profiled_percent.is_some();
+        let mut table = Table::new();
+        table.load_preset(UTF8_FULL_CONDENSED);
+        let mut header = vec!["Struct", "Size", "Padding", "Lines", "Functions"];
+        if profiled {
+            header.push("Samples");
+        }
+        header.push("Hottest functions");
+        table.set_header(header);
+
+        for e in &report.entries {
+            let mut row = vec![
+                Cell::new(&e.name),
+                Cell::new(e.size).set_alignment(CellAlignment::Right),
+                Cell::new(e.padding_bytes).set_alignment(CellAlignment::Right),
+                Cell::new(e.cache_lines).set_alignment(CellAlignment::Right),
+                Cell::new(e.functions.len()).set_alignment(CellAlignment::Right),
+            ];
+            if let Some(weight) = e.weight_percent {
+                let cell = Cell::new(format!("{:.1}%", weight));
+                let cell = if self.no_color || weight == 0.0 { cell } else { cell.fg(Color::Red) };
+                row.push(cell.set_alignment(CellAlignment::Right));
+            }
+            row.push(Cell::new(hottest_functions(e)));
+            table.add_row(row);
+        }
+
+        let mut summary = format!(
+            "{} structs taken by {} of {} functions",
+            report.entries.len(),
+            report.functions_with_structs,
+            report.functions
+        );
+        if let (Some(all), Some(structs)) =
+            (report.profiled_percent, report.struct_profiled_percent)
+        {
+            summary.push_str(&format!(
+                "; {:.1}% of samples are in the binary's functions, {:.1}% in those taking a listed struct",
+                all, structs
+            ));
+        }
+
+        let mut output = table.to_string();
+        output.push_str("\n\n");
+        if self.no_color {
+            output.push_str(&summary);
+        } else {
+            output.push_str(&summary.bold().to_string());
+        }
+        output
+    }
+}
+
+/// `fill (70.0%), log_quote (10.0%), +2 more`.
+fn hottest_functions(entry: &HotspotEntry) -> String {
+    let mut names: Vec<String> = entry
+        .functions
+        .iter()
+        .take(TABLE_FUNCTIONS)
+        .map(|u| match u.weight_percent {
+            Some(weight) => format!("{} ({:.1}%)", u.function, weight),
+            None => u.function.clone(),
+        })
+        .collect();
+    if entry.functions.len() > TABLE_FUNCTIONS {
+        names.push(format!("+{} more", entry.functions.len() - TABLE_FUNCTIONS));
+    }
+    names.join(", ")
+}
+
+#[derive(Serialize)]
+struct HotspotsJsonOutput<'a> {
+    version: &'static str,
+    structs: &'a [HotspotEntry],
+    summary: HotspotsSummary,
+}
+
+#[derive(Serialize)]
+struct HotspotsSummary {
+    functions: usize,
+    functions_with_structs: usize,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    profiled_percent: Option<f64>,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    struct_profiled_percent: Option<f64>,
+}
+
+pub struct HotspotsJsonFormatter {
+    pretty: bool,
+}
+
+impl HotspotsJsonFormatter {
+    pub fn new(pretty: bool) -> Self {
+        Self { pretty }
+    }
+
+    pub fn format(&self, report: &HotspotReport) -> String {
+        let output = HotspotsJsonOutput {
+            version: env!("CARGO_PKG_VERSION"),
+            structs: &report.entries,
+            summary: HotspotsSummary {
+                functions: report.functions,
+                functions_with_structs: report.functions_with_structs,
+                profiled_percent: report.profiled_percent,
+                struct_profiled_percent: report.struct_profiled_percent,
+            },
+        };
+
+        if self.pretty {
+            serde_json::to_string_pretty(&output)
+                .unwrap_or_else(|e| format!("{{\"error\": \"{}\"}}", e))
+        } else {
+            serde_json::to_string(&output).unwrap_or_else(|e| format!("{{\"error\": \"{}\"}}", e))
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::hotspots::FunctionUse;
+    use crate::types::Passing;
+
+    fn report() -> HotspotReport {
+        let user = |function: &str, weight| FunctionUse {
+            function: function.to_string(),
+            linkage_name: None,
+            source_location: None,
+            parameter: "order".to_string(),
+            passing: Passing::Pointer,
+            weight_percent: Some(weight),
+        };
+        HotspotReport {
+            entries: vec![HotspotEntry {
+                name: "Order".to_string(),
+                size: 24,
+                padding_bytes: 8,
+                cache_lines: 1,
+                source_location: None,
+                weight_percent: Some(72.5),
+                functions: vec![
+                    user("fill", 70.0),
+                    user("cancel", 2.5),
+                    user("audit", 0.0),
+                    user("dump", 0.0),
+                ],
+            }],
+            functions: 10,
+            functions_with_structs: 4,
+            profiled_percent: Some(90.0),
+            struct_profiled_percent: Some(72.5),
+        }
+    }
+
+    #[test]
+    fn hotspots_table_names_hottest_functions_and_totals() {
+        let out = HotspotsTableFormatter::new(true).format(&report());
+        assert!(out.contains("72.5%"));
+        assert!(out.contains("fill (70.0%), cancel (2.5%), audit (0.0%), +1 more"));
+        assert!(out.contains(
+            "1 structs taken by 4 of 10 functions; 90.0% of samples are in the binary's \
+             functions, 72.5% in those taking a listed struct"
+        ));
+    }
+
+    #[test]
+    fn hotspots_json_lists_every_function() {
+        let out = HotspotsJsonFormatter::new(false).format(&report());
+        let parsed: serde_json::Value = serde_json::from_str(&out).expect("valid JSON");
+        assert_eq!(parsed["structs"][0]["functions"].as_array().map(Vec::len), Some(4));
+        assert_eq!(parsed["structs"][0]["functions"][0]["passing"], "pointer");
+        assert_eq!(parsed["summary"]["struct_profiled_percent"], 72.5);
+    }
+}
@@ -1,5 +1,7 @@
+use crate::batch::{BatchReport, BatchStruct};
 use crate::types::StructLayout;
 use serde::Serialize;
+use std::io::{self, Write};
 
 #[derive(Serialize)]
 struct Output<'a> {
@@ -7,6 +9,13 @@ struct Output<'a> {
     structs: &'a [StructLayout],
 }
 
+#[derive(Serialize)]
+struct BatchOutput<'a> {
+    version: &'static str,
+    binaries: &'a [String],
+    structs: &'a [BatchStruct],
+}
+
 pub struct JsonFormatter {
     pretty: bool,
 }
@@ -26,6 +35,45 @@ impl JsonFormatter {
             serde_json::to_string(&output).unwrap_or_else(|e| format!("{{\"error\": \"{}\"}}", e))
         }
     }
+
+    /// Serialize the same document as `format` straight into `writer`, without building
+    /// the whole string in memory.
+    pub fn write<W: Write>(&self, writer: W, layouts: &[StructLayout]) -> io::Result<()> {
+        let output = Output { version: env!("CARGO_PKG_VERSION"), structs: layouts };
+
+        if self.pretty {
+            serde_json::to_writer_pretty(writer, &output)?;
+        } else {
+            serde_json::to_writer(writer, &output)?;
+        }
+        Ok(())
+    }
+
+    /// Serialize a batch report: the analyzed binaries and the merged structs, each with the
+    /// binaries it was found in.
+    pub fn write_batch<W: Write>(&self, writer: W, report: &BatchReport) -> io::Result<()> {
+        let output = BatchOutput {
+            version: env!("CARGO_PKG_VERSION"),
+            binaries: &report.binaries,
+            structs: &report.structs,
+        };
+
+        if self.pretty {
+            serde_json::to_writer_pretty(writer, &output)?;
+        } else {
+            serde_json::to_writer(writer, &output)?;
+        }
+        Ok(())
+    }
+
+    /// Write one struct as a single compact JSON line (NDJSON record).
+    pub fn write_ndjson<W: Write + ?Sized>(
+        writer: &mut W,
+        layout: &StructLayout,
+    ) -> io::Result<()> {
+        serde_json::to_writer(&mut *writer, layout)?;
+        writer.write_all(b"\n")
+    }
 }
 
 #[cfg(test)]
@@ -47,6 +95,32 @@ mod tests {
         assert!(parsed["structs"].is_array());
     }
 
+    #[test]
+    fn json_formatter_write_matches_format() {
+        for pretty in [false, true] {
+            let formatter = JsonFormatter::new(pretty);
+            let layouts = [layout("Foo"), layout("Bar")];
+            let mut buf = Vec::new();
+            formatter.write(&mut buf, &layouts).expect("write");
+            assert_eq!(String::from_utf8(buf).unwrap(), formatter.format(&layouts));
+        }
+    }
+
+    #[test]
+    fn ndjson_writes_one_record_per_line() {
+        let mut buf = Vec::new();
+        for name in ["Foo", "Bar"] {
+            JsonFormatter::write_ndjson(&mut buf, &layout(name)).expect("write");
+        }
+        let text = String::from_utf8(buf).unwrap();
+        let lines: Vec<_> = text.lines().collect();
+        assert_eq!(lines.len(), 2);
+        for (line, name) in lines.iter().zip(["Foo", "Bar"]) {
+            let parsed: serde_json::Value = serde_json::from_str(line).expect("valid JSON");
+            assert_eq!(parsed["name"], name);
+        }
+    }
+
     #[test]
     fn json_formatter_compact() {
         let formatter = JsonFormatter::new(false);
@@ -1,9 +1,16 @@
+mod footprint;
+mod hotspots;
 mod json;
+mod parallel;
 mod sarif;
 mod suggest;
 mod table;
+mod timings;
 
+pub use footprint::{FootprintJsonFormatter, FootprintTableFormatter};
+pub use hotspots::{HotspotsJsonFormatter, HotspotsTableFormatter};
 pub use json::JsonFormatter;
 pub use sarif::{CheckViolation, CheckViolationKind, SarifFormatter};
 pub use suggest::{SuggestJsonFormatter, SuggestTableFormatter};
 pub use table::TableFormatter;
+pub use timings::{TimingsJsonFormatter, TimingsTableFormatter};
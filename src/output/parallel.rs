@@ -0,0 +1,106 @@
+//! Rendering large reports in parallel chunks.
+//!
+//! Formatting a report of 100k structs is slow enough to matter and, built as one string,
+//! holds the whole report in memory next to the layouts. `write_chunked` renders a window
+//! of chunks at a time, one chunk per worker, and writes them out in order before
+//! rendering the next window, so output is identical for any job count and at most one
+//! window of rendered text is held at once.
+
+use std::io::{self, Write};
+
+/// Items rendered per chunk.
+const CHUNK_ITEMS: usize = 256;
+
+/// Render `items` with `render` on up to `jobs` threads and write the results to `writer`
+/// in item order. `render` is given the index of the chunk's first item, the chunk, and
+/// the buffer to render into, and returns a value passed to `collect` in chunk order,
+/// together with the rendered chunk, which `collect` may still adjust before it is written.
+pub(crate) fn write_chunked<T, A>(
+    writer: &mut dyn Write,
+    items: &[T],
+    jobs: usize,
+    render: impl Fn(usize, &[T], &mut String) -> A + Sync,
+    mut collect: impl FnMut(A, &mut String),
+) -> io::Result<()>
+where
+    T: Sync,
+    A: Send,
+{
+    let jobs = jobs.max(1);
+    if jobs == 1 {
+        let mut buffer = String::new();
+        for (i, chunk) in items.chunks(CHUNK_ITEMS).enumerate() {
+            buffer.clear();
+            let extra = render(i * CHUNK_ITEMS, chunk, &mut buffer);
+            collect(extra, &mut buffer);
+            writer.write_all(buffer.as_bytes())?;
+        }
+        return Ok(());
+    }
+
+    let window = CHUNK_ITEMS * jobs;
+    for (w, items) in items.chunks(window).enumerate() {
+        let rendered: Vec<(String, A)> = std::thread::scope(|scope| {
+            let render = &render;
+            let handles: Vec<_> = items
+                .chunks(CHUNK_ITEMS)
+                .enumerate()
+                .map(|(i, chunk)| {
+                    scope.spawn(move || {
+                        let mut buffer = String::new();
+                        let extra = render(w * window + i * CHUNK_ITEMS, chunk, &mut buffer);
+                        (buffer, extra)
+                    })
+                })
+                .collect();
+            handles
+                .into_iter()
+                .map(|handle| {
+                    handle.join().unwrap_or_else(|panic| std::panic::resume_unwind(panic))
+                })
+                .collect()
+        });
+        for (mut buffer, extra) in rendered {
+            collect(extra, &mut buffer);
+            writer.write_all(buffer.as_bytes())?;
+        }
+    }
+    Ok(())
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn output_and_collected_values_follow_item_order() {
+        let items: Vec<u32> = (0..2000).collect();
+        let run = |jobs| {
+            let mut out = Vec::new();
+            let mut firsts = Vec::new();
+            write_chunked(
+                &mut out,
+                &items,
+                jobs,
+                |first, chunk, buffer| {
+                    for (i, item) in chunk.iter().enumerate() {
+                        if first + i > 0 {
+                            buffer.push(',');
+                        }
+                        buffer.push_str(&item.to_string());
+                    }
+                    first
+                },
+                |first, _| firsts.push(first),
+            )
+            .unwrap();
+            (String::from_utf8(out).unwrap(), firsts)
+        };
+
+        let (sequential, firsts) = run(1);
+        let expected: Vec<String> = items.iter().map(u32::to_string).collect();
+        assert_eq!(sequential, expected.join(","));
+        assert_eq!(firsts, (0..2000).step_by(CHUNK_ITEMS).collect::<Vec<_>>());
+        assert_eq!(run(3), (sequential, firsts));
+    }
+}
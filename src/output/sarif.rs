@@ -1,9 +1,11 @@
-use crate::analysis::OptimizedLayout;
-use crate::diff::DiffResult;
+use super::parallel::write_chunked;
+use crate::analysis::{OptimizedLayout, SplitKind};
+use crate::diff::{DiffResult, Regression};
 use crate::types::{SourceLocation, StructLayout};
 use serde::Serialize;
 use serde_json::{Value, json};
 use std::collections::BTreeSet;
+use std::io::{self, Write};
 
 const SARIF_VERSION: &str = "2.1.0";
 const SARIF_SCHEMA: &str = "https://schemastore.azurewebsites.net/schemas/json/sarif-2.1.0.json";
@@ -12,13 +14,22 @@ const TOOL_URI: &str = "https://github.com/avifenesh/layout-audit";
 
 const RULE_SIZE_INCREASE: &str = "LAYOUT-SIZE-INCREASE";
 const RULE_PADDING_INCREASE: &str = "LAYOUT-PADDING-INCREASE";
+const RULE_CACHE_LINES_INCREASE: &str = "LAYOUT-CACHE-LINES-INCREASE";
+const RULE_LINE_SPLIT: &str = "LAYOUT-LINE-SPLIT";
+const RULE_FALSE_SHARING_INCREASE: &str = "LAYOUT-FALSE-SHARING-INCREASE";
+const RULE_STRIDE_REGRESSION: &str = "LAYOUT-STRIDE-REGRESSION";
 const RULE_BUDGET_SIZE: &str = "LAYOUT-BUDGET-SIZE";
 const RULE_BUDGET_PADDING: &str = "LAYOUT-BUDGET-PADDING";
 const RULE_BUDGET_PADDING_PERCENT: &str = "LAYOUT-BUDGET-PADDING-PERCENT";
 const RULE_BUDGET_FALSE_SHARING: &str = "LAYOUT-BUDGET-FALSE-SHARING";
+const RULE_BUDGET_CACHE_LINES: &str = "LAYOUT-BUDGET-CACHE-LINES";
+const RULE_BUDGET_CACHE_DENSITY: &str = "LAYOUT-BUDGET-CACHE-DENSITY";
+const RULE_BUDGET_HOT_LINES: &str = "LAYOUT-BUDGET-HOT-LINES";
+const RULE_WRITER_SHARING: &str = "LAYOUT-WRITER-SHARING";
 const RULE_PADDING: &str = "LAYOUT-PADDING";
 const RULE_FALSE_SHARING: &str = "LAYOUT-FALSE-SHARING";
 const RULE_REORDER_SUGGESTION: &str = "LAYOUT-REORDER-SUGGESTION";
+const RULE_SPLIT_SUGGESTION: &str = "LAYOUT-SPLIT-SUGGESTION";
 
 #[derive(Debug, Clone, Copy, Serialize)]
 #[serde(rename_all = "snake_case")]
@@ -27,6 +38,10 @@ pub enum CheckViolationKind {
     MaxPaddingBytes,
     MaxPaddingPercent,
     MaxFalseSharingWarnings,
+    SharedWriterCacheLine,
+    MaxCacheLines,
+    MinCacheLineDensity,
+    MaxHotLines,
 }
 
 #[derive(Debug, Clone, Serialize)]
@@ -40,20 +55,32 @@ pub struct CheckViolation {
 
 pub struct SarifFormatter {
     tool_version: &'static str,
+    jobs: usize,
 }
 
 impl SarifFormatter {
     pub fn new() -> Self {
-        Self { tool_version: env!("CARGO_PKG_VERSION") }
+        Self { tool_version: env!("CARGO_PKG_VERSION"), jobs: 1 }
     }
 
-    pub fn format_diff(&self, diff: &DiffResult, error_on_regression: bool) -> String {
+    /// Render inspect results on `jobs` threads. Output is identical for any job count.
+    pub fn with_jobs(mut self, jobs: usize) -> Self {
+        self.jobs = jobs.max(1);
+        self
+    }
+
+    /// Report the regressions in `diff`, as errors for the kinds in `error_on` and as
+    /// warnings otherwise.
+    pub fn format_diff(&self, diff: &DiffResult, error_on: &[Regression]) -> String {
         let mut results: Vec<Value> = Vec::new();
         let mut used_rules: BTreeSet<&'static str> = BTreeSet::new();
-        let level = if error_on_regression { "error" } else { "warning" };
+        let level_for =
+            |kind: Regression| if error_on.contains(&kind) { "error" } else { "warning" };
 
         for change in &diff.changed {
+            let impact = &change.impact;
             if change.size_delta > 0 {
+                let level = level_for(Regression::Size);
                 used_rules.insert(RULE_SIZE_INCREASE);
                 let message = format!(
                     "Struct {} size increased from {} to {} (+{} bytes)",
@@ -74,6 +101,7 @@ impl SarifFormatter {
             }
 
             if change.padding_delta > 0 {
+                let level = level_for(Regression::Padding);
                 used_rules.insert(RULE_PADDING_INCREASE);
                 let message = format!(
                     "Struct {} padding increased from {} to {} (+{} bytes)",
@@ -92,6 +120,98 @@ impl SarifFormatter {
                     })),
                 ));
             }
+
+            if impact.cache_lines_delta > 0 {
+                used_rules.insert(RULE_CACHE_LINES_INCREASE);
+                let message = format!(
+                    "Struct {} now spans {} cache lines of {} bytes, up from {}",
+                    change.name,
+                    impact.new_cache_lines,
+                    impact.cache_line_size,
+                    impact.old_cache_lines
+                );
+                results.push(make_result(
+                    RULE_CACHE_LINES_INCREASE,
+                    level_for(Regression::CacheLines),
+                    message,
+                    change.source_location.as_ref(),
+                    Some(json!({
+                        "struct": change.name,
+                        "cache_line_size": impact.cache_line_size,
+                        "old_cache_lines": impact.old_cache_lines,
+                        "new_cache_lines": impact.new_cache_lines,
+                        "delta": impact.cache_lines_delta,
+                    })),
+                ));
+            }
+
+            if !impact.newly_split_members.is_empty() {
+                used_rules.insert(RULE_LINE_SPLIT);
+                let message = format!(
+                    "Struct {}: {} now straddle(s) a {}-byte cache line boundary",
+                    change.name,
+                    impact.newly_split_members.join(", "),
+                    impact.cache_line_size
+                );
+                results.push(make_result(
+                    RULE_LINE_SPLIT,
+                    level_for(Regression::LineSplits),
+                    message,
+                    change.source_location.as_ref(),
+                    Some(json!({
+                        "struct": change.name,
+                        "members": impact.newly_split_members,
+                    })),
+                ));
+            }
+
+            if !impact.new_false_sharing_pairs.is_empty() {
+                used_rules.insert(RULE_FALSE_SHARING_INCREASE);
+                let pairs: Vec<String> = impact
+                    .new_false_sharing_pairs
+                    .iter()
+                    .map(|p| format!("{}/{}", p.member_a, p.member_b))
+                    .collect();
+                let message = format!(
+                    "Struct {}: atomics newly share a cache line: {}",
+                    change.name,
+                    pairs.join(", ")
+                );
+                results.push(make_result(
+                    RULE_FALSE_SHARING_INCREASE,
+                    level_for(Regression::FalseSharing),
+                    message,
+                    change.source_location.as_ref(),
+                    Some(json!({
+                        "struct": change.name,
+                        "pairs": impact.new_false_sharing_pairs,
+                    })),
+                ));
+            }
+
+            if impact.stride_regressed() {
+                used_rules.insert(RULE_STRIDE_REGRESSION);
+                let message = format!(
+                    "Struct {}: each array element touches {:.2} cache lines on average, up from {:.2} ({} -> {} elements per {}-byte page)",
+                    change.name,
+                    impact.new_stride.cache_lines_per_element,
+                    impact.old_stride.cache_lines_per_element,
+                    impact.old_stride.elements_per_page,
+                    impact.new_stride.elements_per_page,
+                    crate::diff::PAGE_SIZE
+                );
+                results.push(make_result(
+                    RULE_STRIDE_REGRESSION,
+                    level_for(Regression::Stride),
+                    message,
+                    change.source_location.as_ref(),
+                    Some(json!({
+                        "struct": change.name,
+                        "old_stride": impact.old_stride,
+                        "new_stride": impact.new_stride,
+                    })),
+                ));
+            }
         }
 
         let rules = build_rules(&used_rules);
@@ -119,60 +239,70 @@ impl SarifFormatter {
     }
 
     pub fn format_inspect(&self, layouts: &[StructLayout]) -> String {
-        let mut results: Vec<Value> = Vec::new();
-        let mut used_rules: BTreeSet<&'static str> = BTreeSet::new();
+        let mut output = Vec::new();
+        self.write_inspect(&mut output, layouts).expect("writing to a Vec cannot fail");
+        String::from_utf8(output).expect("SARIF is UTF-8")
+    }
 
-        for layout in layouts {
-            if layout.metrics.padding_bytes > 0 {
-                used_rules.insert(RULE_PADDING);
-                let message = format!(
-                    "Struct {} has {} padding bytes ({:.1}% of {} bytes)",
-                    layout.name,
-                    layout.metrics.padding_bytes,
-                    layout.metrics.padding_percentage,
-                    layout.size
-                );
-                results.push(make_result(
-                    RULE_PADDING,
-                    "warning",
-                    message,
-                    layout.source_location.as_ref(),
-                    Some(json!({
-                        "struct": layout.name,
-                        "size": layout.size,
-                        "padding_bytes": layout.metrics.padding_bytes,
-                        "padding_percent": layout.metrics.padding_percentage,
-                        "cache_lines_spanned": layout.metrics.cache_lines_spanned,
-                    })),
-                ));
-            }
+    /// Write the same document as `format_inspect` to `writer`. Results are rendered in
+    /// parallel chunks and written as they are ready; the rules they use follow them, which
+    /// is where the keys' alphabetical order puts the `tool` object anyway.
+    pub fn write_inspect(
+        &self,
+        writer: &mut dyn Write,
+        layouts: &[StructLayout],
+    ) -> io::Result<()> {
+        let mut used_rules: BTreeSet<&'static str> = BTreeSet::new();
 
-            if let Some(fs) = layout.metrics.false_sharing.as_ref() {
-                if !fs.warnings.is_empty() || !fs.spanning_warnings.is_empty() {
-                    used_rules.insert(RULE_FALSE_SHARING);
-                    let warning_count = fs.warnings.len();
-                    let spanning_count = fs.spanning_warnings.len();
-                    let message = format!(
-                        "Struct {} has {} potential false sharing warning(s) and {} cache-line spanning atomic(s)",
-                        layout.name, warning_count, spanning_count
-                    );
-                    results.push(make_result(
-                        RULE_FALSE_SHARING,
-                        "warning",
-                        message,
-                        layout.source_location.as_ref(),
-                        Some(json!({
-                            "struct": layout.name,
-                            "false_sharing_warnings": warning_count,
-                            "spanning_warnings": spanning_count,
-                        })),
-                    ));
+        writer.write_all(
+            format!(
+                "{{\n  \"$schema\": {},\n  \"runs\": [\n    {{\n      \"results\": [",
+                Value::from(SARIF_SCHEMA)
+            )
+            .as_bytes(),
+        )?;
+        write_chunked(
+            writer,
+            layouts,
+            self.jobs,
+            |_, chunk, output| {
+                let mut rules = Vec::new();
+                for layout in chunk {
+                    for (rule, result) in inspect_results(layout) {
+                        rules.push(rule);
+                        output.push(',');
+                        write_indented(output, &result, 8);
+                    }
+                }
+                rules
+            },
+            |rules, output| {
+                // Chunks are rendered independently, so only here is the first one known.
+                if used_rules.is_empty() && !rules.is_empty() {
+                    output.remove(0);
                 }
+                used_rules.extend(rules);
+            },
+        )?;
+
+        let tool = json!({
+            "driver": {
+                "name": TOOL_NAME,
+                "version": self.tool_version,
+                "informationUri": TOOL_URI,
+                "rules": build_rules(&used_rules),
             }
-        }
-
-        let rules = build_rules(&used_rules);
-        render_sarif(self.tool_version, rules, results)
+        });
+        let mut tail = String::from(if used_rules.is_empty() { "],\n" } else { "\n      ],\n" });
+        tail.push_str("      \"tool\": ");
+        let mut tool_text = String::new();
+        write_indented(&mut tool_text, &tool, 6);
+        tail.push_str(tool_text.trim_start_matches('\n').trim_start());
+        tail.push_str(&format!(
+            "\n    }}\n  ],\n  \"version\": {}\n}}",
+            Value::from(SARIF_VERSION)
+        ));
+        writer.write_all(tail.as_bytes())
     }
 
     pub fn format_suggest(
@@ -184,10 +314,43 @@ impl SarifFormatter {
         let mut used_rules: BTreeSet<&'static str> = BTreeSet::new();
 
         for (idx, suggestion) in suggestions.iter().enumerate() {
+            let location = locations.get(idx).and_then(|loc| loc.as_ref());
+            if let Some(ref plan) = suggestion.split
+                && plan.recommendation != SplitKind::None
+            {
+                used_rules.insert(RULE_SPLIT_SUGGESTION);
+                let (what, optimized) = match plan.recommendation {
+                    SplitKind::StructOfArrays => ("a struct of arrays", &plan.struct_of_arrays),
+                    _ => ("a hot/cold split", &plan.hot_cold),
+                };
+                let message = format!(
+                    "A loop over {} {} elements touches {} cache lines; {} touches {}",
+                    plan.elements,
+                    suggestion.name,
+                    plan.original.cache_lines,
+                    what,
+                    optimized.cache_lines
+                );
+                let hot: Vec<&str> = plan.hot_members.iter().map(|m| m.name.as_str()).collect();
+                results.push(make_result(
+                    RULE_SPLIT_SUGGESTION,
+                    "note",
+                    message,
+                    location,
+                    Some(json!({
+                        "struct": suggestion.name,
+                        "recommendation": plan.recommendation,
+                        "hot_fields": hot,
+                        "elements": plan.elements,
+                        "original_cache_lines": plan.original.cache_lines,
+                        "hot_cold_cache_lines": plan.hot_cold.cache_lines,
+                        "struct_of_arrays_cache_lines": plan.struct_of_arrays.cache_lines,
+                    })),
+                ));
+            }
             if suggestion.savings_bytes == 0 {
                 continue;
             }
-            let location = locations.get(idx).and_then(|loc| loc.as_ref());
             used_rules.insert(RULE_REORDER_SUGGESTION);
             let message = format!(
                 "Struct {} can save {} bytes ({:.1}%) by reordering fields",
@@ -225,6 +388,81 @@ fn rule_id_for_kind(kind: CheckViolationKind) -> &'static str {
         CheckViolationKind::MaxPaddingBytes => RULE_BUDGET_PADDING,
         CheckViolationKind::MaxPaddingPercent => RULE_BUDGET_PADDING_PERCENT,
         CheckViolationKind::MaxFalseSharingWarnings => RULE_BUDGET_FALSE_SHARING,
+        CheckViolationKind::SharedWriterCacheLine => RULE_WRITER_SHARING,
+        CheckViolationKind::MaxCacheLines => RULE_BUDGET_CACHE_LINES,
+        CheckViolationKind::MinCacheLineDensity => RULE_BUDGET_CACHE_DENSITY,
+        CheckViolationKind::MaxHotLines => RULE_BUDGET_HOT_LINES,
+    }
+}
+
+/// The padding and false-sharing results for one inspected struct, with their rules.
+fn inspect_results(layout: &StructLayout) -> Vec<(&'static str, Value)> {
+    let mut results = Vec::new();
+
+    if layout.metrics.padding_bytes > 0 {
+        let message = format!(
+            "Struct {} has {} padding bytes ({:.1}% of {} bytes)",
+            layout.name,
+            layout.metrics.padding_bytes,
+            layout.metrics.padding_percentage,
+            layout.size
+        );
+        results.push((
+            RULE_PADDING,
+            make_result(
+                RULE_PADDING,
+                "warning",
+                message,
+                layout.source_location.as_ref(),
+                Some(json!({
+                    "struct": layout.name,
+                    "size": layout.size,
+                    "padding_bytes": layout.metrics.padding_bytes,
+                    "padding_percent": layout.metrics.padding_percentage,
+                    "cache_lines_spanned": layout.metrics.cache_lines_spanned,
+                })),
+            ),
+        ));
+    }
+
+    if let Some(fs) = layout.metrics.false_sharing.as_ref()
+        && (!fs.contended_lines.is_empty() || !fs.spanning_warnings.is_empty())
+    {
+        let line_count = fs.contended_lines.len();
+        let spanning_count = fs.spanning_warnings.len();
+        let message = format!(
+            "Struct {} has {} cache line(s) shared by atomics ({} pair(s)) and {} cache-line spanning atomic(s)",
+            layout.name, line_count, fs.pair_count, spanning_count
+        );
+        let lines: Vec<u64> = fs.contended_lines.iter().map(|l| l.cache_line).collect();
+        results.push((
+            RULE_FALSE_SHARING,
+            make_result(
+                RULE_FALSE_SHARING,
+                "warning",
+                message,
+                layout.source_location.as_ref(),
+                Some(json!({
+                    "struct": layout.name,
+                    "contended_cache_lines": lines,
+                    "false_sharing_pairs": fs.pair_count,
+                    "spanning_warnings": spanning_count,
+                })),
+            ),
+        ));
+    }
+
+    results
+}
+
+/// Append `value` pretty-printed on a new line, every line indented by `indent` spaces, as
+/// it appears nested that deep in a pretty-printed document.
+fn write_indented(output: &mut String, value: &Value, indent: usize) {
+    let text = serde_json::to_string_pretty(value).unwrap_or_else(|e| format!("\"{}\"", e));
+    for line in text.lines() {
+        output.push('\n');
+        output.extend(std::iter::repeat_n(' ', indent));
+        output.push_str(line);
     }
 }
 
@@ -250,6 +488,19 @@ fn rule_metadata(rule_id: &str) -> (&'static str, &'static str) {
         RULE_PADDING_INCREASE => {
             ("Struct padding increased", "Struct padding increased relative to baseline")
         }
+        RULE_CACHE_LINES_INCREASE => {
+            ("Cache lines increased", "Struct spans more cache lines than the baseline")
+        }
+        RULE_LINE_SPLIT => {
+            ("Member split across cache lines", "A member newly straddles a cache line boundary")
+        }
+        RULE_FALSE_SHARING_INCREASE => {
+            ("False sharing introduced", "Atomics newly share a cache line")
+        }
+        RULE_STRIDE_REGRESSION => (
+            "Array stride regressed",
+            "Array elements of the struct touch more cache lines each than the baseline",
+        ),
         RULE_BUDGET_SIZE => ("Budget: size", "Struct size exceeded budget"),
         RULE_BUDGET_PADDING => ("Budget: padding bytes", "Struct padding bytes exceeded budget"),
         RULE_BUDGET_PADDING_PERCENT => {
@@ -258,11 +509,26 @@ fn rule_metadata(rule_id: &str) -> (&'static str, &'static str) {
         RULE_BUDGET_FALSE_SHARING => {
             ("Budget: false sharing", "Struct false sharing warnings exceeded budget")
         }
+        RULE_BUDGET_CACHE_LINES => {
+            ("Budget: cache lines", "Struct spans more cache lines than budgeted")
+        }
+        RULE_BUDGET_CACHE_DENSITY => {
+            ("Budget: cache line density", "Struct cache line density fell below budget")
+        }
+        RULE_BUDGET_HOT_LINES => {
+            ("Budget: hot cache lines", "Hot fields span more cache lines than budgeted")
+        }
+        RULE_WRITER_SHARING => {
+            ("Cache line shared by writers", "Fields written by different roles share a cache line")
+        }
         RULE_PADDING => ("Padding detected", "Struct contains padding bytes"),
         RULE_FALSE_SHARING => ("Potential false sharing", "Atomic members share cache lines"),
         RULE_REORDER_SUGGESTION => {
             ("Reorder suggestion", "Struct can be reordered to reduce padding")
         }
+        RULE_SPLIT_SUGGESTION => {
+            ("Split suggestion", "Splitting hot fields out of the struct touches fewer cache lines")
+        }
         _ => ("Layout issue", "Layout-audit reported an issue"),
     }
 }
@@ -320,10 +586,12 @@ fn render_sarif(tool_version: &str, rules: Vec<Value>, results: Vec<Value>) -> S
 #[cfg(test)]
 mod tests {
     use super::*;
-    use crate::diff::{DiffResult, MemberChange, MemberChangeKind, StructChange, StructSummary};
+    use crate::diff::{
+        DiffResult, MemberChange, MemberChangeKind, PerformanceImpact, StructChange, StructSummary,
+    };
     use crate::types::{
-        CacheLineSpanningWarning, FalseSharingAnalysis, FalseSharingWarning, LayoutMetrics,
-        SourceLocation, StructLayout,
+        CacheLineSpanningWarning, ContendedCacheLine, FalseSharingAnalysis, FalseSharingWarning,
+        LayoutMetrics, SourceLocation, StructLayout,
     };
 
     fn parse_sarif(s: &str) -> Value {
@@ -345,7 +613,7 @@ mod tests {
             changed: Vec::new(),
             unchanged_count: 0,
         };
-        let sarif = formatter.format_diff(&diff, false);
+        let sarif = formatter.format_diff(&diff, &[]);
         let parsed = parse_sarif(&sarif);
         let results = parsed["runs"][0]["results"].as_array().unwrap();
         assert!(results.is_empty());
@@ -369,6 +637,11 @@ mod tests {
             }],
             source_location: Some(SourceLocation { file: "src/foo.c".to_string(), line: 10 }),
             old_source_location: None,
+            impact: PerformanceImpact::new(
+                &StructLayout::new("Foo".to_string(), 8, Some(8)),
+                &StructLayout::new("Foo".to_string(), 16, Some(8)),
+                64,
+            ),
         };
         let diff = DiffResult {
             added: vec![StructSummary {
@@ -382,7 +655,7 @@ mod tests {
             unchanged_count: 0,
         };
 
-        let sarif = formatter.format_diff(&diff, true);
+        let sarif = formatter.format_diff(&diff, &[Regression::Size, Regression::Padding]);
         let parsed = parse_sarif(&sarif);
         let results = parsed["runs"][0]["results"].as_array().unwrap();
         assert_eq!(results.len(), 2);
@@ -429,6 +702,34 @@ mod tests {
         assert_eq!(results[1]["ruleId"], RULE_BUDGET_PADDING_PERCENT);
     }
 
+    #[test]
+    fn inspect_sarif_streams_the_same_document_as_a_value_tree() {
+        let expected = |layouts: &[StructLayout]| {
+            let results: Vec<(&str, Value)> = layouts.iter().flat_map(inspect_results).collect();
+            let rules: BTreeSet<&'static str> = results.iter().map(|(rule, _)| *rule).collect();
+            let results = results.into_iter().map(|(_, result)| result).collect();
+            render_sarif(env!("CARGO_PKG_VERSION"), build_rules(&rules), results)
+        };
+        // Only structs past the first chunks have padding, so the first result is late.
+        let layouts: Vec<StructLayout> = (0..1500)
+            .map(|i| {
+                let mut layout = basic_layout(&format!("S{i}"));
+                if i > 700 && i % 3 == 0 {
+                    layout.metrics.padding_bytes = 4;
+                    layout.metrics.padding_percentage = 25.0;
+                }
+                layout
+            })
+            .collect();
+
+        for jobs in [1, 4] {
+            let formatter = SarifFormatter::new().with_jobs(jobs);
+            assert_eq!(formatter.format_inspect(&layouts), expected(&layouts), "{jobs} jobs");
+            assert_eq!(formatter.format_inspect(&layouts[..10]), expected(&layouts[..10]));
+            assert_eq!(formatter.format_inspect(&[]), expected(&[]));
+        }
+    }
+
     #[test]
     fn inspect_sarif_padding_and_false_sharing() {
         let formatter = SarifFormatter::new();
@@ -438,6 +739,12 @@ mod tests {
         layout.metrics.cache_lines_spanned = 1;
         layout.source_location = Some(SourceLocation { file: "src/foo.c".to_string(), line: 3 });
         layout.metrics.false_sharing = Some(FalseSharingAnalysis {
+            contended_lines: vec![ContendedCacheLine {
+                cache_line: 0,
+                members: vec!["a".to_string(), "b".to_string()],
+                new_pairs: 1,
+            }],
+            pair_count: 1,
             warnings: vec![FalseSharingWarning {
                 member_a: "a".to_string(),
                 member_b: "b".to_string(),
@@ -476,6 +783,10 @@ mod tests {
             optimized_members: Vec::new(),
             skipped_members: Vec::new(),
             has_bitfields: false,
+            hot_fields: None,
+            cache_lines: None,
+            split: None,
+            targets: Vec::new(),
         };
         let mut savings = no_savings.clone();
         savings.name = "Savings".to_string();
@@ -492,4 +803,52 @@ mod tests {
         assert_eq!(results.len(), 1);
         assert_eq!(results[0]["ruleId"], RULE_REORDER_SUGGESTION);
     }
+
+    #[test]
+    fn suggest_sarif_reports_split_without_savings() {
+        use crate::analysis::{LoopFootprint, SplitPlan};
+
+        let footprint = |cache_lines: u64| LoopFootprint { cache_lines, bytes_per_element: 0.0 };
+        let plan = SplitPlan {
+            recommendation: SplitKind::StructOfArrays,
+            elements: 64,
+            cache_line_size: 64,
+            hot_members: Vec::new(),
+            hot_size: 16,
+            cold_members: Vec::new(),
+            cold_size: 8,
+            unknown_fields: Vec::new(),
+            original: footprint(24),
+            hot_cold: footprint(16),
+            struct_of_arrays: footprint(9),
+        };
+        let split = OptimizedLayout {
+            name: "Tick".to_string(),
+            original_size: 24,
+            optimized_size: 24,
+            savings_bytes: 0,
+            savings_percent: 0.0,
+            struct_alignment: 8,
+            original_members: Vec::new(),
+            optimized_members: Vec::new(),
+            skipped_members: Vec::new(),
+            has_bitfields: false,
+            hot_fields: None,
+            cache_lines: None,
+            split: Some(plan),
+            targets: Vec::new(),
+        };
+
+        let parsed = parse_sarif(&SarifFormatter::new().format_suggest(&[split], &[None]));
+        let results = parsed["runs"][0]["results"].as_array().unwrap();
+        assert_eq!(results.len(), 1);
+        assert_eq!(results[0]["ruleId"], RULE_SPLIT_SUGGESTION);
+        assert_eq!(results[0]["properties"]["recommendation"], "struct_of_arrays");
+        assert!(
+            results[0]["message"]["text"]
+                .as_str()
+                .unwrap()
+                .contains("a struct of arrays touches 9")
+        );
+    }
 }
@@ -1,6 +1,6 @@
 //! Output formatters for suggest command.
 
-use crate::analysis::OptimizedLayout;
+use crate::analysis::{OptimizedLayout, SplitKind};
 use colored::Colorize;
 use comfy_table::{Cell, Color, Table, presets::UTF8_FULL_CONDENSED};
 use serde::Serialize;
@@ -31,36 +31,148 @@ impl SuggestTableFormatter {
         let mut output = String::new();
 
         // Header with savings summary
+        let improved = s.is_improvement();
         let header = if s.savings_bytes > 0 {
             format!(
                 "struct {} ({} bytes -> {} bytes, saves {} bytes / {:.1}%)",
                 s.name, s.original_size, s.optimized_size, s.savings_bytes, s.savings_percent
             )
+        } else if improved {
+            let what = if let Some(ref plan) = s.split {
+                split_kind_label(plan.recommendation)
+            } else if s.cache_lines.is_some() {
+                "cache lines rearranged"
+            } else {
+                "hot fields regrouped"
+            };
+            format!(
+                "struct {} ({} bytes -> {} bytes, {})",
+                s.name, s.original_size, s.optimized_size, what
+            )
         } else {
             format!("struct {} ({} bytes, already optimal)", s.name, s.original_size)
         };
 
         if self.no_color {
             output.push_str(&header);
-        } else if s.savings_bytes > 0 {
+        } else if improved {
             output.push_str(&header.green().bold().to_string());
         } else {
             output.push_str(&header.bold().to_string());
         }
-        output.push_str("\n\n");
+        output.push('\n');
+
+        if let Some(ref hot) = s.hot_fields {
+            output.push_str(&format!(
+                "Hot fields: {} (first cache line: {:.1}% of sampled accesses",
+                hot.hot_members.join(", "),
+                hot.original_first_line_percent
+            ));
+            if hot.optimized_first_line_percent > hot.original_first_line_percent {
+                output.push_str(&format!(
+                    ", {:.1}% after reordering",
+                    hot.optimized_first_line_percent
+                ));
+            }
+            output.push_str(")\n");
+        }
+        if !s.targets.is_empty() {
+            let targets: Vec<String> = s
+                .targets
+                .iter()
+                .map(|t| {
+                    format!(
+                        "{} {} bytes / {} cache line{} (saves {})",
+                        t.target,
+                        t.optimized_size,
+                        t.optimized_cache_lines,
+                        if t.optimized_cache_lines == 1 { "" } else { "s" },
+                        t.savings_bytes
+                    )
+                })
+                .collect();
+            output.push_str(&format!("Targets (least savings shown): {}\n", targets.join(", ")));
+        }
+        if let Some(ref plan) = s.cache_lines {
+            output.push_str(&format!(
+                "Cache lines: {} -> {} ({}-byte lines, {})\n",
+                plan.original_cache_lines,
+                plan.optimized_cache_lines,
+                plan.cache_line_size,
+                if plan.exhaustive { "exhaustive search" } else { "heuristic search" }
+            ));
+            for group in &plan.kept_together {
+                output.push_str(&format!("Kept within one cache line: {}\n", group.join(", ")));
+            }
+            if !plan.isolated_atomics.is_empty() {
+                output.push_str(&format!(
+                    "Atomics on separate cache lines: {}\n",
+                    plan.isolated_atomics.join(", ")
+                ));
+            }
+            for group in &plan.unsatisfied_groups {
+                let msg = format!(
+                    "Warning: cannot keep {} within one cache line (too large, or more than one atomic)\n",
+                    group.join(", ")
+                );
+                if self.no_color {
+                    output.push_str(&msg);
+                } else {
+                    output.push_str(&msg.yellow().to_string());
+                }
+            }
+        }
+        if let Some(ref plan) = s.split {
+            output.push_str(&format!(
+                "Split: {} (loop over {} elements, {}-byte lines: {} cache lines / {:.1} bytes per element as is, {} / {:.1} split hot/cold, {} / {:.1} as struct of arrays)\n",
+                split_kind_label(plan.recommendation),
+                plan.elements,
+                plan.cache_line_size,
+                plan.original.cache_lines,
+                plan.original.bytes_per_element,
+                plan.hot_cold.cache_lines,
+                plan.hot_cold.bytes_per_element,
+                plan.struct_of_arrays.cache_lines,
+                plan.struct_of_arrays.bytes_per_element
+            ));
+            if !plan.unknown_fields.is_empty() {
+                let msg =
+                    format!("Warning: no such hot field(s): {}\n", plan.unknown_fields.join(", "));
+                if self.no_color {
+                    output.push_str(&msg);
+                } else {
+                    output.push_str(&msg.yellow().to_string());
+                }
+            }
+        }
+        output.push('\n');
 
         // Current layout
         output.push_str("Current layout:\n");
         output.push_str(&self.format_members_table(&s.original_members));
         output.push('\n');
 
-        // Suggested layout (only if there are savings)
-        if s.savings_bytes > 0 {
+        // Suggested layout (only if it is an improvement)
+        if improved {
             output.push_str("\nSuggested layout:\n");
             output.push_str(&self.format_members_table_colored(&s.optimized_members));
             output.push('\n');
         }
 
+        // Hot and cold parts of a recommended split
+        if let Some(ref plan) = s.split
+            && plan.recommendation != SplitKind::None
+        {
+            output.push_str(&format!("\nHot part ({} bytes):\n", plan.hot_size));
+            output.push_str(&self.format_members_table_colored(&plan.hot_members));
+            output.push_str(&format!(
+                "\nCold part ({} bytes, parallel array with the same index):\n",
+                plan.cold_size
+            ));
+            output.push_str(&self.format_members_table(&plan.cold_members));
+            output.push('\n');
+        }
+
         // Warnings for skipped members
         if !s.skipped_members.is_empty() {
             let warning = format!(
@@ -88,7 +200,7 @@ impl SuggestTableFormatter {
         }
 
         // FFI warning (always show for optimizable structs)
-        if s.savings_bytes > 0 {
+        if improved {
             let ffi_warning = "\nReordering may affect serialization/FFI compatibility";
             if self.no_color {
                 output.push_str(ffi_warning);
@@ -149,6 +261,14 @@ impl SuggestTableFormatter {
     }
 }
 
+fn split_kind_label(kind: SplitKind) -> &'static str {
+    match kind {
+        SplitKind::None => "no split",
+        SplitKind::HotCold => "hot/cold split",
+        SplitKind::StructOfArrays => "struct of arrays",
+    }
+}
+
 #[derive(Serialize)]
 struct SuggestJsonOutput<'a> {
     version: &'static str,
@@ -173,7 +293,7 @@ impl SuggestJsonFormatter {
     }
 
     pub fn format(&self, suggestions: &[OptimizedLayout]) -> String {
-        let optimizable = suggestions.iter().filter(|s| s.savings_bytes > 0).count();
+        let optimizable = suggestions.iter().filter(|s| s.is_improvement()).count();
         let total_savings: u64 = suggestions.iter().map(|s| s.savings_bytes).sum();
 
         let output = SuggestJsonOutput {
@@ -198,6 +318,9 @@ impl SuggestJsonFormatter {
 #[cfg(test)]
 mod tests {
     use super::*;
+    use crate::analysis::{
+        CacheLinePlan, HotFieldPlacement, LoopFootprint, OptimizedMember, SplitPlan,
+    };
 
     fn suggestion(name: &str, savings: u64) -> OptimizedLayout {
         OptimizedLayout {
@@ -211,6 +334,10 @@ mod tests {
             optimized_members: Vec::new(),
             skipped_members: Vec::new(),
             has_bitfields: false,
+            hot_fields: None,
+            cache_lines: None,
+            split: None,
+            targets: Vec::new(),
         }
     }
 
@@ -233,6 +360,81 @@ mod tests {
         assert!(out.contains("already optimal"));
     }
 
+    #[test]
+    fn suggest_table_shows_hot_field_regrouping() {
+        let mut s = suggestion("Hot", 0);
+        s.hot_fields = Some(HotFieldPlacement {
+            hot_members: vec!["hits".to_string()],
+            original_first_line_percent: 0.0,
+            optimized_first_line_percent: 100.0,
+        });
+        let out = SuggestTableFormatter::new(true).format(&[s]);
+        assert!(out.contains("hot fields regrouped"), "{out}");
+        assert!(out.contains(
+            "Hot fields: hits (first cache line: 0.0% of sampled accesses, 100.0% after reordering)"
+        ));
+        assert!(out.contains("Suggested layout"));
+    }
+
+    #[test]
+    fn suggest_table_shows_cache_line_plan() {
+        let mut s = suggestion("Counters", 0);
+        s.cache_lines = Some(CacheLinePlan {
+            cache_line_size: 64,
+            original_cache_lines: 1,
+            optimized_cache_lines: 2,
+            kept_together: vec![vec!["lo".to_string(), "hi".to_string()]],
+            original_split_groups: 0,
+            unsatisfied_groups: vec![vec!["a".to_string(), "b".to_string()]],
+            isolated_atomics: vec!["head".to_string(), "tail".to_string()],
+            original_false_sharing_pairs: 1,
+            exhaustive: true,
+        });
+        let out = SuggestTableFormatter::new(true).format(&[s]);
+        assert!(out.contains("cache lines rearranged"), "{out}");
+        assert!(out.contains("Cache lines: 1 -> 2 (64-byte lines, exhaustive search)"));
+        assert!(out.contains("Kept within one cache line: lo, hi"));
+        assert!(out.contains("Atomics on separate cache lines: head, tail"));
+        assert!(out.contains("cannot keep a, b within one cache line"));
+    }
+
+    #[test]
+    fn suggest_table_shows_split_plan() {
+        let member = |name: &str, offset: u64| OptimizedMember {
+            name: name.into(),
+            type_name: "u64".into(),
+            offset,
+            size: 8,
+            alignment: 8,
+            bit_offset: None,
+            bit_size: None,
+        };
+        let footprint =
+            |cache_lines: u64| LoopFootprint { cache_lines, bytes_per_element: cache_lines as f64 };
+        let mut s = suggestion("Order", 0);
+        s.split = Some(SplitPlan {
+            recommendation: SplitKind::HotCold,
+            elements: 64,
+            cache_line_size: 64,
+            hot_members: vec![member("price", 0)],
+            hot_size: 8,
+            cold_members: vec![member("note", 0)],
+            cold_size: 8,
+            unknown_fields: vec!["qty".to_string()],
+            original: footprint(16),
+            hot_cold: footprint(8),
+            struct_of_arrays: footprint(8),
+        });
+        let out = SuggestTableFormatter::new(true).format(&[s]);
+        assert!(out.contains("16 bytes -> 16 bytes, hot/cold split"), "{out}");
+        assert!(out.contains(
+            "Split: hot/cold split (loop over 64 elements, 64-byte lines: 16 cache lines"
+        ));
+        assert!(out.contains("Warning: no such hot field(s): qty"));
+        assert!(out.contains("Hot part (8 bytes):"));
+        assert!(out.contains("Cold part (8 bytes, parallel array with the same index):"));
+    }
+
     #[test]
     fn suggest_json_summary_fields() {
         let formatter = SuggestJsonFormatter::new(true);
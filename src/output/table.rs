@@ -1,41 +1,137 @@
+use super::parallel::write_chunked;
+use crate::batch::BatchStruct;
 use crate::types::StructLayout;
 use colored::Colorize;
 use comfy_table::{Cell, CellAlignment, Color, Table, presets::UTF8_FULL_CONDENSED};
+use std::io::{self, Write};
 
 pub struct TableFormatter {
     no_color: bool,
     cache_line_size: u32,
+    jobs: usize,
+    detail: Option<usize>,
 }
 
 impl TableFormatter {
     pub fn new(no_color: bool, cache_line_size: u32) -> Self {
-        Self { no_color, cache_line_size }
+        Self { no_color, cache_line_size, jobs: 1, detail: None }
+    }
+
+    /// Render structs on `jobs` threads. Output is identical for any job count.
+    pub fn with_jobs(mut self, jobs: usize) -> Self {
+        self.jobs = jobs.max(1);
+        self
+    }
+
+    /// Render member tables for only the first `limit` structs; the rest get their header
+    /// line alone, and totals over every struct follow.
+    pub fn with_detail(mut self, limit: usize) -> Self {
+        self.detail = Some(limit);
+        self
     }
 
     pub fn format(&self, layouts: &[StructLayout]) -> String {
+        let mut output = Vec::new();
+        self.write(&mut output, layouts).expect("writing to a Vec cannot fail");
+        String::from_utf8(output).expect("tables are UTF-8")
+    }
+
+    /// Write the same text as `format` to `writer`, rendering chunks of structs in
+    /// parallel and writing each as soon as it is ready.
+    pub fn write(&self, writer: &mut dyn Write, layouts: &[StructLayout]) -> io::Result<()> {
+        let detailed = self.detail.map_or(layouts.len(), |n| n.min(layouts.len()));
+        let (full, brief) = layouts.split_at(detailed);
+
+        write_chunked(
+            writer,
+            full,
+            self.jobs,
+            |first, chunk, output| {
+                for (i, layout) in chunk.iter().enumerate() {
+                    if first + i > 0 {
+                        output.push_str("\n\n");
+                    }
+                    output.push_str(&self.format_struct(layout, None));
+                }
+            },
+            |(), _| {},
+        )?;
+        if self.detail.is_none() {
+            return Ok(());
+        }
+
+        if !brief.is_empty() {
+            if !full.is_empty() {
+                writer.write_all(b"\n\n")?;
+            }
+            writeln!(writer, "{} more struct{}:", brief.len(), plural(brief.len() as u64))?;
+            write_chunked(
+                writer,
+                brief,
+                self.jobs,
+                |_, chunk, output| {
+                    for layout in chunk {
+                        output.push_str("  ");
+                        output.push_str(&self.header(layout));
+                        output.push('\n');
+                    }
+                },
+                |(), _| {},
+            )?;
+        }
+        writer.write_all(self.totals(layouts).as_bytes())
+    }
+
+    /// Like `format`, with the binaries containing each layout listed under its header.
+    pub fn format_batch(&self, structs: &[BatchStruct]) -> String {
         let mut output = String::new();
 
-        for (i, layout) in layouts.iter().enumerate() {
+        for (i, entry) in structs.iter().enumerate() {
             if i > 0 {
                 output.push_str("\n\n");
             }
-            output.push_str(&self.format_struct(layout));
+            output.push_str(&self.format_struct(&entry.layout, Some(&entry.binaries)));
         }
 
         output
     }
 
-    fn format_struct(&self, layout: &StructLayout) -> String {
-        let mut output = String::new();
-
-        let header = format!(
+    fn header(&self, layout: &StructLayout) -> String {
+        format!(
             "struct {} ({} bytes, {:.1}% padding, {} cache line{})",
             layout.name,
             layout.size,
             layout.metrics.padding_percentage,
             layout.metrics.cache_lines_spanned,
-            if layout.metrics.cache_lines_spanned == 1 { "" } else { "s" }
+            plural(layout.metrics.cache_lines_spanned as u64)
+        )
+    }
+
+    /// One line of totals over `layouts`, preceded by a blank line.
+    fn totals(&self, layouts: &[StructLayout]) -> String {
+        let size: u64 = layouts.iter().map(|l| l.size).fold(0, u64::saturating_add);
+        let padding: u64 =
+            layouts.iter().map(|l| l.metrics.padding_bytes).fold(0, u64::saturating_add);
+        let padded = layouts.iter().filter(|l| l.metrics.padding_bytes > 0).count();
+        let multi_line = layouts.iter().filter(|l| l.metrics.cache_lines_spanned > 1).count();
+        let percent = if size > 0 { padding as f64 / size as f64 * 100.0 } else { 0.0 };
+        let totals = format!(
+            "\nTotals: {} struct{}, {} bytes, {} padding bytes ({:.1}%), {} with padding, {} spanning more than one cache line",
+            layouts.len(),
+            plural(layouts.len() as u64),
+            size,
+            padding,
+            percent,
+            padded,
+            multi_line
         );
+        if self.no_color { totals } else { totals.bold().to_string() }
+    }
+
+    fn format_struct(&self, layout: &StructLayout, binaries: Option<&[String]>) -> String {
+        let mut output = String::new();
+
+        let header = self.header(layout);
 
         if self.no_color {
             output.push_str(&header);
@@ -47,6 +143,29 @@ impl TableFormatter {
         if let Some(ref loc) = layout.source_location {
             output.push_str(&format!("  defined at {}:{}\n", loc.file, loc.line));
         }
+        for t in &layout.metrics.targets {
+            output.push_str(&format!(
+                "  on {}: {} cache line{} of {} bytes, {:.1}% density, {} member{} split across lines, {} false sharing pair{} within {} bytes\n",
+                t.target,
+                t.cache_lines_spanned,
+                plural(t.cache_lines_spanned as u64),
+                t.cache_line_size,
+                t.cache_line_density,
+                t.split_members,
+                plural(t.split_members as u64),
+                t.false_sharing_pairs,
+                plural(t.false_sharing_pairs),
+                t.prefetch_size.max(t.cache_line_size)
+            ));
+        }
+        if let Some(binaries) = binaries {
+            output.push_str(&format!(
+                "  found in {} binar{}: {}\n",
+                binaries.len(),
+                if binaries.len() == 1 { "y" } else { "ies" },
+                binaries.join(", ")
+            ));
+        }
         output.push('\n');
 
         let mut table = Table::new();
@@ -193,7 +312,7 @@ impl TableFormatter {
                 }
             }
 
-            if !fs.warnings.is_empty() {
+            if !fs.contended_lines.is_empty() || !fs.warnings.is_empty() {
                 let header = "\nPotential False Sharing:";
                 if self.no_color {
                     output.push_str(header);
@@ -202,6 +321,21 @@ impl TableFormatter {
                 }
                 output.push('\n');
 
+                for line in &fs.contended_lines {
+                    let msg = format!(
+                        "  - cache line {} is shared by {} atomics: {}",
+                        line.cache_line,
+                        line.members.len(),
+                        line.members.join(", ")
+                    );
+                    if self.no_color {
+                        output.push_str(&msg);
+                    } else {
+                        output.push_str(&msg.yellow().to_string());
+                    }
+                    output.push('\n');
+                }
+
                 for w in &fs.warnings {
                     let gap_desc = match w.gap_bytes.cmp(&0) {
                         std::cmp::Ordering::Less => format!("{} bytes overlap", -w.gap_bytes),
@@ -227,6 +361,61 @@ impl TableFormatter {
             }
         }
 
+        if let Some(ref heat) = layout.metrics.access_heat {
+            let header = "\nAccess Heat (sampled):";
+            if self.no_color {
+                output.push_str(header);
+            } else {
+                output.push_str(&header.cyan().bold().to_string());
+            }
+            output.push('\n');
+
+            for line in &heat.cache_lines {
+                output
+                    .push_str(&format!("  - cache line {}: {:.1}%", line.cache_line, line.percent));
+                if !line.members.is_empty() {
+                    output.push_str(&format!(" ({})", line.members.join(", ")));
+                }
+                output.push('\n');
+            }
+            if heat.unattributed_weight > 0.0 && heat.total_weight > 0.0 {
+                output.push_str(&format!(
+                    "  - outside any member: {:.1}%\n",
+                    heat.unattributed_weight / heat.total_weight * 100.0
+                ));
+            }
+        }
+
+        if let Some(ref nested) = layout.metrics.nested {
+            let header = "\nNested Padding (embedded structs flattened):";
+            if self.no_color {
+                output.push_str(header);
+            } else {
+                output.push_str(&header.cyan().bold().to_string());
+            }
+            output.push('\n');
+
+            output.push_str(&format!(
+                "  {} useful bytes, {} padding bytes ({:.1}%), cache density: {:.1}%{}\n",
+                nested.useful_size,
+                nested.padding_bytes,
+                nested.padding_percentage,
+                nested.cache_line_density,
+                if nested.partial { " (partial)" } else { "" }
+            ));
+            for c in &nested.contributors {
+                let location = if c.paths.is_empty() {
+                    "own padding".to_string()
+                } else {
+                    format!("{} × {}", c.instances, c.paths.join(", "))
+                };
+                output.push_str(&format!(
+                    "  - {}: {} bytes ({:.1}%), {}\n",
+                    c.type_name, c.padding_bytes, c.percent, location
+                ));
+            }
+        }
+
         output
     }
 }
@@ -246,12 +435,17 @@ enum TableEntry<'a> {
     },
 }
 
+fn plural(count: u64) -> &'static str {
+    if count == 1 { "" } else { "s" }
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
     use crate::types::{
-        CacheLineSpanningWarning, FalseSharingAnalysis, FalseSharingWarning, LayoutMetrics,
-        MemberLayout, PaddingHole, StructLayout,
+        AccessHeat, CacheLineHeat, CacheLineSpanningWarning, ContendedCacheLine,
+        FalseSharingAnalysis, FalseSharingWarning, LayoutMetrics, MemberLayout, NestedPadding,
+        PaddingContributor, PaddingHole, StructLayout,
     };
 
     fn sample_layout() -> StructLayout {
@@ -273,6 +467,12 @@ mod tests {
                 after_member: Some("a".to_string()),
             }],
             false_sharing: Some(FalseSharingAnalysis {
+                contended_lines: vec![ContendedCacheLine {
+                    cache_line: 0,
+                    members: vec!["a".to_string(), "b".to_string()],
+                    new_pairs: 1,
+                }],
+                pair_count: 1,
                 warnings: vec![FalseSharingWarning {
                     member_a: "a".to_string(),
                     member_b: "b".to_string(),
@@ -299,10 +499,66 @@ mod tests {
                 }],
             }),
             partial: false,
+            access_heat: None,
+            nested: None,
+            targets: Vec::new(),
         };
         layout
     }
 
+    #[test]
+    fn table_formatter_lists_access_heat() {
+        let mut layout = sample_layout();
+        layout.metrics.access_heat = Some(AccessHeat {
+            total_weight: 10.0,
+            unattributed_weight: 1.0,
+            members: Vec::new(),
+            cache_lines: vec![CacheLineHeat {
+                cache_line: 0,
+                weight: 9.0,
+                percent: 90.0,
+                members: vec!["b".to_string(), "a".to_string()],
+            }],
+        });
+        let out = TableFormatter::new(true, 64).format(&[layout]);
+        assert!(out.contains("Access Heat"));
+        assert!(out.contains("cache line 0: 90.0% (b, a)"));
+        assert!(out.contains("outside any member: 10.0%"));
+    }
+
+    #[test]
+    fn table_formatter_lists_nested_padding() {
+        let mut layout = sample_layout();
+        layout.metrics.nested = Some(NestedPadding {
+            useful_size: 2,
+            padding_bytes: 14,
+            padding_percentage: 87.5,
+            cache_line_density: 3.125,
+            contributors: vec![
+                PaddingContributor {
+                    type_name: "Foo".to_string(),
+                    instances: 1,
+                    padding_bytes: 11,
+                    percent: 78.6,
+                    paths: Vec::new(),
+                },
+                PaddingContributor {
+                    type_name: "Leg".to_string(),
+                    instances: 3,
+                    padding_bytes: 3,
+                    percent: 21.4,
+                    paths: vec!["legs[]".to_string()],
+                },
+            ],
+            partial: false,
+        });
+        let out = TableFormatter::new(true, 64).format(&[layout]);
+        assert!(out.contains("Nested Padding"));
+        assert!(out.contains("2 useful bytes, 14 padding bytes (87.5%), cache density: 3.1%"));
+        assert!(out.contains("- Foo: 11 bytes (78.6%), own padding"));
+        assert!(out.contains("- Leg: 3 bytes (21.4%), 3 × legs[]"));
+    }
+
     #[test]
     fn table_formatter_no_color_includes_padding_and_warnings() {
         let formatter = TableFormatter::new(true, 64);
@@ -310,14 +566,49 @@ mod tests {
         assert!(out.contains("struct Foo"));
         assert!(out.contains("PAD"));
         assert!(out.contains("Potential False Sharing"));
+        assert!(out.contains("cache line 0 is shared by 2 atomics: a, b"));
         assert!(out.contains("Cache Line Spanning"));
         assert!(out.contains("Atomic members"));
     }
 
+    #[test]
+    fn table_formatter_batch_lists_binaries() {
+        let formatter = TableFormatter::new(true, 64);
+        let entry = BatchStruct {
+            layout: sample_layout(),
+            binaries: vec!["liba.so".to_string(), "app".to_string()],
+        };
+        let out = formatter.format_batch(&[entry]);
+        assert!(out.contains("struct Foo"));
+        assert!(out.contains("found in 2 binaries: liba.so, app"));
+    }
+
     #[test]
     fn table_formatter_color_path_runs() {
         let formatter = TableFormatter::new(false, 64);
         let out = formatter.format(&[sample_layout()]);
         assert!(out.contains("struct Foo"));
     }
+
+    #[test]
+    fn table_formatter_detail_limits_member_tables_and_totals_everything() {
+        let layouts: Vec<StructLayout> = (0..600)
+            .map(|i| {
+                let mut layout = sample_layout();
+                layout.name = format!("S{i}");
+                layout
+            })
+            .collect();
+        let serial = TableFormatter::new(true, 64).format(&layouts);
+        assert_eq!(TableFormatter::new(true, 64).with_jobs(4).format(&layouts), serial);
+
+        let formatter = TableFormatter::new(true, 64).with_detail(2);
+        let out = formatter.format(&layouts);
+        assert_eq!(out, formatter.with_jobs(3).format(&layouts));
+        assert_eq!(out.matches("Offset").count(), 2);
+        assert!(out.contains("598 more structs:\n  struct S2 ("));
+        let totals = out.lines().last().unwrap();
+        assert!(totals.starts_with("Totals: 600 structs,"), "{totals}");
+        assert!(totals.contains("600 with padding"), "{totals}");
+    }
 }
@@ -0,0 +1,117 @@
+//! Output formatters for `--timings`.
+
+use super::footprint::format_bytes;
+use crate::timings::TimingsReport;
+use comfy_table::{Cell, CellAlignment, Table, presets::UTF8_FULL_CONDENSED};
+use serde::Serialize;
+
+pub struct TimingsTableFormatter;
+
+impl TimingsTableFormatter {
+    pub fn new() -> Self {
+        Self
+    }
+
+    pub fn format(&self, report: &TimingsReport) -> String {
+        let mut table = Table::new();
+        table.load_preset(UTF8_FULL_CONDENSED);
+        table.set_header(vec!["Stage", "Calls", "Wall", "Peak RSS"]);
+        let peak = |bytes: Option<u64>| bytes.map_or_else(|| "-".to_string(), format_bytes);
+        for stage in &report.stages {
+            table.add_row(vec![
+                Cell::new(stage.name),
+                Cell::new(stage.calls).set_alignment(CellAlignment::Right),
+                Cell::new(format_ms(stage.wall_ms)).set_alignment(CellAlignment::Right),
+                Cell::new(peak(stage.peak_rss_bytes)).set_alignment(CellAlignment::Right),
+            ]);
+        }
+        table.add_row(vec![
+            Cell::new("total"),
+            Cell::new(""),
+            Cell::new(format_ms(report.total_ms)).set_alignment(CellAlignment::Right),
+            Cell::new(peak(report.peak_rss_bytes)).set_alignment(CellAlignment::Right),
+        ]);
+
+        let e = &report.extract;
+        let mut output = table.to_string();
+        output.push_str(&format!(
+            "\n\nUnits: {} ({} reused from cache)\n\
+             DIEs visited: {}\n\
+             Type lookups: {} ({:.1}% cache hits), resolving took {}\n\
+             Structs: {} extracted, {} after dedup (dedup took {})\n\
+             Decompressed: {}",
+            e.units,
+            e.units_reused,
+            e.dies_visited,
+            e.type_lookups,
+            e.type_cache_hit_rate * 100.0,
+            format_ms(e.type_resolve_ms),
+            e.structs_found,
+            e.structs_unique,
+            format_ms(e.dedup_ms),
+            format_bytes(report.decompressed_bytes),
+        ));
+        output
+    }
+}
+
+impl Default for TimingsTableFormatter {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+fn format_ms(ms: f64) -> String {
+    if ms >= 1000.0 { format!("{:.2} s", ms / 1000.0) } else { format!("{:.1} ms", ms) }
+}
+
+#[derive(Serialize)]
+struct TimingsJsonOutput<'a> {
+    version: &'static str,
+    #[serde(flatten)]
+    report: &'a TimingsReport,
+}
+
+pub struct TimingsJsonFormatter {
+    pretty: bool,
+}
+
+impl TimingsJsonFormatter {
+    pub fn new(pretty: bool) -> Self {
+        Self { pretty }
+    }
+
+    pub fn format(&self, report: &TimingsReport) -> String {
+        let output = TimingsJsonOutput { version: env!("CARGO_PKG_VERSION"), report };
+        if self.pretty {
+            serde_json::to_string_pretty(&output)
+                .unwrap_or_else(|e| format!("{{\"error\": \"{}\"}}", e))
+        } else {
+            serde_json::to_string(&output).unwrap_or_else(|e| format!("{{\"error\": \"{}\"}}", e))
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::timings::Timings;
+
+    #[test]
+    fn timings_formatters_list_stages_and_counters() {
+        let timings = Timings::new();
+        timings.stage("extract", || ());
+        timings.add_decompressed(2048);
+        let report = timings.report();
+
+        let table = TimingsTableFormatter::new().format(&report);
+        assert!(table.contains("extract"));
+        assert!(table.contains("Decompressed: 2.0 KiB"));
+
+        let json = TimingsJsonFormatter::new(false).format(&report);
+        let parsed: serde_json::Value = serde_json::from_str(&json).expect("valid JSON");
+        assert_eq!(parsed["stages"][0]["name"], "extract");
+        assert_eq!(parsed["decompressed_bytes"], 2048);
+        assert!(parsed["extract"]["type_cache_hit_rate"].is_number());
+    }
+}
@@ -0,0 +1,194 @@
+//! Memory access profiles that attribute sampled data accesses to struct offsets.
+//!
+//! Two text formats are accepted, and may be mixed in one file:
+//!
+//! - CSV lines `struct,offset,samples`, e.g. `Connection,24,1520`. An optional header
+//!   line is skipped, and offsets may be written in hex (`0x18`).
+//! - The data-type profile printed by `perf report --stdio -s type,typeoff` (from
+//!   `perf mem record`), i.e. lines like `12.50%  struct Connection +24 (state)`.
+//!   The overhead column is used as the weight. Lines without a type offset, such as
+//!   `(unknown)` entries, are ignored.
+//!
+//! Weights are relative: only their proportions within one struct matter. Raw sampled
+//! addresses cannot be mapped without knowing where each object was allocated, so the
+//! profile has to be resolved to type offsets first, which is what perf's data-type
+//! profiling does.
+
+use crate::error::{Error, Result};
+use std::collections::{BTreeMap, HashMap};
+use std::path::Path;
+
+/// Accesses sampled at one offset of a struct.
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct AccessSample {
+    pub offset: u64,
+    pub weight: f64,
+}
+
+/// Sampled accesses grouped by struct name.
+#[derive(Debug, Clone, Default)]
+pub struct AccessProfile {
+    structs: HashMap<String, Vec<AccessSample>>,
+}
+
+impl AccessProfile {
+    pub fn load(path: &Path) -> Result<Self> {
+        let text = std::fs::read_to_string(path)?;
+        Self::parse(&text)
+    }
+
+    pub fn parse(text: &str) -> Result<Self> {
+        let mut by_struct: HashMap<String, BTreeMap<u64, f64>> = HashMap::new();
+        let mut seen_data = false;
+
+        for (index, line) in text.lines().enumerate() {
+            let line = line.trim();
+            if line.is_empty() || line.starts_with('#') {
+                continue;
+            }
+
+            let parsed = if line.contains(',') {
+                match parse_csv_line(line) {
+                    Some(sample) => Some(sample),
+                    // Tolerate one header line before the data.
+                    None if !seen_data => None,
+                    None => {
+                        return Err(Error::Profile(format!(
+                            "line {}: expected `struct,offset,samples`, got `{}`",
+                            index + 1,
+                            line
+                        )));
+                    }
+                }
+            } else {
+                parse_perf_line(line)
+            };
+            seen_data = true;
+
+            if let Some((name, offset, weight)) = parsed {
+                *by_struct.entry(name.to_string()).or_default().entry(offset).or_default() +=
+                    weight;
+            }
+        }
+
+        if by_struct.is_empty() {
+            return Err(Error::Profile("no samples found".to_string()));
+        }
+
+        let structs = by_struct
+            .into_iter()
+            .map(|(name, offsets)| {
+                let samples = offsets
+                    .into_iter()
+                    .map(|(offset, weight)| AccessSample { offset, weight })
+                    .collect();
+                (name, samples)
+            })
+            .collect();
+        Ok(Self { structs })
+    }
+
+    /// Samples for `struct_name`, ordered by offset, or `None` if it was never sampled.
+    pub fn samples(&self, struct_name: &str) -> Option<&[AccessSample]> {
+        self.structs.get(struct_name).map(Vec::as_slice)
+    }
+}
+
+/// `name,offset,weight`. The name is everything before the last two commas, so template
+/// arguments like `Pair<int, char>` survive.
+fn parse_csv_line(line: &str) -> Option<(&str, u64, f64)> {
+    let mut fields = line.rsplitn(3, ',');
+    let weight = parse_weight(fields.next()?.trim())?;
+    let offset = parse_offset(fields.next()?.trim())?;
+    let name = fields.next()?.trim();
+    if name.is_empty() {
+        return None;
+    }
+    Some((name, offset, weight))
+}
+
+/// `<overhead>  <type> +<offset> (<field>)`, as printed for the `typeoff` sort key.
+fn parse_perf_line(line: &str) -> Option<(&str, u64, f64)> {
+    let (weight, rest) = line.split_once(char::is_whitespace)?;
+    let weight = parse_weight(weight)?;
+    let rest = rest.trim_start();
+
+    let (type_name, offset) = rest.rsplit_once(" +")?;
+    let offset = offset.split_whitespace().next()?;
+    let offset = parse_offset(offset)?;
+
+    let type_name = ["struct ", "class ", "union "]
+        .iter()
+        .find_map(|prefix| type_name.strip_prefix(prefix))
+        .unwrap_or(type_name)
+        .trim();
+    // perf's placeholders for accesses it could not type: `(unknown)`, `(stack operation)`.
+    if type_name.is_empty() || type_name.starts_with('(') {
+        return None;
+    }
+    Some((type_name, offset, weight))
+}
+
+fn parse_weight(s: &str) -> Option<f64> {
+    let weight: f64 = s.strip_suffix('%').unwrap_or(s).parse().ok()?;
+    (weight.is_finite() && weight >= 0.0).then_some(weight)
+}
+
+fn parse_offset(s: &str) -> Option<u64> {
+    match s.strip_prefix("0x").or_else(|| s.strip_prefix("0X")) {
+        Some(hex) => u64::from_str_radix(hex, 16).ok(),
+        None => s.parse().ok(),
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn parses_csv_with_header_and_merges_offsets() {
+        let profile = AccessProfile::parse(
+            "struct,offset,samples\nConn,0,10\nConn,0x18,5\n# comment\nConn,0,2\n",
+        )
+        .unwrap();
+        assert_eq!(
+            profile.samples("Conn").unwrap(),
+            [AccessSample { offset: 0, weight: 12.0 }, AccessSample { offset: 24, weight: 5.0 }]
+        );
+        assert!(profile.samples("Other").is_none());
+    }
+
+    #[test]
+    fn csv_names_may_contain_commas() {
+        let profile = AccessProfile::parse("Pair<int, char>,4,3").unwrap();
+        assert_eq!(profile.samples("Pair<int, char>").unwrap()[0].offset, 4);
+    }
+
+    #[test]
+    fn parses_perf_typeoff_report() {
+        let report = "\
+# Overhead  Data Type Offset
+# ........  ..................
+#
+    31.25%  struct task_struct +2856 (se.avg.last_update_time)
+     2.00%  struct rq +8 (lock)
+     1.50%  (unknown) +0 (no field)
+     0.75%  (stack operation)
+";
+        let profile = AccessProfile::parse(report).unwrap();
+        assert_eq!(
+            profile.samples("task_struct").unwrap(),
+            [AccessSample { offset: 2856, weight: 31.25 }]
+        );
+        assert_eq!(profile.samples("rq").unwrap()[0].weight, 2.0);
+        assert!(profile.samples("(unknown)").is_none());
+    }
+
+    #[test]
+    fn rejects_malformed_csv_and_empty_profiles() {
+        let err = AccessProfile::parse("Conn,0,10\nConn,zero,1\n").unwrap_err();
+        assert!(err.to_string().contains("line 2"), "{err}");
+        assert!(AccessProfile::parse("# nothing\n").is_err());
+        assert!(AccessProfile::parse("Conn,0,1\nConn,0,-1").is_err());
+    }
+}
@@ -0,0 +1,490 @@
+//! `serve`: keeps a binary's layouts indexed and answers newline-delimited JSON requests
+//! over a socket, re-indexing the binary as it is rebuilt.
+
+use crate::{
+    CheckJsonOutput, CheckSummary, ServeConfig, SuggestConfig, check_violations, extract_stats,
+    load_layout_dwarf, parse_field_groups, read_config, sort_layouts, suggest_layout, timed,
+};
+use anyhow::{Context, Result, anyhow, bail};
+use clap::ValueEnum;
+use layout_audit::{
+    BinaryData, CacheKey, DwarfContext, JsonFormatter, LayoutCache, LayoutIndex, LayoutQuery,
+    OptimizedLayout, OutputFormat, SortField, StructLayout, SuggestJsonFormatter, SuggestStrategy,
+    UnitLayouts, analyze_false_sharing, analyze_layout,
+};
+use std::io::{BufRead, Write};
+use std::net::{TcpListener, TcpStream};
+use std::path::{Path, PathBuf};
+use std::sync::atomic::{AtomicBool, AtomicU64, AtomicUsize, Ordering};
+use std::sync::{Arc, RwLock};
+use std::time::SystemTime;
+
+/// Connections answered at once; further clients are turned away until one disconnects.
+const MAX_CONNECTIONS: usize = 16;
+
+/// One request line to `serve`. Each gets one line of JSON back: `{"ok":true,"result":...}`
+/// with the document the matching `-o json` command prints, or `{"ok":false,"error":"..."}`.
+#[derive(serde::Deserialize)]
+#[serde(tag = "command", rename_all = "snake_case")]
+enum ServeRequest {
+    Inspect {
+        #[serde(flatten)]
+        query: LayoutQuery,
+        sort_by: Option<String>,
+        top: Option<usize>,
+        min_padding: Option<u64>,
+        #[serde(default)]
+        warn_false_sharing: bool,
+    },
+    Suggest {
+        #[serde(flatten)]
+        query: LayoutQuery,
+        strategy: Option<String>,
+        /// `STRUCT:FIELD,FIELD` specs, as for `--keep-together`.
+        #[serde(default)]
+        keep_together: Vec<String>,
+        /// `STRUCT:FIELD,FIELD` specs, as for `--hot`.
+        #[serde(default)]
+        hot: Vec<String>,
+        elements: Option<u64>,
+        max_align: Option<u64>,
+        min_savings: Option<u64>,
+        #[serde(default)]
+        sort_by_savings: bool,
+    },
+    /// Check against a budget config file, resolved against the server's directory, which
+    /// it must not leave.
+    Check {
+        config: PathBuf,
+    },
+    /// The served binary, how many structs it has and how often it was indexed.
+    Status,
+    Shutdown,
+}
+
+/// Shared by the connection handlers and the watcher thread.
+struct ServeState {
+    index: RwLock<Arc<LayoutIndex>>,
+    /// Number of times the binary was indexed.
+    generation: AtomicU64,
+    stop: AtomicBool,
+    /// Connections being answered.
+    connections: AtomicUsize,
+    /// The directory the server was started in, canonicalized; `check` configs must lie
+    /// under it.
+    root: PathBuf,
+}
+
+impl ServeState {
+    fn new(index: LayoutIndex) -> Result<Self> {
+        let root = std::env::current_dir()
+            .and_then(|dir| dir.canonicalize())
+            .context("Failed to resolve the current directory")?;
+        Ok(Self {
+            index: RwLock::new(Arc::new(index)),
+            generation: AtomicU64::new(1),
+            stop: AtomicBool::new(false),
+            connections: AtomicUsize::new(0),
+            root,
+        })
+    }
+
+    fn index(&self) -> Arc<LayoutIndex> {
+        self.index.read().unwrap_or_else(|e| e.into_inner()).clone()
+    }
+}
+
+/// Length and modification time, compared between polls to notice a rebuild.
+type FileStamp = Option<(u64, SystemTime)>;
+
+fn file_stamp(path: &Path) -> FileStamp {
+    let metadata = std::fs::metadata(path).ok()?;
+    Some((metadata.len(), metadata.modified().ok()?))
+}
+
+pub(crate) fn run_serve(config: &ServeConfig<'_>) -> Result<()> {
+    let stamp = file_stamp(config.binary_path);
+    let mut units = None;
+    let index = load_serve_index(config, &mut units)?;
+
+    let listener = TcpListener::bind(config.listen)
+        .with_context(|| format!("Failed to listen on {}", config.listen))?;
+    let addr = listener.local_addr()?;
+    println!("Listening on {} ({} structs)", addr, index.len());
+    std::io::stdout().flush()?;
+
+    let state = &ServeState::new(index)?;
+    std::thread::scope(|scope| {
+        scope.spawn(move || watch_binary(config, state, units, stamp));
+        for stream in listener.incoming() {
+            if state.stop.load(Ordering::Relaxed) {
+                break;
+            }
+            match stream {
+                Ok(mut stream) => {
+                    // Only this thread adds connections, so the count cannot overshoot.
+                    if state.connections.load(Ordering::Relaxed) >= MAX_CONNECTIONS {
+                        let _ = stream
+                            .write_all(b"{\"ok\":false,\"error\":\"Too many connections\"}\n");
+                        continue;
+                    }
+                    state.connections.fetch_add(1, Ordering::Relaxed);
+                    scope.spawn(move || {
+                        serve_connection(stream, config, state, addr);
+                        state.connections.fetch_sub(1, Ordering::Relaxed);
+                    });
+                }
+                Err(e) => eprintln!("Warning: Failed to accept connection: {}", e),
+            }
+        }
+    });
+    Ok(())
+}
+
+/// Extract and analyze every layout of the served binary. `units` carries the units of
+/// the previous extraction (loaded from `--cache-dir` the first time), so a rebuild only
+/// re-extracts the units that changed.
+fn load_serve_index(
+    config: &ServeConfig<'_>,
+    units: &mut Option<UnitLayouts>,
+) -> Result<LayoutIndex> {
+    let binary = timed("mmap", || BinaryData::load(config.binary_path))
+        .with_context(|| format!("Failed to load binary: {}", config.binary_path.display()))?;
+    let cache = config.cache_dir.map(|dir| {
+        (LayoutCache::new(dir), CacheKey::for_units(&binary, None, config.include_go_runtime))
+    });
+    let current = units.get_or_insert_with(|| {
+        cache
+            .as_ref()
+            .map(|(cache, key)| timed("cache", || cache.load_units(key)))
+            .unwrap_or_default()
+    });
+
+    let loaded = load_layout_dwarf(&binary, config.jobs, "Failed to load DWARF debug info")?;
+    let dwarf = DwarfContext::new(&loaded)
+        .with_jobs(config.jobs)
+        .with_unit_cache(Some(current))
+        .with_stats(extract_stats());
+    let mut layouts = timed("extract", || dwarf.find_structs(None, config.include_go_runtime))
+        .context("Failed to parse struct layouts")?;
+    if let Some((cache, key)) = &cache
+        && let Err(e) = timed("cache", || cache.store_units(key, current))
+    {
+        eprintln!("Warning: Failed to write layout cache to {}: {}", cache.dir().display(), e);
+    }
+    *current = std::mem::take(current).carry_over();
+
+    timed("analyze", || {
+        for layout in &mut layouts {
+            analyze_layout(layout, config.cache_line_size);
+        }
+    });
+    Ok(timed("index", || LayoutIndex::new(layouts)))
+}
+
+/// Poll the binary and swap in a new index after it changes. A change is picked up once the
+/// binary has looked the same for two polls in a row, so a half-written file is not read.
+fn watch_binary(
+    config: &ServeConfig<'_>,
+    state: &ServeState,
+    mut units: Option<UnitLayouts>,
+    mut indexed: FileStamp,
+) {
+    let mut pending = indexed;
+    while !state.stop.load(Ordering::Relaxed) {
+        std::thread::sleep(config.poll_interval);
+        let stamp = file_stamp(config.binary_path);
+        if stamp == indexed || stamp != pending {
+            pending = stamp;
+            continue;
+        }
+
+        indexed = stamp;
+        match load_serve_index(config, &mut units) {
+            Ok(index) => {
+                eprintln!("Re-indexed {} ({} structs)", config.binary_path.display(), index.len());
+                *state.index.write().unwrap_or_else(|e| e.into_inner()) = Arc::new(index);
+                state.generation.fetch_add(1, Ordering::Relaxed);
+            }
+            // Keep answering from the previous index; the next change is tried again.
+            Err(e) => {
+                eprintln!("Warning: Failed to re-index {}: {:#}", config.binary_path.display(), e)
+            }
+        }
+    }
+}
+
+/// Answer newline-delimited requests on one connection until the client disconnects or
+/// the server shuts down.
+fn serve_connection(
+    stream: TcpStream,
+    config: &ServeConfig<'_>,
+    state: &ServeState,
+    addr: std::net::SocketAddr,
+) {
+    // Idle connections wake up regularly to notice a shutdown.
+    let _ = stream.set_read_timeout(Some(config.poll_interval));
+    let Ok(mut writer) = stream.try_clone() else { return };
+    let mut reader = std::io::BufReader::new(stream);
+    let mut line = Vec::new();
+    loop {
+        match reader.read_until(b'\n', &mut line) {
+            Ok(0) => return,
+            Ok(_) => {}
+            // Bytes read before the timeout stay in `line`.
+            Err(e)
+                if matches!(
+                    e.kind(),
+                    std::io::ErrorKind::WouldBlock | std::io::ErrorKind::TimedOut
+                ) =>
+            {
+                if state.stop.load(Ordering::Relaxed) {
+                    return;
+                }
+                continue;
+            }
+            Err(_) => return,
+        }
+        let request = String::from_utf8_lossy(&line).trim().to_string();
+        line.clear();
+        if request.is_empty() {
+            continue;
+        }
+
+        let (result, shutdown) = match serde_json::from_str::<ServeRequest>(&request) {
+            Ok(ServeRequest::Shutdown) => (Ok("null".to_string()), true),
+            Ok(request) => (handle_serve_request(request, config, state), false),
+            Err(e) => (Err(anyhow!("Invalid request: {}", e)), false),
+        };
+        let response = match result {
+            Ok(json) => format!("{{\"ok\":true,\"result\":{}}}\n", json),
+            Err(e) => {
+                let message = serde_json::Value::String(format!("{:#}", e));
+                format!("{{\"ok\":false,\"error\":{}}}\n", message)
+            }
+        };
+        if writer.write_all(response.as_bytes()).is_err() {
+            return;
+        }
+        if shutdown {
+            state.stop.store(true, Ordering::Relaxed);
+            // Wake the accept loop so it sees the flag.
+            let _ = TcpStream::connect(addr);
+            return;
+        }
+    }
+}
+
+/// Answer one request from the current index, as compact JSON.
+fn handle_serve_request(
+    request: ServeRequest,
+    config: &ServeConfig<'_>,
+    state: &ServeState,
+) -> Result<String> {
+    let index = state.index();
+    match request {
+        ServeRequest::Inspect { query, sort_by, top, min_padding, warn_false_sharing } => {
+            let sort_by =
+                parse_serve_value(sort_by.as_deref(), "sort_by")?.unwrap_or(SortField::Name);
+            let mut layouts: Vec<StructLayout> = index.query(&query).into_iter().cloned().collect();
+            if let Some(min) = min_padding {
+                layouts.retain(|l| l.metrics.padding_bytes >= min);
+            }
+            if warn_false_sharing {
+                for layout in &mut layouts {
+                    let analysis = analyze_false_sharing(layout, config.cache_line_size);
+                    layout.metrics.false_sharing = Some(analysis);
+                }
+            }
+            sort_layouts(&mut layouts, sort_by);
+            if let Some(n) = top {
+                layouts.truncate(n);
+            }
+            Ok(JsonFormatter::new(false).format(&layouts))
+        }
+        ServeRequest::Suggest {
+            query,
+            strategy,
+            keep_together,
+            hot,
+            elements,
+            max_align,
+            min_savings,
+            sort_by_savings,
+        } => {
+            let strategy = parse_serve_value(strategy.as_deref(), "strategy")?
+                .unwrap_or(SuggestStrategy::Padding);
+            let keep_together = parse_field_groups(
+                &keep_together,
+                "keep-together",
+                SuggestStrategy::CacheLine,
+                strategy,
+            )?;
+            let hot = parse_field_groups(&hot, "hot", SuggestStrategy::Split, strategy)?;
+            if max_align == Some(0) || elements == Some(0) {
+                bail!("max_align and elements must be greater than 0");
+            }
+            let suggest = SuggestConfig {
+                binary_path: config.binary_path,
+                filter: query.filter.as_deref(),
+                output_format: OutputFormat::Json,
+                min_savings,
+                cache_line_size: config.cache_line_size,
+                pretty: false,
+                max_align: max_align.unwrap_or(8),
+                sort_by_savings,
+                strategy,
+                keep_together: &keep_together,
+                hot: &hot,
+                elements: elements.unwrap_or(1024),
+                profile: None,
+                no_color: true,
+                include_go_runtime: config.include_go_runtime,
+                jobs: config.jobs,
+                cache_dir: None,
+                targets: &[],
+            };
+            let mut suggestions: Vec<OptimizedLayout> =
+                index.query(&query).into_iter().map(|l| suggest_layout(l, &suggest)).collect();
+            if let Some(min) = min_savings {
+                suggestions.retain(|s| s.savings_bytes >= min);
+            }
+            if sort_by_savings {
+                suggestions.sort_by(|a, b| b.savings_bytes.cmp(&a.savings_bytes));
+            }
+            Ok(SuggestJsonFormatter::new(false).format(&suggestions))
+        }
+        ServeRequest::Check { config: config_path } => {
+            let compiled =
+                read_config(&serve_config_path(&state.root, &config_path)?)?.compile()?;
+            let violations = check_violations(
+                &compiled,
+                index.layouts(),
+                config.cache_line_size,
+                config.cache_line_size,
+            );
+            let output = CheckJsonOutput {
+                version: env!("CARGO_PKG_VERSION"),
+                violations: &violations,
+                summary: CheckSummary { total_violations: violations.len() },
+            };
+            Ok(serde_json::to_string(&output)?)
+        }
+        ServeRequest::Status => Ok(serde_json::json!({
+            "binary": config.binary_path.display().to_string(),
+            "structs": index.len(),
+            "generation": state.generation.load(Ordering::Relaxed),
+        })
+        .to_string()),
+        ServeRequest::Shutdown => unreachable!("handled by serve_connection"),
+    }
+}
+
+/// `path` resolved against `root`, refusing paths that lead outside it.
+fn serve_config_path(root: &Path, path: &Path) -> Result<PathBuf> {
+    let resolved = root
+        .join(path)
+        .canonicalize()
+        .with_context(|| format!("Config file not found: {}", path.display()))?;
+    if !resolved.starts_with(root) {
+        bail!("Config file {} is outside the server's directory", path.display());
+    }
+    Ok(resolved)
+}
+
+fn parse_serve_value<T: ValueEnum>(value: Option<&str>, field: &str) -> Result<Option<T>> {
+    value
+        .map(|v| T::from_str(v, true).map_err(|_| anyhow!("Invalid {} '{}'", field, v)))
+        .transpose()
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::tests::find_fixture_path;
+    use std::time::Duration;
+
+    #[test]
+    fn serve_reindexes_after_rebuild() {
+        let (Some(simple), Some(modified)) =
+            (find_fixture_path("test_simple"), find_fixture_path("test_modified"))
+        else {
+            return;
+        };
+        let dir = tempfile::tempdir().expect("tempdir");
+        let app = dir.path().join("app");
+        std::fs::copy(&simple, &app).unwrap();
+        let config = ServeConfig {
+            binary_path: &app,
+            listen: "127.0.0.1:0",
+            poll_interval: Duration::from_millis(10),
+            cache_line_size: 64,
+            include_go_runtime: false,
+            jobs: 2,
+            cache_dir: None,
+        };
+
+        let mut units = None;
+        let index = load_serve_index(&config, &mut units).expect("initial index");
+        let state = ServeState::new(index).expect("state");
+        let request = |json: &str| {
+            let request = serde_json::from_str(json).expect("request");
+            let result = handle_serve_request(request, &config, &state).expect("response");
+            serde_json::from_str::<serde_json::Value>(&result).unwrap()
+        };
+        let names = |result: serde_json::Value| -> Vec<String> {
+            let structs = result["structs"].as_array().unwrap();
+            structs.iter().map(|s| s["name"].as_str().unwrap().to_string()).collect()
+        };
+
+        let before = request(r#"{"command":"inspect","name":"NoPadding"}"#);
+        assert_eq!(names(before), ["NoPadding"]);
+        let suggest = request(r#"{"command":"suggest","filter":"InternalPadding"}"#);
+        assert!(suggest["suggestions"].as_array().is_some_and(|s| !s.is_empty()));
+        assert!(
+            serde_json::from_str::<ServeRequest>(r#"{"command":"inspect","sort_by":"nope"}"#)
+                .map_err(anyhow::Error::from)
+                .and_then(|r| handle_serve_request(r, &config, &state))
+                .is_err()
+        );
+
+        // Taken before the copy, which can otherwise land before the watcher starts.
+        let stamp = file_stamp(&app);
+        std::thread::scope(|scope| {
+            scope.spawn(|| watch_binary(&config, &state, units, stamp));
+            std::fs::copy(&modified, &app).unwrap();
+            let deadline = std::time::Instant::now() + Duration::from_secs(30);
+            while state.generation.load(Ordering::Relaxed) < 2
+                && std::time::Instant::now() < deadline
+            {
+                std::thread::sleep(Duration::from_millis(10));
+            }
+            state.stop.store(true, Ordering::Relaxed);
+        });
+        assert_eq!(state.generation.load(Ordering::Relaxed), 2, "binary was not re-indexed");
+
+        let binary = BinaryData::load(&app).expect("load");
+        let loaded = binary.load_dwarf_for_layouts(1).expect("dwarf");
+        let expected = DwarfContext::new(&loaded).find_structs(None, false).expect("extract");
+        assert_eq!(request(r#"{"command":"status"}"#)["structs"], expected.len());
+    }
+
+    #[test]
+    fn check_configs_must_stay_under_the_server_directory() {
+        let dir = tempfile::tempdir().expect("tempdir");
+        let root = dir.path().canonicalize().unwrap().join("served");
+        std::fs::create_dir_all(root.join("ci")).unwrap();
+        std::fs::write(root.join("ci/budgets.yaml"), "budgets: {}\n").unwrap();
+        let outside = root.parent().unwrap().join("outside.yaml");
+        std::fs::write(&outside, "budgets: {}\n").unwrap();
+
+        assert_eq!(
+            serve_config_path(&root, Path::new("ci/budgets.yaml")).unwrap(),
+            root.join("ci/budgets.yaml")
+        );
+        assert!(serve_config_path(&root, Path::new("ci/../ci/budgets.yaml")).is_ok());
+        for path in [outside.as_path(), Path::new("../outside.yaml"), Path::new("missing.yaml")] {
+            assert!(serve_config_path(&root, path).is_err(), "{}", path.display());
+        }
+    }
+}
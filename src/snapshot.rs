@@ -0,0 +1,461 @@
+//! Layout snapshots: the extracted struct layouts of a binary in a file that `diff` and
+//! `check` read in place of the binary itself.
+//!
+//! A snapshot is a few bytes per member instead of the whole binary with its debug info,
+//! so it is what CI keeps as a baseline. Records have a fixed size and strings are stored
+//! once, so a memory-mapped snapshot is read where it lies: `Snapshot::parse` checks the
+//! file without allocating, and the accessors index straight into the mapping.
+
+use crate::dwarf::is_go_internal_type;
+use crate::error::{Error, Result};
+use crate::hash::fnv1a_words;
+use crate::intern::Name;
+use crate::types::{MemberLayout, SourceLocation, StructLayout};
+use indexmap::IndexSet;
+
+/// File magic for snapshots.
+const MAGIC: &[u8; 8] = b"LAYAUDS\0";
+
+/// Bump whenever the layout below changes.
+const FORMAT_VERSION: u32 = 1;
+
+// Layout, all integers little-endian:
+//   header    magic | format version (u32) | reserved (u32) | struct count (u64)
+//             | member count (u64) | string count (u64) | string bytes (u64)
+//             | checksum of everything after the header (u64)
+//   structs   STRUCT_RECORD bytes each
+//   members   MEMBER_RECORD bytes each; the members of one struct are contiguous
+//   strings   STRING_RECORD bytes each: offset (u32) and length (u32) into the text
+//   text      UTF-8 string bytes
+// Strings are referenced by their index among the string records, so each distinct name
+// is converted to a `Name` once however many members carry it.
+const HEADER_LEN: usize = 56;
+
+// name (u32) | file (u32, NO_STRING without a location) | first member (u32)
+// | member count (u32) | size (u64) | alignment (u64) | line (u64) | flags (u32) | 0 (u32)
+const STRUCT_RECORD: usize = 48;
+
+// name (u32) | type name (u32) | offset (u64) | size (u64) | bit offset (u64)
+// | bit size (u64) | flags (u32) | 0 (u32)
+const MEMBER_RECORD: usize = 48;
+
+const STRING_RECORD: usize = 8;
+
+const NO_STRING: u32 = u32::MAX;
+
+const HAS_ALIGNMENT: u32 = 1;
+
+const HAS_OFFSET: u32 = 1;
+const HAS_SIZE: u32 = 1 << 1;
+const HAS_BIT_OFFSET: u32 = 1 << 2;
+const HAS_BIT_SIZE: u32 = 1 << 3;
+const IS_ATOMIC: u32 = 1 << 4;
+
+/// A validated view of a snapshot's bytes.
+#[derive(Clone, Copy)]
+pub struct Snapshot<'a> {
+    structs: &'a [u8],
+    members: &'a [u8],
+    strings: &'a [u8],
+    text: &'a str,
+}
+
+impl<'a> Snapshot<'a> {
+    /// Whether `data` starts like a snapshot, as opposed to an object file.
+    pub fn is_snapshot(data: &[u8]) -> bool {
+        data.starts_with(MAGIC)
+    }
+
+    /// Check that `data` is a complete snapshot of this format version and that every
+    /// record refers to members and strings that exist, so the accessors cannot fail.
+    pub fn parse(data: &'a [u8]) -> Result<Self> {
+        let invalid = |reason: &str| Error::Snapshot(reason.to_string());
+
+        if !Self::is_snapshot(data) {
+            return Err(invalid("not a layout snapshot"));
+        }
+        let header = data.get(..HEADER_LEN).ok_or_else(|| invalid("truncated header"))?;
+        let version = u32_at(header, 8);
+        if version != FORMAT_VERSION {
+            return Err(Error::Snapshot(format!(
+                "format version {} is not supported (expected {}); write it again with \
+                 `inspect --write-snapshot`",
+                version, FORMAT_VERSION
+            )));
+        }
+
+        let count = |at: usize| usize::try_from(u64_at(header, at)).ok();
+        let section = |at: usize, record: usize| count(at)?.checked_mul(record);
+        let sizes = [
+            section(16, STRUCT_RECORD),
+            section(24, MEMBER_RECORD),
+            section(32, STRING_RECORD),
+            section(40, 1),
+        ];
+        let mut body = &data[HEADER_LEN..];
+        let mut sections = [&[][..]; 4];
+        for (section, size) in sections.iter_mut().zip(sizes) {
+            let size = size.ok_or_else(|| invalid("section sizes overflow"))?;
+            (*section, body) = body.split_at_checked(size).ok_or_else(|| invalid("truncated"))?;
+        }
+        if !body.is_empty() {
+            return Err(invalid("trailing bytes after the string table"));
+        }
+        if fnv1a_words(&data[HEADER_LEN..]) != u64_at(header, 48) {
+            return Err(invalid("checksum mismatch"));
+        }
+
+        let [structs, members, strings, text] = sections;
+        let text = std::str::from_utf8(text).map_err(|_| invalid("string table is not UTF-8"))?;
+        let snapshot = Self { structs, members, strings, text };
+
+        let string_count = strings.len() / STRING_RECORD;
+        let member_count = members.len() / MEMBER_RECORD;
+        let is_string = |index: u32| (index as usize) < string_count;
+        for record in strings.chunks_exact(STRING_RECORD) {
+            let start = u32_at(record, 0) as usize;
+            if text.get(start..start + u32_at(record, 4) as usize).is_none() {
+                return Err(invalid("string out of bounds"));
+            }
+        }
+        for record in structs.chunks_exact(STRUCT_RECORD) {
+            let file = u32_at(record, 4);
+            let end = u32_at(record, 8) as usize + u32_at(record, 12) as usize;
+            if !is_string(u32_at(record, 0)) || !(file == NO_STRING || is_string(file)) {
+                return Err(invalid("struct refers to a missing string"));
+            }
+            if end > member_count {
+                return Err(invalid("struct refers to missing members"));
+            }
+        }
+        for record in members.chunks_exact(MEMBER_RECORD) {
+            if !is_string(u32_at(record, 0)) || !is_string(u32_at(record, 4)) {
+                return Err(invalid("member refers to a missing string"));
+            }
+        }
+        Ok(snapshot)
+    }
+
+    /// Write `layouts` as a snapshot. Analysis results are not stored; readers recompute
+    /// them with `analyze_layout`.
+    pub fn encode(layouts: &[StructLayout]) -> Result<Vec<u8>> {
+        fn index<'s>(strings: &mut IndexSet<&'s str>, s: &'s str) -> Result<u32> {
+            let (index, _) = strings.insert_full(s);
+            u32::try_from(index)
+                .ok()
+                .filter(|&index| index != NO_STRING)
+                .ok_or_else(|| Error::Snapshot("too many distinct strings".to_string()))
+        }
+        let too_many_members = || Error::Snapshot("too many members".to_string());
+
+        let member_count: usize = layouts.iter().map(|l| l.members.len()).sum();
+        let mut strings: IndexSet<&str> = IndexSet::new();
+        let mut structs = Vec::with_capacity(layouts.len() * STRUCT_RECORD);
+        let mut members = Vec::with_capacity(member_count * MEMBER_RECORD);
+        let mut first_member = 0u32;
+
+        for layout in layouts {
+            let name = index(&mut strings, &layout.name)?;
+            let (file, line) = match &layout.source_location {
+                Some(loc) => (index(&mut strings, &loc.file)?, loc.line),
+                None => (NO_STRING, 0),
+            };
+            let count = u32::try_from(layout.members.len()).map_err(|_| too_many_members())?;
+            structs.extend_from_slice(&name.to_le_bytes());
+            structs.extend_from_slice(&file.to_le_bytes());
+            structs.extend_from_slice(&first_member.to_le_bytes());
+            structs.extend_from_slice(&count.to_le_bytes());
+            structs.extend_from_slice(&layout.size.to_le_bytes());
+            structs.extend_from_slice(&layout.alignment.unwrap_or(0).to_le_bytes());
+            structs.extend_from_slice(&line.to_le_bytes());
+            let flags = if layout.alignment.is_some() { HAS_ALIGNMENT } else { 0 };
+            structs.extend_from_slice(&flags.to_le_bytes());
+            structs.extend_from_slice(&0u32.to_le_bytes());
+            first_member = first_member.checked_add(count).ok_or_else(too_many_members)?;
+
+            for member in &layout.members {
+                let name = index(&mut strings, &member.name)?;
+                let type_name = index(&mut strings, &member.type_name)?;
+                members.extend_from_slice(&name.to_le_bytes());
+                members.extend_from_slice(&type_name.to_le_bytes());
+                let mut flags = if member.is_atomic { IS_ATOMIC } else { 0 };
+                for (value, flag) in [
+                    (member.offset, HAS_OFFSET),
+                    (member.size, HAS_SIZE),
+                    (member.bit_offset, HAS_BIT_OFFSET),
+                    (member.bit_size, HAS_BIT_SIZE),
+                ] {
+                    if value.is_some() {
+                        flags |= flag;
+                    }
+                    members.extend_from_slice(&value.unwrap_or(0).to_le_bytes());
+                }
+                members.extend_from_slice(&flags.to_le_bytes());
+                members.extend_from_slice(&0u32.to_le_bytes());
+            }
+        }
+
+        let mut records = Vec::with_capacity(strings.len() * STRING_RECORD);
+        let mut text = String::new();
+        for s in &strings {
+            let start = u32::try_from(text.len()).ok();
+            let len = u32::try_from(s.len()).ok();
+            let (Some(start), Some(len)) = (start, len) else {
+                return Err(Error::Snapshot("string table exceeds 4 GiB".to_string()));
+            };
+            records.extend_from_slice(&start.to_le_bytes());
+            records.extend_from_slice(&len.to_le_bytes());
+            text.push_str(s);
+        }
+
+        let mut out = Vec::with_capacity(
+            HEADER_LEN + structs.len() + members.len() + records.len() + text.len(),
+        );
+        out.extend_from_slice(MAGIC);
+        out.extend_from_slice(&FORMAT_VERSION.to_le_bytes());
+        out.extend_from_slice(&0u32.to_le_bytes());
+        for count in [layouts.len(), member_count, strings.len(), text.len()] {
+            out.extend_from_slice(&(count as u64).to_le_bytes());
+        }
+        out.extend_from_slice(&0u64.to_le_bytes());
+        for section in [&structs[..], &members, &records, text.as_bytes()] {
+            out.extend_from_slice(section);
+        }
+        let checksum = fnv1a_words(&out[HEADER_LEN..]);
+        out[48..HEADER_LEN].copy_from_slice(&checksum.to_le_bytes());
+        Ok(out)
+    }
+
+    /// Number of structs.
+    pub fn len(&self) -> usize {
+        self.structs.len() / STRUCT_RECORD
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.structs.is_empty()
+    }
+
+    /// The structs in the order they were written.
+    pub fn iter(&self) -> impl ExactSizeIterator<Item = SnapshotStruct<'a>> + use<'a> {
+        let snapshot = *self;
+        self.structs
+            .chunks_exact(STRUCT_RECORD)
+            .map(move |record| SnapshotStruct { snapshot, record })
+    }
+
+    /// Build the layouts of the structs whose name contains `filter`, leaving out Go
+    /// runtime types unless `include_go_runtime`, as extraction would. Every distinct
+    /// string becomes one shared `Name`.
+    pub fn layouts(&self, filter: Option<&str>, include_go_runtime: bool) -> Vec<StructLayout> {
+        let mut names: Vec<Option<Name>> = vec![None; self.strings.len() / STRING_RECORD];
+        let mut name = |index: u32| {
+            names[index as usize].get_or_insert_with(|| Name::from(self.string(index))).clone()
+        };
+
+        let mut layouts = Vec::new();
+        for snapshot_struct in self.iter() {
+            let struct_name = snapshot_struct.name();
+            if !include_go_runtime && is_go_internal_type(struct_name) {
+                continue;
+            }
+            if filter.is_some_and(|f| !struct_name.contains(f)) {
+                continue;
+            }
+
+            let mut layout = StructLayout::new(
+                struct_name.to_string(),
+                snapshot_struct.size(),
+                snapshot_struct.alignment(),
+            );
+            layout.source_location = snapshot_struct
+                .source_location()
+                .map(|(file, line)| SourceLocation { file: file.to_string(), line });
+            layout.members = snapshot_struct
+                .members()
+                .map(|member| {
+                    let mut layout = MemberLayout::new(
+                        name(u32_at(member.record, 0)),
+                        name(u32_at(member.record, 4)),
+                        member.offset(),
+                        member.size(),
+                    );
+                    layout.bit_offset = member.bit_offset();
+                    layout.bit_size = member.bit_size();
+                    layout.with_atomic(member.is_atomic())
+                })
+                .collect();
+            layouts.push(layout);
+        }
+        layouts
+    }
+
+    fn string(&self, index: u32) -> &'a str {
+        let record = &self.strings[index as usize * STRING_RECORD..][..STRING_RECORD];
+        let start = u32_at(record, 0) as usize;
+        &self.text[start..start + u32_at(record, 4) as usize]
+    }
+}
+
+/// One struct of a `Snapshot`.
+#[derive(Clone, Copy)]
+pub struct SnapshotStruct<'a> {
+    snapshot: Snapshot<'a>,
+    record: &'a [u8],
+}
+
+impl<'a> SnapshotStruct<'a> {
+    pub fn name(&self) -> &'a str {
+        self.snapshot.string(u32_at(self.record, 0))
+    }
+
+    pub fn size(&self) -> u64 {
+        u64_at(self.record, 16)
+    }
+
+    pub fn alignment(&self) -> Option<u64> {
+        (u32_at(self.record, 40) & HAS_ALIGNMENT != 0).then(|| u64_at(self.record, 24))
+    }
+
+    /// Declaring file and line.
+    pub fn source_location(&self) -> Option<(&'a str, u64)> {
+        let file = u32_at(self.record, 4);
+        (file != NO_STRING).then(|| (self.snapshot.string(file), u64_at(self.record, 32)))
+    }
+
+    pub fn members(&self) -> impl ExactSizeIterator<Item = SnapshotMember<'a>> + use<'a> {
+        let snapshot = self.snapshot;
+        let first = u32_at(self.record, 8) as usize;
+        let count = u32_at(self.record, 12) as usize;
+        snapshot.members[first * MEMBER_RECORD..][..count * MEMBER_RECORD]
+            .chunks_exact(MEMBER_RECORD)
+            .map(move |record| SnapshotMember { snapshot, record })
+    }
+}
+
+/// One member of a `SnapshotStruct`.
+#[derive(Clone, Copy)]
+pub struct SnapshotMember<'a> {
+    snapshot: Snapshot<'a>,
+    record: &'a [u8],
+}
+
+impl<'a> SnapshotMember<'a> {
+    pub fn name(&self) -> &'a str {
+        self.snapshot.string(u32_at(self.record, 0))
+    }
+
+    pub fn type_name(&self) -> &'a str {
+        self.snapshot.string(u32_at(self.record, 4))
+    }
+
+    pub fn offset(&self) -> Option<u64> {
+        self.field(8, HAS_OFFSET)
+    }
+
+    pub fn size(&self) -> Option<u64> {
+        self.field(16, HAS_SIZE)
+    }
+
+    pub fn bit_offset(&self) -> Option<u64> {
+        self.field(24, HAS_BIT_OFFSET)
+    }
+
+    pub fn bit_size(&self) -> Option<u64> {
+        self.field(32, HAS_BIT_SIZE)
+    }
+
+    pub fn is_atomic(&self) -> bool {
+        self.flags() & IS_ATOMIC != 0
+    }
+
+    fn field(&self, at: usize, flag: u32) -> Option<u64> {
+        (self.flags() & flag != 0).then(|| u64_at(self.record, at))
+    }
+
+    fn flags(&self) -> u32 {
+        u32_at(self.record, 40)
+    }
+}
+
+fn u32_at(bytes: &[u8], at: usize) -> u32 {
+    u32::from_le_bytes(bytes[at..at + 4].try_into().expect("4 bytes"))
+}
+
+fn u64_at(bytes: &[u8], at: usize) -> u64 {
+    u64::from_le_bytes(bytes[at..at + 8].try_into().expect("8 bytes"))
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn sample() -> Vec<StructLayout> {
+        let mut a = StructLayout::new("Alpha".to_string(), 16, Some(8));
+        a.source_location = Some(SourceLocation { file: "alpha.h".to_string(), line: 12 });
+        let mut flags = MemberLayout::new("flags", "unsigned int", Some(4), None);
+        flags.bit_offset = Some(3);
+        flags.bit_size = Some(5);
+        a.members = vec![
+            MemberLayout::new("count", "std::atomic<int>", Some(0), Some(4)).with_atomic(true),
+            flags,
+            MemberLayout::new("next", "Alpha *", Some(8), Some(8)),
+        ];
+        let mut g = StructLayout::new("runtime.g".to_string(), 8, None);
+        g.members = vec![MemberLayout::new("count", "int", None, Some(8))];
+        vec![a, g, StructLayout::new("Empty".to_string(), 0, Some(1))]
+    }
+
+    fn describe(layouts: &[StructLayout]) -> Vec<String> {
+        layouts.iter().map(|l| format!("{:?}", (l, &l.members))).collect()
+    }
+
+    #[test]
+    fn round_trips_layouts_and_shares_strings() {
+        let layouts = sample();
+        let data = Snapshot::encode(&layouts).expect("encode");
+        assert!(Snapshot::is_snapshot(&data));
+        let snapshot = Snapshot::parse(&data).expect("parse");
+        assert_eq!(snapshot.len(), 3);
+
+        let alpha = snapshot.iter().next().expect("first struct");
+        assert_eq!((alpha.name(), alpha.size(), alpha.alignment()), ("Alpha", 16, Some(8)));
+        assert_eq!(alpha.source_location(), Some(("alpha.h", 12)));
+        let bits = alpha.members().nth(1).expect("second member");
+        assert_eq!((bits.offset(), bits.size(), bits.bit_size()), (Some(4), None, Some(5)));
+
+        let decoded = snapshot.layouts(None, true);
+        assert_eq!(describe(&decoded), describe(&layouts));
+        // "count" is written once, so both members share its name
+        assert!(std::ptr::eq(
+            decoded[0].members[0].name.as_str(),
+            decoded[1].members[0].name.as_str()
+        ));
+    }
+
+    #[test]
+    fn layouts_apply_filter_and_go_runtime_exclusion() {
+        let data = Snapshot::encode(&sample()).expect("encode");
+        let snapshot = Snapshot::parse(&data).expect("parse");
+        let names = |layouts: Vec<StructLayout>| -> Vec<String> {
+            layouts.into_iter().map(|l| l.name).collect()
+        };
+        assert_eq!(names(snapshot.layouts(None, false)), ["Alpha", "Empty"]);
+        assert_eq!(names(snapshot.layouts(Some("ime."), true)), ["runtime.g"]);
+    }
+
+    #[test]
+    fn rejects_damaged_snapshots() {
+        let data = Snapshot::encode(&sample()).expect("encode");
+        assert!(Snapshot::parse(&data[..data.len() - 1]).is_err());
+        assert!(Snapshot::parse(b"\x7fELF").is_err());
+
+        let mut corrupt = data.clone();
+        corrupt[HEADER_LEN + 2] ^= 1;
+        assert!(Snapshot::parse(&corrupt).is_err());
+
+        let mut future = data;
+        future[8] = 99;
+        let err = Snapshot::parse(&future).err().expect("version mismatch");
+        assert!(err.to_string().contains("version 99"));
+    }
+}
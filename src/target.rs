@@ -0,0 +1,144 @@
+//! Target architecture profiles: the cache geometry and ABI alignment that layouts are
+//! evaluated against.
+//!
+//! The same struct layout costs differently on different machines. x86 cores fetch cache
+//! lines in adjacent 128-byte pairs, so two atomics 64 bytes apart still contend; Apple
+//! M-series cores have 128-byte lines outright. Passing several profiles evaluates a
+//! layout against each of them and reports the worst.
+
+use crate::error::{Error, Result};
+use object::{Architecture, BinaryFormat, Object};
+use serde::Serialize;
+
+/// Cache geometry and alignment rules of one target.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Serialize)]
+pub struct TargetProfile {
+    pub name: &'static str,
+    /// Bytes per cache line.
+    pub cache_line: u32,
+    /// Bytes the hardware prefetcher pulls in together, and so the distance within which
+    /// writes from different cores interfere. At least `cache_line`.
+    pub prefetch_size: u32,
+    /// Largest alignment the ABI gives a scalar (`long double`, `__int128`, 8-byte
+    /// integers on i386). Alignment is otherwise the size rounded up to a power of two.
+    pub max_align: u64,
+}
+
+/// Every named profile.
+pub const TARGET_PROFILES: &[TargetProfile] = &[
+    TargetProfile { name: "x86-64", cache_line: 64, prefetch_size: 128, max_align: 16 },
+    TargetProfile { name: "i386", cache_line: 64, prefetch_size: 128, max_align: 4 },
+    TargetProfile { name: "aarch64", cache_line: 64, prefetch_size: 64, max_align: 16 },
+    TargetProfile { name: "apple-m", cache_line: 128, prefetch_size: 128, max_align: 16 },
+    TargetProfile { name: "graviton", cache_line: 64, prefetch_size: 64, max_align: 16 },
+    TargetProfile { name: "arm", cache_line: 64, prefetch_size: 64, max_align: 8 },
+    TargetProfile { name: "riscv64", cache_line: 64, prefetch_size: 64, max_align: 16 },
+    TargetProfile { name: "ppc64", cache_line: 128, prefetch_size: 128, max_align: 16 },
+    TargetProfile { name: "s390x", cache_line: 256, prefetch_size: 256, max_align: 8 },
+];
+
+impl TargetProfile {
+    /// The profile called `name`.
+    pub fn named(name: &str) -> Option<Self> {
+        TARGET_PROFILES.iter().find(|p| p.name.eq_ignore_ascii_case(name)).copied()
+    }
+
+    /// The profile for code built for `architecture` in `format`. 64-bit Arm Mach-O files
+    /// are taken to run on Apple silicon.
+    pub fn for_architecture(architecture: Architecture, format: BinaryFormat) -> Option<Self> {
+        let name = match architecture {
+            Architecture::X86_64 | Architecture::X86_64_X32 => "x86-64",
+            Architecture::I386 => "i386",
+            Architecture::Aarch64 | Architecture::Aarch64_Ilp32
+                if format == BinaryFormat::MachO =>
+            {
+                "apple-m"
+            }
+            Architecture::Aarch64 | Architecture::Aarch64_Ilp32 => "aarch64",
+            Architecture::Arm => "arm",
+            Architecture::Riscv64 => "riscv64",
+            Architecture::PowerPc64 => "ppc64",
+            Architecture::S390x => "s390x",
+            _ => return None,
+        };
+        Self::named(name)
+    }
+
+    /// The profile for the object file in `data`, if it is one of a known architecture.
+    pub fn for_binary(data: &[u8]) -> Option<Self> {
+        let object = object::File::parse(data).ok()?;
+        Self::for_architecture(object.architecture(), object.format())
+    }
+
+    /// Resolve profile names, where `auto` stands for the architecture of `data`.
+    pub fn resolve(names: &[String], data: &[u8]) -> Result<Vec<Self>> {
+        let mut profiles: Vec<Self> = Vec::with_capacity(names.len());
+        for name in names {
+            let profile = if name.eq_ignore_ascii_case("auto") {
+                Self::for_binary(data).ok_or_else(|| {
+                    Error::Target("cannot tell the architecture for 'auto'; name a target".into())
+                })?
+            } else {
+                Self::named(name).ok_or_else(|| {
+                    let known: Vec<&str> = TARGET_PROFILES.iter().map(|p| p.name).collect();
+                    Error::Target(format!(
+                        "unknown target '{}' (known: {})",
+                        name,
+                        known.join(", ")
+                    ))
+                })?
+            };
+            if !profiles.contains(&profile) {
+                profiles.push(profile);
+            }
+        }
+        Ok(profiles)
+    }
+
+    /// The ABI alignment of a scalar of `size` bytes.
+    pub fn alignment(&self, size: u64) -> u64 {
+        crate::analysis::infer_alignment(size, self.max_align)
+    }
+
+    /// Distance within which writes from different cores interfere.
+    pub fn interference_size(&self) -> u32 {
+        self.prefetch_size.max(self.cache_line)
+    }
+}
+
+/// The profile whose interference size is largest, where the most members end up sharing
+/// a line; the first such profile if several tie. `None` if `targets` is empty.
+pub fn widest_interference(targets: &[TargetProfile]) -> Option<&TargetProfile> {
+    targets.iter().rev().max_by_key(|t| t.interference_size())
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn profiles_follow_the_binary_architecture() {
+        let profile = |arch, format| TargetProfile::for_architecture(arch, format).map(|p| p.name);
+        assert_eq!(profile(Architecture::X86_64, BinaryFormat::Elf), Some("x86-64"));
+        assert_eq!(profile(Architecture::Aarch64, BinaryFormat::Elf), Some("aarch64"));
+        assert_eq!(profile(Architecture::Aarch64, BinaryFormat::MachO), Some("apple-m"));
+        assert_eq!(profile(Architecture::Wasm32, BinaryFormat::Wasm), None);
+        assert_eq!(TargetProfile::named("i386").map(|p| p.alignment(8)), Some(4));
+        assert_eq!(TargetProfile::named("x86-64").map(|p| p.alignment(16)), Some(16));
+    }
+
+    #[test]
+    fn resolve_deduplicates_and_rejects_unknown_names() {
+        let names =
+            |names: &[&str]| -> Vec<String> { names.iter().map(|n| n.to_string()).collect() };
+        let targets =
+            TargetProfile::resolve(&names(&["x86-64", "APPLE-M", "x86-64"]), &[]).unwrap();
+        let resolved: Vec<&str> = targets.iter().map(|t| t.name).collect();
+        assert_eq!(resolved, ["x86-64", "apple-m"]);
+        assert_eq!(widest_interference(&targets).map(|t| t.name), Some("x86-64"));
+
+        let unknown = TargetProfile::resolve(&names(&["vax"]), &[]).unwrap_err();
+        assert!(unknown.to_string().contains("unknown target 'vax'"));
+        assert!(TargetProfile::resolve(&names(&["auto"]), b"not an object").is_err());
+    }
+}
@@ -0,0 +1,351 @@
+//! Self-profiling for `--timings`: wall time and peak memory per pipeline stage, and
+//! counters from layout extraction.
+//!
+//! Peak memory is the process's peak resident set size while a stage ran, read from
+//! `/proc/self/status` after resetting it through `/proc/self/clear_refs`, so it is only
+//! available on Linux. The peak is only reset when no other stage is running, so stages
+//! that run concurrently (the two sides of `diff`, binaries in `batch`) each report the
+//! peak over at least the time they overlapped, rather than clearing each other's.
+//!
+//! A stage's wall time is the time during which at least one call of it was running, so
+//! calls on several threads at once count once.
+
+use serde::Serialize;
+use std::sync::Mutex;
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::time::{Duration, Instant};
+
+/// Counters collected by `DwarfContext::find_structs` when attached with
+/// `DwarfContext::with_stats`. Workers count locally and add their totals once per unit.
+#[derive(Debug, Default)]
+pub struct ExtractStats {
+    units: AtomicU64,
+    units_reused: AtomicU64,
+    dies: AtomicU64,
+    type_lookups: AtomicU64,
+    type_cache_hits: AtomicU64,
+    type_resolve_nanos: AtomicU64,
+    structs_found: AtomicU64,
+    structs_unique: AtomicU64,
+    dedup_nanos: AtomicU64,
+}
+
+/// What one unit's extraction counted, before it is added to `ExtractStats`.
+#[derive(Debug, Default)]
+pub(crate) struct UnitCounters {
+    pub(crate) dies: u64,
+    pub(crate) type_lookups: u64,
+    pub(crate) type_cache_hits: u64,
+    pub(crate) type_resolve: Duration,
+}
+
+impl ExtractStats {
+    pub(crate) fn add_unit(&self, counters: &UnitCounters) {
+        self.units.fetch_add(1, Ordering::Relaxed);
+        self.dies.fetch_add(counters.dies, Ordering::Relaxed);
+        self.type_lookups.fetch_add(counters.type_lookups, Ordering::Relaxed);
+        self.type_cache_hits.fetch_add(counters.type_cache_hits, Ordering::Relaxed);
+        self.type_resolve_nanos.fetch_add(nanos(counters.type_resolve), Ordering::Relaxed);
+    }
+
+    pub(crate) fn add_reused_unit(&self) {
+        self.units.fetch_add(1, Ordering::Relaxed);
+        self.units_reused.fetch_add(1, Ordering::Relaxed);
+    }
+
+    pub(crate) fn add_dedup(&self, found: usize, unique: usize, elapsed: Duration) {
+        self.structs_found.fetch_add(found as u64, Ordering::Relaxed);
+        self.structs_unique.fetch_add(unique as u64, Ordering::Relaxed);
+        self.dedup_nanos.fetch_add(nanos(elapsed), Ordering::Relaxed);
+    }
+
+    pub fn counters(&self) -> ExtractCounters {
+        let get = |counter: &AtomicU64| counter.load(Ordering::Relaxed);
+        let lookups = get(&self.type_lookups);
+        let hits = get(&self.type_cache_hits);
+        ExtractCounters {
+            units: get(&self.units),
+            units_reused: get(&self.units_reused),
+            dies_visited: get(&self.dies),
+            type_lookups: lookups,
+            type_cache_hits: hits,
+            type_cache_hit_rate: if lookups == 0 { 0.0 } else { hits as f64 / lookups as f64 },
+            type_resolve_ms: millis(Duration::from_nanos(get(&self.type_resolve_nanos))),
+            structs_found: get(&self.structs_found),
+            structs_unique: get(&self.structs_unique),
+            dedup_ms: millis(Duration::from_nanos(get(&self.dedup_nanos))),
+        }
+    }
+}
+
+/// Extraction counters, summed over every `find_structs` call.
+#[derive(Debug, Clone, Default, Serialize)]
+pub struct ExtractCounters {
+    /// Units visited, including the ones served from the per-unit cache.
+    pub units: u64,
+    pub units_reused: u64,
+    /// DIE reads; members are read once more when their struct is extracted.
+    pub dies_visited: u64,
+    /// Top-level type lookups made by `TypeResolver`.
+    pub type_lookups: u64,
+    /// Lookups answered from the resolver's unit cache or the binary-wide type table.
+    pub type_cache_hits: u64,
+    pub type_cache_hit_rate: f64,
+    /// Time spent in type resolution, summed over worker threads.
+    pub type_resolve_ms: f64,
+    /// Struct layouts extracted, before deduplication.
+    pub structs_found: u64,
+    pub structs_unique: u64,
+    /// Time spent sorting and deduplicating layouts, part of the extract stage.
+    pub dedup_ms: f64,
+}
+
+/// Records stages as they run. Shared by reference; stages may run on several threads.
+pub struct Timings {
+    started: Instant,
+    stages: Mutex<Stages>,
+    extract: ExtractStats,
+    decompressed_bytes: AtomicU64,
+}
+
+#[derive(Default)]
+struct Stages {
+    /// Stages in the order they first ran.
+    recorded: Vec<StageRecord>,
+    /// Calls of any stage in progress.
+    running: usize,
+}
+
+struct StageRecord {
+    name: &'static str,
+    /// Start and end of every call, merged into a wall time when reported.
+    calls: Vec<(Instant, Instant)>,
+    peak_rss_bytes: Option<u64>,
+}
+
+impl Default for Timings {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl Timings {
+    pub fn new() -> Self {
+        Self {
+            started: Instant::now(),
+            stages: Mutex::new(Stages::default()),
+            extract: ExtractStats::default(),
+            decompressed_bytes: AtomicU64::new(0),
+        }
+    }
+
+    /// Run `f` as (one call of) stage `name`. Repeated stages are reported once, with the
+    /// highest peak and the time covered by their calls, which may overlap.
+    pub fn stage<T>(&self, name: &'static str, f: impl FnOnce() -> T) -> T {
+        {
+            let mut stages = self.lock();
+            // Resetting while another stage runs would lose that stage's peak so far.
+            if stages.running == 0 {
+                reset_peak_rss();
+            }
+            stages.running += 1;
+        }
+        let start = Instant::now();
+        let result = f();
+        let end = Instant::now();
+        let peak = peak_rss();
+
+        let mut stages = self.lock();
+        stages.running -= 1;
+        match stages.recorded.iter_mut().find(|s| s.name == name) {
+            Some(stage) => {
+                stage.calls.push((start, end));
+                stage.peak_rss_bytes = stage.peak_rss_bytes.max(peak);
+            }
+            None => stages.recorded.push(StageRecord {
+                name,
+                calls: vec![(start, end)],
+                peak_rss_bytes: peak,
+            }),
+        }
+        result
+    }
+
+    fn lock(&self) -> std::sync::MutexGuard<'_, Stages> {
+        self.stages.lock().unwrap_or_else(|e| e.into_inner())
+    }
+
+    /// Counters to attach to extraction with `DwarfContext::with_stats`.
+    pub fn extract_stats(&self) -> &ExtractStats {
+        &self.extract
+    }
+
+    /// Count the size of sections decompressed while loading DWARF.
+    pub fn add_decompressed(&self, bytes: u64) {
+        self.decompressed_bytes.fetch_add(bytes, Ordering::Relaxed);
+    }
+
+    pub fn report(&self) -> TimingsReport {
+        let stages: Vec<StageTiming> = self
+            .lock()
+            .recorded
+            .iter()
+            .map(|stage| StageTiming {
+                name: stage.name,
+                calls: stage.calls.len() as u64,
+                wall_ms: millis(covered(&stage.calls)),
+                peak_rss_bytes: stage.peak_rss_bytes,
+            })
+            .collect();
+        let stage_peak = stages.iter().filter_map(|s| s.peak_rss_bytes).max();
+        TimingsReport {
+            total_ms: millis(self.started.elapsed()),
+            peak_rss_bytes: stage_peak.max(peak_rss()),
+            decompressed_bytes: self.decompressed_bytes.load(Ordering::Relaxed),
+            extract: self.extract.counters(),
+            stages,
+        }
+    }
+}
+
+#[derive(Debug, Clone, Serialize)]
+pub struct StageTiming {
+    pub name: &'static str,
+    pub calls: u64,
+    /// Time during which at least one call was running.
+    pub wall_ms: f64,
+    /// `None` where the platform does not report it.
+    pub peak_rss_bytes: Option<u64>,
+}
+
+#[derive(Debug, Clone, Serialize)]
+pub struct TimingsReport {
+    /// Stages in the order they first ran.
+    pub stages: Vec<StageTiming>,
+    pub total_ms: f64,
+    pub peak_rss_bytes: Option<u64>,
+    pub decompressed_bytes: u64,
+    pub extract: ExtractCounters,
+}
+
+/// Length of the union of `intervals`.
+fn covered(intervals: &[(Instant, Instant)]) -> Duration {
+    let mut intervals = intervals.to_vec();
+    intervals.sort_unstable();
+    let mut total = Duration::ZERO;
+    let mut current: Option<(Instant, Instant)> = None;
+    for (start, end) in intervals {
+        current = match current {
+            Some((from, to)) if start <= to => Some((from, to.max(end))),
+            Some((from, to)) => {
+                total += to - from;
+                Some((start, end))
+            }
+            None => Some((start, end)),
+        };
+    }
+    if let Some((from, to)) = current {
+        total += to - from;
+    }
+    total
+}
+
+fn nanos(duration: Duration) -> u64 {
+    u64::try_from(duration.as_nanos()).unwrap_or(u64::MAX)
+}
+
+fn millis(duration: Duration) -> f64 {
+    duration.as_secs_f64() * 1000.0
+}
+
+/// Peak resident set size of the process since it started or since the last reset.
+fn peak_rss() -> Option<u64> {
+    let status = std::fs::read_to_string("/proc/self/status").ok()?;
+    let line = status.lines().find_map(|line| line.strip_prefix("VmHWM:"))?;
+    let kib: u64 = line.trim().strip_suffix("kB")?.trim().parse().ok()?;
+    Some(kib * 1024)
+}
+
+/// Restart peak RSS tracking from the current RSS (Linux 4.0+). Best effort: without it a
+/// stage reports the peak of the whole run so far.
+fn reset_peak_rss() {
+    if cfg!(target_os = "linux") {
+        let _ = std::fs::write("/proc/self/clear_refs", "5");
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn repeated_stages_are_merged_in_first_run_order() {
+        let timings = Timings::new();
+        assert_eq!(timings.stage("load", || 1), 1);
+        timings.stage("extract", || std::thread::sleep(Duration::from_millis(2)));
+        timings.stage("load", || ());
+
+        let report = timings.report();
+        let stages: Vec<_> = report.stages.iter().map(|s| (s.name, s.calls)).collect();
+        assert_eq!(stages, [("load", 2), ("extract", 1)]);
+        assert!(report.stages[1].wall_ms >= 2.0);
+        assert!(report.total_ms >= report.stages[1].wall_ms);
+        if cfg!(target_os = "linux") {
+            assert!(report.peak_rss_bytes.is_some_and(|b| b > 0));
+        }
+    }
+
+    #[test]
+    fn concurrent_calls_of_a_stage_count_once() {
+        let timings = Timings::new();
+        let barrier = std::sync::Barrier::new(2);
+        std::thread::scope(|scope| {
+            for _ in 0..2 {
+                scope.spawn(|| {
+                    timings.stage("extract", || {
+                        barrier.wait();
+                        std::thread::sleep(Duration::from_millis(30));
+                    })
+                });
+            }
+        });
+
+        let report = timings.report();
+        let extract = &report.stages[0];
+        assert_eq!(extract.calls, 2);
+        // Summed, the two calls would take longer than the whole run.
+        assert!(extract.wall_ms >= 30.0);
+        assert!(extract.wall_ms <= report.total_ms, "{} > {}", extract.wall_ms, report.total_ms);
+        assert_eq!(timings.lock().running, 0);
+    }
+
+    #[test]
+    fn covered_merges_overlapping_intervals() {
+        let t = Instant::now();
+        let at = |ms| t + Duration::from_millis(ms);
+        let intervals = [(at(5), at(6)), (at(0), at(1)), (at(2), at(7)), (at(10), at(12))];
+        assert_eq!(covered(&intervals), Duration::from_millis(8));
+        assert_eq!(covered(&[]), Duration::ZERO);
+    }
+
+    #[test]
+    fn extract_counters_sum_units_and_hit_rate() {
+        let stats = ExtractStats::default();
+        let unit = UnitCounters {
+            dies: 10,
+            type_lookups: 4,
+            type_cache_hits: 3,
+            type_resolve: Duration::from_millis(1),
+        };
+        stats.add_unit(&unit);
+        stats.add_unit(&unit);
+        stats.add_reused_unit();
+        stats.add_dedup(5, 4, Duration::ZERO);
+
+        let counters = stats.counters();
+        assert_eq!((counters.units, counters.units_reused, counters.dies_visited), (3, 1, 20));
+        assert_eq!(counters.type_cache_hit_rate, 0.75);
+        assert_eq!((counters.structs_found, counters.structs_unique), (5, 4));
+        assert!((counters.type_resolve_ms - 2.0).abs() < 1e-9);
+    }
+}
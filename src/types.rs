@@ -1,3 +1,4 @@
+use crate::intern::Name;
 use serde::Serialize;
 
 #[derive(Debug, Clone, Serialize)]
@@ -13,8 +14,8 @@ pub struct StructLayout {
 
 #[derive(Debug, Clone, Serialize)]
 pub struct MemberLayout {
-    pub name: String,
-    pub type_name: String,
+    pub name: Name,
+    pub type_name: Name,
     pub offset: Option<u64>,
     pub size: Option<u64>,
     #[serde(skip_serializing_if = "Option::is_none")]
@@ -40,6 +41,30 @@ pub struct LayoutMetrics {
     pub partial: bool,
     #[serde(skip_serializing_if = "Option::is_none")]
     pub false_sharing: Option<FalseSharingAnalysis>,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub access_heat: Option<AccessHeat>,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub nested: Option<NestedPadding>,
+    /// Per-target figures when analyzed against target profiles; the metrics above are
+    /// then those of the worst target.
+    #[serde(skip_serializing_if = "Vec::is_empty")]
+    pub targets: Vec<TargetMetrics>,
+}
+
+/// Cache behavior of a layout on one target profile.
+#[derive(Debug, Clone, Serialize, PartialEq)]
+pub struct TargetMetrics {
+    pub target: String,
+    pub cache_line_size: u32,
+    pub prefetch_size: u32,
+    pub cache_lines_spanned: u32,
+    /// Blocks of `prefetch_size` bytes the struct spans.
+    pub prefetch_blocks_spanned: u32,
+    pub cache_line_density: f64,
+    /// Members, bitfields aside, whose bytes lie on more than one cache line.
+    pub split_members: u32,
+    /// Distinct pairs of atomics within one prefetch block of each other.
+    pub false_sharing_pairs: u64,
 }
 
 #[derive(Debug, Clone, Serialize)]
@@ -76,14 +101,44 @@ pub struct CacheLineSpanningWarning {
     pub lines_spanned: u64,
 }
 
+/// Atomic members sharing one cache line, reported once per line.
+#[derive(Debug, Clone, Serialize, PartialEq, Eq)]
+pub struct ContendedCacheLine {
+    pub cache_line: u64,
+    /// Atomics touching the line, in offset order.
+    pub members: Vec<String>,
+    /// Member pairs on this line not already sharing an earlier line.
+    pub new_pairs: u64,
+}
+
 #[derive(Debug, Clone, Serialize, Default, PartialEq, Eq)]
 pub struct FalseSharingAnalysis {
     pub atomic_members: Vec<AtomicMember>,
+    pub contended_lines: Vec<ContendedCacheLine>,
+    /// Distinct pairs of atomics sharing at least one cache line.
+    pub pair_count: u64,
+    /// One entry per pair; only filled in by `analyze_false_sharing_pairs`.
     pub warnings: Vec<FalseSharingWarning>,
     #[serde(skip_serializing_if = "Vec::is_empty")]
     pub spanning_warnings: Vec<CacheLineSpanningWarning>,
 }
 
+/// A cache line holding members written by more than one writer role.
+#[derive(Debug, Clone, Serialize, PartialEq, Eq)]
+pub struct WriterConflict {
+    pub cache_line: u64,
+    /// Distinct roles writing the line, in offset order of their first member.
+    pub roles: Vec<String>,
+    /// Every tagged member touching the line, in offset order.
+    pub members: Vec<RoleMember>,
+}
+
+#[derive(Debug, Clone, Serialize, PartialEq, Eq)]
+pub struct RoleMember {
+    pub name: String,
+    pub role: String,
+}
+
 #[derive(Debug, Clone, Serialize, PartialEq, Eq)]
 pub struct AtomicMember {
     pub name: String,
@@ -95,6 +150,96 @@ pub struct AtomicMember {
     pub spans_cache_lines: bool,
 }
 
+/// Where a struct's sampled accesses land, from an access profile.
+#[derive(Debug, Clone, Serialize, Default, PartialEq)]
+pub struct AccessHeat {
+    pub total_weight: f64,
+    /// Weight of samples outside every member (padding, or beyond the struct size).
+    pub unattributed_weight: f64,
+    /// Sampled members, hottest first.
+    pub members: Vec<MemberHeat>,
+    /// Cache lines that received samples, in address order.
+    pub cache_lines: Vec<CacheLineHeat>,
+}
+
+#[derive(Debug, Clone, Serialize, PartialEq)]
+pub struct MemberHeat {
+    pub name: String,
+    pub offset: u64,
+    pub size: u64,
+    pub weight: f64,
+    /// Share of the struct's total sampled weight.
+    pub percent: f64,
+}
+
+#[derive(Debug, Clone, Serialize, PartialEq)]
+pub struct CacheLineHeat {
+    pub cache_line: u64,
+    pub weight: f64,
+    pub percent: f64,
+    /// Sampled members starting in this cache line, in offset order.
+    pub members: Vec<String>,
+}
+
+/// Padding of one instance with embedded structs and arrays of structs flattened, so
+/// padding inside each element counts toward the outer struct.
+#[derive(Debug, Clone, Serialize, Default, PartialEq)]
+pub struct NestedPadding {
+    pub useful_size: u64,
+    pub padding_bytes: u64,
+    pub padding_percentage: f64,
+    pub cache_line_density: f64,
+    /// Types whose own padding adds up to `padding_bytes` (the struct itself included),
+    /// most padding first. Types without padding are left out.
+    pub contributors: Vec<PaddingContributor>,
+    /// Some embedded layout was incomplete, or its type could not be followed.
+    #[serde(skip_serializing_if = "std::ops::Not::not")]
+    pub partial: bool,
+}
+
+#[derive(Debug, Clone, Serialize, PartialEq)]
+pub struct PaddingContributor {
+    pub type_name: String,
+    /// Copies embedded in one instance of the outer struct.
+    pub instances: u64,
+    /// Own padding of the type times `instances`.
+    pub padding_bytes: u64,
+    /// Share of the flattened padding.
+    pub percent: f64,
+    /// Where the copies sit, as member paths like `legs[]` or `origin.inner`; empty for
+    /// the outer struct itself.
+    #[serde(skip_serializing_if = "Vec::is_empty")]
+    pub paths: Vec<String>,
+}
+
+/// A function with code in the binary, from its `DW_TAG_subprogram`.
+#[derive(Debug, Clone, Serialize)]
+pub struct FunctionInfo {
+    pub name: String,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub linkage_name: Option<String>,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub source_location: Option<SourceLocation>,
+    /// Parameters whose type is a struct or class, or a pointer or reference to one.
+    pub parameters: Vec<StructParameter>,
+}
+
+#[derive(Debug, Clone, Serialize, PartialEq, Eq)]
+pub struct StructParameter {
+    pub name: Name,
+    pub struct_name: Name,
+    pub passing: Passing,
+}
+
+/// How a function receives a struct.
+#[derive(Debug, Clone, Copy, Serialize, PartialEq, Eq, PartialOrd, Ord)]
+#[serde(rename_all = "lowercase")]
+pub enum Passing {
+    Value,
+    Pointer,
+    Reference,
+}
+
 impl StructLayout {
     pub fn new(name: String, size: u64, alignment: Option<u64>) -> Self {
         Self {
@@ -109,8 +254,21 @@ impl StructLayout {
 }
 
 impl MemberLayout {
-    pub fn new(name: String, type_name: String, offset: Option<u64>, size: Option<u64>) -> Self {
-        Self { name, type_name, offset, size, bit_offset: None, bit_size: None, is_atomic: false }
+    pub fn new(
+        name: impl Into<Name>,
+        type_name: impl Into<Name>,
+        offset: Option<u64>,
+        size: Option<u64>,
+    ) -> Self {
+        Self {
+            name: name.into(),
+            type_name: type_name.into(),
+            offset,
+            size,
+            bit_offset: None,
+            bit_size: None,
+            is_atomic: false,
+        }
     }
 
     pub fn with_atomic(mut self, is_atomic: bool) -> Self {
@@ -125,6 +283,19 @@ impl MemberLayout {
             _ => None,
         }
     }
+
+    /// Whether the member's bytes lie on more than one line of `line_size` bytes. Bitfields
+    /// never do, since their storage unit is shared; nor do members of unknown placement.
+    pub fn crosses_line(&self, line_size: u64) -> bool {
+        if self.bit_size.is_some() {
+            return false;
+        }
+        let line = line_size.max(1);
+        match (self.offset, self.end_offset()) {
+            (Some(start), Some(end)) if end > start => start / line != (end - 1) / line,
+            _ => false,
+        }
+    }
 }
 
 #[cfg(test)]
@@ -0,0 +1,22 @@
+// Built with -gpubnames: .debug_pubtypes lists IndexedRecord but not the
+// function-local LocalRecord.
+
+struct IndexedRecord {
+    char tag;    // 1 byte
+                 // 7 bytes padding
+    long value;  // 8 bytes
+};
+
+int count_records(int n) {
+    struct LocalRecord {
+        char tag;   // 1 byte
+                    // 3 bytes padding
+        int value;  // 4 bytes
+    } local = { 'a', n };
+    struct IndexedRecord indexed = { 'b', n };
+    return local.value + (int)indexed.value;
+}
+
+int main(void) {
+    return count_records(1) == 2 ? 0 : 1;
+}
@@ -103,6 +103,28 @@ struct WithAtomics {
     _Atomic int b;
 };
 
+// Arrays and embedded structs whose padding is invisible at the outer level
+struct Route {
+    int id;
+    struct TailPadding legs[4];   // 3 bytes tail padding in each element
+    struct Outer origin;          // 6 bytes padding inside
+    char grid[2][3];
+    // 2 bytes tail padding
+};
+
+// Functions taking structs by pointer and by value
+int route_length(const struct Route *route) {
+    return route->id + route->legs[0].a;
+}
+
+int padding_sum(struct InternalPadding ip) {
+    return ip.b + ip.d;
+}
+
+void copy_padding(struct InternalPadding *to, const struct InternalPadding *from) {
+    *to = *from;
+}
+
 static int sample_fn(int x) {
     return x + 1;
 }
@@ -121,6 +143,7 @@ int main() {
     struct WithFuncPtr wfp;
     struct WithAtomic wa2;
     struct WithAtomics wa3;
+    struct Route route;
 
     (void)np;
     (void)ip;
@@ -135,6 +158,7 @@ int main() {
     (void)wfp;
     (void)wa2;
     (void)wa3;
+    (void)route;
     (void)sample_fn;
 
     return 0;
@@ -148,6 +148,51 @@ fn test_nested_struct() {
     assert_eq!(layout.size, 16);
 }
 
+#[test]
+fn test_nested_padding_rollup() {
+    let path = match get_fixture_path() {
+        Some(p) => p,
+        None => return,
+    };
+
+    let output = std::process::Command::new("cargo")
+        .args([
+            "run",
+            "--",
+            "inspect",
+            path.to_str().unwrap(),
+            "--filter",
+            "Route",
+            "--nested",
+            "-o",
+            "json",
+        ])
+        .output()
+        .expect("Failed to run CLI");
+    assert!(output.status.success(), "CLI failed: {:?}", String::from_utf8_lossy(&output.stderr));
+
+    let parsed: serde_json::Value = serde_json::from_slice(&output.stdout).expect("Invalid JSON");
+    let structs = parsed["structs"].as_array().unwrap();
+    assert_eq!(structs.len(), 1, "the filter still applies to the reported structs");
+    let route = &structs[0];
+    // `char grid[2][3]` is one 6-byte array, leaving 2 bytes of tail padding.
+    let grid = route["members"].as_array().unwrap().iter().find(|m| m["name"] == "grid").unwrap();
+    assert_eq!(grid["size"], 6);
+    assert_eq!(route["metrics"]["padding_bytes"], 2);
+
+    // Plus 4 × 3 bytes in TailPadding legs and 6 bytes inside Outer.
+    let nested = &route["metrics"]["nested"];
+    assert_eq!(nested["padding_bytes"], 20);
+    let contributors: Vec<(&str, u64)> = nested["contributors"]
+        .as_array()
+        .unwrap()
+        .iter()
+        .map(|c| (c["type_name"].as_str().unwrap(), c["padding_bytes"].as_u64().unwrap()))
+        .collect();
+    assert_eq!(contributors, [("TailPadding", 12), ("Outer", 6), ("Route", 2)]);
+    assert_eq!(nested["contributors"][0]["paths"][0], "legs[]");
+}
+
 #[test]
 fn test_cache_line_metrics() {
     let path = match get_fixture_path() {
@@ -378,6 +423,77 @@ budgets:
     assert!(parsed["summary"]["total_violations"].is_number());
 }
 
+#[test]
+fn test_check_writer_roles_sharing_cache_line() {
+    let path = match get_fixture_path() {
+        Some(p) => p,
+        None => return,
+    };
+
+    let run = |writers: &str| {
+        let config =
+            create_temp_config(&format!("budgets:\n  WithArray:\n    writers:\n{}", writers));
+        let output = std::process::Command::new("cargo")
+            .args(["run", "--", "check", path.to_str().unwrap(), "--config"])
+            .args([config.to_str().unwrap(), "-o", "json"])
+            .output()
+            .expect("Failed to run check command");
+        std::fs::remove_file(&config).ok();
+        output
+    };
+
+    // Plain ints written by different threads on one cache line.
+    let output = run("      count: producer\n      \"fl*\": consumer\n");
+    assert!(!output.status.success(), "Check should fail on shared writer cache line");
+    let parsed: serde_json::Value =
+        serde_json::from_slice(&output.stdout).expect("Invalid JSON output");
+    let violation = &parsed["violations"][0];
+    assert_eq!(violation["kind"], "shared_writer_cache_line");
+    let message = violation["message"].as_str().unwrap();
+    assert!(message.contains("written by producer and consumer"), "{message}");
+    assert!(message.contains("count (producer), flags (consumer)"), "{message}");
+
+    let output = run("      \"*\": thread-local\n");
+    assert!(output.status.success(), "{}", String::from_utf8_lossy(&output.stderr));
+}
+
+#[test]
+fn test_check_hot_fields_within_cache_lines() {
+    let path = match get_fixture_path() {
+        Some(p) => p,
+        None => return,
+    };
+
+    let config = create_temp_config(
+        "budgets:\n  Route:\n    hot_fields: [id, grid]\n    max_hot_lines: 1\n    \
+         max_cache_lines: 1\n",
+    );
+    let run = |cache_line: &str| {
+        std::process::Command::new("cargo")
+            .args(["run", "--", "check", path.to_str().unwrap(), "--config"])
+            .args([config.to_str().unwrap(), "-o", "sarif", "--cache-line", cache_line])
+            .output()
+            .expect("Failed to run check command")
+    };
+
+    // Route is 60 bytes: `id` at 0 and `grid` at 52 share one 64-byte line.
+    let output = run("64");
+    assert!(output.status.success(), "{}", String::from_utf8_lossy(&output.stderr));
+
+    let output = run("32");
+    std::fs::remove_file(&config).ok();
+    assert!(!output.status.success());
+    let parsed: serde_json::Value =
+        serde_json::from_slice(&output.stdout).expect("Invalid SARIF output");
+    let rules: Vec<&str> = parsed["runs"][0]["results"]
+        .as_array()
+        .unwrap()
+        .iter()
+        .map(|r| r["ruleId"].as_str().unwrap())
+        .collect();
+    assert_eq!(rules, ["LAYOUT-BUDGET-CACHE-LINES", "LAYOUT-BUDGET-HOT-LINES"]);
+}
+
 #[test]
 fn test_check_sarif_output() {
     let path = match get_fixture_path() {
@@ -995,6 +1111,57 @@ fn test_diff_fail_on_regression() {
     assert!(!output.status.success(), "Should fail with --fail-on-regression when structs grow");
 }
 
+#[test]
+fn test_diff_performance_impact_and_regression_kinds() {
+    let old_path = match get_fixture_path() {
+        Some(p) => p,
+        None => return,
+    };
+    let new_path = match get_modified_fixture_path() {
+        Some(p) => p,
+        None => return,
+    };
+    let run = |args: &[&str]| {
+        std::process::Command::new("cargo")
+            .args(["run", "--", "diff", old_path.to_str().unwrap(), new_path.to_str().unwrap()])
+            .args(args)
+            .output()
+            .expect("Failed to run diff command")
+    };
+
+    let output = run(&["-o", "json"]);
+    let parsed: serde_json::Value =
+        serde_json::from_slice(&output.stdout).expect("Invalid JSON output");
+    let with_array = parsed["changed"]
+        .as_array()
+        .unwrap()
+        .iter()
+        .find(|c| c["name"] == "WithArray")
+        .expect("WithArray changed");
+    let impact = &with_array["impact"];
+    assert_eq!(impact["cache_lines_delta"], 0);
+    // 20-byte elements touch 1.25 lines on average, 28-byte ones 1.375.
+    assert_eq!(impact["old_stride"]["cache_lines_per_element"], 1.25);
+    assert_eq!(impact["new_stride"]["cache_lines_per_element"], 1.375);
+    assert_eq!(impact["new_stride"]["elements_per_page"], 146);
+
+    // No struct crosses into another cache line, but array elements do.
+    let output = run(&["--fail-on-regression", "--regression-on", "cache-lines,line-splits"]);
+    assert!(output.status.success(), "{}", String::from_utf8_lossy(&output.stderr));
+    let output = run(&["--fail-on-regression", "--regression-on", "stride", "-o", "sarif"]);
+    assert!(!output.status.success());
+    let parsed: serde_json::Value =
+        serde_json::from_slice(&output.stdout).expect("Invalid SARIF output");
+    let levels: Vec<(&str, &str)> = parsed["runs"][0]["results"]
+        .as_array()
+        .unwrap()
+        .iter()
+        .map(|r| (r["ruleId"].as_str().unwrap(), r["level"].as_str().unwrap()))
+        .collect();
+    assert!(levels.contains(&("LAYOUT-STRIDE-REGRESSION", "error")), "{levels:?}");
+    assert!(levels.contains(&("LAYOUT-SIZE-INCREASE", "warning")), "{levels:?}");
+}
+
 #[test]
 fn test_check_budget_fail_max_padding_bytes() {
     let path = match get_fixture_path() {
@@ -2084,3 +2251,942 @@ fn test_go_well_aligned_vs_poorly_aligned() {
         poorly[0].metrics.padding_bytes
     );
 }
+
+#[test]
+fn test_parallel_extraction_matches_sequential() {
+    let path = match get_go_fixture_path() {
+        Some(p) => p,
+        None => return,
+    };
+
+    let binary = BinaryData::load(&path).expect("Failed to load Go binary");
+    let loaded = binary.load_dwarf().expect("Failed to load DWARF");
+
+    let sequential = DwarfContext::new(&loaded).find_structs(None, true).expect("Failed");
+    let parallel =
+        DwarfContext::new(&loaded).with_jobs(4).find_structs(None, true).expect("Failed");
+
+    // Go binaries carry many compilation units, so this exercises the worker pool
+    let seq_json = serde_json::to_string(&sequential).unwrap();
+    let par_json = serde_json::to_string(&parallel).unwrap();
+    assert_eq!(seq_json, par_json, "Parallel extraction must match sequential output");
+}
+
+#[test]
+fn test_cli_jobs_flag() {
+    let path = match get_fixture_path() {
+        Some(p) => p,
+        None => return,
+    };
+
+    let run = |jobs: &str| {
+        std::process::Command::new("cargo")
+            .args(["run", "--", "inspect", path.to_str().unwrap(), "-o", "json", "-j", jobs])
+            .output()
+            .expect("Failed to run inspect")
+    };
+
+    let sequential = run("1");
+    let all_cpus = run("0");
+    assert!(sequential.status.success() && all_cpus.status.success());
+    assert_eq!(sequential.stdout, all_cpus.stdout, "--jobs must not change output");
+}
+
+#[test]
+fn test_cli_cache_dir_roundtrip() {
+    let path = match get_fixture_path() {
+        Some(p) => p,
+        None => return,
+    };
+    let cache_dir = tempfile::tempdir().expect("tempdir");
+
+    let run = || {
+        std::process::Command::new("cargo")
+            .args([
+                "run",
+                "--",
+                "inspect",
+                path.to_str().unwrap(),
+                "-o",
+                "json",
+                "--cache-dir",
+                cache_dir.path().to_str().unwrap(),
+            ])
+            .output()
+            .expect("Failed to run inspect")
+    };
+
+    let cold = run();
+    assert!(cold.status.success());
+    let entries: Vec<_> = std::fs::read_dir(cache_dir.path()).unwrap().flatten().collect();
+    assert_eq!(
+        entries.len(),
+        2,
+        "First run should populate the binary's entry and its per-unit entry"
+    );
+
+    let warm = run();
+    assert!(warm.status.success());
+    assert_eq!(cold.stdout, warm.stdout, "Cached layouts must produce identical output");
+}
+
+#[test]
+fn test_cli_timings_report() {
+    let path = match get_fixture_path() {
+        Some(p) => p,
+        None => return,
+    };
+    let dir = tempfile::tempdir().expect("tempdir");
+    let timings_file = dir.path().join("timings.json");
+
+    let run = |args: &[&str]| {
+        std::process::Command::new("cargo")
+            .args(["run", "--", "inspect", path.to_str().unwrap(), "-o", "json"])
+            .args(args)
+            .output()
+            .expect("Failed to run inspect")
+    };
+
+    let plain = run(&[]);
+    let timed = run(&["--timings=json", "--timings-file", timings_file.to_str().unwrap()]);
+    assert!(plain.status.success() && timed.status.success());
+    assert_eq!(plain.stdout, timed.stdout, "--timings must not change output");
+
+    let report: serde_json::Value =
+        serde_json::from_str(&std::fs::read_to_string(&timings_file).unwrap()).unwrap();
+    let stages: Vec<&str> =
+        report["stages"].as_array().unwrap().iter().map(|s| s["name"].as_str().unwrap()).collect();
+    assert_eq!(stages, ["mmap", "load_dwarf", "extract", "analyze", "output"]);
+    assert!(report["extract"]["units"].as_u64().unwrap() > 0);
+    assert!(report["extract"]["dies_visited"].as_u64().unwrap() > 0);
+    let extracted = report["extract"]["structs_unique"].as_u64().unwrap();
+    let printed: serde_json::Value = serde_json::from_slice(&timed.stdout).unwrap();
+    assert_eq!(extracted, printed["structs"].as_array().unwrap().len() as u64);
+
+    let table = run(&["--timings"]);
+    assert!(table.status.success());
+    let stderr = String::from_utf8_lossy(&table.stderr);
+    assert!(stderr.contains("load_dwarf") && stderr.contains("DIEs visited"));
+}
+
+#[test]
+fn test_inspect_detail_renders_top_tables_and_totals() {
+    let path = match get_fixture_path() {
+        Some(p) => p,
+        None => return,
+    };
+
+    let output = std::process::Command::new("cargo")
+        .args(["run", "--", "inspect", path.to_str().unwrap(), "--no-color"])
+        .args(["--sort-by", "padding", "--detail", "1", "-j", "3"])
+        .output()
+        .expect("Failed to run layout-audit");
+    assert!(output.status.success(), "{}", String::from_utf8_lossy(&output.stderr));
+    let stdout = String::from_utf8_lossy(&output.stdout);
+    assert_eq!(stdout.matches("Offset").count(), 1, "{stdout}");
+    assert!(stdout.starts_with("struct "), "{stdout}");
+    assert!(stdout.contains(" more structs:\n  struct "), "{stdout}");
+    assert!(stdout.lines().last().unwrap().starts_with("Totals: "), "{stdout}");
+}
+
+#[test]
+fn test_target_profiles_report_each_target() {
+    let path = match get_fixture_path() {
+        Some(p) => p,
+        None => return,
+    };
+    let run = |args: &[&str]| {
+        std::process::Command::new("cargo")
+            .args(["run", "--"])
+            .args(args)
+            .arg(path.to_str().unwrap())
+            .output()
+            .expect("Failed to run layout-audit")
+    };
+
+    let inspect =
+        run(&["inspect", "-o", "json", "--target", "x86-64,apple-m,auto", "-f", "NoPadding"]);
+    assert!(inspect.status.success(), "{}", String::from_utf8_lossy(&inspect.stderr));
+    let parsed: serde_json::Value = serde_json::from_slice(&inspect.stdout).unwrap();
+    let metrics = &parsed["structs"][0]["metrics"];
+    let targets: Vec<(&str, u64)> = metrics["targets"]
+        .as_array()
+        .unwrap()
+        .iter()
+        .map(|t| (t["target"].as_str().unwrap(), t["cache_line_size"].as_u64().unwrap()))
+        .collect();
+    // `auto` is the fixture's own architecture, x86-64 where the fixtures are built.
+    assert_eq!(&targets[..2], [("x86-64", 64), ("apple-m", 128)]);
+    let densities: Vec<f64> = metrics["targets"]
+        .as_array()
+        .unwrap()
+        .iter()
+        .map(|t| t["cache_line_density"].as_f64().unwrap())
+        .collect();
+    let worst = densities.iter().copied().fold(f64::INFINITY, f64::min);
+    assert_eq!(metrics["cache_line_density"].as_f64().unwrap(), worst);
+
+    let suggest = run(&["suggest", "-o", "json", "--target", "i386,x86-64"]);
+    assert!(suggest.status.success(), "{}", String::from_utf8_lossy(&suggest.stderr));
+    let parsed: serde_json::Value = serde_json::from_slice(&suggest.stdout).unwrap();
+    let suggestion = &parsed["suggestions"][0];
+    let savings: Vec<u64> = suggestion["targets"]
+        .as_array()
+        .unwrap()
+        .iter()
+        .map(|t| t["savings_bytes"].as_u64().unwrap())
+        .collect();
+    assert_eq!(savings.len(), 2);
+    assert_eq!(suggestion["savings_bytes"].as_u64(), savings.iter().min().copied());
+
+    let unknown = run(&["inspect", "--target", "vax"]);
+    assert!(!unknown.status.success());
+    assert!(String::from_utf8_lossy(&unknown.stderr).contains("unknown target 'vax'"));
+    let conflicting = run(&["inspect", "--target", "x86-64", "--cache-line", "128"]);
+    assert!(!conflicting.status.success());
+}
+
+#[test]
+fn test_snapshot_replaces_binary_in_diff_and_check() {
+    let old_path = match get_fixture_path() {
+        Some(p) => p,
+        None => return,
+    };
+    let new_path = match get_modified_fixture_path() {
+        Some(p) => p,
+        None => return,
+    };
+    let dir = tempfile::tempdir().expect("tempdir");
+    let snapshot = dir.path().join("baseline.snapshot");
+
+    let run = |args: &[&str]| {
+        let output = std::process::Command::new("cargo")
+            .args(["run", "--"])
+            .args(args)
+            .output()
+            .expect("Failed to run layout-audit");
+        assert!(output.status.success(), "{}", String::from_utf8_lossy(&output.stderr));
+        output.stdout
+    };
+    let old = old_path.to_str().unwrap();
+    let new = new_path.to_str().unwrap();
+
+    let inspect =
+        run(&["inspect", old, "-o", "json", "--write-snapshot", snapshot.to_str().unwrap()]);
+    assert_eq!(inspect, run(&["inspect", old, "-o", "json"]), "writing a snapshot changed output");
+    let snapshot_len = std::fs::metadata(&snapshot).unwrap().len();
+    assert!(snapshot_len < std::fs::metadata(&old_path).unwrap().len());
+
+    let from_snapshot = run(&["diff", snapshot.to_str().unwrap(), new, "-o", "json"]);
+    assert_eq!(from_snapshot, run(&["diff", old, new, "-o", "json"]));
+
+    let config = create_temp_config(
+        r#"
+budgets:
+  NoPadding:
+    max_size: 100
+"#,
+    );
+    let check =
+        |binary: &str| run(&["check", binary, "--config", config.to_str().unwrap(), "-o", "json"]);
+    assert_eq!(check(snapshot.to_str().unwrap()), check(old));
+
+    // A damaged snapshot is an error rather than an empty baseline.
+    let mut data = std::fs::read(&snapshot).unwrap();
+    data.truncate(data.len() - 1);
+    std::fs::write(&snapshot, data).unwrap();
+    let output = std::process::Command::new("cargo")
+        .args(["run", "--", "diff", snapshot.to_str().unwrap(), new])
+        .output()
+        .expect("Failed to run diff");
+    assert!(!output.status.success());
+    assert!(String::from_utf8_lossy(&output.stderr).contains("Invalid layout snapshot"));
+}
+
+#[test]
+fn test_layout_cache_key_tracks_options() {
+    use layout_audit::{CacheKey, LayoutCache};
+
+    let path = match get_fixture_path() {
+        Some(p) => p,
+        None => return,
+    };
+    let binary = BinaryData::load(&path).expect("Failed to load binary");
+    let loaded = binary.load_dwarf().expect("Failed to load DWARF");
+    let layouts = DwarfContext::new(&loaded).find_structs(None, false).expect("Failed");
+
+    let cache_dir = tempfile::tempdir().expect("tempdir");
+    let cache = LayoutCache::new(cache_dir.path());
+    let key = CacheKey::new(&binary, None, false);
+    assert_eq!(key, CacheKey::new(&binary, None, false), "Key must be deterministic");
+    cache.store(&key, &layouts).expect("store");
+
+    let hit = cache.load(&key).expect("Cache should hit for the same key");
+    assert_eq!(serde_json::to_string(&hit).unwrap(), serde_json::to_string(&layouts).unwrap());
+    assert!(cache.load(&CacheKey::new(&binary, Some("Padded"), false)).is_none());
+    assert!(cache.load(&CacheKey::new(&binary, None, true)).is_none());
+}
+
+#[test]
+fn test_filtered_extraction_matches_full_scan() {
+    for path in [get_fixture_path(), get_cpp_fixture_path()].into_iter().flatten() {
+        let binary = BinaryData::load(&path).expect("Failed to load binary");
+        let loaded = binary.load_dwarf().expect("Failed to load DWARF");
+        let dwarf = DwarfContext::new(&loaded);
+
+        let all = dwarf.find_structs(None, false).expect("Failed");
+        for filter in ["Pair", "Padding", "Node", "zzz_no_match"] {
+            let expected: Vec<_> = all.iter().filter(|s| s.name.contains(filter)).collect();
+            let filtered = dwarf.find_structs(Some(filter), false).expect("Failed");
+            assert_eq!(
+                serde_json::to_string(&expected).unwrap(),
+                serde_json::to_string(&filtered).unwrap(),
+                "Filter {filter:?} on {} must match the filtered full scan",
+                path.display()
+            );
+        }
+    }
+}
+
+#[test]
+fn test_layout_loader_matches_full_loader() {
+    fn extract<'a>(loaded: &'a layout_audit::LoadedDwarf<'a>) -> String {
+        let structs = DwarfContext::new(loaded).find_structs(None, true).expect("Failed");
+        serde_json::to_string(&structs).unwrap()
+    }
+
+    let paths = [get_fixture_path(), get_cpp_fixture_path(), get_go_fixture_path()];
+    for path in paths.into_iter().flatten() {
+        let binary = BinaryData::load(&path).expect("Failed to load binary");
+        let full = extract(&binary.load_dwarf().expect("Failed to load DWARF"));
+        let layouts = extract(&binary.load_dwarf_for_layouts(0).expect("Failed to load DWARF"));
+        assert_eq!(full, layouts, "Section subset changed layouts of {}", path.display());
+    }
+}
+
+#[test]
+fn test_cli_ndjson_output() {
+    let path = match get_fixture_path() {
+        Some(p) => p,
+        None => return,
+    };
+
+    let run = |format: &str| {
+        std::process::Command::new("cargo")
+            .args(["run", "--", "inspect", path.to_str().unwrap(), "-o", format])
+            .output()
+            .expect("Failed to run inspect")
+    };
+
+    let ndjson = run("ndjson");
+    assert!(ndjson.status.success());
+    let json = run("json");
+    let document: serde_json::Value = serde_json::from_slice(&json.stdout).expect("Invalid JSON");
+
+    // Every line is one struct, and together they equal the JSON document's struct list.
+    let stdout = String::from_utf8_lossy(&ndjson.stdout);
+    let records: Vec<serde_json::Value> =
+        stdout.lines().map(|l| serde_json::from_str(l).expect("Invalid NDJSON line")).collect();
+    assert!(!records.is_empty());
+    assert_eq!(&serde_json::Value::Array(records), &document["structs"]);
+}
+
+#[test]
+fn test_cli_ndjson_top_and_sort() {
+    let path = match get_fixture_path() {
+        Some(p) => p,
+        None => return,
+    };
+
+    let output = std::process::Command::new("cargo")
+        .args([
+            "run",
+            "--",
+            "inspect",
+            path.to_str().unwrap(),
+            "-o",
+            "ndjson",
+            "--sort-by",
+            "padding",
+            "-n",
+            "2",
+        ])
+        .output()
+        .expect("Failed to run inspect");
+    assert!(output.status.success());
+
+    let stdout = String::from_utf8_lossy(&output.stdout);
+    let padding: Vec<u64> = stdout
+        .lines()
+        .map(|l| {
+            let v: serde_json::Value = serde_json::from_str(l).expect("Invalid NDJSON line");
+            v["metrics"]["padding_bytes"].as_u64().unwrap()
+        })
+        .collect();
+    assert_eq!(padding.len(), 2);
+    assert!(padding[0] >= padding[1], "Records should be sorted by padding");
+}
+
+// ============================================================================
+// Split DWARF tests
+// ============================================================================
+
+/// Get path to a split DWARF fixture (built from test_simple.c with -gsplit-dwarf), or None
+/// if not found. Only built on Linux.
+fn get_split_fixture_path(name: &str) -> Option<std::path::PathBuf> {
+    let path = std::path::Path::new("tests/fixtures/bin").join(name);
+    path.exists().then_some(path)
+}
+
+/// Compare a split build against the monolithic fixture. `exact` also compares type names
+/// and qualifiers, which only line up when both use the same DWARF version.
+fn assert_split_matches_monolithic(name: &str, exact: bool) {
+    let (Some(split_path), Some(mono_path)) = (get_split_fixture_path(name), get_fixture_path())
+    else {
+        eprintln!("Split DWARF fixture {name} not found, skipping test");
+        return;
+    };
+
+    let split_binary = BinaryData::load(&split_path).expect("Failed to load binary");
+    let split_loaded = split_binary.load_dwarf_for_layouts(0).expect("Failed to load DWARF");
+    assert_eq!(split_loaded.split_dwarfs.len(), 1, "Expected one split unit in {name}");
+    assert!(split_loaded.missing_split_units.is_empty());
+
+    let mono_binary = BinaryData::load(&mono_path).expect("Failed to load binary");
+    let mono_loaded = mono_binary.load_dwarf_for_layouts(0).expect("Failed to load DWARF");
+    let expected = DwarfContext::new(&mono_loaded).find_structs(None, false).expect("Failed");
+    assert!(!expected.is_empty());
+
+    let shape = |layouts: &[layout_audit::StructLayout]| -> Vec<_> {
+        layouts
+            .iter()
+            .map(|s| {
+                let members: Vec<_> =
+                    s.members.iter().map(|m| (m.name.clone(), m.offset, m.size)).collect();
+                (s.name.clone(), s.size, s.source_location.clone().map(|l| l.line), members)
+            })
+            .collect()
+    };
+
+    for jobs in [1, 4] {
+        let split = DwarfContext::new(&split_loaded)
+            .with_jobs(jobs)
+            .find_structs(None, false)
+            .expect("Failed");
+        assert_eq!(shape(&expected), shape(&split), "{name} with {jobs} job(s)");
+        if exact {
+            assert_eq!(
+                serde_json::to_string(&expected).unwrap(),
+                serde_json::to_string(&split).unwrap(),
+                "{name} with {jobs} job(s) must match the monolithic build"
+            );
+        }
+    }
+
+    let filtered =
+        DwarfContext::new(&split_loaded).find_structs(Some("Padding"), false).expect("Failed");
+    assert!(!filtered.is_empty());
+    assert!(filtered.iter().all(|s| s.name.contains("Padding")));
+}
+
+#[test]
+fn test_split_dwarf_dwo() {
+    assert_split_matches_monolithic("test_split", true);
+}
+
+#[test]
+fn test_split_dwarf_dwp() {
+    // Built as DWARF 4, which has no DW_TAG_atomic_type.
+    assert_split_matches_monolithic("test_split_dwp", false);
+}
+
+/// Compare a build with type units (`-fdebug-types-section`) against the C++ fixture.
+/// `exact` as for `assert_split_matches_monolithic`.
+fn assert_type_units_match_monolithic(name: &str, exact: bool) {
+    let (Some(types_path), Some(mono_path)) =
+        (get_split_fixture_path(name), get_cpp_fixture_path())
+    else {
+        eprintln!("Type unit fixture {name} not found, skipping test");
+        return;
+    };
+
+    let types_binary = BinaryData::load(&types_path).expect("Failed to load binary");
+    let types_loaded = types_binary.load_dwarf_for_layouts(0).expect("Failed to load DWARF");
+    let mono_binary = BinaryData::load(&mono_path).expect("Failed to load binary");
+    let mono_loaded = mono_binary.load_dwarf_for_layouts(0).expect("Failed to load DWARF");
+    let expected = DwarfContext::new(&mono_loaded).find_structs(None, false).expect("Failed");
+    assert!(!expected.is_empty());
+
+    // DWARF 4 lists static data members as members without an offset; DWARF 5 does not.
+    let shape = |layouts: &[layout_audit::StructLayout]| -> Vec<_> {
+        layouts
+            .iter()
+            .map(|s| {
+                let members: Vec<_> = s
+                    .members
+                    .iter()
+                    .filter(|m| m.offset.is_some())
+                    .map(|m| (m.name.clone(), m.type_name.clone(), m.offset, m.size))
+                    .collect();
+                (s.name.clone(), s.size, members)
+            })
+            .collect()
+    };
+
+    for jobs in [1, 4] {
+        let types = DwarfContext::new(&types_loaded)
+            .with_jobs(jobs)
+            .find_structs(None, false)
+            .expect("Failed");
+        assert_eq!(shape(&expected), shape(&types), "{name} with {jobs} job(s)");
+        if exact {
+            assert_eq!(
+                serde_json::to_string(&expected).unwrap(),
+                serde_json::to_string(&types).unwrap(),
+                "{name} with {jobs} job(s) must match the build without type units"
+            );
+        }
+    }
+}
+
+#[test]
+fn test_type_units_in_debug_info() {
+    assert_type_units_match_monolithic("test_types", true);
+}
+
+#[test]
+fn test_type_units_in_debug_types() {
+    assert_type_units_match_monolithic("test_types_dwarf4", false);
+}
+
+// ============================================================================
+// Batch mode tests
+// ============================================================================
+
+#[test]
+fn test_batch_merges_identical_layouts() {
+    let (simple, modified) = match (get_fixture_path(), get_modified_fixture_path()) {
+        (Some(s), Some(m)) => (s, m),
+        _ => return,
+    };
+
+    let dir = tempfile::tempdir().expect("tempdir");
+    std::fs::copy(&simple, dir.path().join("a")).expect("copy");
+    std::fs::copy(&simple, dir.path().join("b")).expect("copy");
+    std::fs::copy(&modified, dir.path().join("c")).expect("copy");
+    std::fs::write(dir.path().join("notes.txt"), "not a binary").expect("write");
+
+    let output = std::process::Command::new("cargo")
+        .args(["run", "--", "batch", dir.path().to_str().unwrap(), "-o", "json"])
+        .output()
+        .expect("Failed to run CLI");
+
+    assert!(output.status.success(), "CLI failed: {:?}", String::from_utf8_lossy(&output.stderr));
+
+    let parsed: serde_json::Value =
+        serde_json::from_slice(&output.stdout).expect("Invalid JSON output");
+    let binaries: Vec<_> = parsed["binaries"]
+        .as_array()
+        .unwrap()
+        .iter()
+        .map(|b| std::path::Path::new(b.as_str().unwrap()).file_name().unwrap().to_owned())
+        .collect();
+    assert_eq!(binaries, ["a", "b", "c"], "notes.txt must be skipped");
+
+    let structs = parsed["structs"].as_array().unwrap();
+    let seen_in = |name: &str| -> Vec<Vec<String>> {
+        structs
+            .iter()
+            .filter(|s| s["name"] == name)
+            .map(|s| {
+                s["binaries"]
+                    .as_array()
+                    .unwrap()
+                    .iter()
+                    .map(|b| {
+                        let b = std::path::Path::new(b.as_str().unwrap());
+                        b.file_name().unwrap().to_string_lossy().into_owned()
+                    })
+                    .collect()
+            })
+            .collect()
+    };
+
+    // Identical copies share one entry; the changed layout in `c` stays separate.
+    assert_eq!(seen_in("NoPadding"), [vec!["a", "b"], vec!["c"]]);
+    assert_eq!(seen_in("NewStruct"), [["c"]]);
+}
+
+// ============================================================================
+// Access profile tests
+// ============================================================================
+
+#[test]
+fn test_suggest_with_access_profile() {
+    let path = match get_fixture_path() {
+        Some(p) => p,
+        None => return,
+    };
+
+    let dir = tempfile::tempdir().expect("tempdir");
+    let profile = dir.path().join("profile.txt");
+    // CSV and perf's data-type report may be mixed; both name InternalPadding's `c` and `b`.
+    std::fs::write(
+        &profile,
+        "struct,offset,samples\nInternalPadding,8,80\n    10.00%  struct InternalPadding +4 (b)\n",
+    )
+    .expect("write profile");
+
+    let output = std::process::Command::new("cargo")
+        .args([
+            "run",
+            "--",
+            "inspect",
+            path.to_str().unwrap(),
+            "--filter",
+            "InternalPadding",
+            "-o",
+            "json",
+            "--profile",
+            profile.to_str().unwrap(),
+        ])
+        .output()
+        .expect("Failed to run CLI");
+    assert!(output.status.success(), "CLI failed: {:?}", String::from_utf8_lossy(&output.stderr));
+    let parsed: serde_json::Value = serde_json::from_slice(&output.stdout).expect("Invalid JSON");
+    let heat = &parsed["structs"][0]["metrics"]["access_heat"];
+    assert_eq!(heat["total_weight"], 90.0);
+    assert_eq!(heat["members"][0]["name"], "c");
+    assert_eq!(heat["cache_lines"][0]["cache_line"], 0);
+
+    let output = std::process::Command::new("cargo")
+        .args([
+            "run",
+            "--",
+            "suggest",
+            path.to_str().unwrap(),
+            "--filter",
+            "InternalPadding",
+            "-o",
+            "json",
+            "--profile",
+            profile.to_str().unwrap(),
+        ])
+        .output()
+        .expect("Failed to run CLI");
+    assert!(output.status.success(), "CLI failed: {:?}", String::from_utf8_lossy(&output.stderr));
+    let parsed: serde_json::Value = serde_json::from_slice(&output.stdout).expect("Invalid JSON");
+    let hot = &parsed["suggestions"][0]["hot_fields"];
+    assert_eq!(hot["hot_members"], serde_json::json!(["c", "b"]));
+    assert_eq!(hot["optimized_first_line_percent"], 100.0);
+}
+
+#[test]
+fn test_suggest_cache_line_strategy_separates_atomics() {
+    let path = match get_fixture_path() {
+        Some(p) => p,
+        None => return,
+    };
+
+    let output = std::process::Command::new("cargo")
+        .args([
+            "run",
+            "--",
+            "suggest",
+            path.to_str().unwrap(),
+            "--filter",
+            "WithAtomics",
+            "--strategy",
+            "cache-line",
+            "-o",
+            "json",
+        ])
+        .output()
+        .expect("Failed to run CLI");
+    assert!(output.status.success(), "CLI failed: {:?}", String::from_utf8_lossy(&output.stderr));
+
+    let parsed: serde_json::Value = serde_json::from_slice(&output.stdout).expect("Invalid JSON");
+    let suggestion = &parsed["suggestions"][0];
+    let plan = &suggestion["cache_lines"];
+    assert_eq!(plan["isolated_atomics"], serde_json::json!(["a", "b"]));
+    assert_eq!(plan["original_false_sharing_pairs"], 1);
+    let lines: Vec<u64> = suggestion["optimized_members"]
+        .as_array()
+        .unwrap()
+        .iter()
+        .map(|m| m["offset"].as_u64().unwrap() / 64)
+        .collect();
+    assert_eq!(lines, [0, 1]);
+}
+
+#[test]
+fn test_suggest_split_strategy_moves_cold_fields_out() {
+    let path = match get_fixture_path() {
+        Some(p) => p,
+        None => return,
+    };
+
+    let output = std::process::Command::new("cargo")
+        .args([
+            "run",
+            "--",
+            "suggest",
+            path.to_str().unwrap(),
+            "--filter",
+            "WithPointer",
+            "--strategy",
+            "split",
+            "--hot",
+            "WithPointer:value",
+            "-o",
+            "json",
+        ])
+        .output()
+        .expect("Failed to run CLI");
+    assert!(output.status.success(), "CLI failed: {:?}", String::from_utf8_lossy(&output.stderr));
+
+    let parsed: serde_json::Value = serde_json::from_slice(&output.stdout).expect("Invalid JSON");
+    let plan = &parsed["suggestions"][0]["split"];
+    assert_eq!(plan["recommendation"], "hot_cold");
+    assert_eq!(plan["elements"], 1024);
+    assert_eq!(plan["hot_size"], 4);
+    assert_eq!(plan["hot_cold"]["cache_lines"], 64);
+    assert!(plan["original"]["cache_lines"].as_u64().unwrap() > 64);
+    let cold: Vec<&str> = plan["cold_members"]
+        .as_array()
+        .unwrap()
+        .iter()
+        .map(|m| m["name"].as_str().unwrap())
+        .collect();
+    assert_eq!(cold, ["ptr", "tag"]);
+}
+
+#[test]
+fn test_inspect_false_sharing_one_warning_per_line() {
+    let path = match get_fixture_path() {
+        Some(p) => p,
+        None => return,
+    };
+
+    let inspect = |flag: &str| {
+        let output = std::process::Command::new("cargo")
+            .args(["run", "--", "inspect", path.to_str().unwrap(), "--filter", "WithAtomics", flag])
+            .args(["-o", "json"])
+            .output()
+            .expect("Failed to run CLI");
+        assert!(
+            output.status.success(),
+            "CLI failed: {:?}",
+            String::from_utf8_lossy(&output.stderr)
+        );
+        let parsed: serde_json::Value =
+            serde_json::from_slice(&output.stdout).expect("Invalid JSON");
+        parsed["structs"][0]["metrics"]["false_sharing"].clone()
+    };
+
+    let fs = inspect("--warn-false-sharing");
+    assert_eq!(fs["contended_lines"][0]["members"], serde_json::json!(["a", "b"]));
+    assert_eq!(fs["pair_count"], 1);
+    assert_eq!(fs["warnings"], serde_json::json!([]));
+
+    let fs = inspect("--false-sharing-pairs");
+    assert_eq!(fs["warnings"][0]["member_a"], "a");
+    assert_eq!(fs["warnings"][0]["member_b"], "b");
+}
+
+// ============================================================================
+// Footprint tests
+// ============================================================================
+
+#[test]
+fn test_footprint_weights_padding_by_instances() {
+    let path = match get_fixture_path() {
+        Some(p) => p,
+        None => return,
+    };
+
+    let dir = tempfile::tempdir().expect("tempdir");
+    let counts = dir.path().join("counts.txt");
+    std::fs::write(&counts, "# live objects\nTailPadding: 10\nInternalPadding: 1_000\nNoSuch: 3\n")
+        .expect("write counts");
+
+    let output = std::process::Command::new("cargo")
+        .args([
+            "run",
+            "--",
+            "footprint",
+            path.to_str().unwrap(),
+            "--instances",
+            counts.to_str().unwrap(),
+            "-o",
+            "json",
+        ])
+        .output()
+        .expect("Failed to run CLI");
+    assert!(output.status.success(), "CLI failed: {:?}", String::from_utf8_lossy(&output.stderr));
+    assert!(String::from_utf8_lossy(&output.stderr).contains("not found in binary: NoSuch"));
+
+    let parsed: serde_json::Value = serde_json::from_slice(&output.stdout).expect("Invalid JSON");
+    let structs = parsed["structs"].as_array().unwrap();
+    assert_eq!(structs.len(), 2);
+    // 6 padding bytes × 1000 instances; reordering shrinks 16 bytes to 12.
+    assert_eq!(structs[0]["name"], "InternalPadding");
+    assert_eq!(structs[0]["wasted_bytes"], 6000);
+    assert_eq!(structs[0]["projected_savings_bytes"], 4000);
+    assert_eq!(structs[1]["name"], "TailPadding");
+    assert_eq!(structs[1]["projected_savings_bytes"], 0);
+    assert_eq!(parsed["summary"]["total_wasted_bytes"], 6030);
+    assert_eq!(parsed["summary"]["unmatched"][0], "NoSuch");
+}
+
+#[test]
+fn test_footprint_rejects_malformed_counts() {
+    let path = match get_fixture_path() {
+        Some(p) => p,
+        None => return,
+    };
+
+    let dir = tempfile::tempdir().expect("tempdir");
+    let counts = dir.path().join("counts.txt");
+    std::fs::write(&counts, "InternalPadding: lots\n").expect("write counts");
+
+    let output = std::process::Command::new("cargo")
+        .args([
+            "run",
+            "--",
+            "footprint",
+            path.to_str().unwrap(),
+            "--instances",
+            counts.to_str().unwrap(),
+        ])
+        .output()
+        .expect("Failed to run CLI");
+    assert!(!output.status.success());
+    assert!(String::from_utf8_lossy(&output.stderr).contains("line 1"));
+}
+
+#[test]
+fn test_hotspots_ranks_structs_by_profiled_functions() {
+    let path = match get_fixture_path() {
+        Some(p) => p,
+        None => return,
+    };
+
+    let dir = tempfile::tempdir().expect("tempdir");
+    let perf = dir.path().join("perf.txt");
+    std::fs::write(
+        &perf,
+        "# Overhead  Command  Shared Object  Symbol\n\
+         70.00%  test_simple  test_simple  [.] route_length\n\
+         20.00%  test_simple  test_simple  [.] padding_sum.isra.0\n\
+         10.00%  test_simple  [kernel.kallsyms]  [k] clear_page_erms\n",
+    )
+    .expect("write profile");
+
+    let run = |extra: &[&str]| {
+        let mut args = vec!["run", "--", "hotspots", path.to_str().unwrap(), "-o", "json"];
+        args.extend_from_slice(extra);
+        let output =
+            std::process::Command::new("cargo").args(&args).output().expect("Failed to run CLI");
+        assert!(
+            output.status.success(),
+            "CLI failed: {:?}",
+            String::from_utf8_lossy(&output.stderr)
+        );
+        serde_json::from_slice::<serde_json::Value>(&output.stdout).expect("Invalid JSON")
+    };
+
+    // Without a profile, InternalPadding is taken by more functions.
+    let parsed = run(&[]);
+    let structs = parsed["structs"].as_array().unwrap();
+    let names: Vec<_> = structs.iter().map(|s| s["name"].as_str().unwrap()).collect();
+    assert_eq!(names, ["InternalPadding", "Route"]);
+    let users: Vec<_> = structs[0]["functions"]
+        .as_array()
+        .unwrap()
+        .iter()
+        .map(|f| (f["function"].as_str().unwrap(), f["passing"].as_str().unwrap()))
+        .collect();
+    assert_eq!(users, [("copy_padding", "pointer"), ("padding_sum", "value")]);
+    assert!(
+        structs[1]["functions"][0]["source_location"]["file"]
+            .as_str()
+            .unwrap()
+            .ends_with("test_simple.c")
+    );
+    assert_eq!(parsed["summary"]["functions_with_structs"], 3);
+
+    // The profile ranks Route first, and the clone's samples count for padding_sum.
+    let parsed = run(&["--perf", perf.to_str().unwrap()]);
+    let structs = parsed["structs"].as_array().unwrap();
+    assert_eq!(structs[0]["name"], "Route");
+    assert_eq!(structs[0]["weight_percent"], 70.0);
+    assert_eq!(structs[1]["functions"][0]["function"], "padding_sum");
+    assert_eq!(structs[1]["weight_percent"], 20.0);
+    assert_eq!(parsed["summary"]["profiled_percent"], 90.0);
+}
+
+#[test]
+fn test_cli_serve_answers_queries() {
+    use std::io::{BufRead, BufReader, Write};
+
+    let path = match get_fixture_path() {
+        Some(p) => p,
+        None => return,
+    };
+
+    let mut server = std::process::Command::new("cargo")
+        .args(["run", "--", "serve", path.to_str().unwrap(), "--listen", "127.0.0.1:0"])
+        .stdout(std::process::Stdio::piped())
+        .spawn()
+        .expect("Failed to run serve");
+    let mut banner = String::new();
+    BufReader::new(server.stdout.take().unwrap()).read_line(&mut banner).unwrap();
+    let addr = banner
+        .strip_prefix("Listening on ")
+        .and_then(|rest| rest.split_whitespace().next())
+        .unwrap_or_else(|| panic!("Unexpected banner: {banner}"));
+
+    let stream = std::net::TcpStream::connect(addr).expect("connect");
+    let mut writer = stream.try_clone().unwrap();
+    let mut reader = BufReader::new(stream);
+    let mut ask = |request: &str| {
+        writeln!(writer, "{request}").unwrap();
+        let mut line = String::new();
+        reader.read_line(&mut line).unwrap();
+        serde_json::from_str::<serde_json::Value>(&line).expect("response is JSON")
+    };
+
+    let inspect = ask(r#"{"command":"inspect","name":"InternalPadding"}"#);
+    assert_eq!(inspect["ok"], true);
+    assert_eq!(inspect["result"]["structs"][0]["name"], "InternalPadding");
+    assert_eq!(inspect["result"]["structs"].as_array().unwrap().len(), 1);
+
+    let status = ask(r#"{"command":"status"}"#);
+    assert!(status["result"]["structs"].as_u64().unwrap() > 0);
+
+    let invalid = ask(r#"{"command":"frobnicate"}"#);
+    assert_eq!(invalid["ok"], false);
+    assert!(invalid["error"].as_str().unwrap().contains("Invalid request"));
+
+    assert_eq!(ask(r#"{"command":"shutdown"}"#)["ok"], true);
+    assert!(server.wait().unwrap().success());
+}
+
+#[test]
+fn test_filter_finds_types_missing_from_name_index() {
+    let Some(path) = get_split_fixture_path("test_pubtypes") else {
+        eprintln!("Name index fixture test_pubtypes not found, skipping test");
+        return;
+    };
+    let binary = BinaryData::load(&path).expect("Failed to load binary");
+    let loaded = binary.load_dwarf_for_layouts(1).expect("Failed to load DWARF");
+    let names = |dwarf: DwarfContext<'_>| -> Vec<String> {
+        let layouts = dwarf.find_structs(Some("Record"), false).expect("Failed");
+        layouts.into_iter().map(|s| s.name).collect()
+    };
+
+    // The function-local struct is not in .debug_pubtypes, but a filter must not lose it.
+    assert_eq!(names(DwarfContext::new(&loaded)), ["IndexedRecord", "LocalRecord"]);
+    assert_eq!(names(DwarfContext::new(&loaded).with_name_index(true)), ["IndexedRecord"]);
+}